@@ -0,0 +1,588 @@
+#include "database_archive_importer.h"
+#include "tick_store.h"
+#include "binary_io.h"
+#include "logger.h"
+#include "time_utils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+
+/***********************************************
+ * ZIP record signatures (little endian).
+ ***********************************************/
+static constexpr uint32_t ZIP_LOCAL_HEADER_SIG   = 0x04034b50;
+static constexpr uint32_t ZIP_CENTRAL_HEADER_SIG = 0x02014b50;
+static constexpr uint32_t ZIP_END_OF_CENTRAL_SIG = 0x06054b50;
+static constexpr std::size_t ZIP_END_OF_CENTRAL_SIZE = 22;
+static constexpr std::size_t ZIP_LOCAL_HEADER_SIZE   = 30;
+static constexpr std::size_t ZIP_CENTRAL_HEADER_SIZE = 46;
+
+// Open times above this are in microseconds (spot archives since 2025)
+static constexpr long long MICROSECOND_OPEN_TIME = 100'000'000'000'000LL;
+
+template<typename T>
+static T readLE(std::string_view buf, std::size_t pos)
+{
+    T value = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+        value |= static_cast<T>(static_cast<unsigned char>(buf[pos + i])) << (8 * i);
+    return value;
+}
+
+/**************************************************************************************
+ * Purpose : Extracts the pair of a daily kline archive name (<PAIR>-1d-<YYYY>-<MM>...).
+ * Args    : filename - File name without directories.
+ * Return  : std::string - The pair, or empty if the file is not a daily kline archive.
+ **************************************************************************************/
+std::string pairFromArchiveName(const std::string& filename)
+{
+    const std::size_t dash = filename.find('-');
+    if (dash == std::string::npos || dash == 0)
+        return {};
+
+    if (filename.compare(dash, 4, "-1d-") != 0)
+        return {};
+
+    std::string pair = filename.substr(0, dash);
+    for (char c : pair)
+        if (!std::isupper(static_cast<unsigned char>(c)) && !std::isdigit(static_cast<unsigned char>(c)))
+            return {};
+
+    return pair;
+}
+
+/**************************************************************************************
+ * Purpose : Extracts the pair of an aggregated trades archive name
+ *           (<PAIR>-aggTrades-<YYYY>-<MM>[-<DD>]...).
+ * Args    : filename - File name without directories.
+ * Return  : std::string - The pair, or empty if the file is not an aggTrades archive.
+ **************************************************************************************/
+std::string pairFromAggTradesArchiveName(const std::string& filename)
+{
+    const std::size_t dash = filename.find('-');
+    if (dash == std::string::npos || dash == 0)
+        return {};
+
+    if (filename.compare(dash, 11, "-aggTrades-") != 0)
+        return {};
+
+    std::string pair = filename.substr(0, dash);
+    for (char c : pair)
+        if (!std::isupper(static_cast<unsigned char>(c)) && !std::isdigit(static_cast<unsigned char>(c)))
+            return {};
+
+    return pair;
+}
+
+/**************************************************************************************
+ * Purpose : Walks the central directory of an in-memory ZIP archive and inflates every
+ *           file entry.
+ * Args    : archive - Whole archive.
+ *           fn      - Receives the entry name and its uncompressed content.
+ * Return  : bool - false if the archive is malformed or an entry fails to inflate.
+ **************************************************************************************/
+bool forEachZipEntry(std::string_view archive,
+                     const std::function<void(std::string_view, std::string_view)>& fn)
+{
+    if (archive.size() < ZIP_END_OF_CENTRAL_SIZE)
+        return false;
+
+    // End of central directory: last record, followed by a comment of up to 64 KiB
+    std::size_t eocd = archive.size() - ZIP_END_OF_CENTRAL_SIZE;
+    const std::size_t lowest = eocd > 0xFFFF ? eocd - 0xFFFF : 0;
+    while (readLE<uint32_t>(archive, eocd) != ZIP_END_OF_CENTRAL_SIG)
+    {
+        if (eocd == lowest)
+            return false;
+        --eocd;
+    }
+
+    const uint16_t nEntries  = readLE<uint16_t>(archive, eocd + 10);
+    std::size_t    pos       = readLE<uint32_t>(archive, eocd + 16);
+
+    std::string inflated;
+    for (uint16_t e = 0; e < nEntries; ++e)
+    {
+        if (pos + ZIP_CENTRAL_HEADER_SIZE > archive.size() ||
+            readLE<uint32_t>(archive, pos) != ZIP_CENTRAL_HEADER_SIG)
+            return false;
+
+        const uint16_t method     = readLE<uint16_t>(archive, pos + 10);
+        const uint32_t compSize   = readLE<uint32_t>(archive, pos + 20);
+        const uint32_t rawSize    = readLE<uint32_t>(archive, pos + 24);
+        const uint16_t nameLen    = readLE<uint16_t>(archive, pos + 28);
+        const uint16_t extraLen   = readLE<uint16_t>(archive, pos + 30);
+        const uint16_t commentLen = readLE<uint16_t>(archive, pos + 32);
+        const uint32_t localPos   = readLE<uint32_t>(archive, pos + 42);
+
+        if (pos + ZIP_CENTRAL_HEADER_SIZE + nameLen > archive.size())
+            return false;
+        const std::string_view name = archive.substr(pos + ZIP_CENTRAL_HEADER_SIZE, nameLen);
+        pos += ZIP_CENTRAL_HEADER_SIZE + nameLen + extraLen + commentLen;
+
+        if (name.empty() || name.back() == '/')
+            continue;                              // Directory entry
+
+        if (compSize == 0xFFFFFFFF || rawSize == 0xFFFFFFFF)
+        {
+            LG_ERROR("ZIP64 entry {} is not supported", name);
+            return false;
+        }
+
+        if (localPos + ZIP_LOCAL_HEADER_SIZE > archive.size() ||
+            readLE<uint32_t>(archive, localPos) != ZIP_LOCAL_HEADER_SIG)
+            return false;
+
+        const std::size_t dataPos = localPos + ZIP_LOCAL_HEADER_SIZE
+                                  + readLE<uint16_t>(archive, localPos + 26)
+                                  + readLE<uint16_t>(archive, localPos + 28);
+        if (dataPos + compSize > archive.size())
+            return false;
+
+        const std::string_view compressed = archive.substr(dataPos, compSize);
+
+        if (method == 0)                           // Stored
+        {
+            fn(name, compressed);
+            continue;
+        }
+
+        if (method != 8)                           // Deflate
+        {
+            LG_ERROR("ZIP entry {} uses unsupported compression method {}", name, method);
+            return false;
+        }
+
+        inflated.resize(rawSize);
+
+        z_stream zs{};
+        if (inflateInit2(&zs, -MAX_WBITS) != Z_OK)
+            return false;
+
+        zs.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+        zs.avail_in  = compSize;
+        zs.next_out  = reinterpret_cast<Bytef*>(inflated.data());
+        zs.avail_out = rawSize;
+
+        const int rc = inflate(&zs, Z_FINISH);
+        inflateEnd(&zs);
+
+        if (rc != Z_STREAM_END || zs.total_out != rawSize)
+        {
+            LG_ERROR("Inflating ZIP entry {} failed (zlib {})", name, rc);
+            return false;
+        }
+
+        fn(name, inflated);
+    }
+
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Parses one number followed by ',' (or the end of the line).
+ * Args    : p     - Cursor, advanced past the field and its separator.
+ *           end   - End of the line.
+ *           value - Receives the number.
+ * Return  : bool - false if the field is not a number.
+ **************************************************************************************/
+template<typename T>
+static bool parseField(const char*& p, const char* end, T& value)
+{
+    auto [ptr, ec] = std::from_chars(p, end, value);
+    if (ec != std::errc{} || (ptr != end && *ptr != ',' && *ptr != '\r'))
+        return false;
+    p = (ptr != end && *ptr == ',') ? ptr + 1 : ptr;
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Parses a kline CSV in place. Each line is split with memchr and its fields
+ *           converted with std::from_chars straight from the buffer: no per-field allocation.
+ * Args    : csv  - CSV content.
+ *           out  - Receives date (YYYYMMDD) → OHLCV.
+ *           bad  - Incremented for each malformed line.
+ * Return  : std::size_t - Rows parsed.
+ **************************************************************************************/
+std::size_t parseKlineCsv(std::string_view csv, std::map<unsigned int, OHLCV>& out, std::size_t& bad)
+{
+    std::size_t rows = 0;
+    const char* p   = csv.data();
+    const char* end = csv.data() + csv.size();
+
+    while (p < end)
+    {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        const char* eol = nl ? nl : end;
+        const char* line = p;
+        p = nl ? nl + 1 : end;
+
+        // Header ("open_time,...") and blank lines
+        if (line == eol || !std::isdigit(static_cast<unsigned char>(*line)))
+            continue;
+
+        long long openTime = 0, closeTime = 0;
+        double    trades   = 0.0;
+        OHLCV     c{};
+
+        const bool ok = parseField(line, eol, openTime)
+                     && parseField(line, eol, c.open)
+                     && parseField(line, eol, c.high)
+                     && parseField(line, eol, c.low)
+                     && parseField(line, eol, c.close)
+                     && parseField(line, eol, c.volume)
+                     && parseField(line, eol, closeTime)
+                     && parseField(line, eol, c.quoteVolume)
+                     && parseField(line, eol, trades)
+                     && parseField(line, eol, c.takerBuyVolume)
+                     && parseField(line, eol, c.takerBuyQuoteVolume);
+        if (!ok)
+        {
+            ++bad;
+            continue;
+        }
+        c.trades = trades;
+
+        const long long ms = openTime >= MICROSECOND_OPEN_TIME ? openTime / 1000 : openTime;
+        const std::chrono::sys_days day{std::chrono::floor<std::chrono::days>(std::chrono::milliseconds(ms))};
+
+        out[static_cast<unsigned int>(toYYYYMMDD(std::chrono::year_month_day(day)))] = c;
+        ++rows;
+    }
+
+    return rows;
+}
+
+/**************************************************************************************
+ * Purpose : Parses an aggTrades CSV in place, like parseKlineCsv(), handing each UTC
+ *           day over as soon as the next one starts (archives are in id order, so a
+ *           day is contiguous and only one day is held at a time).
+ * Args    : csv   - CSV content.
+ *           onDay - Receives each day's trades.
+ *           bad   - Incremented for each malformed line.
+ * Return  : std::size_t - Rows parsed.
+ **************************************************************************************/
+std::size_t parseAggTradeCsv(std::string_view csv,
+                             const std::function<void(unsigned int, std::vector<AggTrade>&)>& onDay,
+                             std::size_t& bad)
+{
+    std::size_t rows = 0;
+    const char* p   = csv.data();
+    const char* end = csv.data() + csv.size();
+
+    std::vector<AggTrade> day;
+    unsigned int dayYmd = 0;
+    long long dayStartMs = 0, dayEndMs = 0;
+
+    while (p < end)
+    {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        const char* eol = nl ? nl : end;
+        const char* line = p;
+        p = nl ? nl + 1 : end;
+
+        // Header ("agg_trade_id,...") and blank lines
+        if (line == eol || !std::isdigit(static_cast<unsigned char>(*line)))
+            continue;
+
+        AggTrade t{};
+        long long firstId = 0, lastId = 0;
+
+        bool ok = parseField(line, eol, t.id)
+               && parseField(line, eol, t.price)
+               && parseField(line, eol, t.qty)
+               && parseField(line, eol, firstId)
+               && parseField(line, eol, lastId)
+               && parseField(line, eol, t.timeMs)
+               && line < eol;
+        if (ok)
+        {
+            const char flag = static_cast<char>(std::tolower(static_cast<unsigned char>(*line)));
+            ok = flag == 't' || flag == 'f';
+            t.buyerMaker = flag == 't';
+        }
+        if (!ok)
+        {
+            ++bad;
+            continue;
+        }
+
+        if (t.timeMs >= MICROSECOND_OPEN_TIME)
+            t.timeMs /= 1000;
+
+        if (t.timeMs < dayStartMs || t.timeMs >= dayEndMs)
+        {
+            if (!day.empty())
+                onDay(dayYmd, day);
+            day.clear();
+
+            const std::chrono::sys_days d{std::chrono::floor<std::chrono::days>(std::chrono::milliseconds(t.timeMs))};
+            dayYmd     = static_cast<unsigned int>(toYYYYMMDD(std::chrono::year_month_day(d)));
+            dayStartMs = std::chrono::duration_cast<std::chrono::milliseconds>(d.time_since_epoch()).count();
+            dayEndMs   = dayStartMs + 24LL * 60 * 60 * 1000;
+        }
+
+        day.push_back(t);
+        ++rows;
+    }
+
+    if (!day.empty())
+        onDay(dayYmd, day);
+
+    return rows;
+}
+
+/**************************************************************************************
+ * Purpose : Imports every aggTrades archive under `dir` into the tick store. Files are
+ *           the unit of work: each worker maps one archive, inflates it and encodes
+ *           (and writes) its days as they are parsed. Daily archives of a month whose
+ *           monthly archive is also present are skipped, so no two workers ever write
+ *           the same block.
+ * Args    : dir     - Directory scanned recursively.
+ *           threads - Worker threads (0 = hardware concurrency).
+ *           store   - Destination tick store (nullptr = encode only).
+ *           stats   - Filled with the run counters.
+ * Return  : bool - false if `dir` does not exist, nothing could be parsed or a block
+ *                  could not be written.
+ **************************************************************************************/
+bool importAggTradeDirectory(const boost::filesystem::path& dir, std::size_t threads,
+                             const TickStore* store, AggTradeImportStats& stats)
+{
+    namespace fs = boost::filesystem;
+
+    stats = AggTradeImportStats{};
+
+    if (!fs::is_directory(dir))
+    {
+        LG_ERROR("Archive directory {} does not exist", dir.string());
+        return false;
+    }
+
+    // <PAIR>-aggTrades-<YYYY>-<MM>[-<DD>] without extension → path
+    std::map<std::string, std::string> archives;
+    for (const auto& entry : fs::recursive_directory_iterator(dir))
+    {
+        if (!fs::is_regular_file(entry.status()))
+            continue;
+
+        const std::string ext = entry.path().extension().string();
+        if ((ext == ".zip" || ext == ".csv") && !pairFromAggTradesArchiveName(entry.path().filename().string()).empty())
+            archives.emplace(entry.path().stem().string(), entry.path().string());
+        else
+            ++stats.skipped;
+    }
+
+    std::vector<std::string> files;
+    for (const auto& [stem, path] : archives)
+    {
+        // <PAIR>-aggTrades-YYYY-MM-DD is covered by <PAIR>-aggTrades-YYYY-MM
+        const std::size_t period = stem.find("-aggTrades-") + 11;
+        if (stem.size() - period > 7 && archives.count(stem.substr(0, period + 7)))
+        {
+            ++stats.skipped;
+            continue;
+        }
+        files.push_back(path);
+    }
+
+    if (files.empty())
+    {
+        LG_WARN("No aggTrades archives found in {}", dir.string());
+        return false;
+    }
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    LG_INFO("Importing {} aggTrades archives on {} threads{}...", files.size(), threads,
+            store ? "" : " (dry run)");
+
+    std::mutex statsMutex;
+    std::size_t badLines = 0, failedBlocks = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+
+    forEachFileConcurrently(files, threads, [&](const std::string& file) {
+        const fs::path path(file);
+        const std::string pair = pairFromAggTradesArchiveName(path.filename().string());
+
+        std::size_t rows = 0, bytes = 0, bad = 0, blocks = 0, blockBytes = 0, failed = 0;
+
+        auto onDay = [&](unsigned int ymd, std::vector<AggTrade>& trades) {
+            std::size_t size = 0;
+            if (store)
+                size = store->write(pair, ymd, trades);
+            else
+                size = encodeTickBlock(trades).size();
+
+            if (size == 0) {
+                ++failed;
+                return;
+            }
+            ++blocks;
+            blockBytes += size;
+        };
+
+        MappedFile mapped;
+        bool ok = mapped.open(path);
+        if (ok && path.extension() == ".zip")
+        {
+            ok = forEachZipEntry(mapped.data(), [&](std::string_view name, std::string_view csv) {
+                if (name.size() >= 4 && name.substr(name.size() - 4) == ".csv")
+                {
+                    rows  += parseAggTradeCsv(csv, onDay, bad);
+                    bytes += csv.size();
+                }
+            });
+        }
+        else if (ok)
+        {
+            rows  = parseAggTradeCsv(mapped.data(), onDay, bad);
+            bytes = mapped.data().size();
+        }
+
+        if (!ok)
+            LG_ERROR("Could not read archive {}", file);
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        if (!ok) {
+            ++stats.skipped;
+            return;
+        }
+        ++stats.files;
+        stats.rows       += rows;
+        stats.bytes      += bytes;
+        stats.blocks     += blocks;
+        stats.blockBytes += blockBytes;
+        badLines         += bad;
+        failedBlocks     += failed;
+    });
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if (badLines > 0)
+        LG_WARN("{} malformed CSV lines ignored", badLines);
+    if (failedBlocks > 0)
+        LG_ERROR("{} tick blocks could not be written", failedBlocks);
+
+    LG_INFO("Imported {} trades from {} archives into {} blocks in {:.2f} s ({:.2f} M trades/s, {:.1f} MB/s of CSV)",
+            stats.rows, stats.files, stats.blocks, stats.seconds,
+            stats.seconds > 0 ? stats.rows / stats.seconds / 1e6 : 0.0,
+            stats.seconds > 0 ? stats.bytes / stats.seconds / 1e6 : 0.0);
+    LG_INFO("Compression: {:.1f} MB of CSV → {:.1f} MB of blocks (ratio {:.1f}, {:.2f} bytes/trade)",
+            stats.bytes / 1e6, stats.blockBytes / 1e6,
+            stats.blockBytes > 0 ? static_cast<double>(stats.bytes) / stats.blockBytes : 0.0,
+            stats.rows > 0 ? static_cast<double>(stats.blockBytes) / stats.rows : 0.0);
+
+    return stats.files > 0 && failedBlocks == 0;
+}
+
+/**************************************************************************************
+ * Purpose : Decompresses and parses every daily kline archive under `dir`. Each worker
+ *           maps a file, inflates it, parses it into a local map and splices the map
+ *           into `out` under a lock, so the parsers never contend while scanning.
+ * Args    : dir     - Directory scanned recursively.
+ *           threads - Parser threads (0 = hardware concurrency).
+ *           out     - Receives pair → date → OHLCV.
+ *           stats   - Filled with the run counters.
+ * Return  : bool - false if `dir` does not exist or no archive could be parsed.
+ **************************************************************************************/
+bool parseArchiveDirectory(const boost::filesystem::path& dir, std::size_t threads,
+                           OHLCVData& out, ArchiveImportStats& stats)
+{
+    namespace fs = boost::filesystem;
+
+    stats = ArchiveImportStats{};
+
+    if (!fs::is_directory(dir))
+    {
+        LG_ERROR("Archive directory {} does not exist", dir.string());
+        return false;
+    }
+
+    std::vector<std::string> files;
+    for (const auto& entry : fs::recursive_directory_iterator(dir))
+    {
+        if (!fs::is_regular_file(entry.status()))
+            continue;
+
+        const std::string ext = entry.path().extension().string();
+        if ((ext == ".zip" || ext == ".csv") && !pairFromArchiveName(entry.path().filename().string()).empty())
+            files.push_back(entry.path().string());
+        else
+            ++stats.skipped;
+    }
+    std::sort(files.begin(), files.end());
+
+    if (files.empty())
+    {
+        LG_WARN("No daily kline archives found in {}", dir.string());
+        return false;
+    }
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    LG_INFO("Parsing {} archives on {} threads...", files.size(), threads);
+
+    std::mutex outMutex;
+    const auto t0 = std::chrono::steady_clock::now();
+
+    forEachFileConcurrently(files, threads, [&](const std::string& file) {
+        const fs::path path(file);
+        const std::string pair = pairFromArchiveName(path.filename().string());
+
+        std::map<unsigned int, OHLCV> local;
+        std::size_t rows = 0, bytes = 0, bad = 0;
+
+        MappedFile mapped;
+        bool ok = mapped.open(path);
+        if (ok && path.extension() == ".zip")
+        {
+            ok = forEachZipEntry(mapped.data(), [&](std::string_view name, std::string_view csv) {
+                if (name.size() >= 4 && name.substr(name.size() - 4) == ".csv")
+                {
+                    rows  += parseKlineCsv(csv, local, bad);
+                    bytes += csv.size();
+                }
+            });
+        }
+        else if (ok)
+        {
+            rows  = parseKlineCsv(mapped.data(), local, bad);
+            bytes = mapped.data().size();
+        }
+
+        if (!ok)
+            LG_ERROR("Could not read archive {}", file);
+
+        std::lock_guard<std::mutex> lock(outMutex);
+        if (!ok) {
+            ++stats.skipped;
+            return;
+        }
+        out.data[pair].merge(local);
+        ++stats.files;
+        stats.rows  += rows;
+        stats.bytes += bytes;
+        stats.bad   += bad;
+    });
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if (stats.bad > 0)
+        LG_WARN("{} malformed CSV lines ignored", stats.bad);
+
+    LG_INFO("Parsed {} rows of {} pairs from {} archives ({:.1f} MB) in {:.2f} s ({:.2f} M rows/s)",
+            stats.rows, out.data.size(), stats.files, stats.bytes / 1e6, stats.seconds,
+            stats.seconds > 0 ? stats.rows / stats.seconds / 1e6 : 0.0);
+
+    return stats.files > 0;
+}
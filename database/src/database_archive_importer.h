@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include "data_types.h"
+
+/***********************************************
+ * Counters of one archive import run.
+ ***********************************************/
+struct ArchiveImportStats {
+    std::size_t files   = 0;        // Archives / CSV files parsed
+    std::size_t skipped = 0;        // Files ignored (not daily klines) or unreadable
+    std::size_t rows    = 0;        // Kline rows parsed
+    std::size_t bad     = 0;        // Malformed CSV lines ignored
+    std::size_t bytes   = 0;        // Uncompressed CSV bytes scanned
+    double      seconds = 0.0;      // Wall-clock time of decompression + parsing
+};
+
+/***********************************************
+ * Counters of one aggregated trades import.
+ ***********************************************/
+struct AggTradeImportStats {
+    std::size_t files      = 0;     // Archives / CSV files parsed
+    std::size_t skipped    = 0;     // Files ignored or unreadable
+    std::size_t rows       = 0;     // Trades parsed
+    std::size_t bytes      = 0;     // Uncompressed CSV bytes scanned
+    std::size_t blocks     = 0;     // Day blocks encoded
+    std::size_t blockBytes = 0;     // Encoded block bytes
+    double      seconds    = 0.0;   // Wall-clock time of decompression, parsing and encoding
+};
+
+class TickStore;
+
+/**************************************************************************************
+ * Purpose : Runs `fn(file)` for every file on `maxThreads` worker threads, the pool of
+ *           the directory imports. Workers pull the next file from a shared index as
+ *           soon as they are done, so one large archive never holds back the others.
+ *           Returns once every file has been processed.
+ * Args    : files      - Paths to process.
+ *           maxThreads - Worker threads.
+ *           fn         - Per-file work; must synchronise its own writes to shared state.
+ * Return  : void
+ **************************************************************************************/
+template<typename Fn>
+void forEachFileConcurrently(const std::vector<std::string>& files, std::size_t maxThreads, Fn&& fn)
+{
+    const std::size_t nWorkers = std::min(std::max<std::size_t>(maxThreads, 1), files.size());
+    std::atomic<std::size_t> next{0};
+
+    std::vector<std::thread> workers;
+    workers.reserve(nWorkers);
+
+    for (std::size_t w = 0; w < nWorkers; ++w)
+    {
+        workers.emplace_back([&]() {
+            for (std::size_t i = next++; i < files.size(); i = next++)
+                fn(files[i]);
+        });
+    }
+
+    for (auto& t : workers)
+        t.join();
+}
+
+/**************************************************************************************
+ * Purpose : Extracts the pair of a public-data kline archive name. Binance publishes
+ *           daily klines as <PAIR>-1d-<YYYY>-<MM>[-<DD>].zip (with the extracted .csv
+ *           alongside in some mirrors).
+ * Args    : filename - File name without directories.
+ * Return  : std::string - The pair, or empty if the file is not a daily kline archive.
+ **************************************************************************************/
+std::string pairFromArchiveName(const std::string& filename);
+
+/**************************************************************************************
+ * Purpose : Extracts the pair of an aggregated trades archive name
+ *           (<PAIR>-aggTrades-<YYYY>-<MM>[-<DD>].zip / .csv).
+ * Args    : filename - File name without directories.
+ * Return  : std::string - The pair, or empty if the file is not an aggTrades archive.
+ **************************************************************************************/
+std::string pairFromAggTradesArchiveName(const std::string& filename);
+
+/**************************************************************************************
+ * Purpose : Calls `fn(name, content)` for every file stored in a ZIP archive held in
+ *           memory. Stored and deflated entries are supported (the only methods used by
+ *           the public data archives); ZIP64 archives are not.
+ * Args    : archive - Whole archive (usually a MappedFile view).
+ *           fn      - Receives the entry name and its uncompressed content.
+ * Return  : bool - false if the archive is malformed or an entry fails to inflate.
+ **************************************************************************************/
+bool forEachZipEntry(std::string_view archive,
+                     const std::function<void(std::string_view, std::string_view)>& fn);
+
+/**************************************************************************************
+ * Purpose : Parses a kline CSV (open_time, open, high, low, close, volume, close_time,
+ *           quote_volume, count, taker_buy_volume, taker_buy_quote_volume, ignore) in
+ *           place with std::from_chars. Header lines are skipped, open times in
+ *           microseconds are accepted, and malformed lines are counted but ignored.
+ * Args    : csv  - CSV content.
+ *           out  - Receives date (YYYYMMDD) → OHLCV.
+ *           bad  - Incremented for each malformed line.
+ * Return  : std::size_t - Rows parsed.
+ **************************************************************************************/
+std::size_t parseKlineCsv(std::string_view csv, std::map<unsigned int, OHLCV>& out, std::size_t& bad);
+
+/**************************************************************************************
+ * Purpose : Parses an aggregated trades CSV (agg_trade_id, price, quantity,
+ *           first_trade_id, last_trade_id, transact_time, is_buyer_maker) with
+ *           std::from_chars. Trades are grouped by UTC day: `onDay(ymd, trades)` is
+ *           called each time the day changes and at the end, with the trades of that
+ *           day in file (id) order. Headers are skipped, times in microseconds accepted.
+ * Args    : csv   - CSV content.
+ *           onDay - Receives each day's trades (the vector may be moved from).
+ *           bad   - Incremented for each malformed line.
+ * Return  : std::size_t - Rows parsed.
+ **************************************************************************************/
+std::size_t parseAggTradeCsv(std::string_view csv,
+                             const std::function<void(unsigned int, std::vector<AggTrade>&)>& onDay,
+                             std::size_t& bad);
+
+/**************************************************************************************
+ * Purpose : Decompresses and parses every aggTrades archive under `dir` on `threads`
+ *           workers and writes one tick block per pair and day. With a null `store`
+ *           the blocks are only encoded (dry run: throughput and compression ratio).
+ * Args    : dir     - Directory scanned recursively.
+ *           threads - Worker threads (0 = hardware concurrency).
+ *           store   - Destination tick store (nullptr = encode only).
+ *           stats   - Filled with the run counters.
+ * Return  : bool - false if `dir` does not exist, nothing could be parsed or a block
+ *                  could not be written.
+ **************************************************************************************/
+bool importAggTradeDirectory(const boost::filesystem::path& dir, std::size_t threads,
+                             const TickStore* store, AggTradeImportStats& stats);
+
+/**************************************************************************************
+ * Purpose : Decompresses and parses every daily kline archive (*.zip or *.csv) under
+ *           `dir` on `threads` workers and merges the rows into `out`. Files are
+ *           memory-mapped; nothing touches the network or the database.
+ * Args    : dir     - Directory scanned recursively.
+ *           threads - Parser threads (0 = hardware concurrency).
+ *           out     - Receives pair → date → OHLCV.
+ *           stats   - Filled with the run counters.
+ * Return  : bool - false if `dir` does not exist or no archive could be parsed.
+ **************************************************************************************/
+bool parseArchiveDirectory(const boost::filesystem::path& dir, std::size_t threads,
+                           OHLCVData& out, ArchiveImportStats& stats);
@@ -1,4 +1,5 @@
 #include "database_configdata.h"
+#include <algorithm>
 #include <stdexcept>
 
 /**************************************************************************************
@@ -21,12 +22,223 @@ void DatabaseConfig::ParseConfig(const nlohmann::json& j)
         throw std::runtime_error("'main_exchange' cannot be empty");
     }
 
+    // Optional additional exchanges: distinct, and different from main_exchange
+    exchanges_.clear();
+    if (j.contains("exchanges")) {
+        if (!j["exchanges"].is_array()) {
+            throw std::runtime_error("'exchanges' must be an array of exchange names");
+        }
+        for (const auto& e : j["exchanges"]) {
+            if (!e.is_string() || e.get<std::string>().empty()) {
+                throw std::runtime_error("'exchanges' entries must be non-empty strings");
+            }
+            const std::string name = e.get<std::string>();
+            if (name == main_exchange ||
+                std::find(exchanges_.begin(), exchanges_.end(), name) != exchanges_.end()) {
+                throw std::runtime_error("'exchanges' contains '" + name + "' twice (or the main exchange)");
+            }
+            exchanges_.push_back(name);
+        }
+    }
+
+    // Optional universe policy (defaults: top 50 by quote volume, never evicted)
+    universe_ = UniversePolicy{};
+    if (j.contains("universe")) {
+        const auto& u = j["universe"];
+        if (!u.is_object()) {
+            throw std::runtime_error("'universe' must be an object");
+        }
+
+        if (u.contains("mode")) {
+            const std::string mode = u["mode"].get<std::string>();
+            if (mode != "top_n" && mode != "all") {
+                throw std::runtime_error("'universe.mode' must be 'top_n' or 'all'");
+            }
+            universe_.allSymbols = (mode == "all");
+        }
+
+        if (u.contains("top_n")) {
+            const int topN = u["top_n"].get<int>();
+            if (topN < 1) {
+                throw std::runtime_error("'universe.top_n' must be >= 1");
+            }
+            universe_.topN = static_cast<std::size_t>(topN);
+        }
+
+        if (u.contains("min_quote_volume")) {
+            universe_.minQuoteVolume = u["min_quote_volume"].get<double>();
+            if (universe_.minQuoteVolume < 0.0) {
+                throw std::runtime_error("'universe.min_quote_volume' must be >= 0");
+            }
+        }
+
+        if (u.contains("max_days_out")) {
+            universe_.maxDaysOut = u["max_days_out"].get<int>();
+            if (universe_.maxDaysOut < 0) {
+                throw std::runtime_error("'universe.max_days_out' must be >= 0");
+            }
+        }
+    }
+
     // Validate and extract database_path
     if (!j.contains("database_path") || !j["database_path"].is_string()) {
         throw std::runtime_error("'database_path' must be a valid file path string");
     }
 
     database_path_ = boost::filesystem::path(j["database_path"].get<std::string>());
+
+    // Optional HTTP cassette (record / replay of exchange responses)
+    http_cassette_ = HttpCassetteSettings{};
+    if (j.contains("http_cassette")) {
+        const auto& c = j["http_cassette"];
+        if (!c.is_object()) {
+            throw std::runtime_error("'http_cassette' must be an object");
+        }
+
+        const std::string mode = c.value("mode", "off");
+        if (mode == "record")
+            http_cassette_.mode = CassetteMode::Record;
+        else if (mode == "replay")
+            http_cassette_.mode = CassetteMode::Replay;
+        else if (mode != "off")
+            throw std::runtime_error("'http_cassette.mode' must be 'off', 'record' or 'replay'");
+
+        if (http_cassette_.mode != CassetteMode::Off) {
+            if (!c.contains("directory") || !c["directory"].is_string()) {
+                throw std::runtime_error("'http_cassette.directory' is required when recording or replaying");
+            }
+            http_cassette_.directory = boost::filesystem::path(c["directory"].get<std::string>());
+        }
+
+        if (c.contains("latency_scale")) {
+            http_cassette_.latencyScale = c["latency_scale"].get<double>();
+            if (http_cassette_.latencyScale < 0.0) {
+                throw std::runtime_error("'http_cassette.latency_scale' must be >= 0");
+            }
+        }
+    }
+
+    // Optional websocket kline stream
+    kline_stream_ = KlineStreamSettings{};
+    if (j.contains("kline_stream")) {
+        const auto& k = j["kline_stream"];
+        if (!k.is_object()) {
+            throw std::runtime_error("'kline_stream' must be an object");
+        }
+
+        kline_stream_.enabled = k.value("enabled", false);
+        kline_stream_.url     = k.value("url", std::string{});
+
+        if (k.contains("streams_per_connection")) {
+            const int streams = k["streams_per_connection"].get<int>();
+            if (streams < 1) {
+                throw std::runtime_error("'kline_stream.streams_per_connection' must be >= 1");
+            }
+            kline_stream_.streamsPerConnection = static_cast<std::size_t>(streams);
+        }
+
+        if (k.contains("flush_ms")) {
+            kline_stream_.flushMillis = k["flush_ms"].get<int>();
+            if (kline_stream_.flushMillis < 0) {
+                throw std::runtime_error("'kline_stream.flush_ms' must be >= 0");
+            }
+        }
+
+        if (k.contains("gap_repair_delay_seconds")) {
+            kline_stream_.gapRepairDelay = k["gap_repair_delay_seconds"].get<int>();
+            if (kline_stream_.gapRepairDelay < 0) {
+                throw std::runtime_error("'kline_stream.gap_repair_delay_seconds' must be >= 0");
+            }
+        }
+    }
+
+    // Optional aggregated-trade tick store
+    tick_store_ = TickStoreSettings{};
+    if (j.contains("tick_store")) {
+        const auto& t = j["tick_store"];
+        if (!t.is_object()) {
+            throw std::runtime_error("'tick_store' must be an object");
+        }
+
+        tick_store_.path           = boost::filesystem::path(t.value("path", std::string{}));
+        tick_store_.dailyAggTrades = t.value("daily_agg_trades", false);
+
+        if (tick_store_.dailyAggTrades && tick_store_.path.empty()) {
+            throw std::runtime_error("'tick_store.path' is required when 'daily_agg_trades' is enabled");
+        }
+    }
+
+    // Optional sharding of the OHLCV tables
+    sharding_ = ShardingSettings{};
+    if (j.contains("sharding")) {
+        const auto& s = j["sharding"];
+        if (!s.is_object()) {
+            throw std::runtime_error("'sharding' must be an object");
+        }
+
+        if (s.contains("scheme") &&
+            !parseShardScheme(s["scheme"].get<std::string>(), sharding_.scheme)) {
+            throw std::runtime_error("'sharding.scheme' must be 'none', 'year', 'symbol' or 'year_symbol'");
+        }
+
+        if (s.contains("symbol_buckets")) {
+            sharding_.symbolBuckets = s["symbol_buckets"].get<int>();
+            if (sharding_.symbolBuckets < 1) {
+                throw std::runtime_error("'sharding.symbol_buckets' must be >= 1");
+            }
+        }
+
+        if (s.contains("writer_threads")) {
+            sharding_.writerThreads = s["writer_threads"].get<int>();
+            if (sharding_.writerThreads < 0) {
+                throw std::runtime_error("'sharding.writer_threads' must be >= 0");
+            }
+        }
+
+        // Readers attach one year of buckets at a time: it must fit SQLite's attach limit
+        if ((sharding_.scheme == ShardScheme::Symbol || sharding_.scheme == ShardScheme::YearSymbol) &&
+            sharding_.symbolBuckets > maxAttachedShards()) {
+            throw std::runtime_error("'sharding.symbol_buckets' must be <= " + std::to_string(maxAttachedShards()) +
+                                     " (SQLite's attach limit)");
+        }
+    }
+
+    // Optional notify_sockets
+    notify_sockets_.clear();
+    if (j.contains("notify_sockets")) {
+        if (!j["notify_sockets"].is_array()) {
+            throw std::runtime_error("'notify_sockets' must be an array of socket paths");
+        }
+        notify_sockets_ = j["notify_sockets"].get<std::vector<std::string>>();
+    }
+
+    // Optional market data bus
+    market_bus_name_.clear();
+    if (j.contains("market_bus_name"))
+        market_bus_name_ = j["market_bus_name"].get<std::string>();
+
+    if (j.contains("market_bus_window_days")) {
+        market_bus_window_days_ = j["market_bus_window_days"].get<int>();
+        if (market_bus_window_days_ < 1) {
+            throw std::runtime_error("'market_bus_window_days' must be >= 1");
+        }
+    }
+
+    if (j.contains("market_bus_max_symbols")) {
+        market_bus_max_symbols_ = j["market_bus_max_symbols"].get<int>();
+        if (market_bus_max_symbols_ < 1) {
+            throw std::runtime_error("'market_bus_max_symbols' must be >= 1");
+        }
+    }
+
+    // Optional pre-midnight warm-up lead time
+    prewarm_seconds_ = 20;
+    if (j.contains("prewarm_seconds")) {
+        prewarm_seconds_ = j["prewarm_seconds"].get<int>();
+        if (prewarm_seconds_ < 0) {
+            throw std::runtime_error("'prewarm_seconds' must be >= 0");
+        }
+    }
 }
 
 
@@ -40,7 +252,18 @@ void DatabaseConfig::ParseConfig(const nlohmann::json& j)
 bool DatabaseConfig::operator==(const DatabaseConfig& other) const noexcept
 {
     return main_exchange == other.main_exchange &&
-           database_path_ == other.database_path_;
+           exchanges_ == other.exchanges_ &&
+           universe_ == other.universe_ &&
+           http_cassette_ == other.http_cassette_ &&
+           kline_stream_ == other.kline_stream_ &&
+           tick_store_ == other.tick_store_ &&
+           sharding_ == other.sharding_ &&
+           database_path_ == other.database_path_ &&
+           notify_sockets_ == other.notify_sockets_ &&
+           market_bus_name_ == other.market_bus_name_ &&
+           market_bus_window_days_ == other.market_bus_window_days_ &&
+           market_bus_max_symbols_ == other.market_bus_max_symbols_ &&
+           prewarm_seconds_ == other.prewarm_seconds_;
 }
 
 
@@ -54,6 +277,40 @@ nlohmann::json DatabaseConfig::ToJson() const
 {
     return nlohmann::json{
         {"main_exchange", main_exchange},
-        {"database_path", database_path_.string()}
+        {"exchanges", exchanges_},
+        {"universe", {
+            {"mode", universe_.allSymbols ? "all" : "top_n"},
+            {"top_n", universe_.topN},
+            {"min_quote_volume", universe_.minQuoteVolume},
+            {"max_days_out", universe_.maxDaysOut}
+        }},
+        {"http_cassette", {
+            {"mode", http_cassette_.mode == CassetteMode::Record ? "record" :
+                     http_cassette_.mode == CassetteMode::Replay ? "replay" : "off"},
+            {"directory", http_cassette_.directory.string()},
+            {"latency_scale", http_cassette_.latencyScale}
+        }},
+        {"kline_stream", {
+            {"enabled", kline_stream_.enabled},
+            {"url", kline_stream_.url},
+            {"streams_per_connection", kline_stream_.streamsPerConnection},
+            {"flush_ms", kline_stream_.flushMillis},
+            {"gap_repair_delay_seconds", kline_stream_.gapRepairDelay}
+        }},
+        {"tick_store", {
+            {"path", tick_store_.path.string()},
+            {"daily_agg_trades", tick_store_.dailyAggTrades}
+        }},
+        {"sharding", {
+            {"scheme", shardSchemeName(sharding_.scheme)},
+            {"symbol_buckets", sharding_.symbolBuckets},
+            {"writer_threads", sharding_.writerThreads}
+        }},
+        {"database_path", database_path_.string()},
+        {"notify_sockets", notify_sockets_},
+        {"market_bus_name", market_bus_name_},
+        {"market_bus_window_days", market_bus_window_days_},
+        {"market_bus_max_symbols", market_bus_max_symbols_},
+        {"prewarm_seconds", prewarm_seconds_}
     };
 }
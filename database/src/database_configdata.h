@@ -1,10 +1,66 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <nlohmann/json.hpp>
 
 #include "config_data.h"
+#include "shard_catalog.h"
+
+/***********************************************
+ * Which symbols an exchange tracks every day.
+ * Defaults reproduce the original top-50 set.
+ ***********************************************/
+struct UniversePolicy {
+    bool        allSymbols     = false;   // Track every listed symbol (topN ignored)
+    std::size_t topN           = 50;      // Top-N symbols by 24h quote volume
+    double      minQuoteVolume = 0.0;     // Minimum 24h quote volume to enter the universe
+    int         maxDaysOut     = 0;       // Days outside the universe before eviction (0 = never)
+
+    bool operator==(const UniversePolicy&) const = default;
+};
+
+/***********************************************
+ * HTTP cassette: records exchange responses to
+ * a directory, or replays them instead of the
+ * network (reproducible ingestion benchmarks).
+ ***********************************************/
+enum class CassetteMode { Off, Record, Replay };
+
+struct HttpCassetteSettings {
+    CassetteMode            mode = CassetteMode::Off;
+    boost::filesystem::path directory;                 // One file per request URL
+    double                  latencyScale = 1.0;        // Replay: recorded latency × scale (0 = none)
+
+    bool operator==(const HttpCassetteSettings&) const = default;
+};
+
+/***********************************************
+ * Websocket kline stream of the main exchange:
+ * closed candles are stored as they close, REST
+ * only repairs the gaps after midnight.
+ ***********************************************/
+struct KlineStreamSettings {
+    bool        enabled              = false;
+    std::string url;                              // Stream endpoint override (empty = exchange default)
+    std::size_t streamsPerConnection = 200;       // Streams combined on one connection
+    int         flushMillis          = 1000;      // Quiet time after the last close before storing
+    int         gapRepairDelay       = 60;        // Seconds after midnight before the REST run
+
+    bool operator==(const KlineStreamSettings&) const = default;
+};
+
+/***********************************************
+ * Compressed aggregated-trade store (one block
+ * per symbol and day, see tick_store.h).
+ ***********************************************/
+struct TickStoreSettings {
+    boost::filesystem::path path;                      // Store root (empty = disabled)
+    bool                    dailyAggTrades = false;    // Fetch yesterday's aggTrades after each daily run
+
+    bool operator==(const TickStoreSettings&) const = default;
+};
 
 /**************************************************************************************
  * Purpose : Represents the database-related configuration used by the application.
@@ -45,13 +101,86 @@ private:
     // Exchange identifier used for the database (e.g., "binance").
     std::string main_exchange = "undefined";
 
+    // Additional exchanges ingested alongside the main one, into per-exchange tables.
+    std::vector<std::string> exchanges_;
+
+    // Symbols tracked on every exchange.
+    UniversePolicy universe_;
+
+    // HTTP record/replay (optional, off by default).
+    HttpCassetteSettings http_cassette_;
+
+    // Websocket kline stream (optional, off by default).
+    KlineStreamSettings kline_stream_;
+
+    // Aggregated-trade tick store (optional, off by default).
+    TickStoreSettings tick_store_;
+
+    // Sharding of the OHLCV tables (optional, off by default).
+    ShardingSettings sharding_;
+
     // Filesystem path where the database is located.
     boost::filesystem::path database_path_;
 
+    // Unix datagram socket paths notified after each committed day (optional).
+    std::vector<std::string> notify_sockets_;
+
+    // POSIX shared memory name of the market data bus (optional, empty = disabled).
+    std::string market_bus_name_;
+
+    // Bars per symbol published on the market data bus.
+    int market_bus_window_days_ = 64;
+
+    // Maximum number of symbols the market data bus can hold.
+    int market_bus_max_symbols_ = 512;
+
+    // Seconds before UTC midnight at which connections and the universe are prepared (0 = off).
+    int prewarm_seconds_ = 20;
+
 public:
     // Returns the configured main exchange name.
     const std::string& GetMainExchange() const noexcept { return main_exchange; }
 
+    // Returns the additional exchanges (main exchange excluded).
+    const std::vector<std::string>& GetExchanges() const noexcept { return exchanges_; }
+
+    // Returns the universe policy.
+    const UniversePolicy& GetUniverse() const noexcept { return universe_; }
+
+    // Returns the HTTP cassette settings.
+    const HttpCassetteSettings& GetHttpCassette() const noexcept { return http_cassette_; }
+
+    // Returns the websocket kline stream settings.
+    const KlineStreamSettings& GetKlineStream() const noexcept { return kline_stream_; }
+
+    // Returns the tick store settings.
+    const TickStoreSettings& GetTickStore() const noexcept { return tick_store_; }
+
+    // Returns the sharding settings of the OHLCV tables.
+    const ShardingSettings& GetSharding() const noexcept { return sharding_; }
+
+    // Returns the main exchange followed by the additional ones.
+    std::vector<std::string> GetAllExchanges() const {
+        std::vector<std::string> all{main_exchange};
+        all.insert(all.end(), exchanges_.begin(), exchanges_.end());
+        return all;
+    }
+
     // Returns the filesystem path where the database resides.
     const boost::filesystem::path GetDatabasePath() const noexcept { return database_path_; }
+
+    // Returns the socket paths of the consumers notified after each commit.
+    const std::vector<std::string>& GetNotifySockets() const noexcept { return notify_sockets_; }
+
+    // Returns the market data bus shared memory name (empty = disabled).
+    const std::string& GetMarketBusName() const noexcept { return market_bus_name_; }
+
+    // Returns the number of bars per symbol kept on the market data bus.
+    int GetMarketBusWindowDays() const noexcept { return market_bus_window_days_; }
+
+    // Returns the symbol capacity of the market data bus.
+    int GetMarketBusMaxSymbols() const noexcept { return market_bus_max_symbols_; }
+
+    // Returns the pre-midnight warm-up lead time in seconds (0 = disabled).
+    int GetPrewarmSeconds() const noexcept { return prewarm_seconds_; }
 };
@@ -0,0 +1,457 @@
+#include "database_csv_io.h"
+#include "csv_scanner.h"
+#include "logger.h"
+#include "shard_catalog.h"
+#include "sqlite_connection.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <thread>
+#include <sqlite3.h>
+
+/***********************************************
+ * Column positions of the loaded file
+ * (-1 = column absent).
+ ***********************************************/
+struct CsvColumns {
+    int pair = -1, date = -1, open = -1, high = -1, low = -1, close = -1, volume = -1;
+    int quoteVolume = -1, trades = -1, takerBuyVolume = -1, takerBuyQuoteVolume = -1;
+};
+
+/***********************************************
+ * One parsed line. The pair is an index into
+ * the chunk's own pair table.
+ ***********************************************/
+struct CsvRow {
+    uint32_t     pair;
+    unsigned int date;
+    OHLCV        candle;
+};
+
+/***********************************************
+ * Output of the parse stage for one chunk.
+ ***********************************************/
+struct CsvChunkResult {
+    std::vector<std::string> pairs;
+    std::vector<CsvRow>      rows;
+    std::size_t              bad = 0;
+};
+
+/**************************************************************************************
+ * Purpose : Maps the header names to column positions.
+ * Args    : header - Header line.
+ *           cols   - Receives the positions.
+ * Return  : bool - false if a required column is missing or the header has more than
+ *           CsvRecordScanner::MAX_FIELDS columns.
+ **************************************************************************************/
+static bool parseHeader(std::string_view header, CsvColumns& cols)
+{
+    const std::pair<const char*, int*> names[] = {
+        {"pair", &cols.pair}, {"date", &cols.date},
+        {"open", &cols.open}, {"high", &cols.high}, {"low", &cols.low}, {"close", &cols.close},
+        {"volume", &cols.volume}, {"quote_volume", &cols.quoteVolume}, {"trades", &cols.trades},
+        {"taker_buy_volume", &cols.takerBuyVolume}, {"taker_buy_quote_volume", &cols.takerBuyQuoteVolume},
+    };
+
+    CsvRecordScanner scan(header);
+    if (!scan.next() || scan.overflow())
+        return false;
+
+    for (std::size_t i = 0; i < scan.size(); ++i)
+        for (const auto& [name, slot] : names)
+            if (scan[i] == name)
+                *slot = static_cast<int>(i);
+
+    for (int required : {cols.pair, cols.date, cols.open, cols.high, cols.low, cols.close, cols.volume})
+        if (required < 0)
+            return false;
+
+    return true;
+}
+
+static bool parseNumber(std::string_view field, double& value)
+{
+    auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+    return ec == std::errc{} && ptr == field.data() + field.size();
+}
+
+// Absent column or empty field = 0
+static bool parseOptional(const CsvRecordScanner& scan, int col, double& value)
+{
+    if (col < 0 || static_cast<std::size_t>(col) >= scan.size() || scan[static_cast<std::size_t>(col)].empty()) {
+        value = 0.0;
+        return true;
+    }
+    return parseNumber(scan[static_cast<std::size_t>(col)], value);
+}
+
+/**************************************************************************************
+ * Purpose : Parses a date field, YYYYMMDD or YYYY-MM-DD.
+ * Args    : field - Field text.
+ *           ymd   - Receives the date as YYYYMMDD.
+ * Return  : bool - false if the field is not a date.
+ **************************************************************************************/
+static bool parseDate(std::string_view field, unsigned int& ymd)
+{
+    auto number = [](std::string_view s, unsigned int& v) {
+        auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+        return ec == std::errc{} && ptr == s.data() + s.size();
+    };
+
+    if (field.size() == 8)
+        return number(field, ymd);
+
+    unsigned int y = 0, m = 0, d = 0;
+    if (field.size() == 10 && field[4] == '-' && field[7] == '-' &&
+        number(field.substr(0, 4), y) && number(field.substr(5, 2), m) && number(field.substr(8, 2), d))
+    {
+        ymd = y * 10000 + m * 100 + d;
+        return true;
+    }
+    return false;
+}
+
+/**************************************************************************************
+ * Purpose : Parse stage: converts one chunk (whole lines) into rows.
+ * Args    : chunk - Chunk text, owned by the task.
+ *           cols  - Column positions from the header.
+ * Return  : CsvChunkResult - Rows, pair table and malformed line count.
+ **************************************************************************************/
+static CsvChunkResult parseChunk(const std::string& chunk, const CsvColumns& cols)
+{
+    CsvChunkResult result;
+    result.rows.reserve(chunk.size() / 64);
+
+    const std::size_t needed = static_cast<std::size_t>(
+        std::max({cols.pair, cols.date, cols.open, cols.high, cols.low, cols.close, cols.volume})) + 1;
+
+    std::string_view lastPair;
+    uint32_t lastIndex = 0;
+
+    CsvRecordScanner scan(chunk);
+    while (scan.next())
+    {
+        if (scan.blank())
+            continue;
+
+        CsvRow row{};
+        OHLCV& c = row.candle;
+
+        // Lines past MAX_FIELDS fields are not rows of this file
+        const bool ok = !scan.overflow()
+                     && scan.size() >= needed
+                     && parseDate(scan[cols.date], row.date)
+                     && parseNumber(scan[cols.open],   c.open)
+                     && parseNumber(scan[cols.high],   c.high)
+                     && parseNumber(scan[cols.low],    c.low)
+                     && parseNumber(scan[cols.close],  c.close)
+                     && parseNumber(scan[cols.volume], c.volume)
+                     && parseOptional(scan, cols.quoteVolume,         c.quoteVolume)
+                     && parseOptional(scan, cols.trades,              c.trades)
+                     && parseOptional(scan, cols.takerBuyVolume,      c.takerBuyVolume)
+                     && parseOptional(scan, cols.takerBuyQuoteVolume, c.takerBuyQuoteVolume)
+                     && !scan[cols.pair].empty();
+        if (!ok)
+        {
+            ++result.bad;
+            continue;
+        }
+
+        // Files are usually grouped by pair: only look the name up when it changes
+        const std::string_view pair = scan[cols.pair];
+        if (pair != lastPair || result.pairs.empty())
+        {
+            auto it = std::find(result.pairs.begin(), result.pairs.end(), pair);
+            if (it == result.pairs.end())
+                it = result.pairs.emplace(result.pairs.end(), pair);
+            lastIndex = static_cast<uint32_t>(it - result.pairs.begin());
+            lastPair  = pair;
+        }
+
+        row.pair = lastIndex;
+        result.rows.push_back(row);
+    }
+
+    return result;
+}
+
+/**************************************************************************************
+ * Purpose : Loads an OHLCV CSV file with a pipelined reader: the calling thread reads
+ *           fixed-size chunks (cut after their last line feed) while up to `threads`
+ *           earlier chunks are parsed concurrently; results are merged in file order.
+ * Args    : path    - CSV file.
+ *           threads - Parser threads (0 = hardware concurrency).
+ *           out     - Receives pair → date → OHLCV (later rows win).
+ *           stats   - Filled with the run counters.
+ * Return  : bool - false if the file cannot be read or the header is invalid.
+ **************************************************************************************/
+bool loadOhlcvCsv(const boost::filesystem::path& path, std::size_t threads,
+                  OHLCVData& out, CsvIoStats& stats)
+{
+    stats = CsvIoStats{};
+
+    std::unique_ptr<std::FILE, int(*)(std::FILE*)> file(std::fopen(path.string().c_str(), "rb"), &std::fclose);
+    if (!file)
+    {
+        LG_ERROR("Cannot open {}: {}", path.string(), std::strerror(errno));
+        return false;
+    }
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    const auto t0 = std::chrono::steady_clock::now();
+
+    CsvColumns cols;
+    bool headerRead = false;
+    std::string carry;
+    std::deque<std::future<CsvChunkResult>> inFlight;
+
+    auto merge = [&](CsvChunkResult chunk) {
+        std::vector<std::map<unsigned int, OHLCV>*> target(chunk.pairs.size(), nullptr);
+        for (const CsvRow& row : chunk.rows)
+        {
+            auto*& days = target[row.pair];
+            if (!days)
+                days = &out.data[chunk.pairs[row.pair]];
+            days->insert_or_assign(days->end(), row.date, row.candle);
+        }
+        stats.rows += chunk.rows.size();
+        stats.bad  += chunk.bad;
+    };
+
+    auto drainOne = [&]() {
+        merge(inFlight.front().get());
+        inFlight.pop_front();
+    };
+
+    bool eof = false;
+    while (!eof)
+    {
+        // ---- Read: next chunk ending on a line boundary ----
+        std::string chunk = std::move(carry);
+        carry.clear();
+
+        const std::size_t old = chunk.size();
+        chunk.resize(old + CSV_CHUNK_BYTES);
+        const std::size_t n = std::fread(chunk.data() + old, 1, CSV_CHUNK_BYTES, file.get());
+        chunk.resize(old + n);
+        stats.bytes += n;
+
+        if (n < CSV_CHUNK_BYTES)
+        {
+            if (std::ferror(file.get()))
+            {
+                LG_ERROR("Read {} failed: {}", path.string(), std::strerror(errno));
+                while (!inFlight.empty())
+                    inFlight.pop_front();          // Futures join on destruction
+                return false;
+            }
+            eof = true;
+        }
+
+        if (!eof)
+        {
+            const std::size_t nl = chunk.rfind('\n');
+            if (nl == std::string::npos) {
+                carry = std::move(chunk);          // Line longer than a chunk: keep reading
+                continue;
+            }
+            carry.assign(chunk, nl + 1);
+            chunk.resize(nl + 1);
+        }
+
+        if (!headerRead)
+        {
+            const std::size_t nl = chunk.find('\n');
+            const std::string_view header(chunk.data(), nl == std::string::npos ? chunk.size() : nl);
+            if (!parseHeader(header, cols))
+            {
+                LG_ERROR("{}: header must name at least pair,date,open,high,low,close,volume (at most {} columns)",
+                         path.string(), CsvRecordScanner::MAX_FIELDS);
+                return false;
+            }
+            chunk.erase(0, nl == std::string::npos ? chunk.size() : nl + 1);
+            headerRead = true;
+        }
+
+        // ---- Parse: hand the chunk to a worker, merge the oldest when saturated ----
+        inFlight.push_back(std::async(std::launch::async,
+            [c = std::move(chunk), &cols]() { return parseChunk(c, cols); }));
+
+        if (inFlight.size() > threads)
+            drainOne();
+    }
+
+    while (!inFlight.empty())
+        drainOne();
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if (stats.bad > 0)
+        LG_WARN("{}: {} malformed lines ignored", path.string(), stats.bad);
+
+    LG_INFO("Loaded {} rows of {} pairs from {} ({:.1f} MB) in {:.2f} s ({:.2f} M rows/s)",
+            stats.rows, out.data.size(), path.string(), stats.bytes / 1e6, stats.seconds,
+            stats.seconds > 0 ? stats.rows / stats.seconds / 1e6 : 0.0);
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Appends a number in its shortest round-trip form.
+ **************************************************************************************/
+template<typename T>
+static void appendNumber(std::string& buf, T value)
+{
+    char tmp[32];
+    auto [ptr, ec] = std::to_chars(tmp, tmp + sizeof(tmp), value);
+    buf.append(tmp, ptr);
+}
+
+/**************************************************************************************
+ * Purpose : Dumps an OHLCV table as CSV, ordered by pair and date. The output buffer is
+ *           flushed with one fwrite every CSV_CHUNK_BYTES. A sharded table holding more
+ *           shards than SQLite attaches is read in passes of years (ShardedView), each
+ *           ordered by pair and date.
+ * Args    : databasePath - SQLite database file (opened read-only).
+ *           table        - OHLCV table to read.
+ *           path         - Output CSV file ("-" = standard output).
+ *           filter       - Pairs and date range to export.
+ *           stats        - Filled with the run counters.
+ * Return  : bool - true on success.
+ **************************************************************************************/
+bool exportOhlcvCsv(const boost::filesystem::path& databasePath, const std::string& table,
+                    const std::string& path, const CsvExportFilter& filter, CsvIoStats& stats)
+{
+    stats = CsvIoStats{};
+
+    SqliteConnection conn;
+    if (!conn.open(databasePath, SQLITE_OPEN_READONLY))
+    {
+        LG_ERROR("Cannot open database {}: {}", databasePath.string(), conn.errmsg());
+        return false;
+    }
+
+    // Sharded databases: the table is read through the shard views, in passes of years
+    ShardedView shards;
+    if (!shards.refresh(databasePath))
+        return false;
+
+    sqlite3* db = conn.handle();
+
+    std::string sql =
+        "SELECT pair, date, open, high, low, close, volume, quote_volume, trades, "
+        "taker_buy_volume, taker_buy_quote_volume FROM " + table +
+        " WHERE date BETWEEN ? AND ?";
+    if (!filter.pairs.empty())
+    {
+        sql += " AND pair IN (?";
+        for (std::size_t i = 1; i < filter.pairs.size(); ++i)
+            sql += ", ?";
+        sql += ")";
+    }
+    sql += " ORDER BY pair, date;";
+
+    const bool toStdout = (path == "-");
+    std::FILE* file = toStdout ? stdout : std::fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        LG_ERROR("Cannot open {}: {}", path, std::strerror(errno));
+        return false;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    bool ok = true;
+
+    std::string buf;
+    buf.reserve(CSV_CHUNK_BYTES + 4096);
+    buf += "pair,date,open,high,low,close,volume,quote_volume,trades,taker_buy_volume,taker_buy_quote_volume\n";
+
+    auto flush = [&]() {
+        if (!buf.empty() && std::fwrite(buf.data(), 1, buf.size(), file) != buf.size())
+        {
+            LG_ERROR("Write {} failed: {}", path, std::strerror(errno));
+            ok = false;
+        }
+        stats.bytes += buf.size();
+        buf.clear();
+    };
+
+    for (const auto& [from, to] : shards.passes(filter.pairs, filter.fromDate, filter.toDate))
+    {
+        if (!ok)
+            break;
+        if (!shards.attach(conn, filter.pairs, from, to))
+        {
+            ok = false;
+            break;
+        }
+
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+        {
+            LG_ERROR("SQLite prepare failed: {}", sqlite3_errmsg(db));
+            ok = false;
+            break;
+        }
+
+        sqlite3_bind_int(stmt, 1, from);
+        sqlite3_bind_int(stmt, 2, to);
+        for (std::size_t i = 0; i < filter.pairs.size(); ++i)
+            sqlite3_bind_text(stmt, static_cast<int>(i) + 3, filter.pairs[i].c_str(), -1, SQLITE_TRANSIENT);
+
+        int rc = SQLITE_DONE;
+        while (ok && (rc = sqlite3_step(stmt)) == SQLITE_ROW)
+        {
+            buf.append(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)),
+                       static_cast<std::size_t>(sqlite3_column_bytes(stmt, 0)));
+            buf += ',';
+            appendNumber(buf, sqlite3_column_int(stmt, 1));
+            for (int col = 2; col <= 10; ++col)
+            {
+                buf += ',';
+                if (col == 8)
+                    appendNumber(buf, sqlite3_column_int64(stmt, col));
+                else
+                    appendNumber(buf, sqlite3_column_double(stmt, col));
+            }
+            buf += '\n';
+            ++stats.rows;
+
+            if (buf.size() >= CSV_CHUNK_BYTES)
+                flush();
+        }
+
+        if (ok && rc != SQLITE_DONE)
+        {
+            LG_ERROR("Reading {} failed: {}", table, sqlite3_errmsg(db));
+            ok = false;
+        }
+
+        sqlite3_finalize(stmt);
+    }
+
+    if (ok)
+        flush();
+
+    if (toStdout)
+        std::fflush(file);
+    else if (std::fclose(file) != 0)
+        ok = false;
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if (ok)
+        LG_INFO("Exported {} rows from {} to {} ({:.1f} MB) in {:.2f} s",
+                stats.rows, table, path, stats.bytes / 1e6, stats.seconds);
+    return ok;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include "data_types.h"
+
+/***********************************************
+ * Bytes read or written per chunk by the CSV
+ * loader and dumper.
+ ***********************************************/
+static constexpr std::size_t CSV_CHUNK_BYTES = 8 << 20;
+
+/***********************************************
+ * Counters of one CSV import or export.
+ ***********************************************/
+struct CsvIoStats {
+    std::size_t rows    = 0;        // Rows parsed / written
+    std::size_t bad     = 0;        // Malformed lines ignored (import)
+    std::size_t bytes   = 0;        // CSV bytes read / written
+    double      seconds = 0.0;      // Wall-clock time of the transfer
+};
+
+/***********************************************
+ * Rows selected by an export. Empty pairs = all
+ * pairs, dates are inclusive YYYYMMDD.
+ ***********************************************/
+struct CsvExportFilter {
+    std::vector<std::string> pairs;
+    int fromDate = 0;
+    int toDate   = 99991231;
+};
+
+/**************************************************************************************
+ * Purpose : Loads an OHLCV CSV file. The first line is a header naming the columns, in
+ *           any order: pair, date (YYYYMMDD or YYYY-MM-DD), open, high, low, close,
+ *           volume are required; quote_volume, trades, taker_buy_volume and
+ *           taker_buy_quote_volume are optional; unknown columns are ignored. Lines
+ *           (header included) are limited to CsvRecordScanner::MAX_FIELDS fields;
+ *           longer rows count as malformed.
+ *
+ *           The file is read in CSV_CHUNK_BYTES chunks cut at line boundaries; chunks
+ *           are parsed on `threads` workers (CsvRecordScanner + std::from_chars) while
+ *           the next ones are read, and merged into `out` in file order.
+ *
+ * Args    : path    - CSV file.
+ *           threads - Parser threads (0 = hardware concurrency).
+ *           out     - Receives pair → date → OHLCV (later rows win).
+ *           stats   - Filled with the run counters.
+ * Return  : bool - false if the file cannot be read or the header is invalid.
+ **************************************************************************************/
+bool loadOhlcvCsv(const boost::filesystem::path& path, std::size_t threads,
+                  OHLCVData& out, CsvIoStats& stats);
+
+/**************************************************************************************
+ * Purpose : Dumps rows of an OHLCV table as CSV (header + one line per candle ordered by
+ *           pair and date). Numbers are formatted with std::to_chars (shortest form that
+ *           round-trips) into a buffer flushed every CSV_CHUNK_BYTES. Large sharded
+ *           tables are read in passes of years, the order holding within each pass.
+ *
+ * Args    : databasePath - SQLite database file (opened read-only).
+ *           table        - OHLCV table to read.
+ *           path         - Output CSV file ("-" = standard output).
+ *           filter       - Pairs and date range to export.
+ *           stats        - Filled with the run counters.
+ * Return  : bool - true on success.
+ **************************************************************************************/
+bool exportOhlcvCsv(const boost::filesystem::path& databasePath, const std::string& table,
+                    const std::string& path, const CsvExportFilter& filter, CsvIoStats& stats);
@@ -1,50 +1,140 @@
 #include "database_downloader.h"
 #include "logger.h"
+#include "market_data_reader.h"
 #include "time_utils.h"
 
 
 #include <sqlite3.h>
-#include <boost/filesystem.hpp>
-#include <nlohmann/json.hpp>
 
-using json = nlohmann::json;
+/***********************************************
+ * How long the writer connection waits for the
+ * lock of another writer (an import's bulk
+ * transaction, a shard migration) before a
+ * store fails with SQLITE_BUSY.
+ ***********************************************/
+static constexpr int WRITER_BUSY_TIMEOUT_MS = 60000;
+
+/***********************************************
+ * Columns added to ohlcv_data after its first
+ * release, migrated in place on open.
+ ***********************************************/
+static constexpr std::pair<const char*, const char*> OHLCV_EXTENDED_COLUMNS[] = {
+    {"quote_volume",           "REAL"},
+    {"trades",                 "INTEGER"},
+    {"taker_buy_volume",       "REAL"},
+    {"taker_buy_quote_volume", "REAL"},
+};
 
 /**************************************************************************************
- * Purpose : Opens (or creates) the OHLCV SQLite database and ensures that both:
- *             - tracked_pairs (JSON snapshot table)
- *             - ohlcv_data    (row-per-candle OHLCV table)
- *             - yymmdd        (the first full day of the dataset which is the day it was
- *                                  first written)
- *           exist.
- *
- * Args    : path - Filesystem path to the database file.
- * Return  : sqlite3* - Valid DB handle on success, nullptr on failure.
+ * Purpose : Checks whether `table` has `column` (false for a missing table).
+ * Args    : db     - SQLite handle.
+ *           table  - Table name.
+ *           column - Column name.
+ *           exists - Receives the answer.
+ * Return  : bool - false if the schema could not be read.
  **************************************************************************************/
-sqlite3* DatabaseDownloader::openDatabaseOHLCV(const boost::filesystem::path& path, std::string yymmdd)
+static bool hasColumn(SqliteConnection& db, const std::string& table, const std::string& column, bool& exists)
 {
-    // Ensure directory exists
-    if (!path.parent_path().empty() &&
-        !boost::filesystem::exists(path.parent_path()))
+    SqliteStatement stmt = db.prepare("PRAGMA table_info(" + table + ");");
+    if (!stmt)
     {
-        boost::filesystem::create_directories(path.parent_path());
+        LG_ERROR("Failed to read schema of {}: {}", table, db.errmsg());
+        return false;
     }
 
-    sqlite3* db = nullptr;
-    if (sqlite3_open(path.string().c_str(), &db) != SQLITE_OK)
+    exists = false;
+    while (sqlite3_step(stmt) == SQLITE_ROW)
     {
-        LG_ERROR("SQLite failed to open DB: {}", sqlite3_errmsg(db));
-        sqlite3_close(db);
-        return nullptr;
+        const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        if (name && column == name)
+        {
+            exists = true;
+            break;
+        }
     }
+    return true;
+}
 
-    // Create the 3 tables including date_of_start
-    const char* sql =
-        "CREATE TABLE IF NOT EXISTS tracked_pairs ("
-        "   date TEXT PRIMARY KEY,"
-        "   json TEXT NOT NULL"
-        ");"
+/**************************************************************************************
+ * Purpose : Adds `column` to `table` if it is missing (schema migration of databases
+ *           created by older versions). Existing rows get NULL, read back as 0.
+ * Args    : db     - SQLite handle.
+ *           table  - Table name.
+ *           column - Column name.
+ *           type   - Column type declaration.
+ * Return  : bool - true if the column exists or was added.
+ **************************************************************************************/
+static bool ensureColumn(SqliteConnection& db, const std::string& table, const std::string& column,
+                         const std::string& type)
+{
+    bool exists = false;
+    if (!hasColumn(db, table, column, exists))
+        return false;
+
+    if (exists)
+        return true;
+
+    if (!db.exec("ALTER TABLE " + table + " ADD COLUMN " + column + " " + type + ";"))
+    {
+        LG_ERROR("Migration of {}.{} failed: {}", table, column, db.errmsg());
+        return false;
+    }
+
+    LG_INFO("Migrated {}: added column {}", table, column);
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Table names of an exchange. The main exchange keeps the original names so
+ *           existing databases and consumers are unchanged.
+ * Args    : exchange - Venue identifier.
+ *           isMain   - Whether it is the configured main_exchange.
+ * Return  : ExchangeTables - Table names.
+ **************************************************************************************/
+ExchangeTables ExchangeTables::forExchange(const std::string& exchange, bool isMain)
+{
+    ExchangeTables t;
+    if (!isMain)
+    {
+        t.trackedPairs += "_" + exchange;
+        t.ohlcv        += "_" + exchange;
+        t.funding      += "_" + exchange;
+    }
+    return t;
+}
+
+/**************************************************************************************
+ * Purpose : Creates the per-exchange tables if missing:
+ *             - <trackedPairs> (one row per date and pair: days outside the universe,
+ *                               and the rank / 24h quote volume of universe pairs)
+ *             - <ohlcv>        (row-per-candle OHLCV table, migrated to the extended
+ *                               kline columns)
+ *             - <funding>      (one row per perpetual funding settlement)
+ * Args    : db     - SQLite handle.
+ *           tables - Table names of the exchange.
+ * Return  : bool - true on success.
+ **************************************************************************************/
+bool DatabaseDownloader::ensureExchangeTables(SqliteConnection& db, const ExchangeTables& tables)
+{
+    if (!migrateTrackedPairs(db, tables.trackedPairs))
+        return false;
 
-        "CREATE TABLE IF NOT EXISTS ohlcv_data ("
+    const std::string sql = fmt::format(
+        // History of the tracked set: the state of a date is its rows (date = YYYYMMDD),
+        // rank and quote_volume are NULL for pairs outside the universe that day
+        "CREATE TABLE IF NOT EXISTS {0} ("
+        "   date         INTEGER NOT NULL,"
+        "   pair         TEXT NOT NULL,"
+        "   days_out     INTEGER NOT NULL,"
+        "   rank         INTEGER,"
+        "   quote_volume REAL,"
+        "   PRIMARY KEY(date, pair)"
+        ") WITHOUT ROWID;"
+
+        // History of one pair (when it entered, left, its rank over time)
+        "CREATE INDEX IF NOT EXISTS idx_{0}_pair ON {0}(pair, date);"
+
+        "CREATE TABLE IF NOT EXISTS {1} ("
         "   pair TEXT NOT NULL,"
         "   date INTEGER NOT NULL,"
         "   open REAL,"
@@ -52,143 +142,479 @@ sqlite3* DatabaseDownloader::openDatabaseOHLCV(const boost::filesystem::path& pa
         "   low REAL,"
         "   close REAL,"
         "   volume REAL,"
+        "   quote_volume REAL,"
+        "   trades INTEGER,"
+        "   taker_buy_volume REAL,"
+        "   taker_buy_quote_volume REAL,"
         "   PRIMARY KEY(pair, date)"
         ");"
 
+        // Date lookups (latest day, new days since X) and cross-sections of one date in
+        // pair order (MarketDataReader); supersedes the former date-only index
+        "CREATE INDEX IF NOT EXISTS idx_{1}_date_pair ON {1}(date, pair);"
+        "DROP INDEX IF EXISTS idx_{1}_date;"
+
+        // Funding settlements of the perpetual contracts (fundingTime in Unix ms,
+        // date = UTC day it settles in, for per-bar accrual)
+        "CREATE TABLE IF NOT EXISTS {2} ("
+        "   pair         TEXT NOT NULL,"
+        "   funding_time INTEGER NOT NULL,"
+        "   date         INTEGER NOT NULL,"
+        "   rate         REAL NOT NULL,"
+        "   PRIMARY KEY(pair, funding_time)"
+        ");"
+
+        "CREATE INDEX IF NOT EXISTS idx_{2}_date ON {2}(date);",
+        tables.trackedPairs, tables.ohlcv, tables.funding);
+
+    if (!db.exec(sql))
+    {
+        LG_ERROR("Schema creation of {} failed: {}", tables.ohlcv, db.errmsg());
+        return false;
+    }
+
+    // Databases created before the extended kline fields were kept
+    for (const auto& [column, type] : OHLCV_EXTENDED_COLUMNS)
+    {
+        if (!ensureColumn(db, tables.ohlcv, column, type))
+            return false;
+    }
+
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Opens (or creates) the OHLCV SQLite database on the member connection and
+ *           sets its schema up, once for the lifetime of the connection:
+ *             - the tables of every configured exchange (ensureExchangeTables)
+ *             - date_of_start (the first full day of the dataset, recorded by
+ *                              recordDateOfStart)
+ *             - data_version / data_changes (commit watermark for consumers)
+ *           The file is switched to WAL and the connection waits up to
+ *           WRITER_BUSY_TIMEOUT_MS for other writers.
+ *
+ * Args    : None (database_path_)
+ * Return  : bool - true on success; the connection is left closed on failure.
+ **************************************************************************************/
+bool DatabaseDownloader::openDatabase()
+{
+    if (!db_.open(database_path_))
+    {
+        LG_ERROR("SQLite failed to open DB: {}", db_.errmsg());
+        return false;
+    }
+
+    // The service, its kline stream, the import tools and the readers (signalizer,
+    // backtests) share the file: readers never block a commit in WAL mode, and a
+    // writer waits for another writer's transaction instead of failing the store
+    db_.setBusyTimeout(WRITER_BUSY_TIMEOUT_MS);
+    if (!db_.enableWal())
+        LG_WARN("WAL unavailable on {}, rollback journal kept: commits wait for readers",
+                database_path_.string());
+
+    // Shared tables: date_of_start and the commit watermark
+    const char* sql =
         "CREATE TABLE IF NOT EXISTS date_of_start ("
         "   id TEXT PRIMARY KEY"
+        ");"
+
+        // Commit watermark: one row per committed store, consumers track the last
+        // version they processed and read only the changes after it
+        "CREATE TABLE IF NOT EXISTS data_version ("
+        "   version      INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "   target_date  INTEGER NOT NULL,"
+        "   committed_at TEXT NOT NULL"
+        ");"
+
+        "CREATE TABLE IF NOT EXISTS data_changes ("
+        "   version    INTEGER NOT NULL,"
+        "   pair       TEXT NOT NULL,"
+        "   first_date INTEGER NOT NULL,"
+        "   last_date  INTEGER NOT NULL,"
+        "   PRIMARY KEY(version, pair)"
         ");";
 
-    char* errMsg = nullptr;
-    if (sqlite3_exec(db, sql, nullptr, nullptr, &errMsg) != SQLITE_OK)
+    if (!db_.exec(sql))
     {
-        LG_ERROR("Database schema creation failed: {}", errMsg);
-        sqlite3_free(errMsg);
-        sqlite3_close(db);
-        return nullptr;
+        LG_ERROR("Database schema creation failed: {}", db_.errmsg());
+        db_.close();
+        return false;
     }
 
-    // --- Check if date_of_start table is empty ---
-    sqlite3_stmt* checkStmt = nullptr;
-    const char* checkSQL = "SELECT COUNT(*) FROM date_of_start;";
-
-    if (sqlite3_prepare_v2(db, checkSQL, -1, &checkStmt, nullptr) != SQLITE_OK)
+    std::vector<std::string> ohlcvTables;
+    for (std::size_t i = 0; i < exchanges_.size(); ++i)
     {
-        LG_ERROR("Failed to prepare COUNT query: {}", sqlite3_errmsg(db));
-        sqlite3_close(db);
-        return nullptr;
+        const ExchangeTables tables = ExchangeTables::forExchange(exchanges_[i]->name(), i == 0);
+        if (!ensureExchangeTables(db_, tables))
+        {
+            db_.close();
+            return false;
+        }
+        ohlcvTables.push_back(tables.ohlcv);
     }
 
-    bool isEmpty = false;
-    if (sqlite3_step(checkStmt) == SQLITE_ROW)
+    // Sharded candles: rows still in the main tables move to the shards, which are
+    // read back through shards_ from then on (storedBars, lastStoredDate, ...)
+    bool sharded = shards_.open(db_, database_path_, sharding_, ohlcvTables);
+    for (std::size_t i = 0; sharded && shards_.enabled() && i < ohlcvTables.size(); ++i)
+        sharded = migrateToShards(ohlcvTables[i]);
+
+    if (!sharded)
     {
-        isEmpty = (sqlite3_column_int(checkStmt, 0) == 0);
+        shards_.close();
+        db_.close();
+        return false;
     }
-    sqlite3_finalize(checkStmt);
 
-    // --- Insert only if empty ---
-    if (isEmpty)
-    {
-        sqlite3_stmt* insertStmt = nullptr;
-        const char* insertSQL = "INSERT INTO date_of_start (id) VALUES (?);";
+    LG_INFO("Database {} open", database_path_.string());
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Makes sure the member connection is open, retrying openDatabase() if the
+ *           open at construction (or a previous retry) failed.
+ * Args    : None
+ * Return  : bool - true if the database is usable.
+ **************************************************************************************/
+bool DatabaseDownloader::ensureDatabase()
+{
+    if (db_.isOpen())
+        return true;
+
+    if (openDatabase())
+        return true;
+
+    LG_ERROR("Could not open database {}", database_path_.string());
+    return false;
+}
 
-        if (sqlite3_prepare_v2(db, insertSQL, -1, &insertStmt, nullptr) == SQLITE_OK)
+/**************************************************************************************
+ * Purpose : Streams the rows of main.<table> into the shards batch by batch, then
+ *           empties the main table. The shard writes are upserts, so a migration
+ *           interrupted before the DELETE is simply redone at the next open.
+ * Args    : table - OHLCV table.
+ * Return  : bool - true on success.
+ **************************************************************************************/
+bool DatabaseDownloader::migrateToShards(const std::string& table)
+{
+    // main. explicitly: always the main table, whatever the connection attached
+    MarketDataReader reader(db_, "main." + table);
+    std::size_t rows = 0;
+    {
+        BarCursor cursor = reader.scan(BarQuery{});
+        BarColumns batch;
+        while (cursor.fill(batch) > 0)
         {
-            sqlite3_bind_text(insertStmt, 1, yymmdd.c_str(), -1, SQLITE_TRANSIENT);
+            OHLCVData data;
+            for (std::size_t row = 0; row < batch.size(); ++row)
+                data.data[batch.symbolOf(row)][static_cast<unsigned int>(batch.date[row])] = batch.bar(row);
 
-            if (sqlite3_step(insertStmt) != SQLITE_DONE)
+            if (!shards_.store(table, data))
             {
-                LG_ERROR("Insert failed for date_of_start: {}", sqlite3_errmsg(db));
+                LG_ERROR("Migration of {} into its shards failed", table);
+                return false;
             }
+            rows += batch.size();
         }
-        else
-        {
-            LG_ERROR("Prepare failed for insert: {}", sqlite3_errmsg(db));
-        }
 
-        sqlite3_finalize(insertStmt);
+        if (cursor.failed())
+            return false;
+    }
+
+    if (rows == 0)
+        return true;
+
+    if (!db_.exec("DELETE FROM main." + table + ";"))
+    {
+        LG_ERROR("Cannot empty {} after its migration: {}", table, db_.errmsg());
+        return false;
+    }
+
+    LG_INFO("Moved {} rows of {} into its shards", rows, table);
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Records `yyyymmdd` as the first day of the dataset unless date_of_start
+ *           already holds one (a single conditional INSERT, cached).
+ * Args    : db       - SQLite connection.
+ *           yyyymmdd - Day being written.
+ * Return  : void
+ **************************************************************************************/
+void DatabaseDownloader::recordDateOfStart(SqliteConnection& db, unsigned int yyyymmdd)
+{
+    CachedStatement stmt = db.cached(
+        "INSERT INTO date_of_start (id) "
+        "SELECT ? WHERE NOT EXISTS (SELECT 1 FROM date_of_start);");
+    if (!stmt)
+    {
+        LG_ERROR("Prepare failed for insert: {}", db.errmsg());
+        return;
+    }
+
+    const std::string id = std::to_string(yyyymmdd);
+    sqlite3_bind_text(stmt, 1, id.c_str(), -1, SQLITE_TRANSIENT);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE)
+        LG_ERROR("Insert failed for date_of_start: {}", db.errmsg());
+}
+
+
+/**************************************************************************************
+ * Purpose : Converts a tracked pairs table of the original layout (one row: date TEXT,
+ *           json TEXT holding pair → days out) into the relational one. The JSON is
+ *           expanded by SQLite itself (json_each) and the swap runs in one transaction,
+ *           so an interrupted migration leaves the old table untouched.
+ * Args    : db    - SQLite handle.
+ *           table - Tracked pairs table of the exchange.
+ * Return  : bool - true if nothing had to be done or the migration succeeded.
+ **************************************************************************************/
+bool DatabaseDownloader::migrateTrackedPairs(SqliteConnection& db, const std::string& table)
+{
+    bool legacy = false;
+    if (!hasColumn(db, table, "json", legacy))
+        return false;
+    if (!legacy)
+        return true;
+
+    const std::string sql = fmt::format(
+        "BEGIN IMMEDIATE;"
+        "CREATE TABLE {0}_migrated ("
+        "   date         INTEGER NOT NULL,"
+        "   pair         TEXT NOT NULL,"
+        "   days_out     INTEGER NOT NULL,"
+        "   rank         INTEGER,"
+        "   quote_volume REAL,"
+        "   PRIMARY KEY(date, pair)"
+        ") WITHOUT ROWID;"
+        "INSERT INTO {0}_migrated (date, pair, days_out, rank, quote_volume) "
+        "   SELECT CAST(REPLACE(t.date, '-', '') AS INTEGER), j.key, j.value, NULL, NULL"
+        "   FROM {0} t, json_each(t.json) j;"
+        "DROP TABLE {0};"
+        "ALTER TABLE {0}_migrated RENAME TO {0};"
+        "COMMIT;",
+        table);
+
+    if (!db.exec(sql))
+    {
+        LG_ERROR("Migration of {} failed: {}", table, db.errmsg());
+        db.exec("ROLLBACK;");
+        return false;
     }
 
-    return db;
+    LG_INFO("Migrated {}: JSON snapshot row → one row per pair", table);
+    return true;
+}
+
+/***********************************************
+ * Statements of storeTrackedPairs (the keys of
+ * their cached statements).
+ ***********************************************/
+static std::string trackedRowsSql(const std::string& table)
+{
+    return "SELECT pair, days_out, rank, quote_volume FROM " + table + " WHERE date = ?;";
+}
+
+static std::string trackedUpsertSql(const std::string& table)
+{
+    return "INSERT INTO " + table + " (date, pair, days_out, rank, quote_volume) VALUES (?, ?, ?, ?, ?) "
+           "ON CONFLICT(date, pair) DO UPDATE SET "
+           "   days_out     = excluded.days_out,"
+           "   rank         = excluded.rank,"
+           "   quote_volume = excluded.quote_volume;";
 }
 
+static std::string trackedDeleteSql(const std::string& table)
+{
+    return "DELETE FROM " + table + " WHERE date = ? AND pair = ?;";
+}
 
 /**************************************************************************************
- * Purpose : Stores new tracked pairs, replacing the single row in tracked_pairs.
+ * Purpose : Stores the tracked pairs of data.date. The rows already stored for that
+ *           date are read first and only the difference is written, in a single
+ *           transaction: new pairs are inserted, changed ones updated, pairs gone since
+ *           (evicted) deleted. Storing a new date therefore inserts its rows and never
+ *           rewrites the history.
  *
- * Args    : db   - SQLite handle.
- *           data - TrackedData to persist.
+ * Args    : db    - SQLite handle.
+ *           table - Tracked pairs table of the exchange.
+ *           data  - TrackedData to persist.
  *
  * Return  : bool - true on success, false otherwise.
  **************************************************************************************/
-bool DatabaseDownloader::storeTrackedPairs(sqlite3* db, const TrackedData& data)
+bool DatabaseDownloader::storeTrackedPairs(SqliteConnection& db, const std::string& table, const TrackedData& data)
 {
-    if (!db) return false;
+    if (!db.isOpen()) return false;
 
-    // Clear old row (tracked_pairs only has ONE row)
-    const char* del = "DELETE FROM tracked_pairs;";
-    char* errMsg = nullptr;
+    const int ymd = toYYYYMMDD(data.date);
 
-    if (sqlite3_exec(db, del, nullptr, nullptr, &errMsg) != SQLITE_OK)
+    // Rows stored for this date (a re-run of the same day)
+    struct StoredRow { int daysOut; bool ranked; int rank; double quoteVolume; };
+    std::map<std::string, StoredRow> stored;
     {
-        LG_ERROR("Delete failed: {}", errMsg);
-        sqlite3_free(errMsg);
-        return false;
-    }
+        CachedStatement stmt = db.cached(trackedRowsSql(table));
+        if (!stmt)
+        {
+            LG_ERROR("SQLite prepare failed: {}", db.errmsg());
+            return false;
+        }
+        sqlite3_bind_int(stmt, 1, ymd);
 
-    const char* insert_sql =
-        "INSERT INTO tracked_pairs (date, json) VALUES (?, ?);";
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            const char* pair = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            if (!pair)
+                continue;
+            stored[pair] = StoredRow{sqlite3_column_int(stmt, 1),
+                                     sqlite3_column_type(stmt, 2) != SQLITE_NULL,
+                                     sqlite3_column_int(stmt, 2),
+                                     sqlite3_column_double(stmt, 3)};
+        }
+    }
 
-    sqlite3_stmt* stmt = nullptr;
+    SqliteTransaction tx(db);
+    if (!tx.active())
+    {
+        LG_ERROR("BEGIN failed: {}", tx.error());
+        return false;
+    }
 
-    if (sqlite3_prepare_v2(db, insert_sql, -1, &stmt, nullptr) != SQLITE_OK)
+    CachedStatement upsert = db.cached(trackedUpsertSql(table));
+    CachedStatement remove = db.cached(trackedDeleteSql(table));
+    if (!upsert || !remove)
     {
-        LG_ERROR("SQLite prepare failed: {}", sqlite3_errmsg(db));
+        LG_ERROR("SQLite prepare failed: {}", db.errmsg());
         return false;
     }
 
-    // --- Format date as YYYY-MM-DD ---
-    std::string date_str = formatYMD(data.date);
+    std::size_t written = 0, deleted = 0;
+
+    for (const auto& [pair, daysOut] : data.trackedPairs)
+    {
+        const auto ranked = data.universe.find(pair);
+        const bool inUniverse = ranked != data.universe.end();
+
+        const auto old = stored.find(pair);
+        if (old != stored.end() &&
+            old->second.daysOut == daysOut &&
+            old->second.ranked == inUniverse &&
+            (!inUniverse || (old->second.rank == ranked->second.rank &&
+                             old->second.quoteVolume == ranked->second.quoteVolume)))
+            continue;                              // Unchanged
+
+        sqlite3_reset(upsert);
+        sqlite3_bind_int(upsert, 1, ymd);
+        sqlite3_bind_text(upsert, 2, pair.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(upsert, 3, daysOut);
+        if (inUniverse) {
+            sqlite3_bind_int(upsert, 4, ranked->second.rank);
+            sqlite3_bind_double(upsert, 5, ranked->second.quoteVolume);
+        } else {
+            sqlite3_bind_null(upsert, 4);
+            sqlite3_bind_null(upsert, 5);
+        }
 
+        if (sqlite3_step(upsert) != SQLITE_DONE)
+        {
+            LG_ERROR("SQLite upsert failed for {}: {}", pair, db.errmsg());
+            return false;
+        }
+        ++written;
+    }
 
-    // --- Build JSON object ---
-    json j = json::object();
-    for (auto& [pair, days] : data.trackedPairs)
-        j[pair] = days;
+    for (const auto& [pair, _] : stored)
+    {
+        if (data.trackedPairs.contains(pair))
+            continue;
 
-    std::string json_str = j.dump();
+        sqlite3_reset(remove);
+        sqlite3_bind_int(remove, 1, ymd);
+        sqlite3_bind_text(remove, 2, pair.c_str(), -1, SQLITE_TRANSIENT);
 
-    sqlite3_bind_text(stmt, 1, date_str.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, json_str.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(remove) != SQLITE_DONE)
+        {
+            LG_ERROR("SQLite delete failed for {}: {}", pair, db.errmsg());
+            return false;
+        }
+        ++deleted;
+    }
 
-    if (sqlite3_step(stmt) != SQLITE_DONE)
+    if (!tx.commit())
     {
-        LG_ERROR("SQLite insert failed: {}", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        LG_ERROR("COMMIT failed: {}", tx.error());
         return false;
     }
 
-    sqlite3_finalize(stmt);
+    LG_INFO("Stored {} for {}: {} rows written, {} deleted, {} unchanged",
+            table, formatYMD(data.date), written, deleted, data.trackedPairs.size() - written);
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Compiles the statements the daily sync of one exchange starts with, and
+ *           reads the pages they touch: the latest tracked pairs, the last stored date
+ *           of each of them, and the tracked pairs diff/upsert/delete and candle upsert
+ *           (main database only; shard statements are compiled by the shard writers).
+ *           Statements stay in db's cache, so the run after midnight reuses them.
+ * Args    : db     - SQLite connection (must be open).
+ *           tables - Tables of the exchange.
+ * Return  : bool - false if a statement could not be compiled (already logged).
+ **************************************************************************************/
+bool DatabaseDownloader::primeStatements(SqliteConnection& db, const ExchangeTables& tables)
+{
+    if (!db.isOpen()) return false;
+
+    const TrackedData tracked = getTrackedPairs(db, tables.trackedPairs);
+    for (const auto& [pair, _] : tracked.trackedPairs)
+        lastStoredDate(db, tables.ohlcv, pair);
+
+    std::vector<std::string> statements = {
+        trackedRowsSql(tables.trackedPairs),
+        trackedUpsertSql(tables.trackedPairs),
+        trackedDeleteSql(tables.trackedPairs)
+    };
+    if (!shards_.enabled())
+        statements.push_back(candleUpsertSql(tables.ohlcv));
 
-    LG_INFO("Stored tracked_pairs for {}", date_str);
+    for (const auto& sql : statements)
+    {
+        if (!db.cached(sql))
+        {
+            LG_ERROR("SQLite prepare failed: {}", db.errmsg());
+            return false;
+        }
+    }
+
+    LG_DEBUG("Statements of {} / {} primed ({} tracked pairs)",
+             tables.trackedPairs, tables.ohlcv, tracked.trackedPairs.size());
     return true;
 }
 
 /**************************************************************************************
- * Purpose : Stores OHLCV daily candles into the `ohlcv_data` table. Each candle is
+ * Purpose : Stores OHLCV daily candles into an exchange's OHLCV table. Each candle is
  *           stored as one row identified by (pair, date). Uses an UPSERT so calling
  *           this multiple times for the same (pair, date) will overwrite previous
- *           values safely.
+ *           values safely. All rows are written in a single transaction so readers
+ *           (e.g. the signalizer) never observe a partially stored day. The same
+ *           transaction records a data_version watermark and the pairs/dates changed
+ *           (main exchange only). On a sharded database the candles are written by
+ *           ShardedCandleStore (atomic per shard) and the watermark is committed after.
  *
- * Args    : db   - SQLite handle (must be valid).
- *           data - OHLCVData containing pair → date → OHLCV.
+ * Args    : db         - SQLite connection (must be open).
+ *           table      - OHLCV table of the exchange.
+ *           data       - OHLCVData containing pair → date → OHLCV.
+ *           targetDate - Date of the download the data belongs to.
+ *           committed  - Filled with the watermark version and changed ranges
+ *                        (nullptr = no watermark).
  *
  * Return  : bool - true on success, false on failure.
  **************************************************************************************/
-bool DatabaseDownloader::storeDataOHLCV(sqlite3* db, const OHLCVData& data)
+bool DatabaseDownloader::storeDataOHLCV(SqliteConnection& db, const std::string& table, const OHLCVData& data,
+                                        std::chrono::year_month_day targetDate,
+                                        DayCommitted* committed)
 {
-    LG_INFO("Storing data ohlcv...");
-    if (!db) return false;
+    LG_INFO("Storing data ohlcv into {}...", table);
+    if (!db.isOpen()) return false;
 
     // If there's nothing to store, don't treat it as an error.
     if (data.data.empty()) {
@@ -196,214 +622,266 @@ bool DatabaseDownloader::storeDataOHLCV(sqlite3* db, const OHLCVData& data)
         return true;
     }
 
-    const char* sql =
-        "INSERT INTO ohlcv_data (pair, date, open, high, low, close, volume) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?) "
-        "ON CONFLICT(pair, date) DO UPDATE SET "
-        "open   = excluded.open, "
-        "high   = excluded.high, "
-        "low    = excluded.low, "
-        "close  = excluded.close, "
-        "volume = excluded.volume;";
+    // Sharded: the candles go to their shards (one transaction per shard), and the
+    // catalog listing them is saved before the watermark announces them
+    if (shards_.enabled() && !shards_.store(table, data))
+        return false;
+
+    SqliteTransaction tx(db);
+    if (!tx.active())
+    {
+        LG_ERROR("Begin transaction failed: {}", tx.error());
+        return false;
+    }
+
+    if (!shards_.enabled() && !writeCandles(db, table, data))
+        return false;
 
-    sqlite3_stmt* stmt = nullptr;
+    if (committed && !recordDataVersion(db, data, targetDate, *committed))
+        return false;
 
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    if (!tx.commit())
     {
-        LG_ERROR("SQLite prepare failed: {}", sqlite3_errmsg(db));
+        LG_ERROR("Commit failed: {}", tx.error());
         return false;
     }
 
-    // Iterate over all pairs and their daily candles
-    for (const auto& [pair, dailyMap] : data.data)
+    LG_INFO("Successfully stored OHLCV candles (pairs: {}).",
+                 data.data.size());
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Stores funding events into an exchange's funding table. Each settlement is
+ *           one row identified by (pair, funding_time); re-fetched windows overwrite the
+ *           previous values. All rows are written in a single transaction.
+ *
+ * Args    : db    - SQLite connection (must be open).
+ *           table - Funding table of the exchange.
+ *           data  - FundingRateData containing pair → fundingTime (ms) → rate.
+ *
+ * Return  : bool - true on success, false on failure.
+ **************************************************************************************/
+bool DatabaseDownloader::storeFundingRates(SqliteConnection& db, const std::string& table, const FundingRateData& data)
+{
+    LG_INFO("Storing funding rates into {}...", table);
+    if (!db.isOpen()) return false;
+
+    if (data.data.empty()) {
+        LG_WARN("No funding rates to store.");
+        return true;
+    }
+
+    SqliteTransaction tx(db);
+    if (!tx.active())
+    {
+        LG_ERROR("Begin transaction failed: {}", tx.error());
+        return false;
+    }
+
+    std::size_t nRows = 0;
     {
-        for (const auto& [yyyymmdd, candle] : dailyMap)
+        CachedStatement stmt = db.cached(
+            "INSERT INTO " + table + " (pair, funding_time, date, rate) "
+            "VALUES (?, ?, ?, ?) "
+            "ON CONFLICT(pair, funding_time) DO UPDATE SET "
+            "date = excluded.date, "
+            "rate = excluded.rate;");
+        if (!stmt)
+        {
+            LG_ERROR("SQLite prepare failed: {}", db.errmsg());
+            return false;
+        }
+
+        for (const auto& [pair, events] : data.data)
         {
-            // Bind parameters: pair, date, open, high, low, close, volume
-            sqlite3_bind_text(stmt, 1, pair.c_str(), -1, SQLITE_TRANSIENT);
-            sqlite3_bind_int(stmt, 2, yyyymmdd);
-            sqlite3_bind_double(stmt, 3, candle.open);
-            sqlite3_bind_double(stmt, 4, candle.high);
-            sqlite3_bind_double(stmt, 5, candle.low);
-            sqlite3_bind_double(stmt, 6, candle.close);
-            sqlite3_bind_double(stmt, 7, candle.volume);
-
-            if (sqlite3_step(stmt) != SQLITE_DONE)
+            for (const auto& [fundingTime, rate] : events)
             {
-                LG_ERROR("Insert failed: {}", sqlite3_errmsg(db));
-                sqlite3_finalize(stmt);
-                return false;
+                auto day = std::chrono::floor<std::chrono::days>(
+                    std::chrono::system_clock::time_point(std::chrono::milliseconds(fundingTime)));
+
+                sqlite3_bind_text(stmt, 1, pair.c_str(), -1, SQLITE_TRANSIENT);
+                sqlite3_bind_int64(stmt, 2, fundingTime);
+                sqlite3_bind_int(stmt, 3, toYYYYMMDD(std::chrono::year_month_day(day)));
+                sqlite3_bind_double(stmt, 4, rate);
+
+                if (sqlite3_step(stmt) != SQLITE_DONE)
+                {
+                    LG_ERROR("Funding insert failed: {}", db.errmsg());
+                    return false;
+                }
+
+                sqlite3_reset(stmt);
+                ++nRows;
             }
-
-            // Reset statement for next row
-            sqlite3_reset(stmt);
-            sqlite3_clear_bindings(stmt);
         }
     }
 
-    sqlite3_finalize(stmt);
+    if (!tx.commit())
+    {
+        LG_ERROR("Commit failed: {}", tx.error());
+        return false;
+    }
 
-    LG_INFO("Successfully stored OHLCV candles (pairs: {}).",
-                 data.data.size());
+    LG_INFO("Successfully stored {} funding events (pairs: {}).", nRows, data.data.size());
     return true;
 }
 
 /**************************************************************************************
- * Purpose : Prints all OHLCV rows stored for the latest date available in the 
- *           `ohlcv_data` table. This is intended for debugging and verification that 
- *           the daily fetch and storage operations are working correctly.
+ * Purpose : Inserts a new data_version row and one data_changes row per pair with the
+ *           range of dates written. Must run inside the storeDataOHLCV transaction so
+ *           the watermark becomes visible atomically with the candles.
  *
- * Args    : db - Valid SQLite database handle.
+ * Args    : db         - SQLite connection (transaction already open).
+ *           data       - OHLCVData being stored.
+ *           targetDate - Date of the download the data belongs to.
+ *           committed  - Filled with the new version and changed ranges.
  *
- * Return  : void
+ * Return  : bool - true on success, false on failure.
  **************************************************************************************/
-void DatabaseDownloader::printLatestOHLCV(sqlite3* db)
+bool DatabaseDownloader::recordDataVersion(SqliteConnection& db, const OHLCVData& data,
+                                           std::chrono::year_month_day targetDate,
+                                           DayCommitted& committed)
 {
-    if (!db) {
-        LG_ERROR("DB is null");
-        return;
-    }
+    committed = DayCommitted{};
+    committed.date = toYYYYMMDD(targetDate);
 
-    // ------------------------------------------------------------
-    // 1) Find the latest date stored
-    // ------------------------------------------------------------
-    const char* query_last_date =
-        "SELECT MAX(date) FROM ohlcv_data;";
+    {
+        CachedStatement stmt = db.cached(
+            "INSERT INTO data_version (target_date, committed_at) "
+            "VALUES (?, strftime('%Y-%m-%d %H:%M:%f', 'now'));");
+        if (!stmt)
+        {
+            LG_ERROR("SQLite prepare failed: {}", db.errmsg());
+            return false;
+        }
+
+        sqlite3_bind_int(stmt, 1, committed.date);
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+        {
+            LG_ERROR("Insert data_version failed: {}", db.errmsg());
+            return false;
+        }
+    }
 
-    sqlite3_stmt* stmt = nullptr;
+    committed.version = sqlite3_last_insert_rowid(db.handle());
 
-    if (sqlite3_prepare_v2(db, query_last_date, -1, &stmt, nullptr) != SQLITE_OK)
+    CachedStatement stmt = db.cached(
+        "INSERT INTO data_changes (version, pair, first_date, last_date) "
+        "VALUES (?, ?, ?, ?);");
+    if (!stmt)
     {
-        LG_ERROR("Prepare failed: {}", sqlite3_errmsg(db));
-        return;
+        LG_ERROR("SQLite prepare failed: {}", db.errmsg());
+        return false;
     }
 
-    int rc = sqlite3_step(stmt);
-    if (rc != SQLITE_ROW)
+    for (const auto& [pair, dailyMap] : data.data)
     {
-        LG_WARN("No OHLCV rows found");
-        sqlite3_finalize(stmt);
-        return;
+        if (dailyMap.empty())
+            continue;
+
+        ChangedRange range{pair,
+                           static_cast<int>(dailyMap.begin()->first),
+                           static_cast<int>(dailyMap.rbegin()->first)};
+
+        sqlite3_bind_int64(stmt, 1, committed.version);
+        sqlite3_bind_text(stmt, 2, range.pair.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 3, range.firstDate);
+        sqlite3_bind_int(stmt, 4, range.lastDate);
+
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+        {
+            LG_ERROR("Insert data_changes failed: {}", db.errmsg());
+            return false;
+        }
+
+        sqlite3_reset(stmt);
+
+        committed.changes.push_back(std::move(range));
     }
 
-    int latestDate = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
+    return true;
+}
 
-    if (latestDate == 0) {
-        LG_WARN("Table empty (MAX(date)=0)");
+/**************************************************************************************
+ * Purpose : Prints all OHLCV rows stored for the latest date available in the 
+ *           `ohlcv_data` table. This is intended for debugging and verification that 
+ *           the daily fetch and storage operations are working correctly.
+ *
+ * Args    : db - Valid SQLite database handle.
+ *
+ * Return  : void
+ **************************************************************************************/
+void DatabaseDownloader::printLatestOHLCV(SqliteConnection& db)
+{
+    if (!db.isOpen()) {
+        LG_ERROR("DB is null");
         return;
     }
 
-    LG_INFO("=== OHLCV DATA FOR LATEST DATE: {} ===", latestDate);
+    const ExchangeTables tables;           // Main exchange
 
     // ------------------------------------------------------------
-    // 2) Query all candles for that date
+    // 1) Find the latest date stored
     // ------------------------------------------------------------
-    const char* query_rows =
-        "SELECT pair, open, high, low, close, volume "
-        "FROM ohlcv_data WHERE date = ? "
-        "ORDER BY pair ASC;";
-
-    if (sqlite3_prepare_v2(db, query_rows, -1, &stmt, nullptr) != SQLITE_OK)
-    {
-        LG_ERROR("Prepare rows failed: {}", sqlite3_errmsg(db));
+    const int latestDate = latestStoredDate(db, tables.ohlcv);
+    if (latestDate == 0) {
+        LG_WARN("No OHLCV rows found");
         return;
     }
 
-    sqlite3_bind_int(stmt, 1, latestDate);
+    LG_INFO("=== OHLCV DATA FOR LATEST DATE: {} ===", latestDate);
 
     // ------------------------------------------------------------
-    // 3) Iterate results and print
+    // 2) Print all candles of that date
     // ------------------------------------------------------------
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    const BarColumns bars = storedBars(db, tables.ohlcv, {}, latestDate, latestDate);
+    for (std::size_t i = 0; i < bars.size(); ++i)
     {
-        const char* pair_c = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        double open   = sqlite3_column_double(stmt, 1);
-        double high   = sqlite3_column_double(stmt, 2);
-        double low    = sqlite3_column_double(stmt, 3);
-        double close  = sqlite3_column_double(stmt, 4);
-        double volume = sqlite3_column_double(stmt, 5);
-
-        if (!pair_c) continue;
-
-        std::string pair(pair_c);
-
         LG_INFO(
             "Pair {:<10} | O:{:.4f} H:{:.4f} L:{:.4f} C:{:.4f} V:{:.4f}",
-            pair, open, high, low, close, volume
+            bars.symbolOf(i), bars.open[i], bars.high[i], bars.low[i], bars.close[i], bars.volume[i]
         );
     }
 
-    if (rc != SQLITE_DONE)
-        LG_ERROR("Step error: {}", sqlite3_errmsg(db));
-
-    sqlite3_finalize(stmt);
-
     LG_INFO("=============================================");
 }
 
 
 /**************************************************************************************
- * Purpose : Prints the content of tracked_pairs for diagnostic and debugging purposes.
+ * Purpose : Prints the latest tracked pairs of the main exchange for diagnostic and
+ *           debugging purposes.
  * Args    : db - Valid SQLite handle.
  * Return  : void
  **************************************************************************************/
-void DatabaseDownloader::printTrackedData(sqlite3* db)
+void DatabaseDownloader::printTrackedData(SqliteConnection& db)
 {
-    if (!db) {
+    if (!db.isOpen()) {
         LG_ERROR("DB handle is null");
         return;
     }
 
-    const char* sql = "SELECT date, json FROM tracked_pairs LIMIT 1;";
-
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    const TrackedData tracked = getTrackedPairs(db, ExchangeTables{}.trackedPairs);
+    if (tracked.date == EMPTY_DATE)
     {
-        LG_ERROR("SQLite prepare failed: {}", sqlite3_errmsg(db));
+        LG_WARN("No tracked_pairs rows found");
         return;
     }
 
-    int rc = sqlite3_step(stmt);
-
-    if (rc == SQLITE_ROW)
-    {
-        const char* date_c = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        const char* json_c = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-
-        if (!date_c || !json_c)
-        {
-            LG_WARN("No valid row found");
-            sqlite3_finalize(stmt);
-            return;
-        }
-
-        std::string date_str = date_c;
-        std::string json_str = json_c;
+    LG_INFO("=== TRACKED DATA ===");
+    LG_INFO("Date: {}", formatYMD(tracked.date));
 
-        LG_INFO("=== TRACKED DATA ===");
-        LG_INFO("Date: {}", date_str);
-
-        try {
-            json j = json::parse(json_str);
-
-            for (auto it = j.begin(); it != j.end(); ++it)
-            {
-                LG_INFO("Pair: {:<12} | Days out: {}", it.key(), it.value().get<unsigned>());
-            }
-        }
-        catch (const std::exception& e) {
-            LG_ERROR("Failed to parse JSON: {}", e.what());
-        }
-
-        LG_INFO("=======================");
-    }
-    else
+    for (const auto& [pair, daysOut] : tracked.trackedPairs)
     {
-        LG_WARN("No tracked_pairs rows found");
+        const auto ranked = tracked.universe.find(pair);
+        if (ranked != tracked.universe.end())
+            LG_INFO("Pair: {:<12} | Days out: {} | Rank: {:>3} | Quote volume: {:.0f}",
+                    pair, daysOut, ranked->second.rank, ranked->second.quoteVolume);
+        else
+            LG_INFO("Pair: {:<12} | Days out: {}", pair, daysOut);
     }
 
-    sqlite3_finalize(stmt);
+    LG_INFO("=======================");
 }
 
 /**************************************************************************************
@@ -412,79 +890,40 @@ void DatabaseDownloader::printTrackedData(sqlite3* db)
  * Args    : db - Valid SQLite handle.
  * Return  : void
  **************************************************************************************/
-void DatabaseDownloader::printLatestBTCUSDT(sqlite3* db)
+void DatabaseDownloader::printLatestBTCUSDT(SqliteConnection& db)
 {
-    if (!db) {
+    if (!db.isOpen()) {
         LG_ERROR("DB handle is null");
         return;
     }
 
+    const ExchangeTables tables;           // Main exchange
+
     // ------------------------------------------------------------
     // 1) Get the actual latest date stored in ohlcv_data
     // ------------------------------------------------------------
-    const char* q_latest =
-        "SELECT MAX(date) FROM ohlcv_data;";
-
-    sqlite3_stmt* stmt = nullptr;
-
-    if (sqlite3_prepare_v2(db, q_latest, -1, &stmt, nullptr) != SQLITE_OK)
-    {
-        LG_ERROR("Prepare MAX(date) failed: {}", sqlite3_errmsg(db));
-        return;
-    }
-
-    int rc = sqlite3_step(stmt);
-    if (rc != SQLITE_ROW) {
-        LG_WARN("No OHLCV rows found");
-        sqlite3_finalize(stmt);
-        return;
-    }
-
-    int latestDate = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
-
+    const int latestDate = latestStoredDate(db, tables.ohlcv);
     if (latestDate == 0) {
-        LG_WARN("Table empty (MAX(date)=0)");
+        LG_WARN("No OHLCV rows found");
         return;
     }
 
     LG_INFO("=== BTCUSDT OHLCV FOR STORED DATE {} ===", latestDate);
 
     // ------------------------------------------------------------
-    // 2) Query only BTCUSDT for that stored date
+    // 2) Read only BTCUSDT for that stored date
     // ------------------------------------------------------------
-    const char* q_rows =
-        "SELECT open, high, low, close, volume "
-        "FROM ohlcv_data "
-        "WHERE pair = 'BTCUSDT' AND date = ?;";
-
-    if (sqlite3_prepare_v2(db, q_rows, -1, &stmt, nullptr) != SQLITE_OK)
+    const BarColumns bars = storedBars(db, tables.ohlcv, {"BTCUSDT"}, latestDate, latestDate);
+    if (!bars.empty())
     {
-        LG_ERROR("Prepare rows failed: {}", sqlite3_errmsg(db));
-        return;
-    }
-
-    sqlite3_bind_int(stmt, 1, latestDate);
-
-    rc = sqlite3_step(stmt);
-
-    if (rc == SQLITE_ROW)
-    {
-        double open   = sqlite3_column_double(stmt, 0);
-        double high   = sqlite3_column_double(stmt, 1);
-        double low    = sqlite3_column_double(stmt, 2);
-        double close  = sqlite3_column_double(stmt, 3);
-        double volume = sqlite3_column_double(stmt, 4);
-
         LG_INFO("BTCUSDT | O:{:.4f} H:{:.4f} L:{:.4f} C:{:.4f} V:{:.4f}",
-                     open, high, low, close, volume);
+                     bars.open[0], bars.high[0], bars.low[0], bars.close[0], bars.volume[0]);
     }
     else
     {
         LG_WARN("No BTCUSDT row found for stored date {}", latestDate);
     }
 
-    sqlite3_finalize(stmt);
     LG_INFO("=============================================");
 }
 
@@ -498,44 +937,31 @@ void DatabaseDownloader::printLatestBTCUSDT(sqlite3* db)
  *              - If last date is > 100 days before current date → return 100
  *              - Otherwise: return (currentYMD - lastStoredYMD)
  *
- * Args    : db          - opened SQLite database.
+ * Args    : db          - open SQLite connection.
+ *           table       - OHLCV table of the exchange.
  *           tracked     - TrackedData (contains the map<pair → days_out>).
  *           currentYMD  - current date (year_month_day) to compare against.
  *
  * Return  : std::map<std::string,int> → map of pair → day difference.
  **************************************************************************************/
 std::map<std::string,int> DatabaseDownloader::computeDaysSinceLastStoredOHLCV(
-    sqlite3* db,
+    SqliteConnection& db,
+    const std::string& table,
     const TrackedData& tracked,
     std::chrono::year_month_day currentDate
 ){
     std::map<std::string,int> result;
 
-    if (!db) {
+    if (!db.isOpen()) {
         LG_ERROR("DB is null");
         return result;
     }
 
-    const char* sql =
-        "SELECT MAX(date) FROM ohlcv_data WHERE pair = ?;";
-
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
-        LG_ERROR("Prepare failed: {}",
-                      sqlite3_errmsg(db));
-        return result;
-    }
-
     int currentYMD = toYYYYMMDD(currentDate);
 
     for (const auto& [pair, _] : tracked.trackedPairs)
     {
-        sqlite3_reset(stmt);
-        sqlite3_clear_bindings(stmt);
-        sqlite3_bind_text(stmt, 1, pair.c_str(), -1, SQLITE_TRANSIENT);
-
-        int rc = sqlite3_step(stmt);
-        int lastYMD = (rc == SQLITE_ROW) ? sqlite3_column_int(stmt, 0) : 0;
+        int lastYMD = lastStoredDate(db, table, pair);
 
         // --------------------------------------------------------------------
         // CASE 1 — never stored → need full fetch
@@ -568,6 +994,29 @@ std::map<std::string,int> DatabaseDownloader::computeDaysSinceLastStoredOHLCV(
                      pair, lastYMD, diff, diff);
     }
 
-    sqlite3_finalize(stmt);
     return result;
 }
+
+int DatabaseDownloader::latestStoredDate(SqliteConnection& db, const std::string& table)
+{
+    if (shards_.enabled())
+        return shards_.latestDate(table);
+    return MarketDataReader(db, table).latestDate();
+}
+
+int DatabaseDownloader::lastStoredDate(SqliteConnection& db, const std::string& table, const std::string& pair)
+{
+    if (shards_.enabled())
+        return shards_.lastDate(table, pair);
+
+    SymbolBar bar;
+    return MarketDataReader(db, table).latest(pair, bar) ? bar.date : 0;
+}
+
+BarColumns DatabaseDownloader::storedBars(SqliteConnection& db, const std::string& table,
+                                          const std::vector<std::string>& symbols, int from, int to)
+{
+    if (shards_.enabled())
+        return shards_.bars(table, symbols, from, to);
+    return MarketDataReader(db, table).bars(symbols, from, to);
+}
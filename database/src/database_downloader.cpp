@@ -1,19 +1,77 @@
 #include "database_downloader.h"
+#include "database_http_cassette.h"
 #include "logger.h"
+#include "market_data_reader.h"
 #include "time_utils.h"
 
 #include <sqlite3.h>
+#include <algorithm>
+#include <climits>
+#include <future>
+#include <mutex>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 /**************************************************************************************
- * Purpose : Constructs the DatabaseDownloader with the path to the SQLite database.
- * Args    : database_path - Filesystem path to the database file.
+ * Purpose : Constructs the DatabaseDownloader from the database configuration, with
+ *           one exchange adapter per configured venue (main first). The
+ *           market data bus is optional: if it cannot be created the service keeps
+ *           working and consumers fall back to reading SQLite. The import tools build
+ *           it with DownloaderRole::Import: the bus, the kline stream and the tick store
+ *           stay with the running service.
+ * Args    : config - Active database configuration.
+ *           role   - Service or Import.
  * Return  : None
  **************************************************************************************/
-DatabaseDownloader::DatabaseDownloader(boost::filesystem::path database_path)
-    : database_path_(std::move(database_path))
-{}
+DatabaseDownloader::DatabaseDownloader(const DatabaseConfig& config, DownloaderRole role)
+    : database_path_(config.GetDatabasePath()),
+      notifier_(config.GetNotifySockets()),
+      universe_(config.GetUniverse()),
+      sharding_(config.GetSharding())
+{
+    HttpCassette::Instance().Configure(config.GetHttpCassette());
+
+    // Main exchange first, then the additional venues (unsupported ones are skipped)
+    for (const auto& name : config.GetAllExchanges())
+    {
+        auto adapter = makeExchangeAdapter(name);
+        if (adapter) {
+            exchanges_.push_back(std::move(adapter));
+        } else if (exchanges_.empty()) {
+            LG_ERROR("Main exchange '{}' is not supported, nothing will be downloaded", name);
+            break;
+        }
+    }
+
+    const bool service = role == DownloaderRole::Service;
+
+    if (service && !config.GetMarketBusName().empty())
+    {
+        try {
+            marketBus_ = std::make_unique<MarketBusWriter>(
+                config.GetMarketBusName(),
+                static_cast<uint32_t>(config.GetMarketBusMaxSymbols()),
+                static_cast<uint32_t>(config.GetMarketBusWindowDays()));
+        } catch (const std::exception& e) {
+            LG_ERROR("Market data bus disabled: {}", e.what());
+        }
+    }
+
+    if (service && config.GetKlineStream().enabled && !exchanges_.empty())
+    {
+        klineStream_ = std::make_unique<KlineStreamConsumer>(
+            *exchanges_[0], config.GetKlineStream(),
+            [this](const OHLCVData& data) { storeStreamedCandles(data); });
+    }
+
+    if (service && config.GetTickStore().dailyAggTrades && !exchanges_.empty())
+        tickStore_ = std::make_unique<TickStore>(config.GetTickStore().path);
+
+    // Schema set up once here; if the open fails, the next run retries (ensureDatabase)
+    openDatabase();
+}
 
 /**************************************************************************************
  * Purpose : Debug helper to check which pairs in OHLCVData contain a specific date
@@ -87,68 +145,30 @@ void pruneFutureCandles(OHLCVData& data, std::chrono::year_month_day cutoffDate)
 
 /**************************************************************************************
  * Purpose : Print ALL OHLCV rows stored in the database for BTCUSDT, ordered by date.
- * Args    : db - valid SQLite handle
+ * Args    : bars - Every stored BTCUSDT bar (storedBars)
  * Return  : void
  **************************************************************************************/
-void printAllBTCUSDT(sqlite3* db)
+void printAllBTCUSDT(const BarColumns& bars)
 {
-    if (!db) {
-        LG_ERROR("DB handle is null");
-        return;
-    }
-
-    const char* sql =
-        "SELECT date, open, high, low, close, volume "
-        "FROM ohlcv_data "
-        "WHERE pair = 'BTCUSDT' "
-        "ORDER BY date ASC;";
-
-    sqlite3_stmt* stmt = nullptr;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
-    {
-        LG_ERROR("Prepare failed: {}", sqlite3_errmsg(db));
-        return;
-    }
-
     LG_INFO("=========== ALL BTCUSDT OHLCV STORED ===========");
 
-    int rowCount = 0;
-    int rc;
-
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    for (std::size_t i = 0; i < bars.size(); ++i)
     {
-        int date     = sqlite3_column_int(stmt, 0);
-        double open  = sqlite3_column_double(stmt, 1);
-        double high  = sqlite3_column_double(stmt, 2);
-        double low   = sqlite3_column_double(stmt, 3);
-        double close = sqlite3_column_double(stmt, 4);
-        double vol   = sqlite3_column_double(stmt, 5);
-
         LG_INFO(
             "[{}] O:{:.4f} H:{:.4f} L:{:.4f} C:{:.4f} V:{:.4f}",
-            date, open, high, low, close, vol
+            bars.date[i], bars.open[i], bars.high[i], bars.low[i], bars.close[i], bars.volume[i]
         );
-
-        rowCount++;
     }
 
-    if (rc != SQLITE_DONE)
-        LG_ERROR("Step error: {}", sqlite3_errmsg(db));
-
-    sqlite3_finalize(stmt);
-
-    LG_INFO("=========== {} rows printed ===========", rowCount);
+    LG_INFO("=========== {} rows printed ===========", bars.size());
 }
 
-void printDateOfStart(sqlite3* db)
+void printDateOfStart(SqliteConnection& db)
 {
-    const char* sql = "SELECT id FROM date_of_start;";
-    sqlite3_stmt* stmt = nullptr;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    CachedStatement stmt = db.cached("SELECT id FROM date_of_start;");
+    if (!stmt)
     {
-        LG_ERROR("Failed to prepare SELECT on date_of_start: {}", sqlite3_errmsg(db));
+        LG_ERROR("Failed to prepare SELECT on date_of_start: {}", db.errmsg());
         return;
     }
 
@@ -166,8 +186,6 @@ void printDateOfStart(sqlite3* db)
         }
     }
 
-    sqlite3_finalize(stmt);
-
     // Only one final log:
     LG_INFO("date_of_start entries: {}", allDates);
 }
@@ -175,39 +193,111 @@ void printDateOfStart(sqlite3* db)
 
 
 /**************************************************************************************
- * Purpose : Main orchestration function called by DatabaseScheduler. This downloads
- *           new tracked data for the given date by:
- *              - Opening the SQLite database
- *              - Loading previous tracked data
- *              - Checking if the database is already up to date
- *              - Fetching the top-50 Binance perpetual pairs
- *              - Computing updated tracked-pair day counts
- *              - Storing results in the database
- *              - Printing resulting tracked_pairs contents
- *
- * Args    : date - The UTC date for which tracked data should be computed.
- * Return  : bool - true on success, false otherwise.
+ * Purpose : Stops the kline stream before the database it writes to is closed.
  **************************************************************************************/
-bool DatabaseDownloader::downloadData(std::chrono::year_month_day date)
+DatabaseDownloader::~DatabaseDownloader()
 {
-    std::string date_str = formatYMD(date);
-    LG_INFO("DownloadData({})", date_str);
+    klineStream_.reset();
+    clearPrepared();
+}
 
-    // ------------------------------------------------------------
-    // Open database
-    // ------------------------------------------------------------
-    sqlite3* db = openDatabaseOHLCV(database_path_,std::to_string(toYYYYMMDD(date)));
-    if (!db)
+void DatabaseDownloader::clearPrepared()
+{
+    preparedDate_ = EMPTY_DATE;
+    preparedUniverse_.clear();
+}
+
+/**************************************************************************************
+ * Purpose : Pre-midnight warm-up. The 24h ticker used for discovery is a rolling
+ *           window, so the universe seen seconds before the close is the one the
+ *           download would see right after it. Exchanges are prepared concurrently,
+ *           and meanwhile the statements of their syncs are compiled on db_ (the
+ *           download reuses db_'s statement cache).
+ * Args    : date - Day that will be downloaded once it closes (today, UTC).
+ * Return  : void
+ **************************************************************************************/
+void DatabaseDownloader::prepare(std::chrono::year_month_day date)
+{
+    clearPrepared();
+    if (exchanges_.empty())
+        return;
+
+    const auto t0 = std::chrono::steady_clock::now();
+
+    std::mutex preparedMutex;
+    std::vector<std::future<void>> tasks;
+    for (auto& exchange : exchanges_)
     {
-        LG_ERROR("Could not open database {}", database_path_.string());
-        return false;
+        tasks.push_back(std::async(std::launch::async, [&, &exchange = *exchange]() {
+            exchange.warmUp();
+            Universe universe = exchange.discoverSymbols(universe_);
+            if (universe.empty())
+                return;                            // Discovered again after midnight
+            std::lock_guard<std::mutex> lock(preparedMutex);
+            preparedUniverse_[exchange.name()] = std::move(universe);
+        }));
     }
-    printDateOfStart(db);
+
+    // Database side while the exchanges answer
+    {
+        std::lock_guard<std::mutex> storeLock(storeMutex_);
+        if (!ensureDatabase())
+            LG_WARN("Warm-up: database unavailable, retried by the download");
+        else
+        {
+            for (std::size_t i = 0; i < exchanges_.size(); ++i)
+            {
+                if (!primeStatements(db_, ExchangeTables::forExchange(exchanges_[i]->name(), i == 0)))
+                    LG_WARN("Warm-up: statements of {} not primed, compiled by the download",
+                            exchanges_[i]->name());
+            }
+        }
+    }
+
+    for (auto& task : tasks)
+        task.get();
+
+    preparedDate_ = date;
+
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0);
+    LG_INFO("Warm-up for {} done in {} ms ({} universes prepared)",
+            formatYMD(date), ms.count(), preparedUniverse_.size());
+}
+
+/**************************************************************************************
+ * Purpose : Daily pipeline of one exchange:
+ *              - Loading previous tracked data
+ *              - Discovering the universe (symbols selected by the universe policy)
+ *              - Computing and storing updated tracked-pair day counts
+ *              - Computing the days missing per pair
+ *              - Fetching klines and funding rates
+ *              - Storing them (with the data_version watermark for the main exchange)
+ *           Network calls run without the lock; every SQLite access holds dbMutex, so
+ *           exchanges fetch concurrently and share one serialised write path.
+ *
+ * Args    : exchange  - Venue adapter.
+ *           tables    - Tables of this venue.
+ *           db        - Shared SQLite connection.
+ *           dbMutex   - Serialises access to db.
+ *           date      - The UTC date for which data should be stored.
+ *           committed - Filled with the watermark (main exchange only, else nullptr).
+ * Return  : ExchangeSyncResult - Outcome for this exchange.
+ **************************************************************************************/
+ExchangeSyncResult DatabaseDownloader::syncExchange(ExchangeAdapter& exchange, const ExchangeTables& tables,
+                                                    SqliteConnection& db, std::mutex& dbMutex,
+                                                    std::chrono::year_month_day date, DayCommitted* committed)
+{
+    const std::string venue = exchange.name();
+    const std::string date_str = formatYMD(date);
 
     // ------------------------------------------------------------
     // Load previous tracked data (if any)
     // ------------------------------------------------------------
-    TrackedData prev = getTrackedPairs(db);
+    TrackedData prev;
+    {
+        std::lock_guard<std::mutex> lock(dbMutex);
+        prev = getTrackedPairs(db, tables.trackedPairs);
+    }
     bool prev_exists = prev.date != EMPTY_DATE && !prev.trackedPairs.empty();
 
     TrackedData updated_tracked_data = prev;
@@ -217,75 +307,397 @@ bool DatabaseDownloader::downloadData(std::chrono::year_month_day date)
         // ------------------------------------------------------------
         // Always compute updated tracked pairs, even if empty
         // ------------------------------------------------------------
-        LG_INFO("Fetching top-50 volume pairs...");
-        std::set<std::string> top50 = getTop50PairsByVolume();
+        Universe universe;
+        auto prepared = preparedUniverse_.find(venue);
+        if (prepared != preparedUniverse_.end() && preparedDate_ == date) {
+            LG_INFO("[{}] Using the universe prepared before midnight", venue);
+            universe = prepared->second;
+        } else {
+            LG_INFO("[{}] Discovering universe...", venue);
+            universe = exchange.discoverSymbols(universe_);
+        }
 
-        if (top50.empty())
+        if (universe.empty())
         {
-            LG_ERROR("ERROR — top-50 list is empty. Aborting.");
-            sqlite3_close(db);
-            return false;
+            LG_ERROR("[{}] ERROR — universe is empty. Aborting.", venue);
+            return ExchangeSyncResult::Failed;
         }
 
+        LG_INFO("[{}] Universe: {} pairs", venue, universe.size());
+
         // Compute new tracked-pairs state for "date"
-        updated_tracked_data = getNewTrackedPairs(prev, top50, prev_exists, date);
+        updated_tracked_data = getNewTrackedPairs(prev, universe, prev_exists, date, universe_.maxDaysOut);
 
         // ------------------------------------------------------------
         // Store TRACKED PAIRS FIRST (always)
         // ------------------------------------------------------------
-        if (!storeTrackedPairs(db, updated_tracked_data))
+        std::lock_guard<std::mutex> lock(dbMutex);
+        if (!storeTrackedPairs(db, tables.trackedPairs, updated_tracked_data))
         {
-            LG_ERROR("Failed to store tracked pairs.");
-            sqlite3_close(db);
-            return false;
+            LG_ERROR("[{}] Failed to store tracked pairs.", venue);
+            return ExchangeSyncResult::Failed;
         }
 
-        LG_INFO("Tracked_pairs updated for {}", date_str);
+        LG_INFO("[{}] {} updated for {}", venue, tables.trackedPairs, date_str);
 
     }else{
-        LG_INFO("Tracked_pairs already up to date for {}", date_str);
+        LG_INFO("[{}] {} already up to date for {}", venue, tables.trackedPairs, date_str);
     }
 
-    std::map<std::string,int> dataToDownload = computeDaysSinceLastStoredOHLCV(db,updated_tracked_data, date);
+    std::map<std::string,int> dataToDownload;
+    {
+        std::lock_guard<std::mutex> lock(dbMutex);
+        dataToDownload = computeDaysSinceLastStoredOHLCV(db, tables.ohlcv, updated_tracked_data, date);
+    }
 
     if(dataToDownload.empty()){
-        LG_INFO("OOHLCV already up to date.");
-        sqlite3_close(db);
-        return false;
+        LG_INFO("[{}] OHLCV already up to date.", venue);
+        return ExchangeSyncResult::UpToDate;
     }
 
     // ------------------------------------------------------------
     // NOW fetch OHLCV data — even if tracked_pairs was already up-to-date
     // ------------------------------------------------------------
-    OHLCVData data_ohlcv = fetchDataOHLCV(date, dataToDownload);
+    OHLCVData data_ohlcv = exchange.fetchKlines(date, dataToDownload);
 
     pruneFutureCandles(data_ohlcv, date);
 
     if (data_ohlcv.data.empty())
     {
-        LG_WARN("No OHLCV data returned for {}", date_str);
-        printTrackedData(db);
-        sqlite3_close(db);
-        return true;                       // Not an error — tracked pairs updated anyway
+        LG_WARN("[{}] No OHLCV data returned for {}", venue, date_str);
+        return ExchangeSyncResult::NoData;     // Not an error — tracked pairs updated anyway
     }
 
     // ------------------------------------------------------------
-    // Store OHLCV data
+    // Funding rates over the same windows
+    // ------------------------------------------------------------
+    FundingRateData data_funding = exchange.fetchFundingRates(date, dataToDownload);
+
+    // ------------------------------------------------------------
+    // Store: funding first, so consumers woken by the new
+    // data_version see them. A funding failure does not block
+    // the candles.
     // ------------------------------------------------------------
-    if (!storeDataOHLCV(db, data_ohlcv))
+    std::lock_guard<std::mutex> lock(dbMutex);
+
+    if (!data_funding.data.empty() && !storeFundingRates(db, tables.funding, data_funding))
     {
-        LG_ERROR("Failed to store OHLCV data.");
-        sqlite3_close(db);
+        LG_ERROR("[{}] Failed to store funding rates.", venue);
+    }
+
+    if (!storeDataOHLCV(db, tables.ohlcv, data_ohlcv, date, committed))
+    {
+        LG_ERROR("[{}] Failed to store OHLCV data.", venue);
+        return ExchangeSyncResult::Failed;
+    }
+
+    LG_INFO("[{}] OHLCV data stored for {}", venue, date_str);
+    return ExchangeSyncResult::Stored;
+}
+
+/**************************************************************************************
+ * Purpose : Main orchestration function called by DatabaseScheduler. This downloads
+ *           new data for the given date by:
+ *              - Reopening the SQLite database if it is closed, recording date_of_start
+ *              - Running syncExchange() for every configured exchange concurrently,
+ *                the main exchange on this thread
+ *              - Publishing the market data bus and notifying downstream consumers
+ *                when the main exchange committed a new day
+ *              - Printing resulting tracked_pairs contents
+ *
+ * Args    : date - The UTC date for which tracked data should be computed.
+ * Return  : bool - Outcome of the main exchange: true if data was stored (or none was
+ *                  returned), false on failure or if it was already up to date.
+ **************************************************************************************/
+bool DatabaseDownloader::downloadData(std::chrono::year_month_day date)
+{
+    std::lock_guard<std::mutex> storeLock(storeMutex_);
+
+    std::string date_str = formatYMD(date);
+    LG_INFO("DownloadData({})", date_str);
+
+    if (exchanges_.empty())
+    {
+        LG_ERROR("No supported exchange configured");
         return false;
     }
 
-    LG_INFO("OHLCV data stored for {}", date_str);
+    // ------------------------------------------------------------
+    // Database (open since construction, reopened if that failed)
+    // ------------------------------------------------------------
+    if (!ensureDatabase())
+        return false;
 
-    printTrackedData(db);
-    printAllBTCUSDT(db);
-    sqlite3_close(db);
+    recordDateOfStart(db_, static_cast<unsigned int>(toYYYYMMDD(date)));
+    printDateOfStart(db_);
+
+    // ------------------------------------------------------------
+    // Additional exchanges on their own threads, main exchange here.
+    // All of them share db_ through dbMutex.
+    // ------------------------------------------------------------
+    std::mutex dbMutex;
+    std::vector<std::future<ExchangeSyncResult>> others;
+    const HttpTrafficStats trafficBefore = httpTrafficTotals();
+
+    for (std::size_t i = 1; i < exchanges_.size(); ++i)
+    {
+        ExchangeAdapter& exchange = *exchanges_[i];
+        others.push_back(std::async(std::launch::async, [&, &exchange = exchange]() {
+            return syncExchange(exchange, ExchangeTables::forExchange(exchange.name(), false),
+                                db_, dbMutex, date, nullptr);
+        }));
+    }
+
+    DayCommitted committed;
+    const ExchangeSyncResult result = syncExchange(
+        *exchanges_[0], ExchangeTables::forExchange(exchanges_[0]->name(), true),
+        db_, dbMutex, date, &committed);
+
+    for (std::size_t i = 0; i < others.size(); ++i)
+    {
+        if (others[i].get() == ExchangeSyncResult::Failed)
+            LG_ERROR("[{}] Daily sync failed", exchanges_[i + 1]->name());
+    }
+
+    const HttpTrafficStats traffic = httpTrafficTotals() - trafficBefore;
+    LG_INFO("HTTP: {} requests ({} over HTTP/2), {} KiB received, {} KiB decompressed",
+            traffic.requests, traffic.http2, traffic.wireBytes / 1024, traffic.bodyBytes / 1024);
+
+    switch (result)
+    {
+    case ExchangeSyncResult::Failed:
+        return false;
+
+    case ExchangeSyncResult::UpToDate:
+        refreshMarketBus(db_);             // First run after a restart: bus still empty
+        return false;
+
+    case ExchangeSyncResult::NoData:
+        printTrackedData(db_);
+        return true;
+
+    case ExchangeSyncResult::Stored:
+        break;
+    }
+
+    LG_INFO("OHLCV data stored for {} (data_version {})", date_str, committed.version);
+
+    // Publish the bus before notifying so woken consumers already see the new bars
+    refreshMarketBus(db_);
+
+    // Wake up downstream consumers (signalizer, research caches)
+    notifier_.publish(committed);
+
+    printTrackedData(db_);
+    printAllBTCUSDT(storedBars(db_, ExchangeTables{}.ohlcv, {"BTCUSDT"}, 0, INT_MAX));
 
     LG_INFO("Database updated successfully.");
 
     return true;
 }
+
+/**************************************************************************************
+ * Purpose : Bulk-loads daily candles into the main exchange's ohlcv_data. Rows go
+ *           through storeDataOHLCV (one transaction, UPSERT, data_version watermark of
+ *           the last imported day), so consumers pick the import up like a daily run.
+ * Args    : data - OHLCVData containing pair → date → OHLCV.
+ * Return  : bool - true on success.
+ **************************************************************************************/
+bool DatabaseDownloader::importOHLCV(const OHLCVData& data)
+{
+    std::lock_guard<std::mutex> storeLock(storeMutex_);
+
+    unsigned int first = UINT_MAX, last = 0;
+    std::size_t rows = 0;
+    for (const auto& [pair, dailyMap] : data.data)
+    {
+        if (dailyMap.empty())
+            continue;
+        first = std::min(first, dailyMap.begin()->first);
+        last  = std::max(last, dailyMap.rbegin()->first);
+        rows += dailyMap.size();
+    }
+
+    if (rows == 0)
+    {
+        LG_WARN("Nothing to import.");
+        return true;
+    }
+
+    if (!ensureDatabase())
+        return false;
+    recordDateOfStart(db_, first);
+
+    LG_INFO("Importing {} candles of {} pairs ({} → {})...", rows, data.data.size(), first, last);
+
+    const ExchangeTables tables;           // Main exchange
+
+    DayCommitted committed;
+    if (!storeDataOHLCV(db_, tables.ohlcv, data, fromYYYYMMDD(last), &committed))
+        return false;
+
+    LG_INFO("Import committed (data_version {})", committed.version);
+
+    refreshMarketBus(db_);
+    notifier_.publish(committed);
+
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Reads the main exchange's pairs with 0 days outside the universe (the ones
+ *           the daily run downloads for sure).
+ * Args    : None
+ * Return  : std::vector<std::string> - Sorted symbols (empty if the database fails).
+ **************************************************************************************/
+std::vector<std::string> DatabaseDownloader::universePairs()
+{
+    std::vector<std::string> pairs;
+
+    TrackedData tracked;
+    {
+        std::lock_guard<std::mutex> storeLock(storeMutex_);
+        if (!ensureDatabase())
+            return pairs;
+        tracked = getTrackedPairs(db_, ExchangeTables{}.trackedPairs);
+    }
+
+    for (const auto& [pair, daysOut] : tracked.trackedPairs)
+    {
+        if (daysOut == 0)
+            pairs.push_back(pair);
+    }
+    return pairs;
+}
+
+/**************************************************************************************
+ * Purpose : Subscribes the kline stream to the pairs of the main exchange's universe.
+ * Args    : None
+ * Return  : void
+ **************************************************************************************/
+void DatabaseDownloader::startKlineStream()
+{
+    if (!klineStream_)
+        return;
+
+    std::vector<std::string> pairs = universePairs();
+    if (pairs == klineStreamPairs_ && klineStream_->live())
+        return;
+
+    klineStreamPairs_ = pairs;
+    klineStream_->start(std::move(pairs));
+}
+
+/**************************************************************************************
+ * Purpose : Fetches the aggregated trades of `date` for the universe pairs that have
+ *           no tick block for that day yet, and writes each pair's block as soon as its
+ *           day is complete (one pair in memory at a time, not the whole universe).
+ * Args    : date - UTC day to store.
+ * Return  : bool - true if every missing pair was stored.
+ **************************************************************************************/
+bool DatabaseDownloader::syncAggTrades(std::chrono::year_month_day date)
+{
+    if (!tickStore_)
+        return true;
+
+    const unsigned int ymd = static_cast<unsigned int>(toYYYYMMDD(date));
+
+    std::vector<std::string> pairs;
+    for (auto& pair : universePairs())
+    {
+        if (!tickStore_->has(pair, ymd))
+            pairs.push_back(std::move(pair));
+    }
+
+    if (pairs.empty())
+    {
+        LG_INFO("aggTrades {}: every universe pair already stored", ymd);
+        return true;
+    }
+
+    std::size_t trades = 0, bytes = 0, failed = 0;
+    const std::size_t handed = exchanges_[0]->fetchAggTrades(date, pairs,
+        [&](const std::string& pair, const std::vector<AggTrade>& dayTrades) {
+            const std::size_t size = tickStore_->write(pair, ymd, dayTrades);
+            if (size == 0) {
+                ++failed;
+                return;
+            }
+            trades += dayTrades.size();
+            bytes  += size;
+        });
+
+    LG_INFO("aggTrades {}: {}/{} pairs stored, {} trades in {:.1f} MB ({:.2f} bytes/trade)",
+            ymd, handed - failed, pairs.size(), trades, bytes / 1e6,
+            trades > 0 ? static_cast<double>(bytes) / trades : 0.0);
+
+    return failed == 0 && handed == pairs.size();
+}
+
+/**************************************************************************************
+ * Purpose : Stores the closed candles of the kline stream. Each candle must extend the
+ *           pair's stored history by one day (or overwrite a stored day); the rest is
+ *           logged and fetched by the REST run after midnight. The accepted candles go
+ *           through storeDataOHLCV with a data_version watermark, then the bus is
+ *           refreshed and consumers notified, as after a daily run.
+ * Args    : data - Closed candles, pair → date → OHLCV.
+ * Return  : bool - true on success.
+ **************************************************************************************/
+bool DatabaseDownloader::storeStreamedCandles(const OHLCVData& data)
+{
+    std::lock_guard<std::mutex> storeLock(storeMutex_);
+
+    unsigned int last = 0;
+    for (const auto& [pair, dailyMap] : data.data)
+    {
+        if (!dailyMap.empty())
+            last = std::max(last, dailyMap.rbegin()->first);
+    }
+    if (last == 0)
+        return true;
+
+    if (!ensureDatabase())
+    {
+        LG_ERROR("Kline stream: candles of {} dropped", last);
+        return false;
+    }
+    recordDateOfStart(db_, last);
+
+    const ExchangeTables tables;           // Main exchange
+
+    OHLCVData accepted;
+    std::size_t deferred = 0;
+
+    for (const auto& [pair, dailyMap] : data.data)
+    {
+        unsigned int lastStored = static_cast<unsigned int>(lastStoredDate(db_, tables.ohlcv, pair));
+
+        for (const auto& [yyyymmdd, candle] : dailyMap)
+        {
+            if (lastStored == 0 || lastStored < previousDay(yyyymmdd))
+            {
+                LG_INFO("[stream] {} {}: last stored {}, left to the REST gap repair", pair, yyyymmdd, lastStored);
+                ++deferred;
+                continue;
+            }
+            accepted.data[pair][yyyymmdd] = candle;
+            lastStored = std::max(lastStored, yyyymmdd);
+        }
+    }
+
+    bool ok = true;
+    if (!accepted.data.empty())
+    {
+        DayCommitted committed;
+        ok = storeDataOHLCV(db_, tables.ohlcv, accepted, fromYYYYMMDD(last), &committed);
+        if (ok)
+        {
+            LG_INFO("Streamed candles of {} pairs committed for {} (data_version {}, {} deferred)",
+                    accepted.data.size(), last, committed.version, deferred);
+            refreshMarketBus(db_);
+            notifier_.publish(committed);
+        }
+    }
+
+    return ok;
+}
@@ -1,170 +1,435 @@
-#pragma once
-
-#include <boost/filesystem.hpp>
-#include <map>
-#include <string>
-#include <set>
-#include <chrono>
-#include <sqlite3.h>
-#include "data_types.h"
-
-/***********************************************
- * A placeholder date used when database has
- * no stored tracked_pairs.
- ***********************************************/
-static constexpr std::chrono::year_month_day EMPTY_DATE =
-    std::chrono::year{2000}/1/1;
-
-/***********************************************
- * Struct storing a UTC date and a mapping
- * of trading pairs → days outside top-50.
- ***********************************************/
-struct TrackedData {
-    std::chrono::year_month_day date;      // Stored date for these stats
-    std::map<std::string, int> trackedPairs; // Map pair → days outside top-50
-};
-
-/***********************************************
- * Main downloader class performing:
- *  - SQLite database operations
- *  - Binance API data retrieval
- *  - Tracking logic recomputing pair counters
- ***********************************************/
-class DatabaseDownloader {
-public:
-    /**************************************************************************************
-     * Purpose : Construct the downloader with the path to an SQLite DB file.
-     * Args    : database_path - Filesystem path to the OHLCV database.
-     **************************************************************************************/
-    DatabaseDownloader(boost::filesystem::path database_path);
-    ~DatabaseDownloader() = default;
-
-    /**************************************************************************************
-     * Purpose : Main orchestration function invoked once per day by DatabaseScheduler.
-     * Args    : date - The UTC date for which data must be computed and stored.
-     * Return  : bool - true on success, false on failure.
-     **************************************************************************************/
-    bool downloadData(std::chrono::year_month_day date);
-
-private:
-    // Path to the database file
-    boost::filesystem::path database_path_;
-
-    /**************************************************************************************
-     * Purpose : Opens (or creates) the OHLCV SQLite database and ensures that both:
-     *             - tracked_pairs (JSON snapshot table)
-     *             - ohlcv_data    (row-per-candle OHLCV table)
-     *             - yymmdd        (the first full day of the dataset which is the day it was
-     *                                  first written)
-     *           exist.
-     *
-     * Args    : path - Filesystem path to the database file.
-     * Return  : sqlite3* - Valid DB handle on success, nullptr on failure.
-     **************************************************************************************/
-    sqlite3* openDatabaseOHLCV(const boost::filesystem::path& path, std::string yymmdd);
-
-    /**************************************************************************************
-     * Purpose : Read the only row of tracked_pairs in the database.
-     * Args    : db - SQLite handle.
-     * Return  : TrackedData - Parsed struct. If empty, date == EMPTY_DATE.
-     **************************************************************************************/
-    TrackedData getTrackedPairs(sqlite3* db);
-
-    /**************************************************************************************
-     * Purpose : Store (overwrite) tracked_pairs in the SQLite database.
-     * Args    : db   - SQLite handle.
-     *           data - TrackedData to write.
-     * Return  : bool - true on success.
-     **************************************************************************************/
-    bool storeTrackedPairs(sqlite3* db, const TrackedData& data);
-
-    /**************************************************************************************
-     * Purpose : Print tracked_pairs content for debugging/logging.
-     * Args    : db - SQLite database handle.
-     **************************************************************************************/
-    void printTrackedData(sqlite3* db);
-
-    /**************************************************************************************
-     * Purpose : Fetch the top-50 Binance USDT perpetual futures pairs by 24h volume.
-     * Return  : std::set<std::string> - Set of pair symbols.
-     **************************************************************************************/
-    std::set<std::string> getTop50PairsByVolume();
-
-    /**************************************************************************************
-     * Purpose : Compute updated trackedPairs mapping for the new date.
-     * Args    : prev            - Previously stored tracked pair stats.
-     *           top50           - Current day's top-50 volume symbols.
-     *           prev_exists     - Whether previous data exists in DB.
-     *           current_date    - Date for which we compute stats.
-     * Return  : TrackedData     - Newly computed tracked data struct.
-     **************************************************************************************/
-    TrackedData getNewTrackedPairs(
-        const TrackedData& prev,
-        const std::set<std::string>& top50,
-        bool prev_exists,
-        std::chrono::year_month_day current_date
-    );
-
-    /**************************************************************************************
-     * Purpose : Fetch up to 100 days of OHLCV (1d candles) ending exactly at `targetDate`.
-     *           Caller guarantees `targetDate` is the last full day (e.g., yesterday).
-     *
-     * Args    : targetDate   - YYYY-MM-DD date for last complete candle
-     *           dataToDownload - map<pair → days to download>
-     *
-     * Return  : OHLCVData - Structure: result.data[pair][YYYYMMDD] = OHLCV{...}
-     **************************************************************************************/
-    OHLCVData fetchDataOHLCV(std::chrono::year_month_day targetDate, const std::map<std::string,int>& dataToDownload);
-
-    /**************************************************************************************
-     * Purpose : Stores OHLCV daily candles into the `ohlcv_data` table. Each candle is
-     *           stored as one row identified by (pair, date). Uses an UPSERT so calling
-     *           this multiple times for the same (pair, date) will overwrite previous
-     *           values safely.
-     *
-     * Args    : db   - SQLite handle (must be valid).
-     *           data - OHLCVData containing pair → date → OHLCV.
-     *
-     * Return  : bool - true on success, false on failure.
-     **************************************************************************************/
-    bool storeDataOHLCV(sqlite3* db, const OHLCVData& data);
-
-    /**************************************************************************************
-     * Purpose : Prints all OHLCV rows stored for the latest date available in the 
-     *           `ohlcv_data` table. This is intended for debugging and verification that 
-     *           the daily fetch and storage operations are working correctly.
-     *
-     * Args    : db - Valid SQLite database handle.
-     *
-     * Return  : void
-     **************************************************************************************/
-    void printLatestOHLCV(sqlite3* db);
-
-
-    /**************************************************************************************
-     * Purpose : Prints the OHLCV for BTCUSDT for the latest stored date in the database.
-     *
-     * Args    : db - Valid SQLite handle.
-     * Return  : void
-     **************************************************************************************/
-    void printLatestBTCUSDT(sqlite3* db);
-
-    
-    /**************************************************************************************
-     * Purpose : For each tracked pair, determine how many days have passed since the last
-     *           OHLCV candle stored in the DB.
-     *
-     *           Rules:
-     *              - If pair has no rows → return 100
-     *              - If last date is > 100 days before current date → return 100
-     *              - Otherwise: return (currentYMD - lastStoredYMD)
-     *
-     * Args    : db          - opened SQLite database.
-     *           tracked     - TrackedData (contains the map<pair → days_out>).
-     *           currentYMD  - current date (year_month_day) to compare against.
-     *
-     * Return  : std::map<std::string,int> → map of pair → day difference.
-     **************************************************************************************/
-    std::map<std::string,int> computeDaysSinceLastStoredOHLCV(sqlite3* db, const TrackedData& tracked, std::chrono::year_month_day currentDate);
-    
-};
+#pragma once
+
+#include <boost/filesystem.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <set>
+#include <vector>
+#include <chrono>
+#include <sqlite3.h>
+#include "data_types.h"
+#include "change_notification.h"
+#include "market_data_bus.h"
+#include "database_configdata.h"
+#include "database_exchange_adapter.h"
+#include "database_kline_stream.h"
+#include "tick_store.h"
+#include "shard_catalog.h"
+#include "sharded_candle_store.h"
+#include "sqlite_connection.h"
+
+/***********************************************
+ * Extra days of history replayed before the bus
+ * window so published indicators are converged.
+ ***********************************************/
+static constexpr int MARKET_BUS_WARMUP_DAYS = 200;
+
+/***********************************************
+ * A placeholder date used when database has
+ * no stored tracked_pairs.
+ ***********************************************/
+static constexpr std::chrono::year_month_day EMPTY_DATE =
+    std::chrono::year{2000}/1/1;
+
+/***********************************************
+ * Struct storing a UTC date and a mapping
+ * of trading pairs → days outside the universe.
+ ***********************************************/
+struct TrackedData {
+    std::chrono::year_month_day date;      // Stored date for these stats
+    std::map<std::string, int> trackedPairs; // Map pair → days outside the universe
+    Universe universe;                     // Pairs in the universe on `date` (rank, volume)
+};
+
+/**************************************************************************************
+ * Purpose : Compute updated trackedPairs mapping for the new date.
+ * Args    : prev         - Previously stored tracked pair stats.
+ *           universe     - Current day's universe (policy-selected symbols, ranks).
+ *           prev_exists  - Whether previous data exists in DB.
+ *           current_date - Date for which we compute stats.
+ *           maxDaysOut   - Days outside the universe before eviction (0 = never).
+ * Return  : TrackedData  - Newly computed tracked data struct.
+ **************************************************************************************/
+TrackedData getNewTrackedPairs(const TrackedData& prev, const Universe& universe, bool prev_exists,
+                               std::chrono::year_month_day current_date, int maxDaysOut);
+
+/***********************************************
+ * Tables holding one exchange's data. The main
+ * exchange keeps the original table names; the
+ * others get an _<exchange> suffix.
+ ***********************************************/
+struct ExchangeTables {
+    std::string trackedPairs = "tracked_pairs";           // One row per (date, pair)
+    std::string ohlcv        = "ohlcv_data";
+    std::string funding      = "funding_rates";
+
+    static ExchangeTables forExchange(const std::string& exchange, bool isMain);
+};
+
+/***********************************************
+ * Outcome of one exchange's daily sync.
+ ***********************************************/
+enum class ExchangeSyncResult { Failed, UpToDate, NoData, Stored };
+
+/***********************************************
+ * What a DatabaseDownloader is built for. An
+ * import tool runs next to the service and must
+ * not take over its market data bus.
+ ***********************************************/
+enum class DownloaderRole {
+    Service,        // Daily service: market data bus, kline stream, tick store
+    Import          // One-shot import: database and notifications only
+};
+
+/***********************************************
+ * Main downloader class performing:
+ *  - SQLite database operations
+ *  - Exchange data retrieval through one
+ *    ExchangeAdapter per configured venue
+ *  - Tracking logic recomputing pair counters
+ ***********************************************/
+class DatabaseDownloader {
+public:
+    /**************************************************************************************
+     * Purpose : Construct the downloader from the database configuration (database path,
+     *           exchanges, notification sockets and market data bus settings) and open
+     *           the database.
+     * Args    : config - Active database configuration.
+     *           role   - Import skips the market data bus, the kline stream and the tick
+     *                    store, which belong to the running service.
+     **************************************************************************************/
+    explicit DatabaseDownloader(const DatabaseConfig& config, DownloaderRole role = DownloaderRole::Service);
+    ~DatabaseDownloader();
+
+    DatabaseDownloader(const DatabaseDownloader&) = delete;
+    DatabaseDownloader& operator=(const DatabaseDownloader&) = delete;
+
+    /**************************************************************************************
+     * Purpose : Pre-midnight warm-up for the download of `date`: reopens the database if
+     *           it is closed, compiles the statements each exchange's sync starts with
+     *           (primeStatements), opens pooled connections to every exchange and discovers
+     *           each universe, so the run after the candle close starts with the kline
+     *           requests. The universes are only used by the next downloadData(date).
+     * Args    : date - Day that will be downloaded once it closes (today, UTC).
+     * Return  : void
+     **************************************************************************************/
+    void prepare(std::chrono::year_month_day date);
+
+    /**************************************************************************************
+     * Purpose : Main orchestration function invoked once per day by DatabaseScheduler.
+     * Args    : date - The UTC date for which data must be computed and stored.
+     * Return  : bool - true on success, false on failure.
+     **************************************************************************************/
+    bool downloadData(std::chrono::year_month_day date);
+
+    /**************************************************************************************
+     * Purpose : Bulk-loads externally sourced daily candles (e.g. public data archives)
+     *           into the main exchange's ohlcv_data through the transactional writer,
+     *           then refreshes the market bus (Service role) and notifies consumers like a
+     *           daily run.
+     * Args    : data - OHLCVData containing pair → date → OHLCV.
+     * Return  : bool - true on success.
+     **************************************************************************************/
+    bool importOHLCV(const OHLCVData& data);
+
+    /**************************************************************************************
+     * Purpose : Subscribes the websocket kline stream (when enabled) to the pairs of the
+     *           main exchange currently in the universe. Called after every daily run;
+     *           the stream is only restarted when the set changed or it is down.
+     * Args    : None
+     * Return  : void
+     **************************************************************************************/
+    void startKlineStream();
+
+    // Whether the kline stream is enabled and every connection is open.
+    bool klineStreamLive() const noexcept { return klineStream_ && klineStream_->live(); }
+
+    /**************************************************************************************
+     * Purpose : Stores the aggregated trades of `date` in the tick store (when
+     *           tick_store.daily_agg_trades is enabled) for the main exchange's universe
+     *           pairs whose block is missing. Called after every daily run.
+     * Args    : date - The UTC day to store (last complete day).
+     * Return  : bool - true on success (or when disabled).
+     **************************************************************************************/
+    bool syncAggTrades(std::chrono::year_month_day date);
+
+private:
+    // Path to the database file
+    boost::filesystem::path database_path_;
+
+    // Publishes "day committed" notifications to downstream consumers
+    ChangeNotifier notifier_;
+
+    // Shared memory bus with the latest bars and indicator state (null if disabled)
+    std::unique_ptr<MarketBusWriter> marketBus_;
+
+    // data_version last published on the market bus (-1 = never published)
+    long long marketBusVersion_ = -1;
+
+    // Venue adapters: [0] = main exchange, then the additional exchanges
+    std::vector<std::unique_ptr<ExchangeAdapter>> exchanges_;
+
+    // Symbols tracked on every exchange
+    UniversePolicy universe_;
+
+    // Database connection, open for the lifetime of the downloader (schema set up once)
+    SqliteConnection db_;
+
+    // Serialises every use of db_: daily run, imports, streamed candles, universe reads
+    std::mutex storeMutex_;
+
+    // Configured sharding of the OHLCV tables (an existing catalog takes precedence)
+    ShardingSettings sharding_;
+
+    // Writer of the shards (disabled when the database is not sharded), used under storeMutex_.
+    // Candles of a sharded table are read back through it, never through db_.
+    ShardedCandleStore shards_;
+
+    // Websocket kline stream of the main exchange (null if disabled) and its pairs
+    std::unique_ptr<KlineStreamConsumer> klineStream_;
+    std::vector<std::string> klineStreamPairs_;
+
+    // Aggregated trades store fed after each daily run (null if disabled)
+    std::unique_ptr<TickStore> tickStore_;
+
+    // Main exchange pairs with 0 days outside the universe, from its tracked pairs.
+    std::vector<std::string> universePairs();
+
+    // Prepared by prepare() for preparedDate_: universe per exchange.
+    // Only a downloadData() of that same date uses them.
+    std::chrono::year_month_day preparedDate_ = EMPTY_DATE;
+    std::map<std::string, Universe> preparedUniverse_;
+
+    // Drops the prepared universes.
+    void clearPrepared();
+
+    /**************************************************************************************
+     * Purpose : Stores a batch of closed candles received on the kline stream into the
+     *           main exchange's ohlcv_data, like importOHLCV(). A candle is only kept if
+     *           the day before it is already stored: pairs with a hole (new pairs, missed
+     *           days) are left to the REST gap repair of the next daily run.
+     * Args    : data - Closed candles, pair → date → OHLCV.
+     * Return  : bool - true on success.
+     **************************************************************************************/
+    bool storeStreamedCandles(const OHLCVData& data);
+
+    /**************************************************************************************
+     * Purpose : Runs the daily pipeline of one exchange: tracked pairs, days missing,
+     *           klines and funding fetch, store. Network work runs unlocked; every SQLite
+     *           access holds `dbMutex`, so several exchanges can sync concurrently through
+     *           one connection. Only the main exchange (committed != nullptr) records a
+     *           data_version watermark.
+     *
+     * Args    : exchange  - Venue adapter.
+     *           tables    - Tables of this venue.
+     *           db        - Shared SQLite connection.
+     *           dbMutex   - Serialises access to db.
+     *           date      - Last complete day.
+     *           committed - Filled with the watermark (main exchange only, else nullptr).
+     *
+     * Return  : ExchangeSyncResult - Outcome for this exchange.
+     **************************************************************************************/
+    ExchangeSyncResult syncExchange(ExchangeAdapter& exchange, const ExchangeTables& tables,
+                                    SqliteConnection& db, std::mutex& dbMutex,
+                                    std::chrono::year_month_day date, DayCommitted* committed);
+
+    /**************************************************************************************
+     * Purpose : Creates (and migrates) the tracked pairs, OHLCV and funding tables of one
+     *           exchange.
+     * Args    : db     - SQLite connection.
+     *           tables - Table names of the exchange.
+     * Return  : bool - true on success.
+     **************************************************************************************/
+    bool ensureExchangeTables(SqliteConnection& db, const ExchangeTables& tables);
+
+    /**************************************************************************************
+     * Purpose : Opens (or creates) the OHLCV SQLite database on db_ and sets the schema up
+     *           (tables of every exchange, date_of_start, data_version / data_changes).
+     *           Runs once per connection, not once per download.
+     * Args    : None (database_path_)
+     * Return  : bool - true on success, false on failure (db_ left closed).
+     **************************************************************************************/
+    bool openDatabase();
+
+    // Opens db_ if it is not open yet (retry after a failed open). Return: true if usable.
+    bool ensureDatabase();
+
+    /**************************************************************************************
+     * Purpose : Moves the rows of an OHLCV table of the main database into its shards
+     *           (first open of a database configured for sharding).
+     * Args    : table - OHLCV table.
+     * Return  : bool - true on success.
+     **************************************************************************************/
+    bool migrateToShards(const std::string& table);
+
+    /**************************************************************************************
+     * Purpose : Records the first day of the dataset in date_of_start, if still empty.
+     * Args    : db       - SQLite connection.
+     *           yyyymmdd - Day being written.
+     * Return  : void
+     **************************************************************************************/
+    void recordDateOfStart(SqliteConnection& db, unsigned int yyyymmdd);
+
+    /**************************************************************************************
+     * Purpose : Read the tracked pairs of the latest date stored on or before `asOf`.
+     * Args    : db    - SQLite connection.
+     *           table - Tracked pairs table of the exchange.
+     *           asOf  - Point in time (YYYYMMDD, 0 = latest).
+     * Return  : TrackedData - Parsed struct. If empty, date == EMPTY_DATE.
+     **************************************************************************************/
+    TrackedData getTrackedPairs(SqliteConnection& db, const std::string& table, unsigned int asOf = 0);
+
+    /**************************************************************************************
+     * Purpose : Store the tracked pairs of data.date as a diff against the rows already
+     *           stored for that date, in one transaction. Earlier dates are kept.
+     * Args    : db    - SQLite connection.
+     *           table - Tracked pairs table of the exchange.
+     *           data  - TrackedData to write.
+     * Return  : bool - true on success.
+     **************************************************************************************/
+    bool storeTrackedPairs(SqliteConnection& db, const std::string& table, const TrackedData& data);
+
+    /**************************************************************************************
+     * Purpose : Compiles the statements the daily sync of one exchange starts with
+     *           (tracked pairs, last stored dates, candle upsert) and reads their pages.
+     * Args    : db     - SQLite connection.
+     *           tables - Tables of the exchange.
+     * Return  : bool - true on success.
+     **************************************************************************************/
+    bool primeStatements(SqliteConnection& db, const ExchangeTables& tables);
+
+    /**************************************************************************************
+     * Purpose : Converts a tracked pairs table of the single-JSON-row layout into the
+     *           relational one (no-op for tables already migrated or missing).
+     * Args    : db    - SQLite connection.
+     *           table - Tracked pairs table of the exchange.
+     * Return  : bool - true on success.
+     **************************************************************************************/
+    bool migrateTrackedPairs(SqliteConnection& db, const std::string& table);
+
+    /**************************************************************************************
+     * Purpose : Print tracked_pairs content for debugging/logging.
+     * Args    : db - SQLite connection.
+     **************************************************************************************/
+    void printTrackedData(SqliteConnection& db);
+
+    /**************************************************************************************
+     * Purpose : Stores funding events into a funding table (UPSERT on
+     *           (pair, funding_time)) in a single transaction.
+     *
+     * Args    : db    - SQLite connection (must be open).
+     *           table - Funding table of the exchange.
+     *           data  - FundingRateData containing pair → fundingTime → rate.
+     *
+     * Return  : bool - true on success, false on failure.
+     **************************************************************************************/
+    bool storeFundingRates(SqliteConnection& db, const std::string& table, const FundingRateData& data);
+
+    /**************************************************************************************
+     * Purpose : Stores OHLCV daily candles into the `ohlcv_data` table. Each candle is
+     *           stored as one row identified by (pair, date). Uses an UPSERT so calling
+     *           this multiple times for the same (pair, date) will overwrite previous
+     *           values safely. Rows are written in a single transaction that also
+     *           records a data_version watermark.
+     *
+     * Args    : db         - SQLite connection (must be open).
+     *           table      - OHLCV table of the exchange.
+     *           data       - OHLCVData containing pair → date → OHLCV.
+     *           targetDate - Date of the download the data belongs to.
+     *           committed  - Filled with the watermark version and changed ranges
+     *                        (nullptr = no watermark, for non-main exchanges).
+     *
+     * Return  : bool - true on success, false on failure.
+     **************************************************************************************/
+    bool storeDataOHLCV(SqliteConnection& db, const std::string& table, const OHLCVData& data,
+                        std::chrono::year_month_day targetDate,
+                        DayCommitted* committed);
+
+    /**************************************************************************************
+     * Purpose : Inserts the data_version row and the per-pair data_changes rows for the
+     *           data being stored. Runs inside the storeDataOHLCV transaction.
+     *
+     * Args    : db         - SQLite connection (transaction already open).
+     *           data       - OHLCVData being stored.
+     *           targetDate - Date of the download the data belongs to.
+     *           committed  - Filled with the new version and changed ranges.
+     *
+     * Return  : bool - true on success, false on failure.
+     **************************************************************************************/
+    bool recordDataVersion(SqliteConnection& db, const OHLCVData& data,
+                           std::chrono::year_month_day targetDate,
+                           DayCommitted& committed);
+
+    /**************************************************************************************
+     * Purpose : Prints all OHLCV rows stored for the latest date available in the 
+     *           `ohlcv_data` table. This is intended for debugging and verification that 
+     *           the daily fetch and storage operations are working correctly.
+     *
+     * Args    : db - Open SQLite connection.
+     *
+     * Return  : void
+     **************************************************************************************/
+    void printLatestOHLCV(SqliteConnection& db);
+
+    /**************************************************************************************
+     * Purpose : Publishes the latest window of bars and the indicator state of every pair
+     *           on the market data bus, if the stored data_version differs from the one
+     *           already published. Indicators are replayed over MARKET_BUS_WARMUP_DAYS
+     *           extra days so readers can continue them incrementally.
+     *
+     * Args    : db - Open SQLite connection.
+     *
+     * Return  : void
+     **************************************************************************************/
+    void refreshMarketBus(SqliteConnection& db);
+
+
+    /**************************************************************************************
+     * Purpose : Prints the OHLCV for BTCUSDT for the latest stored date in the database.
+     *
+     * Args    : db - Open SQLite connection.
+     * Return  : void
+     **************************************************************************************/
+    void printLatestBTCUSDT(SqliteConnection& db);
+
+    
+    /**************************************************************************************
+     * Purpose : For each tracked pair, determine how many days have passed since the last
+     *           OHLCV candle stored in the DB.
+     *
+     *           Rules:
+     *              - If pair has no rows → return 100
+     *              - If last date is > 100 days before current date → return 100
+     *              - Otherwise: return (currentYMD - lastStoredYMD)
+     *
+     * Args    : db          - open SQLite connection.
+     *           table       - OHLCV table of the exchange.
+     *           tracked     - TrackedData (contains the map<pair → days_out>).
+     *           currentYMD  - current date (year_month_day) to compare against.
+     *
+     * Return  : std::map<std::string,int> → map of pair → day difference.
+     **************************************************************************************/
+    std::map<std::string,int> computeDaysSinceLastStoredOHLCV(SqliteConnection& db, const std::string& table, const TrackedData& tracked, std::chrono::year_month_day currentDate);
+
+    // Latest date stored in `table` (YYYYMMDD, 0 if empty), from the shards if sharded.
+    int latestStoredDate(SqliteConnection& db, const std::string& table);
+
+    // Latest date stored for `pair` in `table` (YYYYMMDD, 0 if none), from the shards if sharded.
+    int lastStoredDate(SqliteConnection& db, const std::string& table, const std::string& pair);
+
+    /**************************************************************************************
+     * Purpose : Candles of `symbols` over [from, to] stored in `table`, read from the
+     *           shards if it is sharded and from `db` otherwise.
+     * Args    : db      - Open SQLite connection.
+     *           table   - OHLCV table of the exchange.
+     *           symbols - Symbols (empty = all).
+     *           from    - First date (YYYYMMDD, inclusive).
+     *           to      - Last date (YYYYMMDD, inclusive).
+     * Return  : BarColumns - Bars ordered by (symbol, date); empty on error.
+     **************************************************************************************/
+    BarColumns storedBars(SqliteConnection& db, const std::string& table,
+                          const std::vector<std::string>& symbols, int from, int to);
+    
+};
@@ -0,0 +1,612 @@
+#include "database_exchange_adapter.h"
+#include "database_exchange_binance.h"
+#include "database_http_cassette.h"
+#include "database_http_reactor.h"
+#include "logger.h"
+#include "database.h"        // writeCallback declaration
+#include "time_utils.h"
+
+#include <array>
+#include <atomic>
+#include <curl/curl.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************
+ * Process-wide HTTP traffic counters, summed
+ * over every httpGet() / HttpReactor transfer.
+ ***********************************************/
+namespace {
+    struct {
+        std::atomic<std::size_t> requests{0};
+        std::atomic<std::size_t> http2{0};
+        std::atomic<std::size_t> wireBytes{0};
+        std::atomic<std::size_t> bodyBytes{0};
+    } trafficTotals;
+}
+
+HttpTrafficStats& HttpTrafficStats::operator+=(const HttpTrafficStats& other) noexcept
+{
+    requests  += other.requests;
+    http2     += other.http2;
+    wireBytes += other.wireBytes;
+    bodyBytes += other.bodyBytes;
+    return *this;
+}
+
+HttpTrafficStats HttpTrafficStats::operator-(const HttpTrafficStats& other) const noexcept
+{
+    return { requests - other.requests, http2 - other.http2,
+             wireBytes - other.wireBytes, bodyBytes - other.bodyBytes };
+}
+
+/**************************************************************************************
+ * Purpose : Selects the universe among the listed symbols:
+ *              - Drops symbols without volume (settled or delisted contracts keep a
+ *                ticker) and those under policy.minQuoteVolume
+ *              - Ranks the rest by quote volume, ties by symbol so ranks are stable
+ *              - Keeps every one of them (policy.allSymbols) or the top N
+ *
+ * Args    : listed - Symbols with their 24h quote volume.
+ *           policy - Universe policy.
+ *
+ * Return  : Universe - Selected symbols with their rank and quote volume.
+ **************************************************************************************/
+Universe rankUniverse(std::vector<SymbolVolume> listed, const UniversePolicy& policy)
+{
+    std::erase_if(listed, [&](const SymbolVolume& s) {
+        return !(s.quoteVolume > 0.0) || s.quoteVolume < policy.minQuoteVolume;
+    });
+
+    std::sort(listed.begin(), listed.end(), [](const SymbolVolume& a, const SymbolVolume& b) {
+        return a.quoteVolume != b.quoteVolume ? a.quoteVolume > b.quoteVolume : a.symbol < b.symbol;
+    });
+
+    Universe result;
+    const std::size_t count = policy.allSymbols ? listed.size() : std::min(policy.topN, listed.size());
+    for (std::size_t i = 0; i < count; ++i)
+        result[listed[i].symbol] = UniverseEntry{static_cast<int>(i + 1), listed[i].quoteVolume};
+
+    return result;
+}
+
+/**************************************************************************************
+ * Purpose : Snapshot of the process-wide HTTP traffic counters.
+ * Args    : None
+ * Return  : HttpTrafficStats - Totals since start-up.
+ **************************************************************************************/
+HttpTrafficStats httpTrafficTotals()
+{
+    return { trafficTotals.requests.load(), trafficTotals.http2.load(),
+             trafficTotals.wireBytes.load(), trafficTotals.bodyBytes.load() };
+}
+
+/**************************************************************************************
+ * Purpose : Process-wide pool of libcurl easy handles. httpGet() borrows a handle and
+ *           gives it back afterwards, so the connection each handle keeps open is
+ *           reused by the next request (from any thread) instead of paying a fresh
+ *           TCP + TLS handshake. All handles attach to one share handle, so DNS
+ *           entries and TLS sessions are common to every connection.
+ *
+ *           The pool grows to the peak number of concurrent requests and never
+ *           shrinks; idle handles are only freed at exit.
+ **************************************************************************************/
+class CurlHandlePool {
+public:
+    static CurlHandlePool& Instance()
+    {
+        static CurlHandlePool pool;
+        return pool;
+    }
+
+    // Idle handle (reset to default options, connection kept), or a new one.
+    CURL* acquire()
+    {
+        CURL* curl = nullptr;
+        {
+            std::lock_guard lock(mutex_);
+            if (!idle_.empty()) {
+                curl = idle_.back();
+                idle_.pop_back();
+            }
+        }
+        if (curl)
+            curl_easy_reset(curl);
+        else
+            curl = curl_easy_init();
+        if (curl && share_)
+            curl_easy_setopt(curl, CURLOPT_SHARE, share_);
+        return curl;
+    }
+
+    void release(CURL* curl)
+    {
+        std::lock_guard lock(mutex_);
+        idle_.push_back(curl);
+    }
+
+private:
+    CURLSH* share_ = nullptr;
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> locks_;
+    std::mutex mutex_;
+    std::vector<CURL*> idle_;
+
+    CurlHandlePool()
+    {
+        share_ = curl_share_init();
+        if (!share_)
+            return;
+
+        curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &CurlHandlePool::lock);
+        curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &CurlHandlePool::unlock);
+        curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+
+    ~CurlHandlePool()
+    {
+        for (CURL* curl : idle_)
+            curl_easy_cleanup(curl);
+        if (share_)
+            curl_share_cleanup(share_);
+    }
+
+    static void lock(CURL*, curl_lock_data data, curl_lock_access, void* self)
+    {
+        static_cast<CurlHandlePool*>(self)->locks_[data].lock();
+    }
+
+    static void unlock(CURL*, curl_lock_data data, void* self)
+    {
+        static_cast<CurlHandlePool*>(self)->locks_[data].unlock();
+    }
+};
+
+/**************************************************************************************
+ * Purpose : Borrows an easy handle from the pool, set up with the options shared by
+ *           every REST request: negotiate compression (every encoding libcurl was
+ *           built with: gzip, deflate, brotli, zstd) and HTTP/2 over TLS, falling back
+ *           to HTTP/1.1 when the server does not offer it. The body is handed to
+ *           `response` already decompressed.
+ * Args    : url      - Request URL.
+ *           response - Receives the body.
+ * Return  : CURL* - Handle to give back with releaseRequestHandle(), nullptr on failure.
+ **************************************************************************************/
+CURL* acquireRequestHandle(const std::string& url, std::string& response)
+{
+    CURL* curl = CurlHandlePool::Instance().acquire();
+    if (!curl)
+        return nullptr;
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+    return curl;
+}
+
+void releaseRequestHandle(CURL* curl)
+{
+    CurlHandlePool::Instance().release(curl);
+}
+
+/**************************************************************************************
+ * Purpose : Adds one finished transfer to `stats` and to the process-wide totals.
+ *           Wire bytes are the headers plus the body as received (compressed); body
+ *           bytes are what the caller got after decompression.
+ * Args    : curl  - Easy handle of the finished transfer.
+ *           body  - Decompressed body.
+ *           stats - Counters to update (may be nullptr).
+ * Return  : void
+ **************************************************************************************/
+void countTransfer(CURL* curl, const std::string& body, HttpTrafficStats* stats)
+{
+    curl_off_t downloaded = 0;
+    long headerBytes = 0;
+    long version = 0;
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+    curl_easy_getinfo(curl, CURLINFO_HEADER_SIZE, &headerBytes);
+    curl_easy_getinfo(curl, CURLINFO_HTTP_VERSION, &version);
+
+    HttpTrafficStats t;
+    t.requests  = 1;
+    t.http2     = version == CURL_HTTP_VERSION_2_0 ? 1 : 0;
+    t.wireBytes = static_cast<std::size_t>(downloaded) + static_cast<std::size_t>(headerBytes);
+    t.bodyBytes = body.size();
+
+    trafficTotals.requests  += t.requests;
+    trafficTotals.http2     += t.http2;
+    trafficTotals.wireBytes += t.wireBytes;
+    trafficTotals.bodyBytes += t.bodyBytes;
+    if (stats)
+        *stats += t;
+}
+
+/**************************************************************************************
+ * Purpose : Time spent by a finished transfer.
+ * Args    : curl - Easy handle of the finished transfer.
+ * Return  : std::chrono::microseconds - Total transfer time.
+ **************************************************************************************/
+std::chrono::microseconds transferLatency(CURL* curl)
+{
+    curl_off_t us = 0;
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &us);
+    return std::chrono::microseconds(us);
+}
+
+/**************************************************************************************
+ * Purpose : Performs a blocking HTTPS GET and stores the body in `response`. Throttled
+ *           (418/429), server-side (5xx) and transport failures are retried with an
+ *           exponential backoff, up to policy.maxRetries times. With the HTTP cassette
+ *           recording, every response is saved with its latency; when replaying, the
+ *           recorded response is returned and the network is never used.
+ * Args    : url      - Full request URL.
+ *           response - Filled with the response body of the last attempt.
+ *           tag      - Prefix for log messages (usually exchange:pair).
+ *           policy   - Retry policy of the exchange.
+ * Return  : bool - true if a 2xx response was received.
+ **************************************************************************************/
+bool httpGet(const std::string& url, std::string& response, const std::string& tag,
+             const RateLimitPolicy& policy)
+{
+    HttpCassette& cassette = HttpCassette::Instance();
+    const CassetteMode cassetteMode = cassette.mode();
+
+    if (cassetteMode == CassetteMode::Replay)
+    {
+        long status = 0;
+        if (!cassette.replay(url, status, response)) {
+            LG_ERROR("[{}] Not in the HTTP cassette: {}", tag, url);
+            return false;
+        }
+        if (status >= 200 && status < 300)
+            return true;
+
+        LG_ERROR("[{}] HTTP {} (replayed): {}", tag, status, response.substr(0, 200));
+        return false;
+    }
+
+    auto backoff = policy.retryBackoff;
+
+    for (int attempt = 0; ; ++attempt)
+    {
+        response.clear();
+
+        CURL* curl = acquireRequestHandle(url, response);
+        if (!curl) {
+            LG_ERROR("[{}] CURL init failed", tag);
+            return false;
+        }
+
+        CURLcode rc = curl_easy_perform(curl);
+
+        long status = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+        const auto latency = transferLatency(curl);
+        countTransfer(curl, response, nullptr);
+        releaseRequestHandle(curl);
+
+        if (cassetteMode == CassetteMode::Record && rc == CURLE_OK)
+            cassette.record(url, status, response, latency);
+
+        if (rc == CURLE_OK && status >= 200 && status < 300)
+            return true;
+
+        const bool retryable = rc != CURLE_OK || status == 418 || status == 429 || status >= 500;
+
+        if (rc != CURLE_OK)
+            LG_ERROR("[{}] curl_easy_perform error: {}", tag, curl_easy_strerror(rc));
+        else
+            LG_ERROR("[{}] HTTP {}: {}", tag, status, response.substr(0, 200));
+
+        if (!retryable || attempt >= policy.maxRetries)
+            return false;
+
+        LG_WARN("[{}] Retrying in {} ms ({}/{})", tag, backoff.count(), attempt + 1, policy.maxRetries);
+        std::this_thread::sleep_for(backoff);
+        backoff *= 2;
+    }
+}
+
+/**************************************************************************************
+ * Purpose : One ping through a reactor; counts the successes.
+ **************************************************************************************/
+static FetchTask pingOnce(HttpReactor& reactor, std::string url, std::string tag,
+                          RateLimitPolicy policy, std::size_t& warmed)
+{
+    HttpResult response = co_await reactor.get(url, tag, policy);
+    if (response.ok())
+        ++warmed;
+}
+
+/**************************************************************************************
+ * Purpose : Pre-opens the venue's connections ahead of the daily fetch. The pings run
+ *           through a reactor of the venue, so the connections stay in its pooled multi
+ *           handle for the fetch reactors: one multiplexed HTTP/2 connection, or
+ *           maxConcurrent HTTP/1.1 ones. Nothing to warm when replaying a cassette.
+ * Args    : None
+ * Return  : void
+ **************************************************************************************/
+void ExchangeAdapter::warmUp() const
+{
+    const std::string url = pingUrl();
+    if (url.empty() || HttpCassette::Instance().mode() == CassetteMode::Replay)
+        return;
+
+    RateLimitPolicy policy = rateLimit();
+    policy.maxRetries = 0;                     // Best effort
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::size_t warmed = 0;
+    {
+        HttpReactor reactor(name(), policy.maxConcurrent);
+        for (std::size_t i = 0; i < policy.maxConcurrent; ++i)
+            pingOnce(reactor, url, name(), policy, warmed);
+        reactor.run();
+    }
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0);
+
+    LG_INFO("[{}] Warm-up: {}/{} pings in {} ms", name(), warmed, policy.maxConcurrent, ms.count());
+}
+
+/**************************************************************************************
+ * Purpose : Default funding fetch for venues without perpetual funding.
+ * Args    : targetDate     - Unused.
+ *           dataToDownload - Unused.
+ * Return  : FundingRateData - Empty.
+ **************************************************************************************/
+FundingRateData ExchangeAdapter::fetchFundingRates(
+    [[maybe_unused]] std::chrono::year_month_day targetDate,
+    [[maybe_unused]] const std::map<std::string,int>& dataToDownload)
+{
+    return {};
+}
+
+/**************************************************************************************
+ * Purpose : Kline fetch of one pair, as a reactor task: request (retried by the reactor
+ *           following `policy`), parse into `result`. Runs on the reactor's thread, so
+ *           writing `result` needs no lock.
+ * Args    : reactor  - Reactor driving the fetch.
+ *           exchange - Venue (request parser).
+ *           policy   - Retry policy.
+ *           pair     - Symbol.
+ *           url      - Klines request.
+ *           targetYmd - Last complete day.
+ *           result   - Receives the candles of `pair`.
+ * Return  : FetchTask
+ **************************************************************************************/
+static FetchTask fetchPairKlines(HttpReactor& reactor, const ExchangeAdapter& exchange,
+                                 const RateLimitPolicy& policy, std::string pair, std::string url,
+                                 int targetYmd, OHLCVData& result)
+{
+    const std::string tag = exchange.name() + ":" + pair;
+
+    HttpResult response = co_await reactor.get(url, tag, policy);
+    if (!response.ok())
+        co_return;
+
+    std::map<unsigned int, OHLCV> candles;
+    if (!exchange.parseKlines(response.body, targetYmd, candles)) {
+        LG_ERROR("[{}] Klines parse failed", tag);
+        co_return;
+    }
+    result.data[pair] = std::move(candles);
+}
+
+/**************************************************************************************
+ * Purpose : Fetch up to 100 days of OHLCV (1d candles) ending exactly at `targetDate`.
+ *           Caller guarantees `targetDate` is the last full day (e.g., yesterday).
+ *           The venue builds the URL and parses the body; windows, concurrency and the
+ *           merge are shared by every venue.
+ *
+ * Args    : targetDate     - YYYY-MM-DD date for last complete candle
+ *           dataToDownload - map<pair → days to download>
+ *
+ * Return  : OHLCVData - Structure: result.data[pair][YYYYMMDD] = OHLCV{...}
+ **************************************************************************************/
+OHLCVData ExchangeAdapter::fetchKlines(
+    std::chrono::year_month_day targetDate,
+    const std::map<std::string,int>& dataToDownload) const
+{
+    OHLCVData result;
+
+    const std::string venue  = name();
+    const RateLimitPolicy policy = rateLimit();
+
+    const int targetYmd = toYYYYMMDD(targetDate);
+    LG_INFO("[{}] TargetDate = {}", venue, targetYmd);
+
+    HttpReactor reactor(venue, policy.maxConcurrent);
+    for (const auto& [pair, days] : dataToDownload)
+    {
+        const int daysNeeded = std::clamp(days, 1, 100);
+
+        // [start 00:00, day after target 00:00)
+        const int startYmd = shiftDays(targetYmd, -(daysNeeded - 1));
+        const int endYmd   = static_cast<int>(nextDay(targetYmd));
+
+        LG_INFO(
+            "[{}:{}] Fetch {} days: {} → {} (endExclusive={})",
+            venue, pair, daysNeeded, startYmd, targetYmd, endYmd
+        );
+        fetchPairKlines(reactor, *this, policy, pair,
+                        klinesUrl(pair, daysNeeded, toUnixMillis(startYmd), toUnixMillis(endYmd)),
+                        targetYmd, result);
+    }
+
+    // Every pair is in flight or queued; the reactor drives them all from this thread
+    reactor.run();
+
+    const HttpTrafficStats& traffic = reactor.traffic();
+    LG_INFO("[{}] fetchKlines complete: {}/{} pairs, {} requests ({} over HTTP/2), "
+            "{} KiB received, {} KiB decompressed",
+            venue, result.data.size(), dataToDownload.size(), traffic.requests, traffic.http2,
+            traffic.wireBytes / 1024, traffic.bodyBytes / 1024);
+    return result;
+}
+
+/***********************************************
+ * Time window of the aggregated trades requests
+ * searching for the first trade of a day.
+ ***********************************************/
+static constexpr long long AGG_TRADES_WINDOW_MS = 60LL * 60 * 1000;
+
+/***********************************************
+ * Spaces the requests of several reactor tasks:
+ * each reservation returns the wait before the
+ * caller may send its request. Single-threaded,
+ * like the reactor.
+ ***********************************************/
+struct RequestPacer {
+    std::chrono::steady_clock::time_point next;
+    std::chrono::milliseconds             interval;
+
+    std::chrono::microseconds reserve()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        next = std::max(next, now);
+        const auto wait = std::chrono::duration_cast<std::chrono::microseconds>(next - now);
+        next += interval;
+        return wait;
+    }
+};
+
+/**************************************************************************************
+ * Purpose : Aggregated trades of one pair and day, as a reactor task. Hour windows are
+ *           requested until one holds a trade, then pages from the last id + 1 until a
+ *           trade falls on the next day (or nothing newer exists). Trades of the next
+ *           day are dropped. Any failed page abandons the pair.
+ * Args    : reactor    - Reactor driving the fetch.
+ *           exchange   - Venue (requests and parser).
+ *           policy     - Retry policy.
+ *           pacer      - Request spacing shared by every pair.
+ *           pair       - Symbol.
+ *           dayStartMs - Day start (Unix ms, inclusive).
+ *           dayEndMs   - Day end (Unix ms, exclusive).
+ *           onPair     - Receives the trades of the day.
+ *           handed     - Incremented when the pair was handed over.
+ * Return  : FetchTask
+ **************************************************************************************/
+static FetchTask fetchPairAggTrades(HttpReactor& reactor, const ExchangeAdapter& exchange,
+                                    const RateLimitPolicy& policy, RequestPacer& pacer, std::string pair,
+                                    long long dayStartMs, long long dayEndMs,
+                                    const ExchangeAdapter::AggTradesHandler& onPair, std::size_t& handed)
+{
+    const std::string tag = exchange.name() + ":" + pair;
+
+    std::vector<AggTrade> trades;
+    std::vector<AggTrade> page;
+    std::size_t requests = 0;
+    bool dayOver = false;
+
+    for (long long start = dayStartMs; !dayOver; )
+    {
+        std::string url;
+        if (trades.empty())
+        {
+            // Still looking for the first trade of the day
+            if (start >= dayEndMs)
+                break;
+            url = exchange.aggTradesUrl(pair, -1, start, std::min(start + AGG_TRADES_WINDOW_MS, dayEndMs) - 1);
+            start += AGG_TRADES_WINDOW_MS;
+        }
+        else
+        {
+            url = exchange.aggTradesUrl(pair, trades.back().id + 1, -1, -1);
+        }
+
+        co_await reactor.sleep(pacer.reserve());
+        HttpResult response = co_await reactor.get(std::move(url), tag, policy);
+        ++requests;
+        if (!response.ok())
+            co_return;
+
+        page.clear();
+        if (!exchange.parseAggTrades(response.body, page))
+        {
+            LG_ERROR("[{}] aggTrades parse failed", tag);
+            co_return;
+        }
+
+        // Paging past the newest trade: nothing more to read
+        if (page.empty() && !trades.empty())
+            break;
+
+        for (const AggTrade& t : page)
+        {
+            if (t.timeMs >= dayEndMs)
+            {
+                dayOver = true;
+                break;
+            }
+            if (t.timeMs >= dayStartMs)
+                trades.push_back(t);
+        }
+    }
+
+    LG_INFO("[{}] {} aggTrades in {} requests", tag, trades.size(), requests);
+    if (trades.empty())
+        co_return;
+
+    onPair(pair, trades);
+    ++handed;
+}
+
+/**************************************************************************************
+ * Purpose : Aggregated trades of `day` for every pair, one reactor task per pair. The
+ *           venue's aggTradesInterval() spaces the requests of all the tasks, so the
+ *           request weight stays within the venue's budget whatever the concurrency.
+ * Args    : day    - UTC day to fetch.
+ *           pairs  - Symbols.
+ *           onPair - Called on this thread for each complete pair with trades.
+ * Return  : std::size_t - Pairs handed over.
+ **************************************************************************************/
+std::size_t ExchangeAdapter::fetchAggTrades(std::chrono::year_month_day day, const std::vector<std::string>& pairs,
+                                            const AggTradesHandler& onPair) const
+{
+    const std::string venue = name();
+    if (aggTradesUrl("", -1, 0, 0).empty())
+    {
+        LG_WARN("[{}] No aggregated trades endpoint", venue);
+        return 0;
+    }
+
+    const RateLimitPolicy policy = rateLimit();
+    const int ymd = toYYYYMMDD(day);
+    const long long dayStartMs = toUnixMillis(ymd);
+    const long long dayEndMs   = toUnixMillis(static_cast<int>(nextDay(ymd)));
+
+    RequestPacer pacer{std::chrono::steady_clock::now(), aggTradesInterval()};
+    std::size_t handed = 0;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    {
+        HttpReactor reactor(venue, policy.maxConcurrent);
+        for (const auto& pair : pairs)
+            fetchPairAggTrades(reactor, *this, policy, pacer, pair, dayStartMs, dayEndMs, onPair, handed);
+        reactor.run();
+    }
+    const auto s = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - t0);
+
+    LG_INFO("[{}] fetchAggTrades {}: {}/{} pairs in {} s", venue, ymd, handed, pairs.size(), s.count());
+    return handed;
+}
+
+/**************************************************************************************
+ * Purpose : Creates the adapter of a venue by name.
+ * Args    : name - Venue identifier (e.g., "binance").
+ * Return  : std::unique_ptr<ExchangeAdapter> - nullptr if the venue is not supported.
+ **************************************************************************************/
+std::unique_ptr<ExchangeAdapter> makeExchangeAdapter(const std::string& name)
+{
+    if (name == "binance")
+        return std::make_unique<BinanceAdapter>();
+
+    LG_ERROR("Unsupported exchange '{}'", name);
+    return nullptr;
+}
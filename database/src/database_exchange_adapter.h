@@ -0,0 +1,253 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <curl/curl.h>
+#include "data_types.h"
+#include "database_configdata.h"
+
+/***********************************************
+ * Request policy of one exchange: concurrent
+ * requests and retries of throttled calls.
+ ***********************************************/
+struct RateLimitPolicy {
+    std::size_t               maxConcurrent = 8;       // Requests in flight
+    int                       maxRetries    = 2;       // Retries on HTTP 418/429/5xx and transport errors
+    std::chrono::milliseconds retryBackoff{1000};      // Wait before the first retry, doubled each time
+};
+
+/***********************************************
+ * Pair selected by the universe policy: rank by
+ * 24h quote volume (1 = highest) and volume.
+ ***********************************************/
+struct UniverseEntry {
+    int    rank        = 0;
+    double quoteVolume = 0.0;
+
+    bool operator==(const UniverseEntry&) const = default;
+};
+
+// Symbol → rank and volume of the pairs selected by the universe policy.
+using Universe = std::map<std::string, UniverseEntry>;
+
+/***********************************************
+ * Listed symbol with its 24h quote volume, as
+ * reported by a venue's ticker.
+ ***********************************************/
+struct SymbolVolume {
+    std::string symbol;
+    double      quoteVolume = 0.0;
+};
+
+/**************************************************************************************
+ * Purpose : Applies a universe policy to the symbols listed by a venue.
+ * Args    : listed - Symbols with their 24h quote volume.
+ *           policy - Universe policy.
+ * Return  : Universe - Selected symbols, ranked by quote volume (1 = highest).
+ **************************************************************************************/
+Universe rankUniverse(std::vector<SymbolVolume> listed, const UniversePolicy& policy);
+
+/***********************************************
+ * HTTP traffic counters. Wire bytes are headers
+ * plus body as received (compressed), body bytes
+ * are after decompression.
+ ***********************************************/
+struct HttpTrafficStats {
+    std::size_t requests  = 0;      // Completed transfers
+    std::size_t http2     = 0;      // Of which negotiated HTTP/2
+    std::size_t wireBytes = 0;      // Bytes received
+    std::size_t bodyBytes = 0;      // Bytes handed to the caller
+
+    HttpTrafficStats& operator+=(const HttpTrafficStats& other) noexcept;
+    HttpTrafficStats  operator-(const HttpTrafficStats& other) const noexcept;
+};
+
+// Traffic of every request made by this process so far.
+HttpTrafficStats httpTrafficTotals();
+
+/**************************************************************************************
+ * Purpose : Performs a blocking HTTPS GET and stores the body in `response`. Throttled
+ *           (418/429), server-side (5xx) and transport failures are retried following
+ *           `policy`. Compression and HTTP/2 are negotiated with the server.
+ * Args    : url      - Full request URL.
+ *           response - Filled with the response body of the last attempt.
+ *           tag      - Prefix for log messages (usually exchange:pair).
+ *           policy   - Retry policy of the exchange.
+ * Return  : bool - true if a 2xx response was received.
+ **************************************************************************************/
+bool httpGet(const std::string& url, std::string& response, const std::string& tag,
+             const RateLimitPolicy& policy);
+
+/**************************************************************************************
+ * Building blocks of httpGet(), shared with HttpReactor (database_http_reactor.h):
+ * pooled easy handles with the common request options, and traffic accounting.
+ **************************************************************************************/
+CURL* acquireRequestHandle(const std::string& url, std::string& response);
+void  releaseRequestHandle(CURL* curl);
+void  countTransfer(CURL* curl, const std::string& body, HttpTrafficStats* stats);
+std::chrono::microseconds transferLatency(CURL* curl);
+
+/**************************************************************************************
+ * Purpose : Venue-specific part of the daily ingestion. An adapter knows how to discover
+ *           the symbols worth tracking, how to request and parse daily klines, and how
+ *           hard the venue may be hit. The generic fetch loop (per-pair windows,
+ *           concurrency, merge) lives in fetchKlines() and is shared by every venue.
+ *
+ *           Adding a venue = one subclass + one entry in makeExchangeAdapter().
+ **************************************************************************************/
+class ExchangeAdapter {
+public:
+    virtual ~ExchangeAdapter() = default;
+
+    // Lowercase venue identifier (e.g. "binance"), also used in per-exchange table names.
+    virtual std::string name() const = 0;
+
+    // Concurrency and retry policy for this venue's REST API.
+    virtual RateLimitPolicy rateLimit() const noexcept = 0;
+
+    // Cheap endpoint used to warm connections before the daily burst (empty = none).
+    virtual std::string pingUrl() const { return {}; }
+
+    /**************************************************************************************
+     * Purpose : Symbol discovery: the USDT perpetual pairs selected by `policy` (every
+     *           listed pair, or the top N, by 24h quote volume above the minimum).
+     * Args    : policy - Universe policy.
+     * Return  : Universe - Symbols with their rank and quote volume (empty on failure).
+     **************************************************************************************/
+    virtual Universe discoverSymbols(const UniversePolicy& policy) = 0;
+
+    /**************************************************************************************
+     * Purpose : Builds the request for `days` daily klines of `pair` in [startMs, endMs).
+     * Args    : pair    - Symbol.
+     *           days    - Number of daily candles expected.
+     *           startMs - Window start (Unix ms, inclusive).
+     *           endMs   - Window end (Unix ms, exclusive).
+     * Return  : std::string - Request URL.
+     **************************************************************************************/
+    virtual std::string klinesUrl(const std::string& pair, int days, long long startMs, long long endMs) const = 0;
+
+    /**************************************************************************************
+     * Purpose : Response parser: decodes a klines response into daily candles.
+     * Args    : body      - Response body.
+     *           targetYmd - Last complete day; later candles are dropped.
+     *           out       - Filled with YYYYMMDD → OHLCV.
+     * Return  : bool - false if the body could not be parsed.
+     **************************************************************************************/
+    virtual bool parseKlines(const std::string& body, int targetYmd, std::map<unsigned int, OHLCV>& out) const = 0;
+
+    // Websocket endpoint of the kline streams, e.g. "wss://host" (empty = no streams).
+    virtual std::string klineStreamBase() const { return {}; }
+
+    /**************************************************************************************
+     * Purpose : Request path subscribing one websocket connection to the daily kline
+     *           streams of `pairs`.
+     * Args    : pairs - Symbols of the connection.
+     * Return  : std::string - Path and query, appended to klineStreamBase().
+     **************************************************************************************/
+    virtual std::string klineStreamPath([[maybe_unused]] const std::vector<std::string>& pairs) const { return {}; }
+
+    /**************************************************************************************
+     * Purpose : Stream parser: decodes a kline stream message if it carries a closed
+     *           daily candle. Updates of the candle still open are ignored.
+     * Args    : message - Text frame received.
+     *           pair    - Receives the symbol.
+     *           ymd     - Receives the candle day (YYYYMMDD).
+     *           candle  - Receives the final OHLCV.
+     * Return  : bool - true for a closed candle.
+     **************************************************************************************/
+    virtual bool parseClosedKline([[maybe_unused]] std::string_view message, [[maybe_unused]] std::string& pair,
+                                  [[maybe_unused]] unsigned int& ymd, [[maybe_unused]] OHLCV& candle) const
+    {
+        return false;
+    }
+
+    /**************************************************************************************
+     * Purpose : Builds an aggregated trades request: trades from id `fromId` on, or, when
+     *           fromId < 0, the trades of the time window [startMs, endMs] (at most one
+     *           hour). Empty = the venue has no aggregated trades.
+     * Args    : pair    - Symbol.
+     *           fromId  - First trade id (or -1).
+     *           startMs - Window start (Unix ms, inclusive), used when fromId < 0.
+     *           endMs   - Window end (Unix ms, inclusive), used when fromId < 0.
+     * Return  : std::string - Request URL.
+     **************************************************************************************/
+    virtual std::string aggTradesUrl([[maybe_unused]] const std::string& pair, [[maybe_unused]] long long fromId,
+                                     [[maybe_unused]] long long startMs, [[maybe_unused]] long long endMs) const
+    {
+        return {};
+    }
+
+    /**************************************************************************************
+     * Purpose : Aggregated trades parser: appends the trades of a response, in id order.
+     * Args    : body - Response body.
+     *           out  - Receives the trades.
+     * Return  : bool - false if the body could not be parsed.
+     **************************************************************************************/
+    virtual bool parseAggTrades([[maybe_unused]] const std::string& body,
+                                [[maybe_unused]] std::vector<AggTrade>& out) const
+    {
+        return false;
+    }
+
+    // Spacing between aggregated trades requests, for endpoints weighing more than klines.
+    virtual std::chrono::milliseconds aggTradesInterval() const noexcept { return std::chrono::milliseconds(0); }
+
+    // Receives the complete day of aggregated trades of one pair, sorted by id.
+    using AggTradesHandler = std::function<void(const std::string& pair, const std::vector<AggTrade>& trades)>;
+
+    /**************************************************************************************
+     * Purpose : Aggregated trades of one UTC day. Each pair is a coroutine on one
+     *           HttpReactor: hour windows until the first trade of the day, then pages
+     *           following the last trade id until the day is over. Requests of every
+     *           pair share the aggTradesInterval() pacing. A pair whose fetch fails is
+     *           not handed over (no partial day).
+     * Args    : day   - UTC day to fetch.
+     *           pairs - Symbols.
+     *           onPair - Called on this thread for each complete pair with trades.
+     * Return  : std::size_t - Pairs handed over.
+     **************************************************************************************/
+    std::size_t fetchAggTrades(std::chrono::year_month_day day, const std::vector<std::string>& pairs,
+                               const AggTradesHandler& onPair) const;
+
+    /**************************************************************************************
+     * Purpose : Funding-rate history over the same windows as the klines. Venues without
+     *           perpetual funding keep the default (no data).
+     * Args    : targetDate     - Last complete day.
+     *           dataToDownload - map<pair → days to download>
+     * Return  : FundingRateData - pair → fundingTime ms → rate
+     **************************************************************************************/
+    virtual FundingRateData fetchFundingRates(std::chrono::year_month_day targetDate,
+                                              const std::map<std::string,int>& dataToDownload);
+
+    /**************************************************************************************
+     * Purpose : Kline fetch: up to 100 daily candles per pair ending exactly at
+     *           `targetDate`. Each pair is a coroutine on one HttpReactor, so every
+     *           request runs from the calling thread under the venue's rate limit.
+     * Args    : targetDate     - Last complete day (e.g., yesterday).
+     *           dataToDownload - map<pair → days to download>
+     * Return  : OHLCVData - result.data[pair][YYYYMMDD] = OHLCV{...}
+     **************************************************************************************/
+    OHLCVData fetchKlines(std::chrono::year_month_day targetDate,
+                          const std::map<std::string,int>& dataToDownload) const;
+
+    /**************************************************************************************
+     * Purpose : Pre-opens the venue's connections (httpGet() pool and kline reactor)
+     *           so the next fetch does not pay DNS, TCP and TLS setup.
+     * Return  : void
+     **************************************************************************************/
+    void warmUp() const;
+};
+
+/**************************************************************************************
+ * Purpose : Creates the adapter of a venue by name.
+ * Args    : name - Venue identifier (e.g., "binance").
+ * Return  : std::unique_ptr<ExchangeAdapter> - nullptr if the venue is not supported.
+ **************************************************************************************/
+std::unique_ptr<ExchangeAdapter> makeExchangeAdapter(const std::string& name);
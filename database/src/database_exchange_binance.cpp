@@ -0,0 +1,349 @@
+#include "database_exchange_binance.h"
+#include "database_http_reactor.h"
+#include "logger.h"
+#include "time_utils.h"
+
+#include <cctype>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+/**************************************************************************************
+ * Purpose : Fetches the Binance USDT perpetual futures pairs of the universe using the
+ *           /fapi/v1/ticker/24hr endpoint, selected by rankUniverse.
+ * Args    : policy - Universe policy.
+ * Return  : Universe - Symbols (e.g., "BTCUSDT") with their rank and 24h quote volume.
+ **************************************************************************************/
+Universe BinanceAdapter::discoverSymbols(const UniversePolicy& policy)
+{
+    Universe result;
+    std::string response;
+
+    if (!httpGet("https://fapi.binance.com/fapi/v1/ticker/24hr", response, "binance", rateLimit()))
+        return result;
+
+    json tickers;
+    try {
+        tickers = json::parse(response);
+    }
+    catch (...) {
+        LG_ERROR("[binance] Ticker JSON parse failed");
+        return result;
+    }
+
+    std::vector<SymbolVolume> listed;
+
+    for (auto& item : tickers)
+    {
+        std::string symbol = item["symbol"].get<std::string>();
+
+        // USDT perpetual only
+        if (symbol.size() > 4 && symbol.substr(symbol.size() - 4) == "USDT")
+            listed.push_back({symbol, std::stod(item["quoteVolume"].get<std::string>())});
+    }
+
+    return rankUniverse(std::move(listed), policy);
+}
+
+/**************************************************************************************
+ * Purpose : Builds the /fapi/v1/klines request for daily candles of one pair.
+ * Args    : pair    - Symbol.
+ *           days    - Number of candles (limit).
+ *           startMs - Window start (Unix ms, inclusive).
+ *           endMs   - Window end (Unix ms, exclusive).
+ * Return  : std::string - Request URL.
+ **************************************************************************************/
+std::string BinanceAdapter::klinesUrl(const std::string& pair, int days, long long startMs, long long endMs) const
+{
+    return fmt::format(
+        "https://fapi.binance.com/fapi/v1/klines"
+        "?symbol={}&interval=1d&limit={}&startTime={}&endTime={}",
+        pair, days, startMs, endMs
+    );
+}
+
+/**************************************************************************************
+ * Purpose : Parses a /fapi/v1/klines response. Each candle is an array:
+ *           [0] open time, [1..5] OHLCV, [7] quote volume, [8] trade count,
+ *           [9] taker buy base volume, [10] taker buy quote volume.
+ * Args    : body      - Response body.
+ *           targetYmd - Last complete day; later candles are dropped.
+ *           out       - Filled with YYYYMMDD → OHLCV.
+ * Return  : bool - false if the body is not a klines array.
+ **************************************************************************************/
+bool BinanceAdapter::parseKlines(const std::string& body, int targetYmd, std::map<unsigned int, OHLCV>& out) const
+{
+    json j;
+    try {
+        j = json::parse(body);
+    }
+    catch (...) {
+        return false;
+    }
+
+    if (!j.is_array())
+        return false;
+
+    for (auto& arr : j)
+    {
+        long long openTime = arr[0].get<long long>();
+
+        auto tp_days = std::chrono::floor<std::chrono::days>(
+            std::chrono::system_clock::time_point(
+                std::chrono::milliseconds(openTime))
+        );
+
+        int ymd = toYYYYMMDD(std::chrono::year_month_day(tp_days));
+
+        // Extra safety: skip future candles
+        if (ymd > targetYmd)
+            continue;
+
+        OHLCV c;
+        c.open   = std::stod(arr[1].get<std::string>());
+        c.high   = std::stod(arr[2].get<std::string>());
+        c.low    = std::stod(arr[3].get<std::string>());
+        c.close  = std::stod(arr[4].get<std::string>());
+        c.volume = std::stod(arr[5].get<std::string>());
+
+        // Extended fields of the same payload
+        c.quoteVolume         = std::stod(arr[7].get<std::string>());
+        c.trades              = arr[8].get<double>();
+        c.takerBuyVolume      = std::stod(arr[9].get<std::string>());
+        c.takerBuyQuoteVolume = std::stod(arr[10].get<std::string>());
+
+        out[static_cast<unsigned int>(ymd)] = c;
+    }
+
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Builds the combined stream path of the daily klines of `pairs`
+ *           (/stream?streams=btcusdt@kline_1d/ethusdt@kline_1d/...).
+ * Args    : pairs - Symbols of the connection.
+ * Return  : std::string - Path and query.
+ **************************************************************************************/
+std::string BinanceAdapter::klineStreamPath(const std::vector<std::string>& pairs) const
+{
+    std::string path = "/stream?streams=";
+    for (std::size_t i = 0; i < pairs.size(); ++i)
+    {
+        if (i > 0)
+            path += '/';
+        for (char c : pairs[i])
+            path += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        path += "@kline_1d";
+    }
+    return path;
+}
+
+/**************************************************************************************
+ * Purpose : Parses a combined stream message {"stream":..,"data":{"e":"kline","k":{..}}}.
+ *           The candle is sent several times per second while open; only the final
+ *           update (k.x == true) is decoded, the others are rejected before any JSON
+ *           parsing.
+ * Args    : message - Text frame received.
+ *           pair    - Receives the symbol.
+ *           ymd     - Receives the candle day (YYYYMMDD).
+ *           candle  - Receives the final OHLCV.
+ * Return  : bool - true for a closed daily candle.
+ **************************************************************************************/
+bool BinanceAdapter::parseClosedKline(std::string_view message, std::string& pair,
+                                      unsigned int& ymd, OHLCV& candle) const
+{
+    if (message.find("\"x\":true") == std::string_view::npos)
+        return false;
+
+    try {
+        const json j = json::parse(message);
+        const json& k = j.contains("data") ? j["data"]["k"] : j["k"];
+
+        if (!k.value("x", false) || k.value("i", std::string{}) != "1d")
+            return false;
+
+        auto tp_days = std::chrono::floor<std::chrono::days>(
+            std::chrono::system_clock::time_point(
+                std::chrono::milliseconds(k["t"].get<long long>()))
+        );
+
+        pair = k["s"].get<std::string>();
+        ymd  = static_cast<unsigned int>(toYYYYMMDD(std::chrono::year_month_day(tp_days)));
+
+        candle.open   = std::stod(k["o"].get<std::string>());
+        candle.high   = std::stod(k["h"].get<std::string>());
+        candle.low    = std::stod(k["l"].get<std::string>());
+        candle.close  = std::stod(k["c"].get<std::string>());
+        candle.volume = std::stod(k["v"].get<std::string>());
+
+        candle.quoteVolume         = std::stod(k["q"].get<std::string>());
+        candle.trades              = k["n"].get<double>();
+        candle.takerBuyVolume      = std::stod(k["V"].get<std::string>());
+        candle.takerBuyQuoteVolume = std::stod(k["Q"].get<std::string>());
+    }
+    catch (const std::exception& e) {
+        LG_ERROR("[binance] Kline stream message parse failed: {}", e.what());
+        return false;
+    }
+
+    return true;
+}
+
+static constexpr int AGG_TRADES_PAGE_LIMIT = 1000;
+
+/**************************************************************************************
+ * Purpose : Builds a /fapi/v1/aggTrades request, by id or by time window (Binance
+ *           rejects windows of one hour or more).
+ * Args    : pair    - Symbol.
+ *           fromId  - First trade id (or -1 for the window).
+ *           startMs - Window start (Unix ms, inclusive).
+ *           endMs   - Window end (Unix ms, inclusive).
+ * Return  : std::string - Request URL.
+ **************************************************************************************/
+std::string BinanceAdapter::aggTradesUrl(const std::string& pair, long long fromId, long long startMs,
+                                         long long endMs) const
+{
+    if (fromId >= 0)
+        return fmt::format(
+            "https://fapi.binance.com/fapi/v1/aggTrades?symbol={}&fromId={}&limit={}",
+            pair, fromId, AGG_TRADES_PAGE_LIMIT
+        );
+
+    return fmt::format(
+        "https://fapi.binance.com/fapi/v1/aggTrades?symbol={}&startTime={}&endTime={}&limit={}",
+        pair, startMs, endMs, AGG_TRADES_PAGE_LIMIT
+    );
+}
+
+/**************************************************************************************
+ * Purpose : Parses a /fapi/v1/aggTrades response: objects with "a" (aggregate id),
+ *           "p" price, "q" quantity, "T" time and "m" (buyer is the maker).
+ * Args    : body - Response body.
+ *           out  - Receives the trades, in id order.
+ * Return  : bool - false if the body is not a trades array.
+ **************************************************************************************/
+bool BinanceAdapter::parseAggTrades(const std::string& body, std::vector<AggTrade>& out) const
+{
+    try {
+        const json j = json::parse(body);
+        if (!j.is_array())
+            return false;
+
+        out.reserve(out.size() + j.size());
+        for (const auto& item : j)
+        {
+            out.push_back(AggTrade{
+                item["a"].get<long long>(),
+                item["T"].get<long long>(),
+                std::stod(item["p"].get<std::string>()),
+                std::stod(item["q"].get<std::string>()),
+                item["m"].get<bool>()
+            });
+        }
+    }
+    catch (const std::exception& e) {
+        LG_ERROR("[binance] aggTrades parse failed: {}", e.what());
+        return false;
+    }
+
+    return true;
+}
+
+static constexpr int FUNDING_PAGE_LIMIT = 1000;
+
+/**************************************************************************************
+ * Purpose : Funding history of one pair, as a reactor task: pages of FUNDING_PAGE_LIMIT
+ *           events are requested one after the other until the window is exhausted.
+ * Args    : reactor - Reactor driving the fetch.
+ *           policy  - Retry policy.
+ *           pair    - Symbol.
+ *           startMs - Window start (Unix ms, inclusive).
+ *           endMs   - Window end (Unix ms, inclusive).
+ *           result  - Receives the events of `pair` (nothing if a page fails).
+ * Return  : FetchTask
+ **************************************************************************************/
+static FetchTask fetchPairFunding(HttpReactor& reactor, RateLimitPolicy policy, std::string pair,
+                                  long long startMs, long long endMs, FundingRateData& result)
+{
+    const std::string tag = "binance:" + pair;
+
+    std::map<long long, double> local;
+    long long cursor = startMs;
+
+    while (cursor <= endMs)
+    {
+        std::string url = fmt::format(
+            "https://fapi.binance.com/fapi/v1/fundingRate"
+            "?symbol={}&startTime={}&endTime={}&limit={}",
+            pair, cursor, endMs, FUNDING_PAGE_LIMIT
+        );
+
+        HttpResult response = co_await reactor.get(std::move(url), tag, policy);
+        if (!response.ok())
+            co_return;
+
+        json j;
+        try {
+            j = json::parse(response.body);
+        }
+        catch (...) {
+            LG_ERROR("[{}] Funding JSON parse failed", tag);
+            co_return;
+        }
+
+        if (!j.is_array() || j.empty())
+            break;
+
+        long long lastTime = cursor;
+        for (auto& item : j)
+        {
+            lastTime = item["fundingTime"].get<long long>();
+            local[lastTime] = std::stod(item["fundingRate"].get<std::string>());
+        }
+
+        if (static_cast<int>(j.size()) < FUNDING_PAGE_LIMIT)
+            break;
+
+        cursor = lastTime + 1;         // Next page starts after the last event
+    }
+
+    LG_INFO("[{}] {} funding events", tag, local.size());
+    result.data[pair] = std::move(local);
+}
+
+/**************************************************************************************
+ * Purpose : Fetch the funding-rate history (/fapi/v1/fundingRate) of each pair over the
+ *           same window as its OHLCV download, ending at the close of `targetDate`.
+ *           Pairs on 1h/4h funding intervals need several pages. Every pair is a task
+ *           of one reactor, like the klines.
+ *
+ * Args    : targetDate     - Last complete day.
+ *           dataToDownload - map<pair → days to download>
+ *
+ * Return  : FundingRateData - result.data[pair][fundingTime ms] = rate
+ **************************************************************************************/
+FundingRateData BinanceAdapter::fetchFundingRates(
+    std::chrono::year_month_day targetDate,
+    const std::map<std::string,int>& dataToDownload)
+{
+    FundingRateData result;
+    const RateLimitPolicy policy = rateLimit();
+
+    const int targetYmd = toYYYYMMDD(targetDate);
+
+    HttpReactor reactor(name(), policy.maxConcurrent);
+    for (const auto& [pair, days] : dataToDownload)
+    {
+        const int daysNeeded = std::clamp(days, 1, 100);
+
+        // [start 00:00, day after target 00:00)
+        const long long startMs = toUnixMillis(shiftDays(targetYmd, -(daysNeeded - 1)));
+        const long long endMs   = toUnixMillis(static_cast<int>(nextDay(targetYmd))) - 1;
+
+        fetchPairFunding(reactor, policy, pair, startMs, endMs, result);
+    }
+    reactor.run();
+
+    LG_INFO("[binance] fetchFundingRates complete.");
+    return result;
+}
@@ -0,0 +1,154 @@
+#include "database_http_cassette.h"
+#include "binary_io.h"
+#include "logger.h"
+
+#include <cstdint>
+#include <thread>
+
+/***********************************************
+ * Cassette entry header ("HCS1").
+ ***********************************************/
+static constexpr uint32_t CASSETTE_MAGIC = 0x31534348;
+
+HttpCassette& HttpCassette::Instance()
+{
+    static HttpCassette instance;
+    return instance;
+}
+
+/**************************************************************************************
+ * Purpose : Applies the cassette settings. Recording creates the directory; replaying
+ *           an empty or missing directory is reported but not fatal (every request will
+ *           then fail as a miss).
+ * Args    : settings - Cassette settings from the database configuration.
+ * Return  : void
+ **************************************************************************************/
+void HttpCassette::Configure(const HttpCassetteSettings& settings)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    settings_ = settings;
+
+    switch (settings_.mode)
+    {
+    case CassetteMode::Off:
+        return;
+
+    case CassetteMode::Record:
+    {
+        boost::system::error_code ec;
+        boost::filesystem::create_directories(settings_.directory, ec);
+        if (ec)
+            LG_ERROR("HTTP cassette: cannot create {}: {}", settings_.directory.string(), ec.message());
+        LG_INFO("HTTP cassette: recording to {}", settings_.directory.string());
+        return;
+    }
+
+    case CassetteMode::Replay:
+        if (!boost::filesystem::is_directory(settings_.directory))
+            LG_ERROR("HTTP cassette: {} does not exist, every request will miss", settings_.directory.string());
+        LG_INFO("HTTP cassette: replaying {} (latency x{})", settings_.directory.string(), settings_.latencyScale);
+        return;
+    }
+}
+
+CassetteMode HttpCassette::mode() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return settings_.mode;
+}
+
+boost::filesystem::path HttpCassette::entryPath(const std::string& url) const
+{
+    return settings_.directory / fmt::format("{:016x}.http", fnv1a64(url));
+}
+
+/**************************************************************************************
+ * Purpose : Looks up the recorded response of `url` and waits its scaled latency.
+ * Args    : url    - Request URL.
+ *           status - Receives the recorded HTTP status.
+ *           body   - Receives the recorded body.
+ * Return  : bool - false if the URL was never recorded (or the entry is unreadable).
+ **************************************************************************************/
+bool HttpCassette::replay(const std::string& url, long& status, std::string& body)
+{
+    std::chrono::microseconds delay{0};
+    if (!lookup(url, status, body, delay))
+        return false;
+
+    if (delay.count() > 0)
+        std::this_thread::sleep_for(delay);
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Reads the recorded response of `url` without waiting, for callers that
+ *           schedule the wait themselves (the HttpReactor completes the request on a
+ *           timer instead of blocking its thread).
+ * Args    : url    - Request URL.
+ *           status - Receives the recorded HTTP status.
+ *           body   - Receives the recorded body.
+ *           delay  - Receives the recorded latency × latencyScale.
+ * Return  : bool - false if the URL was never recorded (or the entry is unreadable).
+ **************************************************************************************/
+bool HttpCassette::lookup(const std::string& url, long& status, std::string& body,
+                          std::chrono::microseconds& delay)
+{
+    boost::filesystem::path path;
+    double scale;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        path  = entryPath(url);
+        scale = settings_.latencyScale;
+    }
+
+    std::string raw;
+    if (!readFile(path, raw))
+        return false;
+
+    std::chrono::microseconds latency{0};
+    try {
+        BinaryReader in(raw);
+        if (in.read<uint32_t>() != CASSETTE_MAGIC || in.readString() != url)
+            return false;                          // Foreign file or hash collision
+        status  = static_cast<long>(in.read<int64_t>());
+        latency = std::chrono::microseconds(in.read<int64_t>());
+        body    = in.readString();
+    }
+    catch (const std::exception& e) {
+        LG_ERROR("HTTP cassette: corrupt entry {}: {}", path.string(), e.what());
+        return false;
+    }
+
+    delay = scale > 0.0 ? std::chrono::duration_cast<std::chrono::microseconds>(latency * scale)
+                        : std::chrono::microseconds(0);
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Stores the response of `url`, atomically (concurrent fetch threads record
+ *           different URLs; a retried URL keeps its last response).
+ * Args    : url     - Request URL.
+ *           status  - HTTP status.
+ *           body    - Response body.
+ *           latency - Time the request took.
+ * Return  : void
+ **************************************************************************************/
+void HttpCassette::record(const std::string& url, long status, const std::string& body,
+                          std::chrono::microseconds latency)
+{
+    boost::filesystem::path path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        path = entryPath(url);
+    }
+
+    BinaryWriter out;
+    out.write(CASSETTE_MAGIC);
+    out.writeString(url);
+    out.write(static_cast<int64_t>(status));
+    out.write(static_cast<int64_t>(latency.count()));
+    out.writeString(body);
+
+    if (!writeFileAtomic(path, out.data()))
+        LG_ERROR("HTTP cassette: could not record {}", url);
+}
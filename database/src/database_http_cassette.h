@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <boost/filesystem.hpp>
+#include "database_configdata.h"
+
+/**************************************************************************************
+ * Purpose : Record / replay layer under httpGet(). In Record mode every response that
+ *           reached the server (status, body and wall-clock latency) is written to the
+ *           cassette directory, one file per URL. In Replay mode httpGet() never
+ *           touches the network: responses come from the cassette after sleeping the
+ *           recorded latency × latencyScale (0 = as fast as possible), so fetch,
+ *           parsing and storage can be benchmarked and profiled run to run.
+ *
+ *           Replaying a daily run needs the same URLs: run the same date (--once)
+ *           against a copy of the database as it was when recording.
+ *
+ *           Process-wide, like the logger: configured once by DatabaseDownloader.
+ **************************************************************************************/
+class HttpCassette {
+public:
+    static HttpCassette& Instance();
+
+    // Applies the settings (creates the directory when recording).
+    void Configure(const HttpCassetteSettings& settings);
+
+    CassetteMode mode() const;
+
+    /**************************************************************************************
+     * Purpose : Looks up the recorded response of `url` and waits its scaled latency.
+     * Args    : url    - Request URL.
+     *           status - Receives the recorded HTTP status.
+     *           body   - Receives the recorded body.
+     * Return  : bool - false if the URL was never recorded.
+     **************************************************************************************/
+    bool replay(const std::string& url, long& status, std::string& body);
+
+    /**************************************************************************************
+     * Purpose : Same lookup as replay(), but returns the scaled latency instead of
+     *           sleeping it.
+     * Args    : url    - Request URL.
+     *           status - Receives the recorded HTTP status.
+     *           body   - Receives the recorded body.
+     *           delay  - Receives the time the response should take.
+     * Return  : bool - false if the URL was never recorded.
+     **************************************************************************************/
+    bool lookup(const std::string& url, long& status, std::string& body,
+                std::chrono::microseconds& delay);
+
+    /**************************************************************************************
+     * Purpose : Stores the response of `url` (overwrites a previous recording).
+     * Args    : url     - Request URL.
+     *           status  - HTTP status.
+     *           body    - Response body.
+     *           latency - Time the request took.
+     * Return  : void
+     **************************************************************************************/
+    void record(const std::string& url, long status, const std::string& body,
+                std::chrono::microseconds latency);
+
+private:
+    HttpCassette() = default;
+
+    mutable std::mutex   mutex_;
+    HttpCassetteSettings settings_;
+
+    boost::filesystem::path entryPath(const std::string& url) const;
+};
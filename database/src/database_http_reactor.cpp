@@ -0,0 +1,322 @@
+#include "database_http_reactor.h"
+#include "database_http_cassette.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**************************************************************************************
+ * Purpose : Process-wide pool of curl multi handles, one stack per venue. A multi
+ *           handle owns the connections of its transfers; keeping it between reactors
+ *           keeps those connections open for the next batch.
+ **************************************************************************************/
+class CurlMultiPool {
+public:
+    static CurlMultiPool& Instance()
+    {
+        static CurlMultiPool pool;
+        return pool;
+    }
+
+    CURLM* acquire(const std::string& name)
+    {
+        {
+            std::lock_guard lock(mutex_);
+            auto& idle = idle_[name];
+            if (!idle.empty()) {
+                CURLM* multi = idle.back();
+                idle.pop_back();
+                return multi;
+            }
+        }
+
+        CURLM* multi = curl_multi_init();
+        if (multi)
+            curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+        return multi;
+    }
+
+    void release(const std::string& name, CURLM* multi)
+    {
+        std::lock_guard lock(mutex_);
+        idle_[name].push_back(multi);
+    }
+
+private:
+    std::mutex mutex_;
+    std::map<std::string, std::vector<CURLM*>> idle_;
+
+    CurlMultiPool() = default;
+
+    ~CurlMultiPool()
+    {
+        for (auto& [_, idle] : idle_)
+            for (CURLM* multi : idle)
+                curl_multi_cleanup(multi);
+    }
+};
+
+std::string HttpResult::describe() const
+{
+    if (rc != CURLE_OK)
+        return fmt::format("curl error: {}", curl_easy_strerror(rc));
+    if (status == 0)
+        return "no response";
+    return fmt::format("HTTP {}: {}", status, body.substr(0, 200));
+}
+
+void FetchTask::promise_type::unhandled_exception() noexcept
+{
+    try {
+        throw;
+    }
+    catch (const std::exception& e) {
+        LG_ERROR("Fetch task failed: {}", e.what());
+    }
+    catch (...) {
+        LG_ERROR("Fetch task failed: unknown exception");
+    }
+}
+
+/**************************************************************************************
+ * Purpose : Takes the venue's multi handle from the pool (or creates it). HTTP/1.1
+ *           fallback opens at most `maxInFlight` connections to a host.
+ * Args    : name        - Venue identifier (pool key and log prefix).
+ *           maxInFlight - Transfers running at the same time.
+ **************************************************************************************/
+HttpReactor::HttpReactor(std::string name, std::size_t maxInFlight)
+    : name_(std::move(name)),
+      maxInFlight_(std::max<std::size_t>(maxInFlight, 1)),
+      multi_(CurlMultiPool::Instance().acquire(name_))
+{
+    if (!multi_)
+        LG_ERROR("[{}] curl_multi_init failed", name_);
+    else
+        curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(maxInFlight_));
+}
+
+/**************************************************************************************
+ * Purpose : Gives the multi handle back to the pool. Coroutines still suspended (run()
+ *           was not called or did not finish) are destroyed with their transfers.
+ **************************************************************************************/
+HttpReactor::~HttpReactor()
+{
+    for (Request* request : active_)
+    {
+        curl_multi_remove_handle(multi_, request->curl_);
+        releaseRequestHandle(request->curl_);
+        request->handle_.destroy();
+    }
+    for (Request* request : queued_)
+        request->handle_.destroy();
+    for (auto& [_, timer] : timers_)
+        timer.handle.destroy();
+
+    if (multi_)
+        CurlMultiPool::Instance().release(name_, multi_);
+}
+
+/**************************************************************************************
+ * Purpose : Called when a coroutine awaits a request. Replayed responses are scheduled
+ *           on a timer (recorded failures are returned as they are, not retried); live
+ *           requests wait in the queue for a transfer slot.
+ * Args    : request - Awaiter living in the suspended coroutine frame.
+ *           handle  - Coroutine to resume once the result is in `request`.
+ * Return  : void
+ **************************************************************************************/
+void HttpReactor::submit(Request* request, std::coroutine_handle<> handle)
+{
+    request->handle_ = handle;
+
+    HttpCassette& cassette = HttpCassette::Instance();
+    if (cassette.mode() == CassetteMode::Replay)
+    {
+        std::chrono::microseconds delay{0};
+        if (!cassette.lookup(request->url_, request->result_.status, request->result_.body, delay))
+            LG_ERROR("[{}] Not in the HTTP cassette: {}", request->tag_, request->url_);
+        else if (!request->result_.ok())
+            LG_ERROR("[{}] {} (replayed)", request->tag_, request->result_.describe());
+
+        timers_.emplace(std::chrono::steady_clock::now() + delay, Timer{handle, nullptr});
+        return;
+    }
+
+    enqueue(request);
+}
+
+/**************************************************************************************
+ * Purpose : Queues an attempt of `request`, clearing the previous attempt's result.
+ * Args    : request - Request to (re)send.
+ * Return  : void
+ **************************************************************************************/
+void HttpReactor::enqueue(Request* request)
+{
+    request->result_ = HttpResult{};
+    queued_.push_back(request);
+}
+
+/**************************************************************************************
+ * Purpose : Moves queued requests onto the multi handle while slots are free.
+ * Args    : None
+ * Return  : void
+ **************************************************************************************/
+void HttpReactor::startQueued()
+{
+    while (!queued_.empty() && active_.size() < maxInFlight_)
+    {
+        Request* request = queued_.front();
+        queued_.pop_front();
+
+        request->curl_ = multi_ ? acquireRequestHandle(request->url_, request->result_.body) : nullptr;
+        if (!request->curl_)
+        {
+            LG_ERROR("[{}] CURL init failed", request->tag_);
+            request->result_.rc = CURLE_FAILED_INIT;
+            timers_.emplace(std::chrono::steady_clock::now(), Timer{request->handle_, nullptr});
+            continue;
+        }
+
+        // Wait for the connection being set up rather than opening another one
+        curl_easy_setopt(request->curl_, CURLOPT_PIPEWAIT, 1L);
+        curl_easy_setopt(request->curl_, CURLOPT_PRIVATE, request);
+
+        curl_multi_add_handle(multi_, request->curl_);
+        active_.insert(request);
+    }
+}
+
+/**************************************************************************************
+ * Purpose : Completes a transfer: accounting, cassette recording, handle back to the
+ *           pool. A retryable failure with retries left is re-queued after the backoff;
+ *           otherwise the coroutine resumes (and may submit new requests).
+ * Args    : request - Finished request.
+ *           rc      - Transfer result.
+ * Return  : void
+ **************************************************************************************/
+void HttpReactor::finish(Request* request, CURLcode rc)
+{
+    CURL* curl = request->curl_;
+    HttpResult& result = request->result_;
+
+    result.rc = rc;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &result.status);
+    countTransfer(curl, result.body, &traffic_);
+
+    HttpCassette& cassette = HttpCassette::Instance();
+    if (rc == CURLE_OK && cassette.mode() == CassetteMode::Record)
+        cassette.record(request->url_, result.status, result.body, transferLatency(curl));
+
+    curl_multi_remove_handle(multi_, curl);
+    releaseRequestHandle(curl);
+    request->curl_ = nullptr;
+    active_.erase(request);
+
+    if (!result.ok())
+    {
+        LG_ERROR("[{}] {}", request->tag_, result.describe());
+
+        if (result.retryable() && request->attempt_ < request->maxRetries_)
+        {
+            ++request->attempt_;
+            LG_WARN("[{}] Retrying in {} ms ({}/{})", request->tag_, request->backoff_.count(),
+                    request->attempt_, request->maxRetries_);
+            timers_.emplace(std::chrono::steady_clock::now() + request->backoff_, Timer{request->handle_, request});
+            request->backoff_ *= 2;
+            return;
+        }
+    }
+
+    request->handle_.resume();
+}
+
+/**************************************************************************************
+ * Purpose : Completes every transfer curl reports as done.
+ * Args    : None
+ * Return  : void
+ **************************************************************************************/
+void HttpReactor::completeTransfers()
+{
+    int queued = 0;
+    while (CURLMsg* msg = curl_multi_info_read(multi_, &queued))
+    {
+        if (msg->msg != CURLMSG_DONE)
+            continue;
+
+        Request* request = nullptr;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &request);
+        finish(request, msg->data.result);
+    }
+}
+
+/**************************************************************************************
+ * Purpose : Handles the expired timers: re-queues the retries and resumes the other
+ *           coroutines (sleeps, replayed and failed-to-start requests).
+ * Args    : None
+ * Return  : void
+ **************************************************************************************/
+void HttpReactor::resumeDueTimers()
+{
+    const auto now = std::chrono::steady_clock::now();
+    while (!timers_.empty() && timers_.begin()->first <= now)
+    {
+        const Timer timer = timers_.begin()->second;
+        timers_.erase(timers_.begin());
+
+        if (timer.retry)
+            enqueue(timer.retry);
+        else
+            timer.handle.resume();
+    }
+}
+
+/**************************************************************************************
+ * Purpose : Event loop: start queued requests, let curl progress, resume the finished
+ *           requests and expired timers, then wait on the sockets until the next event
+ *           or timer. Returns when nothing is pending any more.
+ * Args    : None
+ * Return  : void
+ **************************************************************************************/
+void HttpReactor::run()
+{
+    while (!queued_.empty() || !active_.empty() || !timers_.empty())
+    {
+        startQueued();
+
+        if (!active_.empty())
+        {
+            int running = 0;
+            const CURLMcode mc = curl_multi_perform(multi_, &running);
+            if (mc != CURLM_OK)
+            {
+                // The handle is unusable: fail what is in flight, the tasks decide
+                LG_ERROR("[{}] curl_multi error: {}", name_, curl_multi_strerror(mc));
+                for (Request* request : std::vector<Request*>(active_.begin(), active_.end()))
+                    finish(request, CURLE_SEND_ERROR);
+            }
+            completeTransfers();
+        }
+
+        resumeDueTimers();
+
+        // Completions may have queued new requests that can start right away
+        if (!queued_.empty() && active_.size() < maxInFlight_)
+            continue;
+
+        // Sleep until the next socket event or timer (capped to stay responsive)
+        auto wait = std::chrono::milliseconds(1000);
+        if (!timers_.empty())
+            wait = std::clamp(std::chrono::ceil<std::chrono::milliseconds>(
+                                  timers_.begin()->first - std::chrono::steady_clock::now()),
+                              std::chrono::milliseconds(0), wait);
+
+        if (!active_.empty())
+            curl_multi_poll(multi_, nullptr, 0, static_cast<int>(wait.count()), nullptr);
+        else if (!timers_.empty())
+            std::this_thread::sleep_for(wait);
+    }
+
+    LG_DEBUG("[{}] Reactor done: {} requests ({} over HTTP/2)", name_, traffic_.requests, traffic_.http2);
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <curl/curl.h>
+#include "database_exchange_adapter.h"
+
+/***********************************************
+ * Outcome of one request made through the
+ * HttpReactor.
+ ***********************************************/
+struct HttpResult {
+    CURLcode    rc     = CURLE_OK;      // Transport result
+    long        status = 0;             // HTTP status (0 if no response)
+    std::string body;                   // Decompressed body
+
+    bool ok() const noexcept { return rc == CURLE_OK && status >= 200 && status < 300; }
+
+    // Throttled (418/429), server-side (5xx) and transport failures.
+    bool retryable() const noexcept { return rc != CURLE_OK || status == 418 || status == 429 || status >= 500; }
+
+    // Short description of a failure, for logs.
+    std::string describe() const;
+};
+
+/**************************************************************************************
+ * Purpose : Fire-and-forget coroutine driven by an HttpReactor. The task starts right
+ *           away, runs until its first co_await and is resumed by HttpReactor::run()
+ *           when the awaited request or timer completes; the frame frees itself when
+ *           the coroutine returns. Exceptions escaping the coroutine are logged.
+ *
+ *           Arguments the coroutine keeps across co_await must outlive the run():
+ *           take strings by value, and the reactor and outputs by reference from the
+ *           scope that calls run().
+ **************************************************************************************/
+struct FetchTask {
+    struct promise_type {
+        FetchTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept;
+    };
+};
+
+/**************************************************************************************
+ * Purpose : Single-threaded event loop for HTTP requests written as coroutines:
+ *
+ *              FetchTask fetchOne(HttpReactor& reactor, std::string url, Out& out) {
+ *                  HttpResult r = co_await reactor.get(url, tag, policy);
+ *                  if (!r.ok()) co_return;
+ *                  ...                          // Parse into out, next page, ...
+ *              }
+ *
+ *              HttpReactor reactor("binance", 8);
+ *              for (...) fetchOne(reactor, url, out);
+ *              reactor.run();                   // Returns once every task is done
+ *
+ *           Requests go through one curl multi handle: multiplexed as HTTP/2 streams of
+ *           a single connection when the server supports it, at most `maxInFlight` at a
+ *           time, the rest queued in submission order. curl_multi_poll() waits on the
+ *           sockets and the reactor's timers, so thousands of pending requests cost
+ *           one thread and no locks. Retries follow the policy given to get(), as in
+ *           httpGet(): failed attempts are logged and re-queued after the backoff, the
+ *           coroutine only resumes with the final result. Replayed cassette responses
+ *           complete on a timer after their recorded latency; recording works as in
+ *           httpGet().
+ *
+ *           The multi handle of a venue (and the connections it holds) is kept in a
+ *           process-wide pool keyed by `name` and reused by the next reactor of the
+ *           same venue, so connections warmed before a batch serve the batch.
+ **************************************************************************************/
+class HttpReactor {
+public:
+    HttpReactor(std::string name, std::size_t maxInFlight);
+    ~HttpReactor();
+
+    HttpReactor(const HttpReactor&) = delete;
+    HttpReactor& operator=(const HttpReactor&) = delete;
+
+    /***********************************************
+     * Awaitable of one GET; co_await yields the
+     * HttpResult.
+     ***********************************************/
+    class Request {
+    public:
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { reactor_.submit(this, handle); }
+        HttpResult await_resume() noexcept { return std::move(result_); }
+
+    private:
+        friend class HttpReactor;
+        Request(HttpReactor& reactor, std::string url, std::string tag, const RateLimitPolicy& policy)
+            : reactor_(reactor), url_(std::move(url)), tag_(std::move(tag)),
+              maxRetries_(policy.maxRetries), backoff_(policy.retryBackoff) {}
+
+        HttpReactor&              reactor_;
+        std::string               url_;
+        std::string               tag_;
+        int                       maxRetries_;
+        std::chrono::milliseconds backoff_;
+        int                       attempt_ = 0;
+        HttpResult                result_;
+        CURL*                     curl_ = nullptr;
+        std::coroutine_handle<>   handle_;
+    };
+
+    /***********************************************
+     * Awaitable of a timer (retry backoff).
+     ***********************************************/
+    class Sleep {
+    public:
+        bool await_ready() const noexcept { return until_ <= std::chrono::steady_clock::now(); }
+        void await_suspend(std::coroutine_handle<> handle) { reactor_.timers_.emplace(until_, Timer{handle, nullptr}); }
+        void await_resume() const noexcept {}
+
+    private:
+        friend class HttpReactor;
+        Sleep(HttpReactor& reactor, std::chrono::steady_clock::time_point until) : reactor_(reactor), until_(until) {}
+
+        HttpReactor&                          reactor_;
+        std::chrono::steady_clock::time_point until_;
+    };
+
+    // GET of `url`, retried following `policy`; failures are logged with `tag`.
+    Request get(std::string url, std::string tag, const RateLimitPolicy& policy)
+    {
+        return Request(*this, std::move(url), std::move(tag), policy);
+    }
+
+    Sleep sleep(std::chrono::microseconds duration) { return Sleep(*this, std::chrono::steady_clock::now() + duration); }
+
+    /**************************************************************************************
+     * Purpose : Drives the transfers and timers, resuming the waiting coroutines, until
+     *           no request and no timer is left.
+     * Return  : void
+     **************************************************************************************/
+    void run();
+
+    // Traffic of the requests completed by this reactor.
+    const HttpTrafficStats& traffic() const noexcept { return traffic_; }
+
+private:
+    std::string name_;
+    std::size_t maxInFlight_;
+    CURLM*      multi_ = nullptr;
+
+    std::deque<Request*> queued_;                 // Waiting for a transfer slot
+    std::set<Request*>   active_;                 // Added to the multi handle
+
+    // Expiry resumes `handle`, or re-queues `retry` (backoff of a failed attempt).
+    struct Timer {
+        std::coroutine_handle<> handle;
+        Request*                retry;
+    };
+    std::multimap<std::chrono::steady_clock::time_point, Timer> timers_;
+
+    HttpTrafficStats traffic_;
+
+    void submit(Request* request, std::coroutine_handle<> handle);
+    void enqueue(Request* request);
+    void startQueued();
+    void completeTransfers();
+    void finish(Request* request, CURLcode rc);
+    void resumeDueTimers();
+};
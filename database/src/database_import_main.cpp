@@ -0,0 +1,150 @@
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <boost/program_options.hpp>
+
+#include "logger.h"
+#include "database_configdata.h"
+#include "database_downloader.h"
+#include "database_archive_importer.h"
+#include "tick_store.h"
+
+namespace po = boost::program_options;
+
+/**************************************************************************************
+ * Bulk importer of exchange public data archives (zipped daily kline CSVs, e.g.
+ * data.binance.vision). Parses a directory of archives in parallel and loads the rows
+ * into the database configured for algotrading_database. With --dry-run nothing is
+ * written: the archives are only parsed and the throughput reported, which makes the
+ * importer usable fully offline on local fixtures.
+ *
+ * With --agg-trades the directory holds aggregated trades archives instead
+ * (<PAIR>-aggTrades-*.zip / .csv), written as compressed day blocks into the tick
+ * store (--tick-store, or tick_store.path of the configuration).
+ **************************************************************************************/
+int main(int argc, char** argv) {
+
+    bool debugMode = false;
+    bool dryRun    = false;
+    bool aggTrades = false;
+    std::string configPath;
+    std::string schemaPath;
+    std::string inputDir;
+    std::string tickStorePath;
+    std::size_t threads = 0;
+
+    Logger::Instance().Setup(
+        /*debugEnabled=*/false,
+        /*quiet=*/false,
+        /*fileAppender=*/"importer.log",
+        /*rollingAppender=*/"importer_roll.log",
+        /*includeHeader=*/true
+    );
+
+    // ----------------------------------------------------
+    // CLI arguments
+    // ----------------------------------------------------
+    try {
+        po::options_description desc("Options");
+        desc.add_options()
+            ("help,h", "Show help")
+            ("debug,d", "Enable debug logging")
+            ("config,c", po::value<std::string>(&configPath), "Path to the database configuration file (not needed with --dry-run)")
+            ("schema,s", po::value<std::string>(&schemaPath), "Path to the database JSON schema file (not needed with --dry-run)")
+            ("input,i", po::value<std::string>(&inputDir)->required(), "Directory of <PAIR>-1d-* (or <PAIR>-aggTrades-*) .zip / .csv archives")
+            ("threads,t", po::value<std::size_t>(&threads)->default_value(0), "Parser threads (0 = hardware concurrency)")
+            ("agg-trades,a", "Import <PAIR>-aggTrades-* archives into the tick store instead")
+            ("tick-store", po::value<std::string>(&tickStorePath), "Tick store directory (default: tick_store.path of the configuration)")
+            ("dry-run,n", "Parse only, do not write to the database");
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << "\n";
+            return 0;
+        }
+
+        debugMode = vm.count("debug") > 0;
+        dryRun    = vm.count("dry-run") > 0;
+        aggTrades = vm.count("agg-trades") > 0;
+
+        po::notify(vm);
+
+        const bool needsConfig = !dryRun && !(aggTrades && !tickStorePath.empty());
+        if (needsConfig && (configPath.empty() || schemaPath.empty()))
+            throw std::runtime_error("--config and --schema are required unless --dry-run (or --agg-trades with --tick-store) is set");
+    }
+    catch (const std::exception& e) {
+        LG_ERROR(std::string("Argument error: ") + e.what());
+        return 1;
+    }
+
+    Logger::Instance().Setup(
+        /*debugEnabled=*/debugMode,
+        /*quiet=*/false,
+        /*fileAppender=*/"importer.log",
+        /*rollingAppender=*/"importer_roll.log",
+        /*includeHeader=*/true
+    );
+
+    // ----------------------------------------------------
+    // Configuration (database path, main exchange, bus)
+    // ----------------------------------------------------
+    DatabaseConfig config;
+    if (!dryRun && !(aggTrades && !tickStorePath.empty()))
+    {
+        try {
+            config.LoadFromFile(configPath, schemaPath);
+        }
+        catch (const std::exception& e) {
+            LG_ERROR("Invalid configuration {}: {}", configPath, e.what());
+            return 1;
+        }
+    }
+
+    // ----------------------------------------------------
+    // Aggregated trades: parse, encode and write day blocks
+    // ----------------------------------------------------
+    if (aggTrades)
+    {
+        std::unique_ptr<TickStore> store;
+        if (!dryRun)
+        {
+            const boost::filesystem::path root = tickStorePath.empty() ? config.GetTickStore().path
+                                                                       : boost::filesystem::path(tickStorePath);
+            if (root.empty()) {
+                LG_ERROR("No tick store: set --tick-store or tick_store.path in {}", configPath);
+                return 1;
+            }
+            store = std::make_unique<TickStore>(root);
+        }
+
+        AggTradeImportStats aggStats;
+        if (!importAggTradeDirectory(inputDir, threads, store.get(), aggStats))
+            return 1;
+
+        if (dryRun)
+            LG_INFO("Dry run: nothing written.");
+        return 0;
+    }
+
+    std::unique_ptr<DatabaseDownloader> downloader;
+    if (!dryRun)
+        downloader = std::make_unique<DatabaseDownloader>(config, DownloaderRole::Import);
+
+    // ----------------------------------------------------
+    // Parse, then load in one transaction
+    // ----------------------------------------------------
+    OHLCVData data;
+    ArchiveImportStats stats;
+    if (!parseArchiveDirectory(inputDir, threads, data, stats))
+        return 1;
+
+    if (dryRun) {
+        LG_INFO("Dry run: nothing written.");
+        return 0;
+    }
+
+    return downloader->importOHLCV(data) ? 0 : 1;
+}
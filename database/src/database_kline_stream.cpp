@@ -0,0 +1,309 @@
+#include "database_kline_stream.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <array>
+#include <poll.h>
+
+/***********************************************
+ * A connection without any frame (updates or
+ * server pings) for this long is reopened.
+ ***********************************************/
+static constexpr std::chrono::seconds STREAM_IDLE_TIMEOUT{90};
+
+/***********************************************
+ * Upper bound of the reconnection backoff.
+ ***********************************************/
+static constexpr std::chrono::milliseconds STREAM_MAX_BACKOFF{60000};
+
+#if KLINE_STREAM_WEBSOCKETS
+/**************************************************************************************
+ * Purpose : curl_ws_recv with the frame metadata as a const pointer. The out parameter
+ *           is `struct curl_ws_frame**` in libcurl 7.x and `const struct curl_ws_frame**`
+ *           in 8.x; `Frame` is deduced from the declaration in use.
+ * Args    : recv     - &curl_ws_recv.
+ *           curl     - Websocket handle.
+ *           buffer   - Payload destination, `size` bytes.
+ *           received - Payload bytes written.
+ *           meta     - Metadata of the received frame.
+ * Return  : CURLcode - Result of curl_ws_recv.
+ **************************************************************************************/
+template <typename Frame>
+static CURLcode wsRecv(CURLcode (*recv)(CURL*, void*, std::size_t, std::size_t*, Frame**), CURL* curl,
+                       char* buffer, std::size_t size, std::size_t& received, const curl_ws_frame*& meta)
+{
+    Frame* frame = nullptr;
+    const CURLcode rc = recv(curl, buffer, size, &received, &frame);
+    meta = frame;
+    return rc;
+}
+#endif
+
+KlineStreamConsumer::KlineStreamConsumer(const ExchangeAdapter& exchange, KlineStreamSettings settings,
+                                         ClosedHandler onClosed)
+    : exchange_(exchange),
+      settings_(std::move(settings)),
+      onClosed_(std::move(onClosed))
+{
+}
+
+KlineStreamConsumer::~KlineStreamConsumer()
+{
+    stop();
+}
+
+/**************************************************************************************
+ * Purpose : (Re)starts the stream thread on `pairs`. Venues without kline streams are
+ *           left stopped.
+ * Args    : pairs - Symbols to follow.
+ * Return  : void
+ **************************************************************************************/
+void KlineStreamConsumer::start(std::vector<std::string> pairs)
+{
+    stop();
+
+    if (pairs.empty())
+        return;
+
+    if (settings_.url.empty() && exchange_.klineStreamBase().empty())
+    {
+        LG_ERROR("[{}] No kline stream endpoint, websocket consumer disabled", exchange_.name());
+        return;
+    }
+
+#if KLINE_STREAM_WEBSOCKETS
+    stop_    = false;
+    running_ = true;
+    thread_  = std::thread(&KlineStreamConsumer::run, this, std::move(pairs));
+#else
+    LG_ERROR("[{}] Built against libcurl {} headers without the websocket API, kline stream disabled",
+             exchange_.name(), LIBCURL_VERSION);
+#endif
+}
+
+void KlineStreamConsumer::stop()
+{
+    stop_ = true;
+    if (thread_.joinable())
+        thread_.join();
+    running_ = false;
+}
+
+#if KLINE_STREAM_WEBSOCKETS
+/**************************************************************************************
+ * Purpose : Opens the websocket of `conn` (blocking handshake, bounded by the connect
+ *           timeout).
+ * Args    : conn - Connection to open.
+ * Return  : bool - true once the upgrade succeeded.
+ **************************************************************************************/
+bool KlineStreamConsumer::open(Connection& conn)
+{
+    conn.curl = curl_easy_init();
+    if (!conn.curl)
+    {
+        close(conn, "CURL init failed");
+        return false;
+    }
+
+    curl_easy_setopt(conn.curl, CURLOPT_URL, conn.url.c_str());
+    curl_easy_setopt(conn.curl, CURLOPT_CONNECT_ONLY, 2L);         // Websocket upgrade, then curl_ws_*
+    curl_easy_setopt(conn.curl, CURLOPT_CONNECTTIMEOUT, 10L);
+    curl_easy_setopt(conn.curl, CURLOPT_TCP_KEEPALIVE, 1L);
+
+    const CURLcode rc = curl_easy_perform(conn.curl);
+    if (rc != CURLE_OK)
+    {
+        close(conn, fmt::format("connect failed: {}", curl_easy_strerror(rc)));
+        return false;
+    }
+
+    curl_easy_getinfo(conn.curl, CURLINFO_ACTIVESOCKET, &conn.socket);
+
+    conn.message.clear();
+    conn.lastData = std::chrono::steady_clock::now();
+    conn.backoff  = std::chrono::milliseconds(1000);
+    ++connected_;
+
+    LG_INFO("[{}] Kline stream open: {} pairs ({} → {})", exchange_.name(), conn.pairs.size(),
+            conn.pairs.front(), conn.pairs.back());
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Closes `conn` and schedules its reconnection after the backoff.
+ * Args    : conn   - Connection to close.
+ *           reason - Logged cause.
+ * Return  : void
+ **************************************************************************************/
+void KlineStreamConsumer::close(Connection& conn, const std::string& reason)
+{
+    if (conn.socket != CURL_SOCKET_BAD)
+    {
+        std::size_t sent = 0;
+        curl_ws_send(conn.curl, "", 0, &sent, 0, CURLWS_CLOSE);
+        conn.socket = CURL_SOCKET_BAD;
+        --connected_;
+    }
+
+    if (conn.curl)
+        curl_easy_cleanup(conn.curl);
+    conn.curl = nullptr;
+
+    if (stop_)
+        return;
+
+    LG_WARN("[{}] Kline stream of {} pairs closed ({}), reconnecting in {} ms",
+            exchange_.name(), conn.pairs.size(), reason, conn.backoff.count());
+
+    conn.retryAt = std::chrono::steady_clock::now() + conn.backoff;
+    conn.backoff = std::min(conn.backoff * 2, STREAM_MAX_BACKOFF);
+}
+
+/**************************************************************************************
+ * Purpose : Reads every frame available on `conn` without blocking, reassembling
+ *           fragmented messages, and adds the closed candles to `pending`.
+ * Args    : conn         - Open connection.
+ *           pending      - Closed candles not handed over yet.
+ *           pendingCount - Incremented for each new closed candle.
+ * Return  : bool - false if the connection failed or was closed (already handled).
+ **************************************************************************************/
+bool KlineStreamConsumer::drain(Connection& conn, OHLCVData& pending, std::size_t& pendingCount)
+{
+    std::array<char, 64 * 1024> buffer;
+
+    for (;;)
+    {
+        std::size_t received = 0;
+        const curl_ws_frame* meta = nullptr;
+
+        const CURLcode rc = wsRecv(&curl_ws_recv, conn.curl, buffer.data(), buffer.size(), received, meta);
+        if (rc == CURLE_AGAIN)
+            return true;
+        if (rc != CURLE_OK)
+        {
+            close(conn, curl_easy_strerror(rc));
+            return false;
+        }
+
+        conn.lastData = std::chrono::steady_clock::now();
+
+        if (meta->flags & CURLWS_CLOSE)
+        {
+            close(conn, "closed by server");
+            return false;
+        }
+
+        // Pings are answered by libcurl, pongs carry nothing
+        if (meta->flags & (CURLWS_PING | CURLWS_PONG))
+            continue;
+
+        conn.message.append(buffer.data(), received);
+        if (meta->bytesleft > 0 || (meta->flags & CURLWS_CONT))
+            continue;
+
+        std::string pair;
+        unsigned int ymd = 0;
+        OHLCV candle{};
+        if (exchange_.parseClosedKline(conn.message, pair, ymd, candle))
+        {
+            auto [_, inserted] = pending.data[pair].insert_or_assign(ymd, candle);
+            if (inserted)
+                ++pendingCount;
+        }
+        conn.message.clear();
+    }
+}
+
+/**************************************************************************************
+ * Purpose : Stream thread: opens one connection per streamsPerConnection pairs, then
+ *           polls all of them, reconnecting failed or silent ones, and flushes the
+ *           closed candles once the close burst is over.
+ * Args    : pairs - Symbols to follow.
+ * Return  : void
+ **************************************************************************************/
+void KlineStreamConsumer::run(std::vector<std::string> pairs)
+{
+    const std::string base = settings_.url.empty() ? exchange_.klineStreamBase() : settings_.url;
+    const std::size_t perConnection = std::max<std::size_t>(settings_.streamsPerConnection, 1);
+
+    std::vector<Connection> conns;
+    for (std::size_t i = 0; i < pairs.size(); i += perConnection)
+    {
+        Connection conn;
+        conn.pairs.assign(pairs.begin() + i, pairs.begin() + std::min(i + perConnection, pairs.size()));
+        conn.url = base + exchange_.klineStreamPath(conn.pairs);
+        conns.push_back(std::move(conn));
+    }
+
+    connections_ = conns.size();
+    connected_   = 0;
+    LG_INFO("[{}] Kline stream: {} pairs on {} connections", exchange_.name(), pairs.size(), conns.size());
+
+    const auto flushAfter = std::chrono::milliseconds(settings_.flushMillis);
+
+    OHLCVData pending;
+    std::size_t pendingCount = 0;
+    auto lastClose = std::chrono::steady_clock::now();
+
+    std::vector<pollfd> fds;
+    std::vector<Connection*> polled;
+
+    while (!stop_)
+    {
+        auto now = std::chrono::steady_clock::now();
+
+        for (auto& conn : conns)
+        {
+            if (stop_)
+                break;
+            if (!conn.curl && conn.retryAt <= now)
+                open(conn);
+        }
+
+        // Wait for frames (capped so stop(), retries and the flush stay responsive)
+        fds.clear();
+        polled.clear();
+        for (auto& conn : conns)
+        {
+            if (conn.socket == CURL_SOCKET_BAD)
+                continue;
+            fds.push_back(pollfd{static_cast<int>(conn.socket), POLLIN, 0});
+            polled.push_back(&conn);
+        }
+
+        ::poll(fds.data(), fds.size(), 200);
+
+        const std::size_t before = pendingCount;
+        for (std::size_t i = 0; i < fds.size(); ++i)
+        {
+            if (fds[i].revents != 0)
+                drain(*polled[i], pending, pendingCount);
+        }
+
+        now = std::chrono::steady_clock::now();
+        if (pendingCount != before)
+            lastClose = now;
+
+        for (auto& conn : conns)
+        {
+            if (conn.socket != CURL_SOCKET_BAD && now - conn.lastData > STREAM_IDLE_TIMEOUT)
+                close(conn, "no data");
+        }
+
+        // Whole close burst received (or quiet for flushMillis): one batch
+        if (pendingCount > 0 && (pending.data.size() >= pairs.size() || now - lastClose >= flushAfter))
+        {
+            LG_INFO("[{}] Kline stream: {} closed candles of {} pairs", exchange_.name(), pendingCount,
+                    pending.data.size());
+            onClosed_(pending);
+            pending.data.clear();
+            pendingCount = 0;
+        }
+    }
+
+    for (auto& conn : conns)
+        close(conn, "stopped");
+
+    LG_INFO("[{}] Kline stream stopped", exchange_.name());
+}
+#endif
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <curl/curl.h>
+#include "data_types.h"
+#include "database_configdata.h"
+#include "database_exchange_adapter.h"
+
+/***********************************************
+ * 1 when the libcurl headers have the websocket
+ * API (websockets.h, from 7.86); otherwise the
+ * consumer is compiled out and start() only logs.
+ ***********************************************/
+#if LIBCURL_VERSION_NUM >= 0x075600
+#define KLINE_STREAM_WEBSOCKETS 1
+#else
+#define KLINE_STREAM_WEBSOCKETS 0
+#endif
+
+/**************************************************************************************
+ * Purpose : Websocket consumer of an exchange's daily kline streams. The tracked pairs
+ *           are split into combined-stream connections of streamsPerConnection pairs,
+ *           all driven by one thread polling their sockets, so hundreds of streams cost
+ *           one thread and a handful of connections.
+ *
+ *           Updates of the open candle are dropped by the adapter's parser; closed
+ *           candles are collected and handed to `onClosed` in one batch once no other
+ *           close arrived for flushMillis (or every subscribed pair has closed), so the
+ *           midnight burst becomes a single transaction. Connections that fail, close
+ *           or stay silent are reopened with a doubling backoff.
+ *
+ *           Uses the libcurl websocket API (CONNECT_ONLY = 2, curl_ws_recv); libcurl
+ *           answers the server pings itself. Built against headers older than 7.86
+ *           (KLINE_STREAM_WEBSOCKETS == 0) the consumer never starts.
+ **************************************************************************************/
+class KlineStreamConsumer {
+public:
+    using ClosedHandler = std::function<void(const OHLCVData&)>;
+
+    /**************************************************************************************
+     * Purpose : Constructs an idle consumer; nothing is opened before start().
+     * Args    : exchange - Venue adapter (stream endpoint and parser); must outlive this.
+     *           settings - Stream settings (endpoint override, streams per connection).
+     *           onClosed - Receives each batch of closed candles, on the stream thread.
+     **************************************************************************************/
+    KlineStreamConsumer(const ExchangeAdapter& exchange, KlineStreamSettings settings, ClosedHandler onClosed);
+    ~KlineStreamConsumer();
+
+    KlineStreamConsumer(const KlineStreamConsumer&) = delete;
+    KlineStreamConsumer& operator=(const KlineStreamConsumer&) = delete;
+
+    /**************************************************************************************
+     * Purpose : Subscribes to the daily klines of `pairs`, replacing the previous
+     *           subscription (the stream thread is restarted).
+     * Args    : pairs - Symbols to follow.
+     * Return  : void
+     **************************************************************************************/
+    void start(std::vector<std::string> pairs);
+
+    // Stops the stream thread and closes every connection (pending candles are dropped).
+    void stop();
+
+    // Whether every connection of the subscription is currently open.
+    bool live() const noexcept { return running_ && connected_ == connections_ && connections_ > 0; }
+
+private:
+    /***********************************************
+     * One combined-stream websocket connection.
+     ***********************************************/
+    struct Connection {
+        std::vector<std::string> pairs;
+        std::string              url;
+        CURL*                    curl   = nullptr;
+        curl_socket_t            socket = CURL_SOCKET_BAD;
+        std::string              message;                  // Frame fragments received so far
+        std::chrono::steady_clock::time_point lastData;    // Last frame received
+        std::chrono::steady_clock::time_point retryAt;     // Next connection attempt
+        std::chrono::milliseconds backoff{1000};
+    };
+
+    const ExchangeAdapter& exchange_;
+    KlineStreamSettings    settings_;
+    ClosedHandler          onClosed_;
+
+    std::thread              thread_;
+    std::atomic<bool>        stop_{false};
+    std::atomic<bool>        running_{false};
+    std::atomic<std::size_t> connections_{0};
+    std::atomic<std::size_t> connected_{0};
+
+#if KLINE_STREAM_WEBSOCKETS
+    void run(std::vector<std::string> pairs);
+    bool open(Connection& conn);
+    void close(Connection& conn, const std::string& reason);
+    bool drain(Connection& conn, OHLCVData& pending, std::size_t& pendingCount);
+#endif
+};
@@ -45,6 +45,7 @@ int main(int argc, char** argv) {
     std::string configPath;
     std::string schemaPath;
     int checkInterval = 30;
+    int onceDate = 0;
 
     try {
         po::options_description desc("Options");
@@ -53,7 +54,8 @@ int main(int argc, char** argv) {
             ("debug,d", "Enable debug logging")
             ("config,c", po::value<std::string>(&configPath)->required(), "Path to configuration file")
             ("schema,s", po::value<std::string>(&schemaPath)->required(), "Path to JSON schema file")
-            ("check-interval,i", po::value<int>(&checkInterval)->default_value(30), "Seconds between configuration checks");
+            ("check-interval,i", po::value<int>(&checkInterval)->default_value(30), "Seconds between configuration checks")
+            ("once", po::value<int>(&onceDate), "Run the daily update for this date (YYYYMMDD) once and exit (benchmarks, HTTP cassette replay)");
 
         po::variables_map vm;
         po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -111,6 +113,28 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    // ----------------------------------------------------
+    // One-shot run for a fixed date
+    // ----------------------------------------------------
+    if (onceDate > 0) {
+        const std::chrono::year_month_day date{
+            std::chrono::year{onceDate / 10000},
+            std::chrono::month{static_cast<unsigned>(onceDate / 100 % 100)},
+            std::chrono::day{static_cast<unsigned>(onceDate % 100)}};
+        if (!date.ok()) {
+            LG_ERROR("Invalid --once date {}", onceDate);
+            return 1;
+        }
+
+        DatabaseDownloader downloader(ctx->config);
+        const auto t0 = std::chrono::steady_clock::now();
+        const bool ok = downloader.downloadData(date);
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        LG_INFO("Daily update for {} {} in {:.3f} s", onceDate, ok ? "completed" : "failed", elapsed);
+        return ok ? 0 : 1;
+    }
+
     // ----------------------------------------------------
     // Create DatabaseScheduler
     // ----------------------------------------------------
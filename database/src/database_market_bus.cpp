@@ -0,0 +1,163 @@
+#include "database_downloader.h"
+#include "indicators.h"
+#include "logger.h"
+#include "market_data_reader.h"
+#include "time_utils.h"
+
+#include <limits>
+#include <sqlite3.h>
+#include <string>
+#include <unordered_map>
+
+/**************************************************************************************
+ * Purpose : Returns a single integer produced by a scalar query (MAX(...) etc.).
+ * Args    : db  - Open SQLite connection.
+ *           sql - Query returning one row with one integer column.
+ * Return  : long long - The value, or 0 if NULL or on error.
+ **************************************************************************************/
+static long long queryScalar(SqliteConnection& db, const char* sql)
+{
+    CachedStatement stmt = db.cached(sql);
+    if (!stmt)
+    {
+        LG_ERROR("Prepare failed ({}): {}", sql, db.errmsg());
+        return 0;
+    }
+
+    long long value = 0;
+    if (sqlite3_step(stmt) == SQLITE_ROW)
+        value = sqlite3_column_int64(stmt, 0);
+
+    return value;
+}
+
+
+/**************************************************************************************
+ * Purpose : Publishes the latest window of bars and the indicator state of every pair
+ *           on the market data bus when the stored data_version differs from the one
+ *           already published:
+ *              - Streams window + MARKET_BUS_WARMUP_DAYS days of candles in batches
+ *                (read from the shards at once when the table is sharded)
+ *              - Replays IndicatorState per pair over them
+ *              - Lays the last window days out column-wise on a shared date axis
+ *              - Publishes the snapshot under the bus seqlock
+ *
+ * Args    : db - Open SQLite connection.
+ *
+ * Return  : void
+ **************************************************************************************/
+void DatabaseDownloader::refreshMarketBus(SqliteConnection& db)
+{
+    if (!marketBus_)
+        return;
+
+    const long long version = queryScalar(db, "SELECT MAX(version) FROM data_version;");
+    if (version == marketBusVersion_)
+        return;
+
+    const ExchangeTables tables;           // Main exchange
+
+    const int latestDate = latestStoredDate(db, tables.ohlcv);
+    if (latestDate == 0)
+        return;
+
+    const int window = static_cast<int>(marketBus_->windowBars());
+
+    // ------------------------------------------------------------
+    // Shared calendar axis: the last `window` days ending at latestDate
+    // ------------------------------------------------------------
+    MarketBusSnapshot snapshot;
+    snapshot.dataVersion = version;
+    snapshot.dates.reserve(window);
+
+    std::unordered_map<int, std::size_t> dateIndex;
+    for (int b = 0; b < window; ++b)
+    {
+        const int date = shiftDays(latestDate, b - (window - 1));
+        dateIndex[date] = snapshot.dates.size();
+        snapshot.dates.push_back(date);
+    }
+
+    const int firstDate = shiftDays(latestDate, 1 - (window + MARKET_BUS_WARMUP_DAYS));
+
+    constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+    IndicatorState state;
+    BarData latest{};
+    std::string current;
+
+    // Closes the pair being replayed and appends its state to the snapshot
+    auto flushPair = [&]() {
+        if (current.empty()) return;
+        snapshot.states.push_back(state);
+        snapshot.latest.push_back(latest);
+    };
+
+    // Replays a batch of bars ordered by (symbol, date)
+    auto replay = [&](const BarColumns& batch) {
+        for (std::size_t row = 0; row < batch.size(); ++row)
+        {
+            if (current != batch.symbolOf(row))
+            {
+                flushPair();
+                current = batch.symbolOf(row);
+                state   = IndicatorState{};
+                latest  = BarData{};
+
+                snapshot.symbols.push_back(current);
+                for (auto& col : snapshot.columns)
+                    col.resize(col.size() + window, NaN);
+            }
+
+            const int date = batch.date[row];
+            const OHLCV c  = batch.bar(row);
+
+            const BarData bar = state.update(c);
+            if (date == latestDate)
+                latest = bar;
+
+            auto it = dateIndex.find(date);
+            if (it == dateIndex.end())
+                continue;                  // Warm-up only
+
+            const std::size_t at = (snapshot.symbols.size() - 1) * window + it->second;
+            snapshot.columns[static_cast<std::size_t>(BusField::Open)][at]   = c.open;
+            snapshot.columns[static_cast<std::size_t>(BusField::High)][at]   = c.high;
+            snapshot.columns[static_cast<std::size_t>(BusField::Low)][at]    = c.low;
+            snapshot.columns[static_cast<std::size_t>(BusField::Close)][at]  = c.close;
+            snapshot.columns[static_cast<std::size_t>(BusField::Volume)][at] = c.volume;
+            snapshot.columns[static_cast<std::size_t>(BusField::QuoteVolume)][at]         = c.quoteVolume;
+            snapshot.columns[static_cast<std::size_t>(BusField::Trades)][at]              = c.trades;
+            snapshot.columns[static_cast<std::size_t>(BusField::TakerBuyVolume)][at]      = c.takerBuyVolume;
+            snapshot.columns[static_cast<std::size_t>(BusField::TakerBuyQuoteVolume)][at] = c.takerBuyQuoteVolume;
+        }
+    };
+
+    // ------------------------------------------------------------
+    // History (window + warm-up) symbol by symbol: streamed from db,
+    // or merged from the shards in one read (a symbol may span years)
+    // ------------------------------------------------------------
+    if (shards_.enabled())
+    {
+        const BarColumns bars = shards_.bars(tables.ohlcv, {}, firstDate, latestDate);
+        if (bars.empty())
+            return;
+        replay(bars);
+    }
+    else
+    {
+        MarketDataReader reader(db, tables.ohlcv);
+        BarCursor cursor = reader.scan(BarQuery{{}, firstDate, latestDate, BarOrder::BySymbol});
+
+        BarColumns batch;
+        while (cursor.fill(batch) > 0)
+            replay(batch);
+
+        if (cursor.failed())
+            return;
+    }
+    flushPair();
+
+    marketBus_->publish(snapshot);
+    marketBusVersion_ = version;
+}
@@ -1,96 +1,88 @@
 #include "database_downloader.h"
 #include "logger.h"
+#include "time_utils.h"
 #include <fmt/chrono.h>
 #include <sqlite3.h>
-#include <nlohmann/json.hpp>
 #include <chrono>
+#include <climits>
 #include <string>
 #include <ctime>
 #include <fmt/core.h>
 
-using json = nlohmann::json;
-
 /**************************************************************************************
- * Purpose : Reads the single row in tracked_pairs, reconstructing the TrackedData
- *           struct containing date and symbol → days mappings.
- * Args    : db - Valid SQLite handle.
+ * Purpose : Reads the tracked pairs of the latest date stored on or before `asOf`,
+ *           reconstructing the TrackedData struct (symbol → days out, and the rank and
+ *           quote volume of the pairs in the universe that day). The date is found on
+ *           the primary key, the rows of that date are one index range.
+ * Args    : db    - Open SQLite connection.
+ *           table - Tracked pairs table of the exchange.
+ *           asOf  - Point in time (YYYYMMDD, 0 = latest).
  * Return  : TrackedData - If no row exists, date == EMPTY_DATE.
  **************************************************************************************/
-TrackedData DatabaseDownloader::getTrackedPairs(sqlite3* db)
+TrackedData DatabaseDownloader::getTrackedPairs(SqliteConnection& db, const std::string& table, unsigned int asOf)
 {
     TrackedData result;
     result.date = EMPTY_DATE;
 
-    const char* sql = "SELECT date, json FROM tracked_pairs LIMIT 1;";
-
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    CachedStatement stmt = db.cached(
+        "SELECT date, pair, days_out, rank, quote_volume FROM " + table +
+        " WHERE date = (SELECT MAX(date) FROM " + table + " WHERE date <= ?);");
+    if (!stmt)
     {
-        LG_ERROR("SQLite prepare failed: {}", sqlite3_errmsg(db));
+        LG_ERROR("SQLite prepare failed: {}", db.errmsg());
         return result;
     }
 
-    if (sqlite3_step(stmt) == SQLITE_ROW)
-    {
-        const char* date_text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        const char* json_text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-
-        if (date_text && json_text)
-        {
-            std::string ds(date_text);
-
-            int y = std::stoi(ds.substr(0, 4));
-            unsigned m = static_cast<unsigned>(std::stoi(ds.substr(5, 2)));
-            unsigned d = static_cast<unsigned>(std::stoi(ds.substr(8, 2)));
-
-            std::chrono::year year_obj{y};
-            std::chrono::month month_obj{m};
-            std::chrono::day day_obj{d};
+    sqlite3_bind_int(stmt, 1, asOf == 0 ? INT_MAX : static_cast<int>(asOf));
 
-            if (year_obj.ok() && month_obj.ok() && day_obj.ok())
-                result.date = year_obj / month_obj / day_obj;
-            else
-                result.date = EMPTY_DATE;
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        const auto date = fromYYYYMMDD(static_cast<unsigned int>(sqlite3_column_int(stmt, 0)));
+        const char* pair = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        if (!pair || !date.ok())
+            continue;
 
-            json j = json::parse(json_text);
+        result.date = date;
+        result.trackedPairs[pair] = sqlite3_column_int(stmt, 2);
 
-            for (auto it = j.begin(); it != j.end(); ++it)
-            {
-                const std::string& pair = it.key();
-                unsigned int days = it.value().get<unsigned int>();
-                result.trackedPairs[pair] = days;
-            }
-        }
+        // Pairs outside the universe that day have no rank
+        if (sqlite3_column_type(stmt, 3) != SQLITE_NULL)
+            result.universe[pair] = UniverseEntry{sqlite3_column_int(stmt, 3), sqlite3_column_double(stmt, 4)};
     }
 
-    sqlite3_finalize(stmt);
     return result;
 }
 
 /**************************************************************************************
  * Purpose : Computes the new tracked pair state for the given date based on:
  *              - previous tracked data
- *              - current top-50 pairs
+ *              - current universe (policy-selected pairs)
  *              - whether previous data existed
+ *           Pairs outside the universe for more than maxDaysOut days are evicted
+ *           (never when maxDaysOut == 0), so churn does not grow the tracked set, and
+ *           the nightly fetch, without bound.
  * Args    : prev         - Previous day's tracked data.
- *           top50        - Current top-50 pair set.
+ *           universe     - Current universe pair set.
  *           prev_exists  - Whether previous data exists.
  *           date         - Current date for which data is computed.
+ *           maxDaysOut   - Days outside the universe before eviction (0 = never).
  * Return  : TrackedData  - New tracked data.
  **************************************************************************************/
-TrackedData DatabaseDownloader::getNewTrackedPairs(
+TrackedData getNewTrackedPairs(
         const TrackedData& prev,
-        const std::set<std::string>& top50,
+        const Universe& universe,
         bool prev_exists,
-        std::chrono::year_month_day date)
+        std::chrono::year_month_day date,
+        int maxDaysOut)
 {
     TrackedData result;
-    result.date = date;
+    result.date     = date;
+    result.universe = universe;
 
-    // No previous data → initialize all top50 pairs with 0 days
+    // No previous data → initialize all universe pairs with 0 days
     if (!prev_exists)
     {
-        for (const auto& p : top50)
+        for (const auto& [p, _] : universe)
             result.trackedPairs[p] = 0;
         return result;
     }
@@ -99,16 +91,27 @@ TrackedData DatabaseDownloader::getNewTrackedPairs(
     int diff = (std::chrono::sys_days(date) - std::chrono::sys_days(prev.date)).count();
     if (diff < 1) {diff = 1; LG_ERROR("wtf diff <1?");}
 
-    // Coins in top 50 → reset to zero
-    for (const auto& p : top50)
+    // Coins in the universe → reset to zero
+    for (const auto& [p, _] : universe)
         result.trackedPairs[p] = 0;
 
-    // Coins not in top 50 → increment days
+    // Coins not in the universe → increment days, evict past maxDaysOut
+    std::size_t evicted = 0;
     for (const auto& [oldPair, oldDays] : prev.trackedPairs)
     {
-        if (!top50.contains(oldPair))
-            result.trackedPairs[oldPair] = oldDays + diff;
+        if (universe.contains(oldPair))
+            continue;
+
+        const int daysOut = oldDays + diff;
+        if (maxDaysOut > 0 && daysOut > maxDaysOut) {
+            ++evicted;
+            continue;
+        }
+        result.trackedPairs[oldPair] = daysOut;
     }
 
+    if (evicted > 0)
+        LG_INFO("Evicted {} pairs outside the universe for more than {} days", evicted, maxDaysOut);
+
     return result;
 }
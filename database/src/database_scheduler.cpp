@@ -4,6 +4,8 @@
 #include "database_downloader.h"
 #include "time_utils.h"
 
+#include <thread>
+
 /**************************************************************************************
  * Purpose : Constructs the DatabaseScheduler and initializes the underlying Scheduler
  *           timer parameters, configuration handler reference, and database downloader.
@@ -22,7 +24,8 @@ DatabaseScheduler::DatabaseScheduler(std::shared_ptr<DatabaseContext> ctx,
                                      std::chrono::seconds secondsToStart)
     : Scheduler<DatabaseContext>(ctx, interval, timeout, secondsToStart),
       configHandler_(configHandler),
-      databaseDownloader_(this->ctx->config.GetDatabasePath())
+      databaseDownloader_(this->ctx->config),
+      tick_(interval)
 {
     // Compute when the next UTC midnight event should fire
     nextMidnightUTC_ = computeNextMidnightUTC();
@@ -51,7 +54,36 @@ void DatabaseScheduler::processSecond() {
     // ============================================================================
     auto now = std::chrono::system_clock::now();
 
-    if (now >= nextMidnightUTC_ || firtsIteration) {
+    // ============================================================================
+    // PRE-MIDNIGHT WARM-UP — connections, universe and database ready before the
+    // close, then the last tick before midnight waits for it precisely instead of
+    // firing up to one tick late
+    // ============================================================================
+    const auto prewarm = std::chrono::seconds(ctxRef.config.GetPrewarmSeconds());
+
+    // With the kline stream live the closed candles arrive over the websocket at the
+    // close; the REST run then only repairs gaps, gap_repair_delay_seconds later
+    const auto dueUTC = nextMidnightUTC_ +
+        (databaseDownloader_.klineStreamLive()
+             ? std::chrono::seconds(ctxRef.config.GetKlineStream().gapRepairDelay)
+             : std::chrono::seconds(0));
+
+    if (!firtsIteration && prewarm.count() > 0 && now < nextMidnightUTC_)
+    {
+        if (!prepared_ && now >= nextMidnightUTC_ - prewarm) {
+            LG_INFO("Pre-midnight warm-up triggered");
+            databaseDownloader_.prepare(getCurrentUtcDate());
+            prepared_ = true;
+            now = std::chrono::system_clock::now();
+        }
+
+        if (prepared_ && dueUTC == nextMidnightUTC_ && nextMidnightUTC_ - now <= tick_) {
+            std::this_thread::sleep_until(nextMidnightUTC_);
+            now = std::chrono::system_clock::now();
+        }
+    }
+
+    if (now >= dueUTC || firtsIteration) {
         LG_INFO("Midnight event triggered");
         
         firtsIteration = false;
@@ -61,6 +93,13 @@ void DatabaseScheduler::processSecond() {
             
         // Schedule the next midnight trigger
         nextMidnightUTC_ = computeNextMidnightUTC();
+        prepared_ = false;
+
+        // Follow today's universe on the kline stream (if enabled)
+        databaseDownloader_.startKlineStream();
+
+        // Yesterday's aggregated trades into the tick store (if enabled)
+        databaseDownloader_.syncAggTrades(getPreviousDayDate(getCurrentUtcDate()));
     }
 
     // ============================================================================
@@ -68,4 +68,10 @@ private:
 
     // boolean for first iteration of scheduler
     bool firtsIteration = true;
+
+    // Scheduler tick (the warm-up waits for midnight itself within the last tick).
+    std::chrono::milliseconds tick_;
+
+    // Whether the pre-midnight warm-up already ran for nextMidnightUTC_.
+    bool prepared_ = false;
 };
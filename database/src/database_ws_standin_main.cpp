@@ -0,0 +1,565 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+
+#include "logger.h"
+#include "time_utils.h"
+
+namespace po = boost::program_options;
+
+/**************************************************************************************
+ * Local stand-in of an exchange kline websocket, for testing the kline stream consumer
+ * without the network. It accepts any number of connections on one thread, takes the
+ * streams to serve from the request path (/stream?streams=btcusdt@kline_1d/...) and
+ * replays a synthetic random walk per stream in the Binance combined-stream format:
+ * --updates updates of the open candle every --interval-ms, then the closed candle
+ * (k.x = true), for --days days starting at --start. Afterwards connections stay open
+ * and only receive pings.
+ *
+ *   algotrading_ws_standin --port 9443 --start 20260301 --days 2
+ *   database config: "kline_stream": { "enabled": true, "url": "ws://127.0.0.1:9443" }
+ *
+ * --start should be the day after the last one stored, or the consumer leaves the
+ * candles to the REST gap repair.
+ *
+ * Test hooks (database/tests/test_kline_stream.cpp): --fragment-bytes splits every
+ * message into continuation frames, --close-after closes the first connection with a
+ * CLOSE frame after that many messages, and the --stall symbols update their open
+ * candle forever without closing it.
+ **************************************************************************************/
+
+static std::atomic<bool> stopRequested{false};
+
+static void signalHandler(int) { stopRequested = true; }
+
+/**************************************************************************************
+ * Purpose : SHA-1 digest (RFC 3174), only needed for the websocket handshake.
+ * Args    : data - Bytes to hash.
+ * Return  : std::array<uint8_t, 20> - Digest.
+ **************************************************************************************/
+static std::array<uint8_t, 20> sha1(const std::string& data)
+{
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    std::string msg = data;
+    const uint64_t bits = static_cast<uint64_t>(data.size()) * 8;
+    msg += static_cast<char>(0x80);
+    while (msg.size() % 64 != 56)
+        msg += '\0';
+    for (int i = 7; i >= 0; --i)
+        msg += static_cast<char>((bits >> (i * 8)) & 0xFF);
+
+    auto rotl = [](uint32_t x, int n) { return (x << n) | (x >> (32 - n)); };
+
+    for (std::size_t chunk = 0; chunk < msg.size(); chunk += 64)
+    {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i)
+        {
+            w[i] = (static_cast<uint32_t>(static_cast<uint8_t>(msg[chunk + 4 * i])) << 24) |
+                   (static_cast<uint32_t>(static_cast<uint8_t>(msg[chunk + 4 * i + 1])) << 16) |
+                   (static_cast<uint32_t>(static_cast<uint8_t>(msg[chunk + 4 * i + 2])) << 8) |
+                    static_cast<uint32_t>(static_cast<uint8_t>(msg[chunk + 4 * i + 3]));
+        }
+        for (int i = 16; i < 80; ++i)
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i)
+        {
+            uint32_t f, k;
+            if (i < 20)      { f = (b & c) | (~b & d);           k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d;                    k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d);  k = 0x8F1BBCDC; }
+            else             { f = b ^ c ^ d;                    k = 0xCA62C1D6; }
+
+            const uint32_t t = rotl(a, 5) + f + e + k + w[i];
+            e = d; d = c; c = rotl(b, 30); b = a; a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    std::array<uint8_t, 20> digest;
+    for (int i = 0; i < 20; ++i)
+        digest[i] = static_cast<uint8_t>(h[i / 4] >> (24 - 8 * (i % 4)));
+    return digest;
+}
+
+static std::string base64(const uint8_t* data, std::size_t size)
+{
+    static constexpr char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string out;
+    for (std::size_t i = 0; i < size; i += 3)
+    {
+        const uint32_t n = (static_cast<uint32_t>(data[i]) << 16) |
+                           (i + 1 < size ? static_cast<uint32_t>(data[i + 1]) << 8 : 0) |
+                           (i + 2 < size ? static_cast<uint32_t>(data[i + 2]) : 0);
+        out += table[(n >> 18) & 63];
+        out += table[(n >> 12) & 63];
+        out += i + 1 < size ? table[(n >> 6) & 63] : '=';
+        out += i + 2 < size ? table[n & 63] : '=';
+    }
+    return out;
+}
+
+/**************************************************************************************
+ * Purpose : Encodes one unmasked server frame.
+ * Args    : opcode  - 0x0 continuation, 0x1 text, 0x8 close, 0x9 ping, 0xA pong.
+ *           payload - Frame payload.
+ *           fin     - Whether this is the last frame of the message.
+ * Return  : std::string - Bytes to send.
+ **************************************************************************************/
+static std::string wsFrame(uint8_t opcode, const std::string& payload, bool fin = true)
+{
+    std::string frame;
+    frame += static_cast<char>((fin ? 0x80 : 0x00) | opcode);
+
+    const uint64_t n = payload.size();
+    if (n < 126) {
+        frame += static_cast<char>(n);
+    } else if (n <= 0xFFFF) {
+        frame += static_cast<char>(126);
+        frame += static_cast<char>(n >> 8);
+        frame += static_cast<char>(n & 0xFF);
+    } else {
+        frame += static_cast<char>(127);
+        for (int i = 7; i >= 0; --i)
+            frame += static_cast<char>((n >> (i * 8)) & 0xFF);
+    }
+    return frame + payload;
+}
+
+/**************************************************************************************
+ * Purpose : Encodes a text message, split into frames of at most `fragmentBytes`
+ *           payload bytes (a text frame, then continuation frames).
+ * Args    : payload       - Message.
+ *           fragmentBytes - Payload bytes per frame (0 = one frame).
+ * Return  : std::string - Bytes to send.
+ **************************************************************************************/
+static std::string wsText(const std::string& payload, std::size_t fragmentBytes)
+{
+    if (fragmentBytes == 0 || payload.size() <= fragmentBytes)
+        return wsFrame(0x1, payload);
+
+    std::string frames;
+    for (std::size_t pos = 0; pos < payload.size(); pos += fragmentBytes)
+    {
+        const bool last = pos + fragmentBytes >= payload.size();
+        frames += wsFrame(pos == 0 ? 0x1 : 0x0, payload.substr(pos, fragmentBytes), last);
+    }
+    return frames;
+}
+
+/***********************************************
+ * Synthetic daily kline of one stream.
+ ***********************************************/
+struct SyntheticStream {
+    std::string  symbol;          // Uppercase symbol
+    int          day = 0;         // Candle day (YYYYMMDD)
+    int          daysLeft = 0;    // Closed candles still to send
+    int          update = 0;      // Updates of the open candle sent
+    double       open = 0, high = 0, low = 0, close = 0, volume = 0, quoteVolume = 0;
+    long long    trades = 0;
+    bool         stalled = false;     // Never closes its candle
+    std::mt19937_64 rng;
+
+    void startCandle(double price)
+    {
+        open = high = low = close = price;
+        volume = quoteVolume = 0.0;
+        trades = update = 0;
+    }
+
+    // Random step of the candle, as one update of the stream.
+    void step()
+    {
+        std::normal_distribution<double> ret(0.0, 0.01);
+        std::uniform_real_distribution<double> qty(10.0, 1000.0);
+
+        close *= std::exp(ret(rng));
+        high = std::max(high, close);
+        low  = std::min(low, close);
+
+        const double q = qty(rng);
+        volume      += q;
+        quoteVolume += q * close;
+        trades      += 1 + static_cast<long long>(q);
+        ++update;
+    }
+
+    std::string message(bool closed) const
+    {
+        const long long t = toUnixMillis(day);
+        std::string lower = symbol;
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+
+        return fmt::format(
+            R"({{"stream":"{0}@kline_1d","data":{{"e":"kline","E":{2},"s":"{1}","k":{{"t":{2},"T":{3},)"
+            R"("s":"{1}","i":"1d","o":"{4}","c":"{5}","h":"{6}","l":"{7}","v":"{8}","n":{9},"x":{10},)"
+            R"("q":"{11}","V":"{12}","Q":"{13}","B":"0"}}}}}})",
+            lower, symbol, t, t + 86400000LL - 1, open, close, high, low, volume, trades,
+            closed ? "true" : "false", quoteVolume, volume / 2, quoteVolume / 2);
+    }
+};
+
+/***********************************************
+ * One accepted connection.
+ ***********************************************/
+struct Client {
+    int          fd = -1;
+    bool         upgraded = false;
+    bool         closing = false;     // CLOSE frame queued: drop once `out` is sent
+    int          messages = 0;        // Text messages queued
+    std::string  in;                  // Bytes received, not parsed yet
+    std::string  out;                 // Bytes waiting to be sent
+    std::vector<SyntheticStream> streams;
+};
+
+/**************************************************************************************
+ * Purpose : Answers the upgrade request in `client.in` (once complete) and creates the
+ *           requested streams.
+ * Args    : client - Connection.
+ *           start  - First candle day.
+ *           days   - Closed candles per stream.
+ *           seed   - Random seed, combined with each symbol.
+ *           stall  - Symbols whose candle never closes.
+ * Return  : bool - false if the request is not a valid websocket upgrade.
+ **************************************************************************************/
+static bool handshake(Client& client, int start, int days, uint64_t seed, const std::vector<std::string>& stall)
+{
+    const std::size_t end = client.in.find("\r\n\r\n");
+    if (end == std::string::npos)
+        return true;                                    // Wait for the rest
+
+    std::string request = client.in.substr(0, end);
+    client.in.erase(0, end + 4);
+
+    std::string lowered = request;
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    const std::size_t keyPos = lowered.find("sec-websocket-key:");
+    if (request.rfind("GET ", 0) != 0 || keyPos == std::string::npos)
+        return false;
+
+    std::size_t keyStart = request.find_first_not_of(' ', keyPos + 18);
+    std::string key = request.substr(keyStart, request.find("\r\n", keyStart) - keyStart);
+
+    const auto digest = sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
+    client.out += "HTTP/1.1 101 Switching Protocols\r\n"
+                  "Upgrade: websocket\r\n"
+                  "Connection: Upgrade\r\n"
+                  "Sec-WebSocket-Accept: " + base64(digest.data(), digest.size()) + "\r\n\r\n";
+    client.upgraded = true;
+
+    // /stream?streams=btcusdt@kline_1d/ethusdt@kline_1d
+    const std::string path = request.substr(4, request.find(' ', 4) - 4);
+    const std::size_t query = path.find("streams=");
+    if (query == std::string::npos)
+        return true;
+
+    std::string list = path.substr(query + 8);
+    list = list.substr(0, list.find('&'));
+
+    std::size_t pos = 0;
+    while (pos < list.size())
+    {
+        std::size_t next = list.find('/', pos);
+        if (next == std::string::npos)
+            next = list.size();
+
+        const std::string stream = list.substr(pos, next - pos);
+        pos = next + 1;
+
+        const std::size_t at = stream.find('@');
+        if (at == std::string::npos)
+            continue;
+
+        SyntheticStream s;
+        s.symbol = stream.substr(0, at);
+        std::transform(s.symbol.begin(), s.symbol.end(), s.symbol.begin(), [](unsigned char c) { return std::toupper(c); });
+        s.day      = start;
+        s.daysLeft = days;
+        s.stalled  = std::find(stall.begin(), stall.end(), s.symbol) != stall.end();
+        s.rng.seed(seed ^ std::hash<std::string>{}(s.symbol));
+        s.startCandle(std::uniform_real_distribution<double>(1.0, 1000.0)(s.rng));
+        client.streams.push_back(std::move(s));
+    }
+
+    LG_INFO("Connection {}: {} streams", client.fd, client.streams.size());
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Consumes the (masked) client frames in `client.in`: pings are answered,
+ *           a close frame is echoed.
+ * Args    : client - Upgraded connection.
+ * Return  : bool - false once the client closed.
+ **************************************************************************************/
+static bool readFrames(Client& client)
+{
+    for (;;)
+    {
+        const std::string& in = client.in;
+        if (in.size() < 2)
+            return true;
+
+        const uint8_t opcode = static_cast<uint8_t>(in[0]) & 0x0F;
+        const bool masked = static_cast<uint8_t>(in[1]) & 0x80;
+        uint64_t length = static_cast<uint8_t>(in[1]) & 0x7F;
+        std::size_t header = 2;
+
+        if (length == 126) {
+            if (in.size() < 4) return true;
+            length = (static_cast<uint64_t>(static_cast<uint8_t>(in[2])) << 8) | static_cast<uint8_t>(in[3]);
+            header = 4;
+        } else if (length == 127) {
+            if (in.size() < 10) return true;
+            length = 0;
+            for (int i = 0; i < 8; ++i)
+                length = (length << 8) | static_cast<uint8_t>(in[2 + i]);
+            header = 10;
+        }
+
+        const std::size_t maskSize = masked ? 4 : 0;
+        if (in.size() < header + maskSize + length)
+            return true;
+
+        std::string payload = in.substr(header + maskSize, length);
+        if (masked)
+        {
+            for (std::size_t i = 0; i < payload.size(); ++i)
+                payload[i] ^= in[header + i % 4];
+        }
+        client.in.erase(0, header + maskSize + length);
+
+        if (opcode == 0x8) {
+            client.out += wsFrame(0x8, payload.substr(0, 2));
+            return false;
+        }
+        if (opcode == 0x9)
+            client.out += wsFrame(0xA, payload);
+    }
+}
+
+int main(int argc, char** argv) {
+
+    int port = 9443;
+    int start = 0;
+    int days = 1;
+    int updates = 4;
+    int intervalMs = 250;
+    uint64_t seed = 42;
+    std::size_t fragmentBytes = 0;
+    int closeAfter = 0;
+    std::vector<std::string> stall;
+
+    Logger::Instance().Setup(
+        /*debugEnabled=*/false,
+        /*quiet=*/false,
+        /*fileAppender=*/"ws_standin.log",
+        /*rollingAppender=*/"ws_standin_roll.log",
+        /*includeHeader=*/true
+    );
+
+    std::signal(SIGINT,  signalHandler);
+    std::signal(SIGTERM, signalHandler);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // ----------------------------------------------------
+    // CLI arguments
+    // ----------------------------------------------------
+    try {
+        po::options_description desc("Options");
+        desc.add_options()
+            ("help,h", "Show help")
+            ("port,p", po::value<int>(&port)->default_value(9443), "Port to listen on (127.0.0.1)")
+            ("start", po::value<int>(&start)->required(), "Day of the first candle (YYYYMMDD)")
+            ("days", po::value<int>(&days)->default_value(1), "Closed candles per stream")
+            ("updates", po::value<int>(&updates)->default_value(4), "Updates of the open candle before it closes")
+            ("interval-ms", po::value<int>(&intervalMs)->default_value(250), "Milliseconds between updates")
+            ("seed", po::value<uint64_t>(&seed)->default_value(42), "Random seed of the synthetic prices")
+            ("fragment-bytes", po::value<std::size_t>(&fragmentBytes)->default_value(0),
+             "Split messages into frames of this many bytes (0 = whole messages)")
+            ("close-after", po::value<int>(&closeAfter)->default_value(0),
+             "Close the first connection after this many messages (0 = never)")
+            ("stall", po::value<std::vector<std::string>>(&stall)->multitoken(),
+             "Symbols whose open candle never closes");
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << "\n";
+            return 0;
+        }
+
+        po::notify(vm);
+    }
+    catch (const std::exception& e) {
+        LG_ERROR(std::string("Argument error: ") + e.what());
+        return 1;
+    }
+
+    // ----------------------------------------------------
+    // Listening socket
+    // ----------------------------------------------------
+    const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    const int yes = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(listener, 128) != 0)
+    {
+        LG_ERROR("Cannot listen on 127.0.0.1:{}: {}", port, std::strerror(errno));
+        return 1;
+    }
+
+    LG_INFO("Kline stream stand-in on ws://127.0.0.1:{} ({} days from {}, {} updates every {} ms)",
+            port, days, start, updates, intervalMs);
+
+    std::transform(stall.begin(), stall.end(), stall.begin(), [](std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::toupper(c); });
+        return s;
+    });
+
+    std::vector<Client> clients;
+    int closesLeft = closeAfter > 0 ? 1 : 0;
+    auto nextTick = std::chrono::steady_clock::now();
+    auto nextPing = nextTick + std::chrono::seconds(30);
+
+    // ----------------------------------------------------
+    // Event loop: accept, read, tick the streams, write
+    // ----------------------------------------------------
+    while (!stopRequested)
+    {
+        std::vector<pollfd> fds{{listener, POLLIN, 0}};
+        for (const auto& client : clients)
+            fds.push_back(pollfd{client.fd, static_cast<short>(POLLIN | (client.out.empty() ? 0 : POLLOUT)), 0});
+
+        const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(nextTick - std::chrono::steady_clock::now());
+        ::poll(fds.data(), fds.size(), static_cast<int>(std::max<long long>(wait.count(), 0)));
+
+        if (fds[0].revents & POLLIN)
+        {
+            const int fd = ::accept(listener, nullptr, nullptr);
+            if (fd >= 0) {
+                Client client;
+                client.fd = fd;
+                clients.push_back(std::move(client));
+            }
+        }
+
+        for (std::size_t i = 0; i < clients.size(); ++i)
+        {
+            Client& client = clients[i];
+            const short revents = fds.size() > i + 1 ? fds[i + 1].revents : 0;
+            bool alive = true;
+
+            if (revents & (POLLIN | POLLHUP | POLLERR))
+            {
+                char buffer[4096];
+                const ssize_t n = ::recv(client.fd, buffer, sizeof(buffer), 0);
+                if (n <= 0)
+                    alive = false;
+                else {
+                    client.in.append(buffer, static_cast<std::size_t>(n));
+                    alive = client.upgraded ? readFrames(client) : handshake(client, start, days, seed, stall);
+                }
+            }
+
+            if (!client.out.empty())
+            {
+                const ssize_t n = ::send(client.fd, client.out.data(), client.out.size(), MSG_DONTWAIT);
+                if (n > 0)
+                    client.out.erase(0, static_cast<std::size_t>(n));
+                else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+                    alive = false;
+            }
+            if (client.closing && client.out.empty())
+                alive = false;
+
+            if (!alive)
+            {
+                LG_INFO("Connection {} closed", client.fd);
+                ::close(client.fd);
+                client.fd = -1;
+            }
+        }
+        std::erase_if(clients, [](const Client& c) { return c.fd < 0; });
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now < nextTick)
+            continue;
+        nextTick = now + std::chrono::milliseconds(intervalMs);
+
+        const bool ping = now >= nextPing;
+        if (ping)
+            nextPing = now + std::chrono::seconds(30);
+
+        for (auto& client : clients)
+        {
+            if (!client.upgraded || client.closing)
+                continue;
+            if (ping)
+                client.out += wsFrame(0x9, "standin");
+
+            for (auto& s : client.streams)
+            {
+                if (s.daysLeft == 0)
+                    continue;
+
+                s.step();
+                const bool closed = s.update > updates && !s.stalled;
+                client.out += wsText(s.message(closed), fragmentBytes);
+                ++client.messages;
+
+                if (closed)
+                {
+                    --s.daysLeft;
+                    s.day = static_cast<int>(nextDay(static_cast<unsigned int>(s.day)));
+                    s.startCandle(s.close);
+                }
+            }
+
+            // Endpoint restart: status 1012 (service restart)
+            if (closesLeft > 0 && client.messages >= closeAfter)
+            {
+                LG_INFO("Connection {}: closing after {} messages", client.fd, client.messages);
+                client.out += wsFrame(0x8, std::string("\x03\xF4", 2) + "restart");
+                client.closing = true;
+                --closesLeft;
+            }
+        }
+    }
+
+    for (auto& client : clients)
+        ::close(client.fd);
+    ::close(listener);
+
+    LG_INFO("Kline stream stand-in stopped");
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "database_downloader.h"
+#include "logger.h"
+#include "market_data_reader.h"
+#include "sharded_candle_store.h"
+#include "time_utils.h"
+
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <fmt/core.h>
+
+using Clock = std::chrono::steady_clock;
+
+/***********************************************
+ * Size of the benchmark: symbols × days.
+ ***********************************************/
+static constexpr int N_SYMBOLS = 600;
+static constexpr int N_DAYS    = 100;
+
+// Milliseconds elapsed since `start`.
+static double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**************************************************************************************
+ * Purpose : Benchmark of the 600-symbol universe, the figures quoted by the universe
+ *           policy change:
+ *              - Storing symbols × days candles in one transaction (writeCandles, the
+ *                write of storeDataOHLCV)
+ *              - The days-since-last-stored lookups of every symbol (one primary key
+ *                probe each, as computeDaysSinceLastStoredOHLCV)
+ **************************************************************************************/
+int main()
+{
+    Logger::Instance().Setup(false, true, "", "", false);
+
+    const boost::filesystem::path dir = boost::filesystem::temp_directory_path() /
+                                        boost::filesystem::unique_path("bench_universe_%%%%%%");
+    boost::filesystem::create_directories(dir);
+
+    SqliteConnection db;
+    if (!db.open(dir / "bench.db"))
+        return 1;
+
+    // Schema of ensureExchangeTables for the main exchange
+    db.exec("CREATE TABLE ohlcv_data ("
+            "   pair TEXT NOT NULL, date INTEGER NOT NULL,"
+            "   open REAL, high REAL, low REAL, close REAL, volume REAL,"
+            "   quote_volume REAL, trades INTEGER, taker_buy_volume REAL, taker_buy_quote_volume REAL,"
+            "   PRIMARY KEY(pair, date));"
+            "CREATE INDEX idx_ohlcv_data_date_pair ON ohlcv_data(date, pair);");
+
+    std::vector<std::string> pairs;
+    OHLCVData data;
+    for (int i = 0; i < N_SYMBOLS; ++i)
+    {
+        pairs.push_back(fmt::format("S{:03}USDT", i));
+        for (int d = 0; d < N_DAYS; ++d)
+        {
+            const double p = 100.0 + i + d;
+            data.data[pairs.back()][static_cast<unsigned int>(shiftDays(20240101, d))] =
+                OHLCV{p, p + 1, p - 1, p + 0.5, 1000.0, 1e5, 500, 400.0, 4e4};
+        }
+    }
+
+    // ------------------------------------------------------------
+    // Store: one transaction, one cached statement
+    // ------------------------------------------------------------
+    auto start = Clock::now();
+    {
+        SqliteTransaction tx(db);
+        if (!writeCandles(db, "ohlcv_data", data) || !tx.commit())
+            return 1;
+    }
+    fmt::print("store {} x {} rows, one transaction: {:.1f} ms\n", N_SYMBOLS, N_DAYS, elapsedMs(start));
+
+    // ------------------------------------------------------------
+    // Days since the last stored candle of every symbol
+    // ------------------------------------------------------------
+    start = Clock::now();
+    MarketDataReader reader(db);
+    int found = 0;
+    for (const auto& pair : pairs)
+    {
+        SymbolBar bar;
+        found += reader.latest(pair, bar);
+    }
+    fmt::print("days-since lookups of {} symbols: {:.2f} ms ({} found)\n", pairs.size(), elapsedMs(start), found);
+
+    db.close();
+    boost::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/***********************************************
+ * One record as split by a CsvRecordScanner.
+ ***********************************************/
+struct CsvRecord {
+    std::vector<std::string> fields;
+    bool overflow = false;
+    bool blank    = false;
+
+    bool operator==(const CsvRecord&) const = default;
+};
+
+// Every record of `text`, scanned with `Scanner` (CsvRecordScanner or a renamed build of it).
+template<typename Scanner>
+std::vector<CsvRecord> scanRecords(std::string_view text)
+{
+    std::vector<CsvRecord> records;
+    Scanner scan(text);
+    while (scan.next())
+    {
+        CsvRecord record;
+        for (std::size_t i = 0; i < scan.size(); ++i)
+            record.fields.emplace_back(scan[i]);
+        record.overflow = scan.overflow();
+        record.blank    = scan.blank();
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+// Same, with the scanner compiled without its SSE2 path (csv_scanner_scalar.cpp).
+std::vector<CsvRecord> scanRecordsScalar(std::string_view text);
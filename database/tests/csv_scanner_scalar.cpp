@@ -0,0 +1,13 @@
+// CsvRecordScanner built as on a target without SSE2, under another name so both builds
+// can be linked into one test (the header picks its path with #if defined(__SSE2__)).
+#undef __SSE2__
+#define CsvRecordScanner CsvRecordScannerScalar
+#include "csv_scanner.h"
+#undef CsvRecordScanner
+
+#include "csv_records.h"
+
+std::vector<CsvRecord> scanRecordsScalar(std::string_view text)
+{
+    return scanRecords<CsvRecordScannerScalar>(text);
+}
@@ -0,0 +1,170 @@
+#include "database_archive_importer.h"
+#include "logger.h"
+#include "test_check.h"
+
+#include <atomic>
+#include <boost/filesystem.hpp>
+#include <fmt/core.h>
+#include <fstream>
+#include <iterator>
+
+namespace fs = boost::filesystem;
+
+// Whole content of a fixture file.
+static std::string readFixture(const fs::path& path)
+{
+    std::ifstream in(path.string(), std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+// Bar equality on every field the importer fills.
+static bool sameBar(const OHLCV& a, const OHLCV& b)
+{
+    return a.open == b.open && a.high == b.high && a.low == b.low && a.close == b.close &&
+           a.volume == b.volume && a.quoteVolume == b.quoteVolume && a.trades == b.trades &&
+           a.takerBuyVolume == b.takerBuyVolume && a.takerBuyQuoteVolume == b.takerBuyQuoteVolume;
+}
+
+/**************************************************************************************
+ * Purpose : Parses the fixture directory and checks every archive kind:
+ *              - BTCUSDT: stored ZIP, 3 days
+ *              - ETHUSDT: deflated ZIP, 4 days
+ *              - SOLUSDT: plain CSV, 3 days and one malformed line
+ *              - XRPUSDT: plain CSV without header, open times in microseconds
+ *              - README.txt: skipped
+ **************************************************************************************/
+static void testDirectory(const fs::path& dir, std::size_t threads)
+{
+    OHLCVData data;
+    ArchiveImportStats stats;
+    CHECK(parseArchiveDirectory(dir, threads, data, stats));
+
+    CHECK(stats.files == 4);
+    CHECK(stats.skipped == 1);
+    CHECK(stats.rows == 12);
+    CHECK(stats.bad == 1);
+
+    CHECK(data.data.size() == 4);
+    CHECK(data.data["BTCUSDT"].size() == 3);
+    CHECK(data.data["ETHUSDT"].size() == 4);
+    CHECK(data.data["SOLUSDT"].size() == 3);
+    CHECK(data.data["XRPUSDT"].size() == 2);
+
+    // Row i of a fixture: open = base + i, quote volumes = (100 + i) · open, (50 + i) · open
+    CHECK(sameBar(data.data["BTCUSDT"][20240102],
+                  OHLCV{42001.0, 42003.0, 42000.0, 42002.0, 101.5, 101.0 * 42001.0, 1001, 51.25, 51.0 * 42001.0}));
+    CHECK(sameBar(data.data["ETHUSDT"][20240104],
+                  OHLCV{2203.0, 2205.0, 2202.0, 2204.0, 103.5, 103.0 * 2203.0, 1003, 53.25, 53.0 * 2203.0}));
+    CHECK(sameBar(data.data["SOLUSDT"][20240103],
+                  OHLCV{102.0, 104.0, 101.0, 103.0, 102.5, 102.0 * 102.0, 1002, 52.25, 52.0 * 102.0}));
+    CHECK(!data.data["SOLUSDT"].contains(20240106));   // The malformed line
+    CHECK(sameBar(data.data["XRPUSDT"][20250102],
+                  OHLCV{2.0, 4.0, 1.0, 3.0, 101.5, 101.0 * 2.0, 1001, 51.25, 51.0 * 2.0}));
+}
+
+// Offset of the first central directory header of an archive.
+static std::size_t centralHeader(const std::string& zip)
+{
+    return zip.find(std::string("PK\x01\x02", 4));
+}
+
+static void patch32(std::string& zip, std::size_t pos, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+        zip[pos + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+/**************************************************************************************
+ * Purpose : Stored and deflated entries inflate to their CSV; a ZIP64 entry and an
+ *           unknown compression method are rejected, by forEachZipEntry and by a
+ *           directory import (the archive is skipped).
+ **************************************************************************************/
+static void testZipEntries(const fs::path& dir)
+{
+    for (const char* name : {"BTCUSDT-1d-2024-01.zip", "ETHUSDT-1d-2024-01.zip"})
+    {
+        std::size_t entries = 0, rows = 0, bad = 0;
+        std::map<unsigned int, OHLCV> bars;
+        CHECK(forEachZipEntry(readFixture(dir / name), [&](std::string_view entry, std::string_view csv) {
+            ++entries;
+            CHECK(entry.ends_with(".csv"));
+            rows += parseKlineCsv(csv, bars, bad);
+        }));
+        CHECK(entries == 1 && rows == bars.size() && rows >= 3 && bad == 0);
+    }
+
+    const std::string stored = readFixture(dir / "BTCUSDT-1d-2024-01.zip");
+    const std::size_t central = centralHeader(stored);
+    CHECK(central != std::string::npos);
+    if (central == std::string::npos)
+        return;
+
+    std::string zip64 = stored;
+    patch32(zip64, central + 20, 0xFFFFFFFF);          // Compressed size in the ZIP64 extra field
+    std::string bzip2 = stored;
+    bzip2[central + 10] = 12;                           // Method 12 (bzip2)
+
+    for (const std::string* archive : {&zip64, &bzip2})
+    {
+        bool called = false;
+        CHECK(!forEachZipEntry(*archive, [&](std::string_view, std::string_view) { called = true; }));
+        CHECK(!called);
+
+        const fs::path tmp = fs::temp_directory_path() / fs::unique_path("test_archive_%%%%%%");
+        fs::create_directories(tmp);
+        std::ofstream((tmp / "ADAUSDT-1d-2024-01.zip").string(), std::ios::binary) << *archive;
+
+        OHLCVData data;
+        ArchiveImportStats stats;
+        CHECK(!parseArchiveDirectory(tmp, 1, data, stats));
+        CHECK(stats.files == 0 && stats.skipped == 1 && data.data.empty());
+        fs::remove_all(tmp);
+    }
+
+    CHECK(!forEachZipEntry("not a zip archive", [](std::string_view, std::string_view) {}));
+}
+
+// Every file processed exactly once, never more than maxThreads at a time.
+static void testWorkerPool()
+{
+    std::vector<std::string> files;
+    for (int i = 0; i < 600; ++i)
+        files.push_back(fmt::format("{:03}.zip", i));
+
+    std::vector<std::atomic<int>> visits(files.size());
+    std::atomic<int> inFlight{0}, peak{0};
+
+    forEachFileConcurrently(files, 8, [&](const std::string& file) {
+        const int now = ++inFlight;
+        int seen = peak.load();
+        while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+        ++visits[static_cast<std::size_t>(std::stoi(file.substr(0, 3)))];
+        --inFlight;
+    });
+
+    for (const auto& v : visits)
+        CHECK(v.load() == 1);
+    CHECK(peak.load() >= 1 && peak.load() <= 8);
+}
+
+int main(int argc, char** argv)
+{
+    Logger::Instance().Setup(false, true, "", "", false);
+
+    if (argc < 2)
+    {
+        std::cerr << "usage: test_archive_importer <fixtures/archives>\n";
+        return 2;
+    }
+    const fs::path dir = argv[1];
+
+    testDirectory(dir, 1);
+    testDirectory(dir, 3);
+    testZipEntries(dir);
+    testWorkerPool();
+
+    CHECK(pairFromArchiveName("BTCUSDT-1d-2024-01.zip") == "BTCUSDT");
+    CHECK(pairFromArchiveName("BTCUSDT-1h-2024-01.zip").empty());
+
+    return testResult();
+}
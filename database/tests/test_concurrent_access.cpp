@@ -0,0 +1,99 @@
+#include "database_downloader.h"
+#include "logger.h"
+#include "sqlite_connection.h"
+#include "test_check.h"
+
+#include <chrono>
+#include <thread>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+using namespace std::chrono_literals;
+
+static fs::path workDir;
+
+// One candle of every symbol on `yyyymmdd`.
+static OHLCVData dayOf(unsigned int yyyymmdd)
+{
+    OHLCVData data;
+    for (const char* pair : {"BTCUSDT", "ETHUSDT", "SOLUSDT"})
+        data.data[pair][yyyymmdd] = OHLCV{100, 110, 90, 105, 1000, 105000, 50, 500, 52500};
+    return data;
+}
+
+static int countRows(SqliteConnection& db)
+{
+    CachedStatement count = db.cached("SELECT COUNT(*) FROM ohlcv_data;");
+    if (!count || sqlite3_step(count) != SQLITE_ROW)
+        return -1;
+    return sqlite3_column_int(count, 0);
+}
+
+static std::string journalMode(SqliteConnection& db)
+{
+    CachedStatement mode = db.cached("PRAGMA journal_mode;");
+    if (!mode || sqlite3_step(mode) != SQLITE_ROW)
+        return {};
+    return reinterpret_cast<const char*>(sqlite3_column_text(mode, 0));
+}
+
+/**************************************************************************************
+ * Purpose : The service's writer connection shares the file with readers and other
+ *           writers: a store commits while a reader holds a snapshot (WAL), the reader
+ *           keeps its snapshot until it ends, and a store started while another
+ *           connection holds the write lock waits for it instead of failing.
+ **************************************************************************************/
+static void testWriterAlongsideOthers()
+{
+    const fs::path database = workDir / "market.db";
+
+    DatabaseConfig config;
+    config.ParseConfig({
+        {"main_exchange", "binance"},
+        {"database_path", database.string()}
+    });
+    DatabaseDownloader downloader(config, DownloaderRole::Import);
+    CHECK(downloader.importOHLCV(dayOf(20260301)));
+
+    // A reader in the middle of a read transaction
+    SqliteConnection reader;
+    CHECK(reader.open(database, SQLITE_OPEN_READONLY));
+    reader.setBusyTimeout(5000);
+    CHECK(journalMode(reader) == "wal");
+    CHECK(reader.exec("BEGIN;"));
+    CHECK(countRows(reader) == 3);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    CHECK(downloader.importOHLCV(dayOf(20260302)));
+    CHECK(std::chrono::steady_clock::now() - t0 < 5s);
+
+    CHECK(countRows(reader) == 3);                  // Its snapshot
+    CHECK(reader.exec("COMMIT;"));
+    CHECK(countRows(reader) == 6);
+
+    // Another writer holding the write lock for a moment
+    SqliteConnection other;
+    CHECK(other.open(database));
+    CHECK(other.exec("BEGIN IMMEDIATE;"));
+    std::thread release([&] {
+        std::this_thread::sleep_for(300ms);
+        other.exec("COMMIT;");
+    });
+
+    CHECK(downloader.importOHLCV(dayOf(20260303)));
+    release.join();
+    CHECK(countRows(reader) == 9);
+}
+
+int main()
+{
+    Logger::Instance().Setup(false, true, "", "", false);
+
+    workDir = fs::temp_directory_path() / fs::unique_path("concurrent_%%%%%%");
+    fs::create_directories(workDir);
+
+    testWriterAlongsideOthers();
+
+    fs::remove_all(workDir);
+    return testResult();
+}
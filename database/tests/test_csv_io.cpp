@@ -0,0 +1,373 @@
+#include "csv_records.h"
+#include "csv_scanner.h"
+#include "database_csv_io.h"
+#include "logger.h"
+#include "sharded_candle_store.h"
+#include "sqlite_connection.h"
+#include "test_check.h"
+#include "time_utils.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <boost/filesystem.hpp>
+#include <fmt/format.h>
+
+namespace fs = boost::filesystem;
+
+static fs::path workDir;
+
+// Bar equality on every field the CSV carries.
+static bool sameBar(const OHLCV& a, const OHLCV& b)
+{
+    return a.open == b.open && a.high == b.high && a.low == b.low && a.close == b.close &&
+           a.volume == b.volume && a.quoteVolume == b.quoteVolume && a.trades == b.trades &&
+           a.takerBuyVolume == b.takerBuyVolume && a.takerBuyQuoteVolume == b.takerBuyQuoteVolume;
+}
+
+static bool sameData(const OHLCVData& a, const OHLCVData& b)
+{
+    if (a.data.size() != b.data.size())
+        return false;
+    for (const auto& [pair, days] : a.data)
+    {
+        auto it = b.data.find(pair);
+        if (it == b.data.end() || it->second.size() != days.size())
+            return false;
+        for (const auto& [date, bar] : days)
+        {
+            auto other = it->second.find(date);
+            if (other == it->second.end() || !sameBar(bar, other->second))
+                return false;
+        }
+    }
+    return true;
+}
+
+static void writeFile(const fs::path& path, const std::string& content)
+{
+    std::ofstream out(path.string(), std::ios::binary);
+    out << content;
+}
+
+// Shortest round-trip text of `value`, as the dumper writes it.
+static std::string number(double value)
+{
+    char buf[32];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    return std::string(buf, ptr);
+}
+
+/**************************************************************************************
+ * Purpose : Random walk candles with full-precision doubles (integral trades, as the
+ *           table stores them).
+ **************************************************************************************/
+static OHLCVData sampleData(int pairs, int days)
+{
+    std::mt19937_64 rng(7);
+    std::normal_distribution<double> ret(0.0, 0.02);
+    std::uniform_real_distribution<double> qty(1.0, 1e6);
+
+    OHLCVData data;
+    for (int p = 0; p < pairs; ++p)
+    {
+        double price = 10.0 + p * 3.7;
+        for (int d = 0; d < days; ++d)
+        {
+            const double open = price;
+            price *= std::exp(ret(rng));
+            const double volume = qty(rng);
+            data.data[fmt::format("S{:02}USDT", p)][static_cast<unsigned int>(shiftDays(20230101, d))] =
+                OHLCV{open, std::max(open, price) * 1.01, std::min(open, price) * 0.99, price, volume,
+                      volume * price, std::floor(volume / 7), volume * 0.45, volume * price * 0.45};
+        }
+    }
+    return data;
+}
+
+/**************************************************************************************
+ * Purpose : Table → CSV → OHLCVData gives back exactly the stored doubles, whole and
+ *           filtered (pairs and date range).
+ **************************************************************************************/
+static void testRoundTrip()
+{
+    const fs::path database = workDir / "roundtrip.db";
+    const OHLCVData data = sampleData(12, 400);
+
+    SqliteConnection db;
+    CHECK(db.open(database));
+    CHECK(db.exec("CREATE TABLE ohlcv_data ("
+                  "   pair TEXT NOT NULL, date INTEGER NOT NULL,"
+                  "   open REAL, high REAL, low REAL, close REAL, volume REAL,"
+                  "   quote_volume REAL, trades INTEGER, taker_buy_volume REAL, taker_buy_quote_volume REAL,"
+                  "   PRIMARY KEY(pair, date));"));
+    {
+        SqliteTransaction tx(db);
+        CHECK(writeCandles(db, "ohlcv_data", data));
+        CHECK(tx.commit());
+    }
+    db.close();
+
+    const fs::path csv = workDir / "roundtrip.csv";
+    CsvIoStats exported;
+    CHECK(exportOhlcvCsv(database, "ohlcv_data", csv.string(), CsvExportFilter{}, exported));
+    CHECK(exported.rows == 12 * 400);
+
+    for (std::size_t threads : {1, 4})
+    {
+        OHLCVData loaded;
+        CsvIoStats stats;
+        CHECK(loadOhlcvCsv(csv, threads, loaded, stats));
+        CHECK(stats.rows == exported.rows);
+        CHECK(stats.bad == 0);
+        CHECK(stats.bytes == exported.bytes);
+        CHECK(sameData(loaded, data));
+    }
+
+    CsvExportFilter filter;
+    filter.pairs    = {"S03USDT", "S07USDT"};
+    filter.fromDate = 20230301;
+    filter.toDate   = 20230331;
+    CHECK(exportOhlcvCsv(database, "ohlcv_data", csv.string(), filter, exported));
+    CHECK(exported.rows == 2 * 31);
+
+    OHLCVData loaded;
+    CsvIoStats stats;
+    CHECK(loadOhlcvCsv(csv, 2, loaded, stats));
+    CHECK(loaded.data.size() == 2);
+    for (const auto& [pair, days] : loaded.data)
+    {
+        CHECK(days.size() == 31);
+        CHECK(days.begin()->first == 20230301 && days.rbegin()->first == 20230331);
+        for (const auto& [date, bar] : days)
+            CHECK(sameBar(bar, data.data.at(pair).at(date)));
+    }
+}
+
+/**************************************************************************************
+ * Purpose : CRLF file, columns in another order with an unknown one, ISO dates, blank
+ *           lines, malformed lines and a last line without line feed.
+ **************************************************************************************/
+static void testCrlfAndLastLine()
+{
+    const fs::path csv = workDir / "crlf.csv";
+    writeFile(csv,
+        "date,pair,close,open,low,high,volume,comment,trades\r\n"
+        "2024-01-01,BTCUSDT,42283.58,42283.59,41884.64,44184.1,27174.29903,x,1014289\r\n"
+        "\r\n"
+        "2024-01-02,BTCUSDT,44179.55,42283.58,42180.77,45879.63,65146.40661,,\r\n"
+        "2024-01-03,BTCUSDT,not-a-number,1,1,1,1,,\r\n"
+        "20240101,ETHUSDT,2352.04,2281.87,2265.24,2352.37,216702.6914,y,1021226\r\n"
+        "20240102,ETHUSDT,2355.34,2352.04,2341.0,2386.71,325900.2337,z,1166591");
+
+    OHLCVData data;
+    CsvIoStats stats;
+    CHECK(loadOhlcvCsv(csv, 1, data, stats));
+    CHECK(stats.rows == 4);
+    CHECK(stats.bad == 1);
+
+    CHECK(sameBar(data.data["BTCUSDT"][20240101],
+                  OHLCV{42283.59, 44184.1, 41884.64, 42283.58, 27174.29903, 0.0, 1014289, 0.0, 0.0}));
+    CHECK(sameBar(data.data["BTCUSDT"][20240102],
+                  OHLCV{42283.58, 45879.63, 42180.77, 44179.55, 65146.40661, 0.0, 0.0, 0.0, 0.0}));
+    CHECK(sameBar(data.data["ETHUSDT"][20240102],
+                  OHLCV{2352.04, 2386.71, 2341.0, 2355.34, 325900.2337, 0.0, 1166591, 0.0, 0.0}));
+    CHECK(data.data["BTCUSDT"].size() == 2);
+
+    // Last line ending on a bare '\r'
+    writeFile(csv, "pair,date,open,high,low,close,volume\r\nSOLUSDT,20240105,1,2,0.5,1.5,10\r");
+    data.data.clear();
+    CHECK(loadOhlcvCsv(csv, 1, data, stats));
+    CHECK(stats.rows == 1 && stats.bad == 0);
+    CHECK(data.data["SOLUSDT"][20240105].volume == 10.0);
+
+    // Header only, without line feed
+    writeFile(csv, "pair,date,open,high,low,close,volume");
+    data.data.clear();
+    CHECK(loadOhlcvCsv(csv, 1, data, stats));
+    CHECK(stats.rows == 0 && data.data.empty());
+
+    writeFile(csv, "pair,date,open,high,low,volume\n");
+    CHECK(!loadOhlcvCsv(csv, 1, data, stats));
+}
+
+/**************************************************************************************
+ * Purpose : Lines past MAX_FIELDS fields are malformed (even with every column right),
+ *           lines of exactly MAX_FIELDS are rows; a header past MAX_FIELDS is refused.
+ **************************************************************************************/
+static void testFieldLimit()
+{
+    const std::size_t limit = CsvRecordScanner::MAX_FIELDS;
+
+    std::string extra;                              // Fields after the 7 named ones
+    for (std::size_t i = 7; i < limit; ++i)
+        extra += ",0";
+
+    const fs::path csv = workDir / "fields.csv";
+    writeFile(csv, "pair,date,open,high,low,close,volume\n"
+                   "AAAUSDT,20240101,1,2,0.5,1.5,10" + extra + "\n"
+                   "BBBUSDT,20240101,1,2,0.5,1.5,10" + extra + ",0\n"
+                   "CCCUSDT,20240101,1,2,0.5,1.5,10" + extra + extra + "\n");
+
+    OHLCVData data;
+    CsvIoStats stats;
+    CHECK(loadOhlcvCsv(csv, 1, data, stats));
+    CHECK(stats.rows == 1);
+    CHECK(stats.bad == 2);
+    CHECK(data.data.size() == 1 && data.data.count("AAAUSDT") == 1);
+
+    std::string header = "pair,date,open,high,low,close,volume";
+    for (std::size_t i = 7; i <= limit; ++i)
+        header += ",c" + std::to_string(i);
+    writeFile(csv, header + "\nAAAUSDT,20240101,1,2,0.5,1.5,10\n");
+    CHECK(!loadOhlcvCsv(csv, 1, data, stats));
+}
+
+/**************************************************************************************
+ * Purpose : A file of several CSV_CHUNK_BYTES: lines straddle the chunk cuts, and one
+ *           row (a 2-chunk pair name) is longer than a chunk, so the reader carries it
+ *           over two reads without line feed. Mixed LF / CRLF, blank lines, one line
+ *           past MAX_FIELDS, no final line feed. Same result on 1 and 4 threads.
+ **************************************************************************************/
+static void testChunkBoundaries()
+{
+    std::string content = "pair,date,open,high,low,close,volume,quote_volume,trades\n";
+    OHLCVData expected;
+    std::size_t rows = 0;
+
+    auto addRow = [&](const std::string& pair, unsigned int date, const OHLCV& c, bool crlf) {
+        content += pair + "," + std::to_string(date) + "," + number(c.open) + "," + number(c.high) + "," +
+                   number(c.low) + "," + number(c.close) + "," + number(c.volume) + "," +
+                   number(c.quoteVolume) + "," + number(c.trades) + (crlf ? "\r\n" : "\n");
+        expected.data[pair][date] = c;
+        ++rows;
+    };
+
+    std::mt19937_64 rng(11);
+    std::uniform_real_distribution<double> value(0.001, 100000.0);
+    auto randomBar = [&]() {
+        const double o = value(rng), v = value(rng);
+        return OHLCV{o, o * 1.1, o * 0.9, value(rng), v, v * o, std::floor(v), 0.0, 0.0};
+    };
+
+    const std::string longPair(2 * CSV_CHUNK_BYTES + 123, 'L');
+    bool longAdded = false, overflowAdded = false;
+
+    for (int i = 0; content.size() < 3 * CSV_CHUNK_BYTES + 5000; ++i)
+    {
+        const std::string pair = fmt::format("P{:04}USDT", i / 1500);
+        const auto date = static_cast<unsigned int>(shiftDays(20200101, i % 1500));
+        addRow(pair, date, randomBar(), i % 3 == 0);
+
+        if (i % 997 == 0)
+            content += "\n";
+
+        // Starts half a chunk in, ends past 2.5 chunks
+        if (!longAdded && content.size() > CSV_CHUNK_BYTES / 2)
+        {
+            addRow(longPair, 20240101, OHLCV{1, 2, 0.5, 1.5, 10, 15, 3, 0, 0}, false);
+            longAdded = true;
+        }
+        if (!overflowAdded && content.size() > 2 * CSV_CHUNK_BYTES + CSV_CHUNK_BYTES / 2)
+        {
+            content += "XXXUSDT,20240101,1,2,0.5,1.5,10";
+            for (std::size_t f = 7; f < 2 * CsvRecordScanner::MAX_FIELDS; ++f)
+                content += ",0";
+            content += "\n";
+            overflowAdded = true;
+        }
+    }
+    while (content.back() == '\n' || content.back() == '\r')
+        content.pop_back();                         // No final line feed
+
+    const std::size_t longStart = content.find(longPair);
+    CHECK(content.size() > 3 * CSV_CHUNK_BYTES);
+    CHECK(longStart < CSV_CHUNK_BYTES && longStart + longPair.size() > 2 * CSV_CHUNK_BYTES);
+
+    const fs::path csv = workDir / "chunks.csv";
+    writeFile(csv, content);
+
+    for (std::size_t threads : {1, 4})
+    {
+        OHLCVData data;
+        CsvIoStats stats;
+        CHECK(loadOhlcvCsv(csv, threads, data, stats));
+        CHECK(stats.rows == rows);
+        CHECK(stats.bad == 1);
+        CHECK(stats.bytes == content.size());
+        CHECK(data.data.count(longPair) == 1);
+        CHECK(sameData(data, expected));
+    }
+    fs::remove(csv);
+}
+
+/**************************************************************************************
+ * Purpose : The SSE2 scan and the scalar one split random CSV-like text identically:
+ *           field lengths around the 16-byte blocks, empty fields, blank and CRLF
+ *           lines, records past MAX_FIELDS, with and without a final line feed.
+ **************************************************************************************/
+static void testScalarEquivalence()
+{
+    std::mt19937_64 rng(3);
+    std::uniform_int_distribution<int> fieldLength(0, 40);
+    std::uniform_int_distribution<int> fieldCount(1, 2 * static_cast<int>(CsvRecordScanner::MAX_FIELDS));
+    std::uniform_int_distribution<int> kind(0, 9);
+
+    std::string text;
+    for (int line = 0; line < 3000; ++line)
+    {
+        const int k = kind(rng);
+        if (k < 2) {
+            text += k == 0 ? "\n" : "\r\n";
+            continue;
+        }
+
+        const int fields = k < 8 ? std::min(fieldCount(rng), 12) : fieldCount(rng);
+        for (int f = 0; f < fields; ++f)
+        {
+            if (f > 0)
+                text += ',';
+            text.append(static_cast<std::size_t>(fieldLength(rng)), static_cast<char>('a' + f % 26));
+        }
+        text += k == 9 ? "\r\n" : "\n";
+    }
+
+    for (const std::string& input : {text, text.substr(0, text.size() - 1), text.substr(0, text.size() / 2 + 7),
+                                     std::string(","), std::string("\n"), std::string("abc\r")})
+    {
+        const auto sse = scanRecords<CsvRecordScanner>(input);
+        const auto scalar = scanRecordsScalar(input);
+        CHECK(sse == scalar);
+    }
+
+    const auto records = scanRecordsScalar(text);
+    std::size_t overflows = 0, blanks = 0;
+    for (const auto& r : records)
+    {
+        overflows += r.overflow;
+        blanks    += r.blank;
+        CHECK(r.fields.size() <= CsvRecordScanner::MAX_FIELDS);
+        CHECK(r.fields.empty() || r.fields.back().empty() || r.fields.back().back() != '\r');
+    }
+    CHECK(records.size() == 3000);
+    CHECK(overflows > 0 && blanks > 0);
+}
+
+int main()
+{
+    Logger::Instance().Setup(false, true, "", "", false);
+
+    workDir = fs::temp_directory_path() / fs::unique_path("csv_io_%%%%%%");
+    fs::create_directories(workDir);
+
+    testRoundTrip();
+    testCrlfAndLastLine();
+    testFieldLimit();
+    testChunkBoundaries();
+    testScalarEquivalence();
+
+    fs::remove_all(workDir);
+    return testResult();
+}
@@ -0,0 +1,155 @@
+#include "binary_io.h"
+#include "database_http_cassette.h"
+#include "logger.h"
+#include "test_check.h"
+
+#include <chrono>
+#include <boost/filesystem.hpp>
+#include <fmt/format.h>
+
+namespace fs = boost::filesystem;
+using namespace std::chrono_literals;
+
+static fs::path workDir;
+
+static const std::string KLINES_URL = "https://api.binance.com/api/v3/klines?symbol=BTCUSDT&interval=1d&limit=2";
+static const std::string TICKER_URL = "https://api.binance.com/api/v3/ticker/24hr";
+
+static void configure(CassetteMode mode, const fs::path& directory, double latencyScale)
+{
+    HttpCassetteSettings settings;
+    settings.mode         = mode;
+    settings.directory    = directory;
+    settings.latencyScale = latencyScale;
+    HttpCassette::Instance().Configure(settings);
+}
+
+// Entry file of `url` (named after its FNV-1a hash, as HttpCassette does).
+static fs::path entryOf(const fs::path& directory, const std::string& url)
+{
+    return directory / fmt::format("{:016x}.http", fnv1a64(url));
+}
+
+/**************************************************************************************
+ * Purpose : record() then lookup() / replay(): status, body (binary safe) and the
+ *           recorded latency scaled by latencyScale (slept by replay() only).
+ **************************************************************************************/
+static void testRecordReplay(const fs::path& dir)
+{
+    HttpCassette& cassette = HttpCassette::Instance();
+
+    const std::string body = std::string("[[1704067200000,\"42283.58\"]]") + '\0' + "tail";
+    configure(CassetteMode::Record, dir, 1.0);
+    CHECK(cassette.mode() == CassetteMode::Record);
+    CHECK(fs::is_directory(dir));                   // Created by Configure
+
+    cassette.record(KLINES_URL, 200, body, 40ms);
+    cassette.record(TICKER_URL, 429, "{\"code\":-1003}", 1ms);
+    cassette.record(TICKER_URL, 200, "[]", 3ms);    // Retried: the last response wins
+
+    configure(CassetteMode::Replay, dir, 0.5);
+    CHECK(cassette.mode() == CassetteMode::Replay);
+
+    long status = 0;
+    std::string got;
+    std::chrono::microseconds delay{0};
+    CHECK(cassette.lookup(KLINES_URL, status, got, delay));
+    CHECK(status == 200);
+    CHECK(got == body);
+    CHECK(delay == 20ms);
+
+    CHECK(cassette.lookup(TICKER_URL, status, got, delay));
+    CHECK(status == 200 && got == "[]" && delay == 1500us);
+
+    const auto start = std::chrono::steady_clock::now();
+    CHECK(cassette.replay(KLINES_URL, status, got));
+    CHECK(std::chrono::steady_clock::now() - start >= 20ms);
+    CHECK(status == 200 && got == body);
+
+    configure(CassetteMode::Replay, dir, 0.0);      // As fast as possible
+    CHECK(cassette.lookup(KLINES_URL, status, got, delay));
+    CHECK(delay == 0us);
+
+    CHECK(!cassette.lookup(KLINES_URL + "&startTime=0", status, got, delay));
+}
+
+/**************************************************************************************
+ * Purpose : Unreadable entries are misses: truncated, wrong magic, empty.
+ **************************************************************************************/
+static void testCorruptEntry(const fs::path& dir)
+{
+    HttpCassette& cassette = HttpCassette::Instance();
+    const fs::path entry = entryOf(dir, KLINES_URL);
+
+    std::string raw;
+    CHECK(readFile(entry, raw));
+
+    long status = 0;
+    std::string body;
+    std::chrono::microseconds delay{0};
+
+    CHECK(writeFileAtomic(entry, std::string_view(raw).substr(0, raw.size() - 10)));
+    CHECK(!cassette.lookup(KLINES_URL, status, body, delay));
+
+    std::string badMagic = raw;
+    badMagic[0] ^= 0x20;
+    CHECK(writeFileAtomic(entry, badMagic));
+    CHECK(!cassette.lookup(KLINES_URL, status, body, delay));
+
+    CHECK(writeFileAtomic(entry, ""));
+    CHECK(!cassette.lookup(KLINES_URL, status, body, delay));
+
+    CHECK(writeFileAtomic(entry, raw));             // Restored
+    CHECK(cassette.lookup(KLINES_URL, status, body, delay));
+}
+
+/**************************************************************************************
+ * Purpose : Two URLs sharing a hash share an entry file; the entry keeps its URL, so
+ *           the one that was not recorded misses instead of getting the other's body.
+ **************************************************************************************/
+static void testHashCollision(const fs::path& dir)
+{
+    HttpCassette& cassette = HttpCassette::Instance();
+    const std::string other = "https://api.binance.com/api/v3/exchangeInfo";
+
+    // Simulated collision: the file of `other` holds the KLINES_URL entry
+    fs::copy_file(entryOf(dir, KLINES_URL), entryOf(dir, other), fs::copy_options::overwrite_existing);
+
+    long status = 0;
+    std::string body;
+    std::chrono::microseconds delay{0};
+    CHECK(!cassette.lookup(other, status, body, delay));
+    CHECK(body.empty());
+    CHECK(cassette.lookup(KLINES_URL, status, body, delay));
+}
+
+/**************************************************************************************
+ * Purpose : Replaying a missing directory: every request misses, nothing is created.
+ **************************************************************************************/
+static void testMissingDirectory()
+{
+    const fs::path missing = workDir / "missing";
+    configure(CassetteMode::Replay, missing, 1.0);
+
+    long status = 0;
+    std::string body;
+    CHECK(!HttpCassette::Instance().replay(KLINES_URL, status, body));
+    CHECK(!fs::exists(missing));
+}
+
+int main()
+{
+    Logger::Instance().Setup(false, true, "", "", false);
+
+    workDir = fs::temp_directory_path() / fs::unique_path("http_cassette_%%%%%%");
+    const fs::path dir = workDir / "cassette";
+
+    testRecordReplay(dir);
+    testCorruptEntry(dir);
+    testHashCollision(dir);
+    testMissingDirectory();
+
+    configure(CassetteMode::Off, {}, 1.0);
+    fs::remove_all(workDir);
+    return testResult();
+}
@@ -0,0 +1,388 @@
+#include "database_downloader.h"
+#include "database_kline_stream.h"
+#include "logger.h"
+#include "market_data_reader.h"
+#include "test_check.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <nlohmann/json.hpp>
+
+namespace fs = boost::filesystem;
+using Clock = std::chrono::steady_clock;
+using namespace std::chrono_literals;
+
+/***********************************************
+ * Exit code meson reports as a skipped test.
+ ***********************************************/
+static constexpr int TEST_SKIPPED = 77;
+
+static std::string standinExe;
+static fs::path    workDir;
+
+// Whether this libcurl was built with the websocket API.
+static bool curlHasWebsockets()
+{
+    const curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+    for (const char* const* p = info->protocols; p && *p; ++p)
+    {
+        if (std::strcmp(*p, "ws") == 0)
+            return true;
+    }
+    return false;
+}
+
+// A loopback port nothing listens on (bound, read back, released).
+static int freePort()
+{
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+
+    socklen_t size = sizeof(addr);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &size);
+    ::close(fd);
+    return ntohs(addr.sin_port);
+}
+
+static bool accepting(int port)
+{
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    const bool ok = ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    ::close(fd);
+    return ok;
+}
+
+// Polls `done` every 10 ms until it holds or `timeout` expires. Return: done().
+static bool waitFor(const std::function<bool()>& done, std::chrono::milliseconds timeout)
+{
+    const auto end = Clock::now() + timeout;
+    while (!done())
+    {
+        if (Clock::now() >= end)
+            return false;
+        std::this_thread::sleep_for(10ms);
+    }
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : algotrading_ws_standin child process on `port`, started with `args`
+ *           (--port added) in the work directory, stopped with SIGTERM on destruction.
+ **************************************************************************************/
+class StandIn {
+public:
+    StandIn(int port, std::vector<std::string> args)
+    {
+        args.insert(args.begin(), {standinExe, "--port", std::to_string(port)});
+
+        pid_ = ::fork();
+        if (pid_ == 0)
+        {
+            std::vector<char*> argv;
+            for (auto& a : args)
+                argv.push_back(a.data());
+            argv.push_back(nullptr);
+
+            if (::chdir(workDir.c_str()) == 0)
+                ::execv(standinExe.c_str(), argv.data());
+            _exit(127);
+        }
+
+        ready_ = pid_ > 0 && waitFor([port] { return accepting(port); }, 5s);
+        CHECK(ready_);
+    }
+
+    ~StandIn()
+    {
+        if (pid_ <= 0)
+            return;
+        ::kill(pid_, SIGTERM);
+        ::waitpid(pid_, nullptr, 0);
+    }
+
+    StandIn(const StandIn&) = delete;
+    StandIn& operator=(const StandIn&) = delete;
+
+    bool ready() const noexcept { return ready_; }
+
+private:
+    pid_t pid_ = -1;
+    bool  ready_ = false;
+};
+
+/***********************************************
+ * Batches handed over by a consumer, with the
+ * time each one arrived.
+ ***********************************************/
+struct Batches {
+    std::mutex mutex;
+    std::vector<std::pair<Clock::time_point, OHLCVData>> list;
+
+    KlineStreamConsumer::ClosedHandler handler()
+    {
+        return [this](const OHLCVData& data) {
+            std::lock_guard<std::mutex> lock(mutex);
+            list.emplace_back(Clock::now(), data);
+        };
+    }
+
+    std::size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return list.size();
+    }
+};
+
+static KlineStreamSettings streamSettings(int port, int flushMillis)
+{
+    KlineStreamSettings settings;
+    settings.enabled     = true;
+    settings.url         = "ws://127.0.0.1:" + std::to_string(port);
+    settings.flushMillis = flushMillis;
+    return settings;
+}
+
+// Whether every pair of `data` holds exactly the candle of `ymd`, with sane values.
+static bool onlyDay(const OHLCVData& data, unsigned int ymd)
+{
+    for (const auto& [pair, days] : data.data)
+    {
+        if (days.size() != 1 || days.begin()->first != ymd)
+            return false;
+        const OHLCV& c = days.begin()->second;
+        if (!(c.close > 0.0 && c.high >= c.low && c.high >= c.close && c.low <= c.close && c.volume > 0.0))
+            return false;
+    }
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Every message split into 37-byte frames: the consumer must reassemble them,
+ *           and each complete close burst (all 3 pairs) is one batch, handed over at
+ *           once rather than after the 5 s quiet time.
+ **************************************************************************************/
+static void testFragmentsAndBursts(const ExchangeAdapter& binance)
+{
+    const int port = freePort();
+    StandIn standin(port, {"--start", "20260301", "--days", "2", "--updates", "2",
+                           "--interval-ms", "50", "--fragment-bytes", "37"});
+    if (!standin.ready())
+        return;
+
+    Batches batches;
+    KlineStreamConsumer consumer(binance, streamSettings(port, 5000), batches.handler());
+    const auto started = Clock::now();
+    consumer.start({"BTCUSDT", "ETHUSDT", "SOLUSDT"});
+
+    CHECK(waitFor([&] { return batches.size() >= 2; }, 4s));
+    CHECK(consumer.live());
+    consumer.stop();
+
+    CHECK(batches.list.size() == 2);
+    if (batches.list.size() != 2)
+        return;
+    CHECK(batches.list[0].second.data.size() == 3);
+    CHECK(batches.list[1].second.data.size() == 3);
+    CHECK(onlyDay(batches.list[0].second, 20260301));
+    CHECK(onlyDay(batches.list[1].second, 20260302));
+    CHECK(batches.list[1].first - started < 4s);
+}
+
+/**************************************************************************************
+ * Purpose : A pair whose candle never closes: the other pair's close is handed over
+ *           alone once no close arrived for flushMillis.
+ **************************************************************************************/
+static void testQuietFlush(const ExchangeAdapter& binance)
+{
+    const int port = freePort();
+    StandIn standin(port, {"--start", "20260301", "--days", "1", "--updates", "2",
+                           "--interval-ms", "50", "--stall", "ethusdt"});
+    if (!standin.ready())
+        return;
+
+    Batches batches;
+    KlineStreamConsumer consumer(binance, streamSettings(port, 700), batches.handler());
+    const auto started = Clock::now();
+    consumer.start({"BTCUSDT", "ETHUSDT"});
+
+    CHECK(waitFor([&] { return batches.size() >= 1; }, 4s));
+    std::this_thread::sleep_for(1s);
+    consumer.stop();
+
+    CHECK(batches.list.size() == 1);
+    if (batches.list.empty())
+        return;
+    CHECK(batches.list[0].first - started >= 700ms);
+    CHECK(batches.list[0].second.data.size() == 1);
+    CHECK(batches.list[0].second.data.count("BTCUSDT") == 1);
+    CHECK(onlyDay(batches.list[0].second, 20260301));
+}
+
+/**************************************************************************************
+ * Purpose : The stand-in closes the first connection (CLOSE frame) after 4 messages,
+ *           i.e. after the first close: the consumer reopens it after the 1 s backoff
+ *           and receives the replay of every day.
+ **************************************************************************************/
+static void testServerClose(const ExchangeAdapter& binance)
+{
+    const int port = freePort();
+    StandIn standin(port, {"--start", "20260301", "--days", "3", "--updates", "2",
+                           "--interval-ms", "100", "--close-after", "4"});
+    if (!standin.ready())
+        return;
+
+    Batches batches;
+    KlineStreamConsumer consumer(binance, streamSettings(port, 5000), batches.handler());
+    consumer.start({"BTCUSDT"});
+
+    CHECK(waitFor([&] { return batches.size() >= 1; }, 3s));
+    CHECK(waitFor([&] { return !consumer.live(); }, 2s));        // CLOSE received
+    CHECK(waitFor([&] { return batches.size() >= 4; }, 5s));
+    consumer.stop();
+
+    // Day 1, then after the reconnection days 1 to 3 again
+    CHECK(batches.list.size() == 4);
+    if (batches.list.size() != 4)
+        return;
+    const unsigned int days[] = {20260301, 20260301, 20260302, 20260303};
+    for (std::size_t i = 0; i < 4; ++i)
+        CHECK(onlyDay(batches.list[i].second, days[i]));
+    CHECK(batches.list[1].first - batches.list[0].first >= 1s);
+}
+
+/**************************************************************************************
+ * Purpose : Nothing listens at first: attempts at 0 s and 1 s fail, the next one waits
+ *           for the doubled backoff (3 s), although the stand-in is up from 1.5 s.
+ **************************************************************************************/
+static void testBackoff(const ExchangeAdapter& binance)
+{
+    const int port = freePort();
+
+    Batches batches;
+    KlineStreamConsumer consumer(binance, streamSettings(port, 1000), batches.handler());
+    const auto started = Clock::now();
+    consumer.start({"BTCUSDT"});
+
+    std::this_thread::sleep_for(1500ms);
+    CHECK(!consumer.live());
+
+    StandIn standin(port, {"--start", "20260301", "--days", "1", "--interval-ms", "100"});
+    if (!standin.ready())
+        return;
+
+    CHECK(waitFor([&] { return consumer.live(); }, 5s));
+    const auto opened = Clock::now() - started;
+    CHECK(opened >= 2800ms);
+    CHECK(opened < 4500ms);
+
+    CHECK(waitFor([&] { return batches.size() >= 1; }, 3s));
+    consumer.stop();
+}
+
+/**************************************************************************************
+ * Purpose : Through the downloader: BTCUSDT has the day before the stream stored, so
+ *           its streamed days are committed; ETHUSDT has no history, so its candles
+ *           are deferred to the REST gap repair and nothing of it is written.
+ **************************************************************************************/
+static void testStoreDeferral()
+{
+    const int port = freePort();
+    const fs::path database = workDir / "stream.db";
+
+    DatabaseConfig config;
+    config.ParseConfig({
+        {"main_exchange", "binance"},
+        {"database_path", database.string()},
+        {"kline_stream", {{"enabled", true}, {"url", "ws://127.0.0.1:" + std::to_string(port)}, {"flush_ms", 200}}}
+    });
+
+    DatabaseDownloader downloader(config);
+
+    SqliteConnection db;
+    CHECK(db.open(database));
+    db.setBusyTimeout(5000);
+    CHECK(db.exec("INSERT INTO tracked_pairs (date, pair, days_out, rank, quote_volume) VALUES "
+                  "(20260228, 'BTCUSDT', 0, 1, 1e9), (20260228, 'ETHUSDT', 0, 2, 1e8);"));
+
+    OHLCVData history;
+    history.data["BTCUSDT"][20260228] = OHLCV{100, 110, 90, 105, 1000, 105000, 50, 500, 52500};
+    CHECK(downloader.importOHLCV(history));
+
+    StandIn standin(port, {"--start", "20260301", "--days", "2", "--updates", "2", "--interval-ms", "50"});
+    if (!standin.ready())
+        return;
+
+    downloader.startKlineStream();
+    CHECK(waitFor([&] { return downloader.klineStreamLive(); }, 3s));
+
+    MarketDataReader reader(db);
+    CHECK(waitFor([&] {
+        SymbolBar last;
+        return reader.latest("BTCUSDT", last) && last.date == 20260302;
+    }, 5s));
+
+    // Let the ETHUSDT candles of the same bursts go through storeStreamedCandles too
+    std::this_thread::sleep_for(500ms);
+
+    const BarColumns btc = reader.bars({"BTCUSDT"}, 0, INT_MAX);
+    CHECK((btc.date == std::vector<int>{20260228, 20260301, 20260302}));
+    CHECK(reader.bars({"ETHUSDT"}, 0, INT_MAX).empty());
+}
+
+int main(int argc, char** argv)
+{
+    Logger::Instance().Setup(false, true, "", "", false);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    if (argc < 2)
+    {
+        std::cerr << "usage: test_kline_stream <algotrading_ws_standin>\n";
+        return 2;
+    }
+    standinExe = fs::absolute(argv[1]).string();
+
+    if (!KLINE_STREAM_WEBSOCKETS || !curlHasWebsockets())
+    {
+        std::cerr << "libcurl " << curl_version_info(CURLVERSION_NOW)->version
+                  << " has no websocket support, skipped\n";
+        return TEST_SKIPPED;
+    }
+
+    workDir = fs::temp_directory_path() / fs::unique_path("kline_stream_%%%%%%");
+    fs::create_directories(workDir);
+
+    auto binance = makeExchangeAdapter("binance");
+    CHECK(binance != nullptr);
+    if (binance)
+    {
+        testFragmentsAndBursts(*binance);
+        testQuietFlush(*binance);
+        testServerClose(*binance);
+        testBackoff(*binance);
+    }
+    testStoreDeferral();
+
+    fs::remove_all(workDir);
+    return testResult();
+}
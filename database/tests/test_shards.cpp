@@ -0,0 +1,254 @@
+#include "bar_block_source.h"
+#include "database_csv_io.h"
+#include "database_downloader.h"
+#include "logger.h"
+#include "market_data_reader.h"
+#include "shard_catalog.h"
+#include "test_check.h"
+
+#include <algorithm>
+#include <set>
+#include <boost/filesystem.hpp>
+#include <fmt/format.h>
+
+namespace fs = boost::filesystem;
+
+/***********************************************
+ * Generated history: more years × buckets than
+ * SQLite attaches, so every read needs passes.
+ ***********************************************/
+static constexpr int N_SYMBOLS    = 12;
+static constexpr int FIRST_YEAR   = 2012;
+static constexpr int LAST_YEAR    = 2025;
+static constexpr int BUCKETS      = 4;
+
+static fs::path workDir;
+
+// Buckets the generated symbols hash to.
+static std::size_t usedBuckets(const ShardCatalog& catalog)
+{
+    std::set<int> buckets;
+    for (int i = 0; i < N_SYMBOLS; ++i)
+        buckets.insert(catalog.keyOf(fmt::format("S{:02}USDT", i), 0).bucket);
+    return buckets.size();
+}
+
+// Days 1, 11 and 21 of every month over [firstYear, lastYear], one random walk per symbol.
+static OHLCVData generateData(int firstYear, int lastYear)
+{
+    OHLCVData data;
+    for (int i = 0; i < N_SYMBOLS; ++i)
+    {
+        auto& bars = data.data[fmt::format("S{:02}USDT", i)];
+        double close = 10.0 + i;
+        for (int year = firstYear; year <= lastYear; ++year)
+            for (int month = 1; month <= 12; ++month)
+                for (int day = 1; day <= 21; day += 10)
+                {
+                    const double open = close;
+                    close = open * (1.0 + 0.01 * ((year + month * 7 + day + i) % 11 - 5));
+                    const double volume = 1000.0 + year % 100 + month + i;
+                    bars[year * 10000 + month * 100 + day] =
+                        OHLCV{open, std::max(open, close) * 1.01, std::min(open, close) * 0.99, close,
+                              volume, volume * close, 40.0 + i, volume / 2, volume * close / 2};
+                }
+    }
+    return data;
+}
+
+static std::size_t rowCount(const OHLCVData& data)
+{
+    std::size_t rows = 0;
+    for (const auto& [pair, bars] : data.data)
+        rows += bars.size();
+    return rows;
+}
+
+// Whether `columns` holds exactly the bars of `data` (any row order).
+static bool sameBars(const OHLCVData& data, const BarColumns& columns)
+{
+    if (columns.size() != rowCount(data))
+        return false;
+
+    for (std::size_t row = 0; row < columns.size(); ++row)
+    {
+        auto pair = data.data.find(columns.symbolOf(row));
+        if (pair == data.data.end())
+            return false;
+        auto bar = pair->second.find(static_cast<unsigned int>(columns.date[row]));
+        if (bar == pair->second.end())
+            return false;
+
+        const OHLCV read = columns.bar(row);
+        if (read.open != bar->second.open || read.close != bar->second.close ||
+            read.volume != bar->second.volume || read.trades != bar->second.trades ||
+            read.takerBuyQuoteVolume != bar->second.takerBuyQuoteVolume)
+            return false;
+    }
+    return true;
+}
+
+static nlohmann::json configOf(const fs::path& database, bool sharded)
+{
+    nlohmann::json j = {
+        {"main_exchange", "binance"},
+        {"database_path", database.string()}
+    };
+    if (sharded)
+        j["sharding"] = {{"scheme", "year_symbol"}, {"symbol_buckets", BUCKETS}, {"writer_threads", 3}};
+    return j;
+}
+
+/**************************************************************************************
+ * Purpose : Rows stored before sharding was configured move to the shards on the next
+ *           open, new stores keep adding shards past the attach limit, and the main
+ *           table is left empty.
+ **************************************************************************************/
+static void testMigration(const fs::path& database, const OHLCVData& history, const OHLCVData& recent)
+{
+    {
+        DatabaseConfig config;
+        config.ParseConfig(configOf(database, false));
+        DatabaseDownloader downloader(config);
+        CHECK(downloader.importOHLCV(history));
+    }
+
+    {
+        DatabaseConfig config;
+        config.ParseConfig(configOf(database, true));
+        DatabaseDownloader downloader(config);
+        CHECK(downloader.importOHLCV(recent));
+    }
+
+    ShardCatalog catalog;
+    CHECK(catalog.load(database));
+    CHECK(catalog.enabled());
+    CHECK(catalog.scheme() == ShardScheme::YearSymbol);
+    CHECK(catalog.shards().size() == static_cast<std::size_t>(LAST_YEAR + 1 - FIRST_YEAR + 1) * usedBuckets(catalog));
+    CHECK(catalog.shards().size() > static_cast<std::size_t>(maxAttachedShards()));
+
+    SqliteConnection db;
+    CHECK(db.open(database, SQLITE_OPEN_READONLY));
+    CachedStatement count = db.cached("SELECT COUNT(*) FROM main.ohlcv_data;");
+    CHECK(count && sqlite3_step(count) == SQLITE_ROW && sqlite3_column_int(count, 0) == 0);
+}
+
+/**************************************************************************************
+ * Purpose : A ShardedView reads back every bar: the whole table only in passes (one
+ *           attach over every shard is refused), one symbol in fewer passes, and each
+ *           pass attaches at most maxAttachedShards() shards.
+ **************************************************************************************/
+static void testView(const fs::path& database, const OHLCVData& all)
+{
+    SqliteConnection db;
+    CHECK(db.open(database, SQLITE_OPEN_READONLY));
+
+    ShardedView view;
+    CHECK(view.refresh(database));
+    CHECK(view.sharded());
+    CHECK(!view.attach(db));
+
+    MarketDataReader reader(db);
+
+    const auto passes = view.passes({});
+    CHECK(passes.size() > 1);
+    CHECK(passes.front().first == 0 && passes.back().second == INT_MAX);
+
+    BarColumns merged;
+    for (const auto& [from, to] : passes)
+    {
+        CHECK(view.attach(db, {}, from, to));
+        CHECK(view.attached() <= static_cast<std::size_t>(maxAttachedShards()));
+
+        BarCursor cursor = reader.scan(BarQuery{{}, from, to, BarOrder::BySymbol});
+        while (cursor.append(merged) > 0) {}
+        CHECK(!cursor.failed());
+    }
+    CHECK(sameBars(all, merged));
+
+    // One symbol: one bucket per year
+    const std::string symbol = "S05USDT";
+    const auto symbolPasses = view.passes({symbol});
+    CHECK(symbolPasses.size() < passes.size());
+
+    OHLCVData one;
+    one.data[symbol] = all.data.at(symbol);
+    BarColumns bars;
+    for (const auto& [from, to] : symbolPasses)
+    {
+        CHECK(view.attach(db, {symbol}, from, to));
+        BarCursor cursor = reader.scan(BarQuery{{symbol}, from, to, BarOrder::BySymbol});
+        while (cursor.append(bars) > 0) {}
+    }
+    CHECK(sameBars(one, bars));
+    CHECK(std::is_sorted(bars.date.begin(), bars.date.end()));
+
+    // One year: a single pass over its buckets
+    ShardCatalog catalog;
+    CHECK(catalog.load(database));
+    CHECK(view.passes({}, 20150101, 20151231).size() == 1);
+    CHECK(view.attach(db, {}, 20150101, 20151231));
+    CHECK(view.attached() == usedBuckets(catalog));
+    CHECK(reader.latestDate() == 20151221);
+}
+
+/**************************************************************************************
+ * Purpose : The readers built on the view: SqliteBarSource (symbol ranges and blocks
+ *           spanning several passes) and the CSV export.
+ **************************************************************************************/
+static void testReaders(const fs::path& database, const OHLCVData& all)
+{
+    SqliteBarSource source;
+    CHECK(source.open(database));
+
+    const std::vector<SymbolRange> ranges = source.ranges();
+    CHECK(ranges.size() == N_SYMBOLS);
+    for (const auto& range : ranges)
+    {
+        CHECK(range.first == FIRST_YEAR * 10000 + 101);
+        CHECK(range.last == (LAST_YEAR + 1) * 10000 + 1221);
+    }
+
+    BarBlock block;
+    CHECK(source.load("S03USDT", 20100101, 20301231, block));
+    const auto& expected = all.data.at("S03USDT");
+    CHECK(block.dates.size() == expected.size());
+    auto it = expected.begin();
+    for (std::size_t i = 0; i < block.dates.size() && it != expected.end(); ++i, ++it)
+        CHECK(block.dates[i] == static_cast<Timestamp>(it->first) && block.bars[i].close == it->second.close);
+
+    const fs::path csv = workDir / "export.csv";
+    CsvIoStats stats;
+    CHECK(exportOhlcvCsv(database, "ohlcv_data", csv.string(), CsvExportFilter{}, stats));
+    CHECK(stats.rows == rowCount(all));
+
+    CsvExportFilter filter;
+    filter.pairs    = {"S07USDT"};
+    filter.fromDate = 20131201;
+    filter.toDate   = 20240131;
+    CHECK(exportOhlcvCsv(database, "ohlcv_data", csv.string(), filter, stats));
+    CHECK(stats.rows == (10 * 12 + 2) * 3);
+}
+
+int main()
+{
+    Logger::Instance().Setup(false, true, "", "", false);
+
+    workDir = fs::temp_directory_path() / fs::unique_path("shards_%%%%%%");
+    fs::create_directories(workDir);
+    const fs::path database = workDir / "market.db";
+
+    const OHLCVData history = generateData(FIRST_YEAR, LAST_YEAR);
+    const OHLCVData recent  = generateData(LAST_YEAR + 1, LAST_YEAR + 1);
+
+    OHLCVData all = history;
+    for (const auto& [pair, bars] : recent.data)
+        all.data[pair].insert(bars.begin(), bars.end());
+
+    testMigration(database, history, recent);
+    testView(database, all);
+    testReaders(database, all);
+
+    fs::remove_all(workDir);
+    return testResult();
+}
@@ -0,0 +1,169 @@
+#include "database_downloader.h"
+#include "logger.h"
+#include "test_check.h"
+
+#include <chrono>
+#include <cmath>
+#include <fmt/core.h>
+#include <set>
+
+using namespace std::chrono;
+
+/***********************************************
+ * Size of the generated venue.
+ ***********************************************/
+static constexpr int N_SYMBOLS = 600;
+
+// Deterministic generator (xorshift): the same universe on every run.
+static uint64_t nextRandom(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/**************************************************************************************
+ * Purpose : 24h quote volumes of the generated venue on day `day`: a log-uniform spread
+ *           that drifts day by day, so symbols cross the top-N boundary, plus a few
+ *           settled contracts with zero volume.
+ **************************************************************************************/
+static std::vector<SymbolVolume> listedOn(int day)
+{
+    std::vector<SymbolVolume> listed;
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < N_SYMBOLS; ++i)
+    {
+        const double base  = std::pow(10.0, 4.0 + 5.0 * static_cast<double>(nextRandom(state) % 10000) / 10000.0);
+        const double drift = 1.0 + 0.6 * std::sin(0.35 * day + i);
+        const double volume = (i % 97 == 0) ? 0.0 : base * drift;
+        listed.push_back({fmt::format("S{:03}USDT", i), volume});
+    }
+    return listed;
+}
+
+// Ranks 1..size, by decreasing volume, all above the policy floor.
+static void checkRanking(const Universe& universe, const UniversePolicy& policy)
+{
+    std::vector<const UniverseEntry*> byRank(universe.size() + 1, nullptr);
+    for (const auto& [symbol, entry] : universe)
+    {
+        CHECK(entry.rank >= 1 && entry.rank <= static_cast<int>(universe.size()));
+        CHECK(entry.quoteVolume > 0.0 && entry.quoteVolume >= policy.minQuoteVolume);
+        if (entry.rank >= 1 && entry.rank <= static_cast<int>(universe.size()))
+        {
+            CHECK(byRank[entry.rank] == nullptr);
+            byRank[entry.rank] = &entry;
+        }
+    }
+    for (std::size_t r = 2; r < byRank.size(); ++r)
+        CHECK(byRank[r - 1] && byRank[r] && byRank[r - 1]->quoteVolume >= byRank[r]->quoteVolume);
+}
+
+static void testRanking()
+{
+    const std::vector<SymbolVolume> listed = listedOn(0);
+    std::size_t traded = 0, aboveFloor = 0;
+    for (const auto& s : listed)
+    {
+        traded     += s.quoteVolume > 0.0;
+        aboveFloor += s.quoteVolume >= 1e6;
+    }
+
+    UniversePolicy top;
+    top.topN = 200;
+    const Universe topUniverse = rankUniverse(listed, top);
+    CHECK(topUniverse.size() == 200);
+    checkRanking(topUniverse, top);
+
+    // The top N is the head of the full ranking
+    UniversePolicy all;
+    all.allSymbols = true;
+    const Universe allUniverse = rankUniverse(listed, all);
+    CHECK(allUniverse.size() == traded);
+    checkRanking(allUniverse, all);
+    for (const auto& [symbol, entry] : topUniverse)
+        CHECK(allUniverse.contains(symbol) && allUniverse.at(symbol).rank == entry.rank);
+
+    UniversePolicy floor;
+    floor.allSymbols     = true;
+    floor.minQuoteVolume = 1e6;
+    const Universe floored = rankUniverse(listed, floor);
+    CHECK(floored.size() == aboveFloor);
+    checkRanking(floored, floor);
+
+    // Ties rank by symbol
+    const Universe tied = rankUniverse({{"BUSDT", 5.0}, {"AUSDT", 5.0}, {"CUSDT", 9.0}}, all);
+    CHECK(tied.at("CUSDT").rank == 1 && tied.at("AUSDT").rank == 2 && tied.at("BUSDT").rank == 3);
+}
+
+/**************************************************************************************
+ * Purpose : Replays 60 days of the drifting top 150 (with one skipped day) through
+ *           getNewTrackedPairs and checks every day against an independent model of
+ *           the hysteresis: a pair stays tracked until it has been out of the universe
+ *           for more than maxDaysOut days, and re-entering resets its count.
+ **************************************************************************************/
+static void testHysteresis(int maxDaysOut)
+{
+    UniversePolicy policy;
+    policy.topN = 150;
+
+    std::map<std::string, int> lastIn;     // Symbol → last day in the universe
+    TrackedData tracked;
+    bool exists = false;
+    std::size_t maxTracked = 0, evictions = 0;
+
+    for (int day = 0; day < 60; ++day)
+    {
+        if (day == 30)
+            continue;                      // Missed run: the next one counts two days
+
+        const Universe universe = rankUniverse(listedOn(day), policy);
+        const auto date = year_month_day{sys_days{year{2024}/1/1} + days{day}};
+        const TrackedData next = getNewTrackedPairs(tracked, universe, exists, date, maxDaysOut);
+
+        for (const auto& [symbol, _] : universe)
+            lastIn[symbol] = day;
+
+        std::set<std::string> expected;
+        for (const auto& [symbol, last] : lastIn)
+        {
+            const int out = day - last;
+            if (maxDaysOut == 0 || out <= maxDaysOut)
+                expected.insert(symbol);
+        }
+        for (const auto& [symbol, _] : tracked.trackedPairs)
+            evictions += !next.trackedPairs.contains(symbol);
+
+        CHECK(next.trackedPairs.size() == expected.size());
+        for (const auto& symbol : expected)
+        {
+            auto it = next.trackedPairs.find(symbol);
+            CHECK(it != next.trackedPairs.end());
+            if (it != next.trackedPairs.end())
+                CHECK(it->second == day - lastIn[symbol]);
+        }
+        CHECK(next.universe == universe);
+
+        maxTracked = std::max(maxTracked, next.trackedPairs.size());
+        tracked = next;
+        exists  = true;
+    }
+
+    // The drift churns the universe: eviction bounds the tracked set, or nothing leaves
+    if (maxDaysOut > 0)
+        CHECK(evictions > 0 && maxTracked < lastIn.size());
+    else
+        CHECK(evictions == 0 && tracked.trackedPairs.size() == lastIn.size());
+}
+
+int main()
+{
+    Logger::Instance().Setup(false, true, "", "", false);
+
+    testRanking();
+    testHysteresis(7);
+    testHysteresis(0);
+
+    return testResult();
+}
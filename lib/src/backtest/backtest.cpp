@@ -1,31 +1,51 @@
 #include "backtest.h"
 #include "logger.h"
 #include "time_utils.h"
+#include "strategy_high_breakout.h"
 
 
-Backtester::Backtester(const EnrichedData& marketData,Timestamp start,Timestamp end, Strategy strategy)
-    : marketData_(marketData),
-      start_(start),
-      end_(end),
-      portfolio_(start),
-      strategy_(strategy)
-{};
-
-
-void Backtester::run(){
+void logBacktestStart(){
     LG_INFO("Starting backtest");
+}
 
-    for (auto it = marketData_.lower_bound(start_); it != marketData_.end() && it->first <= end_; ++it){
-        Timestamp ts = it->first;
-        const CoinBarMap& bars = it->second;
-
-        calculateSignals(bars, ts);
-        updatePortfolio();
-    }
-
-    LG_INFO("Storing Results:");
-    storeResults();
 
+void logBacktestResults(const Portfolio& portfolio){
+    LG_INFO("Final balance: {:.2f} | Final equity: {:.2f} | Simulated (not taken): {} | Funding paid: {:.2f}",
+            portfolio.GetCurrentBalance(), portfolio.GetCurrentEquity(), portfolio.GetNSimulated(),
+            portfolio.GetFundingPaid());
     LG_INFO("Backtest finished");
-
-}
\ No newline at end of file
+}
+
+
+// Builds the Backtester of the strategy named `name` over either kind of bar source.
+template<typename Bars>
+static std::unique_ptr<BacktestRunner> makeBacktesterOver(const std::string& name,
+                                                          Bars& bars,
+                                                          Timestamp start, Timestamp end,
+                                                          double commissionEntryPctg,
+                                                          double commissionExitPctg){
+    if (name == "high_breakout")
+        return std::make_unique<Backtester<StrategyHighBreakout>>(
+            bars, start, end, commissionEntryPctg, commissionExitPctg);
+
+    LG_ERROR("Unknown strategy '{}'", name);
+    return nullptr;
+}
+
+
+std::unique_ptr<BacktestRunner> makeBacktester(const std::string& name,
+                                               const EnrichedData& marketData,
+                                               Timestamp start, Timestamp end,
+                                               double commissionEntryPctg,
+                                               double commissionExitPctg){
+    return makeBacktesterOver(name, marketData, start, end, commissionEntryPctg, commissionExitPctg);
+}
+
+
+std::unique_ptr<BacktestRunner> makeBacktester(const std::string& name,
+                                               PagedBarFeed& feed,
+                                               Timestamp start, Timestamp end,
+                                               double commissionEntryPctg,
+                                               double commissionExitPctg){
+    return makeBacktesterOver(name, feed, start, end, commissionEntryPctg, commissionExitPctg);
+}
@@ -1,29 +1,169 @@
+#pragma once
+
+#include <concepts>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 #include "data_types.h"
 #include "portfolio.h"
-#include <vector>
 #include "strategy.h"
+#include "execution_model.h"
+#include "logger.h"
+#include "paged_bar_feed.h"
 
 
-class Backtester {
+/**************************************************************************************
+ * Purpose : Requirements for a strategy driven by Backtester<StrategyT>. Any type with
+ *           this member works; deriving from Strategy is not required. Strategies that
+ *           do derive from Strategy should be declared `final` so the per-bar call is
+ *           devirtualized and inlined into the bar loop.
+ **************************************************************************************/
+template<typename StrategyT>
+concept BacktestStrategy = requires(StrategyT& strategy,
+                                    std::vector<Trade>& trades,
+                                    const CoinBarMap& bars,
+                                    Timestamp ts) {
+    { strategy.calculateSignals(trades, bars, ts) } -> std::same_as<void>;
+};
+
+
+/**************************************************************************************
+ * Purpose : Type-erased handle for backtests whose strategy is chosen at runtime. The
+ *           virtual call happens once per run, never per bar.
+ **************************************************************************************/
+class BacktestRunner {
 public:
-    Backtester(const EnrichedData& marketData,Timestamp start,Timestamp end, Strategy strategy);
+    virtual ~BacktestRunner() = default;
 
-    void run();
+    // Runs the whole backtest.
+    virtual void run() = 0;
 
-private:
-    const EnrichedData& marketData_;
-    Portfolio portfolio_;
-    std::vector<Trade> current_trades_;
-    Strategy strategy_;
+    // Portfolio after (or during) the run.
+    virtual const Portfolio& portfolio() const = 0;
+
+    // Routes fills through an execution model (next-open, slippage, volume cap, notional
+    // commission) instead of the strategy's close/stop prices.
+    virtual void setExecutionModel(const ExecutionConfig& config) = 0;
+
+    // Accrues perpetual funding on open positions. The schedule must outlive run().
+    virtual void setFundingSchedule(const FundingSchedule& schedule) = 0;
+};
+
+
+// Logging shared by every Backtester instantiation.
+void logBacktestStart();
+void logBacktestResults(const Portfolio& portfolio);
+
+
+/**************************************************************************************
+ * Purpose : Bar-by-bar backtester statically bound to one strategy type. Owns the
+ *           portfolio and builds the strategy in place against it (the strategy keeps a
+ *           reference), so derived strategies are never sliced.
+ **************************************************************************************/
+template<BacktestStrategy StrategyT>
+class Backtester final : public BacktestRunner {
+public:
+    /**************************************************************************************
+     * Purpose : Construct the backtester and its strategy.
+     * Args    : marketData   - Enriched bars (date → pair → BarData), must outlive run().
+     *           start / end  - Inclusive date range (YYYYMMDD).
+     *           strategyArgs - Forwarded to StrategyT after the Portfolio&.
+     **************************************************************************************/
+    template<typename... Args>
+    Backtester(const EnrichedData& marketData, Timestamp start, Timestamp end, Args&&... strategyArgs)
+        : marketData_(&marketData),
+          start_(start),
+          end_(end),
+          portfolio_(start),
+          strategy_(portfolio_, std::forward<Args>(strategyArgs)...)
+    {}
+
+    /**************************************************************************************
+     * Purpose : Construct an out-of-core backtester: bars are paged in through `feed`
+     *           instead of being held in memory.
+     * Args    : feed         - Paged bar feed, must outlive run().
+     *           start / end  - Inclusive date range (YYYYMMDD).
+     *           strategyArgs - Forwarded to StrategyT after the Portfolio&.
+     **************************************************************************************/
+    template<typename... Args>
+    Backtester(PagedBarFeed& feed, Timestamp start, Timestamp end, Args&&... strategyArgs)
+        : feed_(&feed),
+          start_(start),
+          end_(end),
+          portfolio_(start),
+          strategy_(portfolio_, std::forward<Args>(strategyArgs)...)
+    {}
 
+    void run() override {
+        logBacktestStart();
+
+        if (feed_) {
+            feed_->seek(start_);
+            Timestamp ts;
+            while (const CoinBarMap* bars = feed_->next(end_, ts))
+                step(*bars, ts);
+            if (feed_->failed())
+                LG_ERROR("Backtest stopped early: bars could not be loaded, results are partial");
+        } else {
+            for (auto it = marketData_->lower_bound(start_); it != marketData_->end() && it->first <= end_; ++it)
+                step(it->second, it->first);
+        }
+
+        logBacktestResults(portfolio_);
+    }
+
+    const Portfolio& portfolio() const override { return portfolio_; }
+
+    void setExecutionModel(const ExecutionConfig& config) override { execution_.emplace(config); }
+
+    void setFundingSchedule(const FundingSchedule& schedule) override { portfolio_.setFundingSchedule(&schedule); }
+
+    StrategyT& strategy() noexcept { return strategy_; }
+
+private:
+    const EnrichedData* marketData_ = nullptr;    // In-memory bars, or
+    PagedBarFeed*       feed_       = nullptr;    // out-of-core bars
     Timestamp start_;
     Timestamp end_;
+    Portfolio portfolio_;                  // Declared before strategy_: it is bound to it
+    std::vector<Trade> current_trades_;
+    StrategyT strategy_;
+    std::optional<ExecutionModel> execution_;   // Empty = fills at strategy prices
 
-    void updatePortfolio(){
-        portfolio_.updatePortfolio(current_trades_);
-    }
+    void step(const CoinBarMap& bars, Timestamp ts) {
+        if (execution_)
+            execution_->fillEntries(current_trades_, bars, ts);
+
+        strategy_.calculateSignals(current_trades_, bars, ts);
 
-    void calculateSignals(const CoinBarMap& bars ,Timestamp& ts){
-        stratety_.calculateSignals(current_trades_, bars, ts);
+        if (execution_)
+            execution_->fillExits(current_trades_, bars);
+
+        portfolio_.updatePortfolio(current_trades_, ts);
     }
 };
+
+
+/**************************************************************************************
+ * Purpose : Creates a backtest for a strategy selected by name at runtime.
+ * Args    : name                - Strategy name (e.g., "high_breakout").
+ *           marketData          - Enriched bars, must outlive the returned runner.
+ *           start / end         - Inclusive date range (YYYYMMDD).
+ *           commissionEntryPctg - Entry commission percentage.
+ *           commissionExitPctg  - Exit commission percentage.
+ * Return  : std::unique_ptr<BacktestRunner> - nullptr if the name is unknown.
+ **************************************************************************************/
+std::unique_ptr<BacktestRunner> makeBacktester(const std::string& name,
+                                               const EnrichedData& marketData,
+                                               Timestamp start, Timestamp end,
+                                               double commissionEntryPctg,
+                                               double commissionExitPctg);
+
+// Same, over a paged bar feed (must outlive the returned runner).
+std::unique_ptr<BacktestRunner> makeBacktester(const std::string& name,
+                                               PagedBarFeed& feed,
+                                               Timestamp start, Timestamp end,
+                                               double commissionEntryPctg,
+                                               double commissionExitPctg);
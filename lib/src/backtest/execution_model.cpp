@@ -0,0 +1,171 @@
+#include "execution_model.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+/**************************************************************************************
+ * Purpose : Slippage as a fraction of price for an order of `size` base units on `bar`.
+ * Args    : bar  - Bar the order executes on.
+ *           size - Order size (base units).
+ * Return  : double - Slippage fraction (0.001 = 10 bps).
+ **************************************************************************************/
+double ExecutionModel::slippage(const BarData& bar, double size) const noexcept
+{
+    double s = config_.fixedSlippageBps * 1e-4;
+
+    if (config_.atrSlippageFraction > 0.0 && bar.open > 0.0)
+        s += config_.atrSlippageFraction * bar.atr_14d / bar.open;
+
+    if (config_.impactCoefficient > 0.0 && bar.volume > 0.0)
+        s += config_.impactCoefficient * std::sqrt(size / bar.volume);
+
+    return s;
+}
+
+
+/**************************************************************************************
+ * Purpose : Fills the entries due on this bar (trades signalled on the previous bar,
+ *           start_ == ts) at the open plus slippage, capped by volume participation, and
+ *           charges entry commission on the filled notional. Orders that cannot fill (no
+ *           bar for the coin, zero volume) are cancelled: exited on this bar with zero
+ *           size and still simulated, so the strategy cannot fill them at its own price
+ *           and the portfolio counts them as not taken. Exits deferred by fillExits()
+ *           are filled here at the open of the coin's first bar, minus slippage, and
+ *           closed on this bar before the strategy sees the trade again.
+ * Args    : trades - Current trades of one portfolio.
+ *           bars   - Bars of this timestamp.
+ *           ts     - Current timestamp.
+ * Return  : void
+ **************************************************************************************/
+void ExecutionModel::fillEntries(std::vector<Trade>& trades, const CoinBarMap& bars, Timestamp ts)
+{
+    for (auto& trade : trades)
+    {
+        if (!pendingExits_.empty() && pendingExits_.contains(trade.trade_id_))
+        {
+            auto it = bars.find(trade.coin_);
+            if (it == bars.end())
+                continue;
+
+            pendingExits_.erase(trade.trade_id_);
+            fillExit(trade, it->second, it->second.open);
+            trade.end_    = ts;
+            trade.exited_ = true;
+            continue;
+        }
+
+        if (trade.start_ != ts || !trade.isSimulated_ || trade.exited_)
+            continue;
+
+        auto it = bars.find(trade.coin_);
+        const double size = it == bars.end() ? 0.0
+                                             : std::min(trade.size_, config_.maxVolumePctg * it->second.volume);
+        if (size <= 0.0)
+        {
+            trade.size_   = 0.0;
+            trade.end_    = ts;
+            trade.exited_ = true;
+            continue;
+        }
+
+        const BarData& bar = it->second;
+
+        const double slip = slippage(bar, size);
+        const double price = trade.direction_ == Direction::Short ? bar.open * (1.0 - slip)
+                                                                  : bar.open * (1.0 + slip);
+
+        trade.entry_         = price;
+        trade.current_price_ = price;
+        trade.size_          = size;
+        trade.isSimulated_   = false;
+        trade.commission_    = price * size * config_.commissionEntryPctg;
+
+        entryCommission_[trade.trade_id_] = trade.commission_;
+    }
+}
+
+
+/**************************************************************************************
+ * Purpose : Fills the exits flagged by the strategy on this bar. A long stopped out is
+ *           filled at min(stop, open) — the open if the bar gapped below the stop —
+ *           minus slippage (mirrored for shorts). When the coin has no bar, the exit is
+ *           deferred: the trade is reopened and fillEntries() fills it on the coin's next
+ *           bar, so every exit goes through slippage. Entry commissions of trades that
+ *           left the portfolio by any other path are dropped.
+ * Args    : trades - Current trades of one portfolio.
+ *           bars   - Bars of this timestamp.
+ * Return  : void
+ **************************************************************************************/
+void ExecutionModel::fillExits(std::vector<Trade>& trades, const CoinBarMap& bars)
+{
+    for (auto& trade : trades)
+    {
+        if (!trade.exited_ || !entryCommission_.contains(trade.trade_id_))
+            continue;                      // Open, or never filled by the model
+
+        auto it = bars.find(trade.coin_);
+        if (it == bars.end())
+        {
+            trade.end_    = 0;
+            trade.exited_ = false;
+            pendingExits_.insert(trade.trade_id_);
+            continue;
+        }
+
+        const BarData& bar = it->second;
+        fillExit(trade, bar, trade.direction_ == Direction::Short ? std::max(trade.exit_, bar.open)
+                                                                  : std::min(trade.exit_, bar.open));
+    }
+
+    purgeClosed(trades);
+}
+
+
+/**************************************************************************************
+ * Purpose : Fills one exit at `exitPrice` minus slippage (plus for shorts); the total
+ *           commission becomes entry commission + exit notional × commissionExitPctg.
+ * Args    : trade     - Trade being closed, filled by fillEntries().
+ *           bar       - Bar the exit executes on.
+ *           exitPrice - Price before slippage.
+ * Return  : void
+ **************************************************************************************/
+void ExecutionModel::fillExit(Trade& trade, const BarData& bar, double exitPrice)
+{
+    auto charged = entryCommission_.find(trade.trade_id_);
+    const double entryCommission = charged->second;
+    entryCommission_.erase(charged);
+
+    const double slip = slippage(bar, trade.size_);
+    const double price = trade.direction_ == Direction::Short ? exitPrice * (1.0 + slip)
+                                                              : exitPrice * (1.0 - slip);
+
+    trade.exit_       = price;
+    trade.commission_ = entryCommission + price * trade.size_ * config_.commissionExitPctg;
+}
+
+
+/**************************************************************************************
+ * Purpose : Drops the entry commission (and pending exit) of trades that are no longer
+ *           open in `trades`: removed or closed without going through fillExits().
+ *           Scans the trades only when the counts disagree.
+ * Args    : trades - Current trades of one portfolio, after this bar's exits.
+ * Return  : void
+ **************************************************************************************/
+void ExecutionModel::purgeClosed(const std::vector<Trade>& trades)
+{
+    std::size_t open = 0;
+    for (const auto& trade : trades)
+        if (!trade.exited_ && entryCommission_.contains(trade.trade_id_))
+            ++open;
+
+    if (open == entryCommission_.size())
+        return;
+
+    std::erase_if(entryCommission_, [&](const auto& entry) {
+        return std::none_of(trades.begin(), trades.end(), [&](const Trade& trade) {
+            return trade.trade_id_ == entry.first && !trade.exited_;
+        });
+    });
+    std::erase_if(pendingExits_, [&](TradeID id) { return !entryCommission_.contains(id); });
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "data_types.h"
+
+
+/***********************************************
+ * Execution parameters. Defaults are neutral
+ * apart from next-open fills.
+ ***********************************************/
+struct ExecutionConfig {
+    double fixedSlippageBps    = 0.0;    // Constant slippage per fill (basis points)
+    double atrSlippageFraction = 0.0;    // Extra slippage = fraction × ATR14
+    double impactCoefficient   = 0.0;    // Extra slippage = coef × sqrt(order size / bar volume)
+    double maxVolumePctg       = 1.0;    // Max order size as a fraction of the bar's base volume
+    double commissionEntryPctg = 0.0;    // Charged on entry notional
+    double commissionExitPctg  = 0.0;    // Charged on exit notional
+};
+
+
+/**************************************************************************************
+ * Purpose : Execution layer between strategies and the portfolio. Strategies keep
+ *           emitting intents (entry at the signal close, exit at the stop); the model
+ *           turns them into fills, once per bar and in one batch for all trades:
+ *
+ *             - fillEntries() runs before the strategy on bar t+1: trades signalled on
+ *               bar t (start_ == ts) are filled at the open plus slippage, capped to
+ *               maxVolumePctg of the bar's volume, and charged entry commission on the
+ *               filled notional. Trades with no bar or zero fillable size are cancelled
+ *               (exited, zero size, still simulated).
+ *             - fillExits() runs after the strategy: trades stopped out on this bar are
+ *               filled at the stop, or at the open if the bar gapped through it, minus
+ *               slippage, and charged exit commission on the exit notional. An exit on
+ *               a bar without data for the coin is deferred: the trade stays open and
+ *               fillEntries() fills it at the open of the coin's next bar, before the
+ *               strategy runs.
+ *
+ *           Slippage (as a fraction of price) = fixedSlippageBps·1e-4
+ *                                             + atrSlippageFraction·ATR/open
+ *                                             + impactCoefficient·sqrt(size/volume)
+ **************************************************************************************/
+class ExecutionModel {
+public:
+    explicit ExecutionModel(const ExecutionConfig& config) : config_(config) {}
+
+    /**************************************************************************************
+     * Purpose : Fills the entries due on this bar (signalled on the previous bar) and the
+     *           exits deferred until the coin has a bar.
+     * Args    : trades - Current trades of one portfolio.
+     *           bars   - Bars of this timestamp.
+     *           ts     - Current timestamp.
+     * Return  : void
+     **************************************************************************************/
+    void fillEntries(std::vector<Trade>& trades, const CoinBarMap& bars, Timestamp ts);
+
+    /**************************************************************************************
+     * Purpose : Fills the exits flagged by the strategy on this bar.
+     * Args    : trades - Current trades of one portfolio.
+     *           bars   - Bars of this timestamp.
+     * Return  : void
+     **************************************************************************************/
+    void fillExits(std::vector<Trade>& trades, const CoinBarMap& bars);
+
+    // Slippage as a fraction of price for an order of `size` on `bar`.
+    double slippage(const BarData& bar, double size) const noexcept;
+
+    const ExecutionConfig& config() const noexcept { return config_; }
+
+private:
+    ExecutionConfig config_;
+
+    // Entry commission of each filled, still open trade (exit adds to it)
+    std::unordered_map<TradeID, double> entryCommission_;
+
+    // Trades whose exit is waiting for a bar of their coin
+    std::unordered_set<TradeID> pendingExits_;
+
+    void fillExit(Trade& trade, const BarData& bar, double exitPrice);
+    void purgeClosed(const std::vector<Trade>& trades);
+};
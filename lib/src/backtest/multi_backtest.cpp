@@ -0,0 +1,15 @@
+#include "multi_backtest.h"
+#include "logger.h"
+
+
+void logSleeveResults(std::size_t index, const Portfolio& portfolio){
+    LG_INFO("Strategy #{} | Final balance: {:.2f} | Final equity: {:.2f} | Simulated (not taken): {}",
+            index, portfolio.GetCurrentBalance(), portfolio.GetCurrentEquity(), portfolio.GetNSimulated());
+}
+
+
+void logAggregateResults(double balance, double equity, std::size_t nStrategies){
+    LG_INFO("Aggregate of {} strategies | Final balance: {:.2f} | Final equity: {:.2f}",
+            nStrategies, balance, equity);
+    LG_INFO("Backtest finished");
+}
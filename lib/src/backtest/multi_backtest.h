@@ -0,0 +1,193 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "backtest.h"
+
+
+/**************************************************************************************
+ * Purpose : Strategies that can consume a cross-sectional ranking computed once per bar
+ *           and shared with other strategies, instead of ranking the bars themselves.
+ **************************************************************************************/
+template<typename StrategyT>
+concept RankedStrategy = BacktestStrategy<StrategyT> &&
+    requires(StrategyT& strategy,
+             std::vector<Trade>& trades,
+             const CoinBarMap& bars,
+             const RankedBars& ranked,
+             Timestamp ts) {
+        { strategy.ranking() } -> std::same_as<Ranking>;
+        { strategy.calculateSignals(trades, bars, ranked, ts) } -> std::same_as<void>;
+    };
+
+
+/***********************************************
+ * One strategy run inside a MultiBacktester:
+ * its own sub-portfolio and open trades.
+ ***********************************************/
+template<BacktestStrategy StrategyT>
+struct StrategySleeve {
+    Portfolio          portfolio;          // Declared before strategy: it is bound to it
+    std::vector<Trade> current_trades;
+    StrategyT          strategy;
+    std::optional<ExecutionModel> execution;   // Per sleeve: it tracks its own fills
+
+    template<typename Tuple>
+    StrategySleeve(Timestamp start, Tuple&& args)
+        : portfolio(start),
+          strategy(std::make_from_tuple<StrategyT>(
+              std::tuple_cat(std::forward_as_tuple(portfolio), std::forward<Tuple>(args))))
+    {}
+
+    // The strategy references portfolio: a sleeve must never move.
+    StrategySleeve(const StrategySleeve&) = delete;
+    StrategySleeve& operator=(const StrategySleeve&) = delete;
+};
+
+
+// Logging shared by every MultiBacktester instantiation.
+void logSleeveResults(std::size_t index, const Portfolio& portfolio);
+void logAggregateResults(double balance, double equity, std::size_t nStrategies);
+
+
+/**************************************************************************************
+ * Purpose : Drives several strategies from a single pass over the bar stream. Each bar
+ *           (and its enriched indicators) is read once; cross-sectional rankings are
+ *           computed once per distinct Ranking and shared by every strategy that uses
+ *           it. Each strategy trades its own sub-portfolio, and an aggregate balance /
+ *           equity curve (sum of the sub-portfolios) is kept per bar.
+ *
+ * Usage   :
+ *    MultiBacktester<StrategyHighBreakout, OtherStrategy> bt(
+ *        data, start, end,
+ *        std::make_tuple(entryPctg, exitPctg),     // args after Portfolio& for each
+ *        std::make_tuple(...));
+ *    bt.run();
+ **************************************************************************************/
+template<BacktestStrategy... StrategyTs>
+class MultiBacktester {
+public:
+    /**************************************************************************************
+     * Purpose : Construct one sleeve per strategy type.
+     * Args    : marketData   - Enriched bars (date → pair → BarData), must outlive run().
+     *           start / end  - Inclusive date range (YYYYMMDD).
+     *           strategyArgs - One tuple per strategy, forwarded after the Portfolio&.
+     **************************************************************************************/
+    template<typename... ArgTuples>
+        requires (sizeof...(ArgTuples) == sizeof...(StrategyTs))
+    MultiBacktester(const EnrichedData& marketData, Timestamp start, Timestamp end, ArgTuples&&... strategyArgs)
+        : marketData_(&marketData),
+          start_(start),
+          end_(end),
+          sleeves_(std::make_unique<StrategySleeve<StrategyTs>>(start, std::forward<ArgTuples>(strategyArgs))...)
+    {}
+
+    /**************************************************************************************
+     * Purpose : Construct an out-of-core run: bars are paged in through `feed`.
+     * Args    : feed         - Paged bar feed, must outlive run().
+     *           start / end  - Inclusive date range (YYYYMMDD).
+     *           strategyArgs - One tuple per strategy, forwarded after the Portfolio&.
+     **************************************************************************************/
+    template<typename... ArgTuples>
+        requires (sizeof...(ArgTuples) == sizeof...(StrategyTs))
+    MultiBacktester(PagedBarFeed& feed, Timestamp start, Timestamp end, ArgTuples&&... strategyArgs)
+        : feed_(&feed),
+          start_(start),
+          end_(end),
+          sleeves_(std::make_unique<StrategySleeve<StrategyTs>>(start, std::forward<ArgTuples>(strategyArgs))...)
+    {}
+
+    void run() {
+        logBacktestStart();
+
+        if (feed_) {
+            feed_->seek(start_);
+            Timestamp ts;
+            while (const CoinBarMap* bars = feed_->next(end_, ts))
+                stepAll(*bars, ts);
+            if (feed_->failed())
+                LG_ERROR("Backtest stopped early: bars could not be loaded, results are partial");
+        } else {
+            for (auto it = marketData_->lower_bound(start_); it != marketData_->end() && it->first <= end_; ++it)
+                stepAll(it->second, it->first);
+        }
+
+        logResults();
+    }
+
+    // Routes every sleeve's fills through an execution model.
+    void setExecutionModel(const ExecutionConfig& config) {
+        std::apply([&](auto&... s) { (s->execution.emplace(config), ...); }, sleeves_);
+    }
+
+    // Accrues perpetual funding on every sleeve. The schedule must outlive run().
+    void setFundingSchedule(const FundingSchedule& schedule) {
+        std::apply([&](auto&... s) { (s->portfolio.setFundingSchedule(&schedule), ...); }, sleeves_);
+    }
+
+    // Sub-portfolio of the I-th strategy.
+    template<std::size_t I>
+    const Portfolio& portfolio() const { return std::get<I>(sleeves_)->portfolio; }
+
+    // Sum of the sub-portfolios' balances.
+    double aggregateBalance() const {
+        return std::apply([](const auto&... s) { return (0.0 + ... + s->portfolio.GetCurrentBalance()); }, sleeves_);
+    }
+
+    // Sum of the sub-portfolios' equities.
+    double aggregateEquity() const {
+        return std::apply([](const auto&... s) { return (0.0 + ... + s->portfolio.GetCurrentEquity()); }, sleeves_);
+    }
+
+    // Aggregate (balance, equity) after each bar.
+    const std::vector<std::pair<double,double>>& aggregateHistoric() const noexcept { return aggregateHistoric_; }
+
+private:
+    const EnrichedData* marketData_ = nullptr;    // In-memory bars, or
+    PagedBarFeed*       feed_       = nullptr;    // out-of-core bars
+    Timestamp start_;
+    Timestamp end_;
+    std::tuple<std::unique_ptr<StrategySleeve<StrategyTs>>...> sleeves_;   // Heap: stable addresses
+    std::vector<std::pair<double,double>> aggregateHistoric_;
+
+    void stepAll(const CoinBarMap& bars, Timestamp ts) {
+        // Rankings of this bar, computed on first use and shared
+        std::array<std::optional<RankedBars>, RANKING_COUNT> rankings;
+
+        std::apply([&](auto&... sleeve) { (step(*sleeve, bars, rankings, ts), ...); }, sleeves_);
+
+        aggregateHistoric_.emplace_back(aggregateBalance(), aggregateEquity());
+    }
+
+    template<typename StrategyT>
+    static void step(StrategySleeve<StrategyT>& sleeve, const CoinBarMap& bars,
+                     std::array<std::optional<RankedBars>, RANKING_COUNT>& rankings, Timestamp ts) {
+        if (sleeve.execution)
+            sleeve.execution->fillEntries(sleeve.current_trades, bars, ts);
+
+        if constexpr (RankedStrategy<StrategyT>) {
+            auto& ranked = rankings[static_cast<std::size_t>(sleeve.strategy.ranking())];
+            if (!ranked)
+                ranked = Strategy::rank(bars, sleeve.strategy.ranking());
+            sleeve.strategy.calculateSignals(sleeve.current_trades, bars, *ranked, ts);
+        } else {
+            sleeve.strategy.calculateSignals(sleeve.current_trades, bars, ts);
+        }
+
+        if (sleeve.execution)
+            sleeve.execution->fillExits(sleeve.current_trades, bars);
+
+        sleeve.portfolio.updatePortfolio(sleeve.current_trades, ts);
+    }
+
+    void logResults() const {
+        std::size_t index = 0;
+        std::apply([&](const auto&... s) { (logSleeveResults(index++, s->portfolio), ...); }, sleeves_);
+        logAggregateResults(aggregateBalance(), aggregateEquity(), sizeof...(StrategyTs));
+    }
+};
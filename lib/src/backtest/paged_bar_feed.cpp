@@ -0,0 +1,334 @@
+#include "paged_bar_feed.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <climits>
+
+BarBlockCache::BarBlockCache(BarBlockSource& source, const BarCacheConfig& config)
+    : source_(source),
+      config_(config)
+{
+    config_.blockMonths = std::max(config_.blockMonths, 1);
+    config_.readAhead   = std::max(config_.readAhead, 0);
+
+    if (config_.readAhead > 0)
+        worker_ = std::thread(&BarBlockCache::workerLoop, this);
+}
+
+BarBlockCache::~BarBlockCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable())
+        worker_.join();
+}
+
+int BarBlockCache::blockOf(Timestamp date) const noexcept
+{
+    const int months = (date / 10000) * 12 + (date / 100) % 100 - 1;
+    return months / config_.blockMonths;
+}
+
+Timestamp BarBlockCache::blockStart(int block) const noexcept
+{
+    const int months = block * config_.blockMonths;
+    return (months / 12) * 10000 + (months % 12 + 1) * 100 + 1;
+}
+
+/**************************************************************************************
+ * Purpose : Looks the block up. A hit moves it to the front of the LRU and waits for it
+ *           if it is still loading; a block still queued for prefetch is taken out of
+ *           the queue and loaded here; a miss registers the entry first, so concurrent
+ *           requests for the same block share the one load.
+ * Args    : symbol - Symbol.
+ *           block  - Time block.
+ * Return  : BlockPtr - The block.
+ **************************************************************************************/
+BarBlockCache::BlockPtr BarBlockCache::get(const std::string& symbol, int block)
+{
+    Key key{symbol, block};
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto it = entries_.find(key);
+    if (it != entries_.end())
+    {
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        ++stats_.hits;
+
+        auto queued = std::find_if(queue_.begin(), queue_.end(), [&](const auto& q) { return q.first == key; });
+        if (queued == queue_.end())
+        {
+            std::shared_future<BlockPtr> pending = it->second.block;
+            lock.unlock();
+            return pending.get();
+        }
+
+        std::promise<BlockPtr> promise = std::move(queued->second);
+        queue_.erase(queued);
+        lock.unlock();
+
+        BlockPtr loadedBlock = load(key);
+        promise.set_value(loadedBlock);
+        lock.lock();
+        loaded(key, loadedBlock);
+        return loadedBlock;
+    }
+
+    ++stats_.misses;
+    std::promise<BlockPtr> promise;
+    lru_.push_front(key);
+    entries_.emplace(key, Entry{promise.get_future().share(), 0, false, lru_.begin()});
+    lock.unlock();
+
+    BlockPtr loadedBlock = load(key);
+    promise.set_value(loadedBlock);
+    lock.lock();
+    loaded(key, loadedBlock);
+    return loadedBlock;
+}
+
+void BarBlockCache::prefetch(const std::string& symbol, int block)
+{
+    if (!worker_.joinable())
+        return;
+
+    Key key{symbol, block};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (entries_.contains(key))
+            return;
+
+        std::promise<BlockPtr> promise;
+        lru_.push_front(key);
+        entries_.emplace(key, Entry{promise.get_future().share(), 0, false, lru_.begin()});
+        queue_.emplace_back(std::move(key), std::move(promise));
+    }
+    wake_.notify_one();
+}
+
+std::vector<SymbolRange> BarBlockCache::ranges()
+{
+    std::lock_guard<std::mutex> lock(sourceMutex_);
+    return source_.ranges();
+}
+
+BarCacheStats BarBlockCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+BarBlockCache::BlockPtr BarBlockCache::load(const Key& key)
+{
+    auto block = std::make_shared<BarBlock>();
+    bool ok;
+    {
+        std::lock_guard<std::mutex> lock(sourceMutex_);
+        ok = source_.load(key.symbol, blockStart(key.block), blockEnd(key.block), *block);
+    }
+
+    if (ok)
+        return block;
+
+    LG_ERROR("Loading bars of {} from {} to {} failed", key.symbol, blockStart(key.block), blockEnd(key.block));
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.failures;
+    return nullptr;
+}
+
+/**************************************************************************************
+ * Purpose : Accounts a finished load and evicts down to the budget; a failed load is
+ *           dropped instead. Called with mutex_ held.
+ * Args    : key   - Block loaded.
+ *           block - Its content (nullptr if the load failed).
+ **************************************************************************************/
+void BarBlockCache::loaded(const Key& key, const BlockPtr& block)
+{
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.ready)
+        return;
+
+    if (!block)
+    {
+        lru_.erase(it->second.lru);
+        entries_.erase(it);
+        return;
+    }
+
+    it->second.ready = true;
+    it->second.bytes = block->bytes();
+    stats_.bytes += it->second.bytes;
+    evict();
+}
+
+/**************************************************************************************
+ * Purpose : Drops least recently used blocks until the cache fits its budget. Blocks
+ *           still loading are skipped, and the most recently used block is always kept.
+ *           Called with mutex_ held.
+ **************************************************************************************/
+void BarBlockCache::evict()
+{
+    auto it = lru_.end();
+    while (stats_.bytes > config_.maxBytes && it != lru_.begin())
+    {
+        --it;
+        if (it == lru_.begin())
+            break;
+
+        auto entry = entries_.find(*it);
+        if (!entry->second.ready)
+            continue;
+
+        stats_.bytes -= entry->second.bytes;
+        ++stats_.evictions;
+        entries_.erase(entry);
+        it = lru_.erase(it);
+    }
+}
+
+void BarBlockCache::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        wake_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+        if (stop_)
+            return;
+
+        auto [key, promise] = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+
+        BlockPtr block = load(key);
+        promise.set_value(block);
+
+        lock.lock();
+        ++stats_.prefetched;
+        loaded(key, block);
+    }
+}
+
+PagedBarFeed::PagedBarFeed(BarBlockSource& source, const BarCacheConfig& config)
+    : cache_(source, config)
+{
+}
+
+/**************************************************************************************
+ * Purpose : Rebuilds the symbol cursors for a run from `start`:
+ *              - Reads the symbol ranges and drops symbols that end before `start`
+ *              - Queues the first block of every symbol, so they load in the background
+ *                while earlier symbols replay
+ *              - Replays each symbol's bars before `start` into its IndicatorState
+ *
+ * Args    : start - First date of the run (YYYYMMDD).
+ *
+ * Return  : std::size_t - Symbols with bars from `start` on.
+ **************************************************************************************/
+std::size_t PagedBarFeed::seek(Timestamp start)
+{
+    cursors_.clear();
+    bars_.clear();
+    failed_ = false;
+
+    const int warmup = cache_.config().warmupBlocks;
+
+    for (auto& range : cache_.ranges())
+    {
+        if (range.last < start)
+            continue;
+
+        SymbolCursor c;
+        c.block     = cache_.blockOf(range.first);
+        c.lastBlock = cache_.blockOf(range.last);
+        if (warmup >= 0)
+            c.block = std::max(c.block, cache_.blockOf(start) - warmup);
+        c.range = std::move(range);
+        cursors_.push_back(std::move(c));
+    }
+
+    for (const auto& c : cursors_)
+        cache_.prefetch(c.range.symbol, c.block);
+
+    for (auto& c : cursors_)
+    {
+        enterBlock(c, c.block);
+        while (c.data && c.date() < start)
+        {
+            c.state.update(c.data->bars[c.pos]);
+            advance(c);
+        }
+        if (failed_)
+            return 0;
+    }
+
+    LG_INFO("Paged feed from {}: {} symbols, {} MiB cache, {}-month blocks, read-ahead {}",
+            start, cursors_.size(), cache_.config().maxBytes >> 20, cache_.config().blockMonths,
+            cache_.config().readAhead);
+    return cursors_.size();
+}
+
+const CoinBarMap* PagedBarFeed::next(Timestamp end, Timestamp& ts)
+{
+    if (failed_)
+        return nullptr;
+
+    ts = INT_MAX;
+    for (const auto& c : cursors_)
+        if (c.data && c.date() < ts)
+            ts = c.date();
+
+    if (ts == INT_MAX || ts > end)
+        return nullptr;
+
+    bars_.clear();
+    for (auto& c : cursors_)
+    {
+        if (!c.data || c.date() != ts)
+            continue;
+
+        // Cursors are ordered by symbol: every insertion goes at the end
+        bars_.emplace_hint(bars_.end(), c.range.symbol, c.state.update(c.data->bars[c.pos]));
+        advance(c);
+    }
+
+    // The bars of ts are complete even if a cursor failed to enter its next block;
+    // the following call stops instead of returning dates without that symbol
+    return &bars_;
+}
+
+/**************************************************************************************
+ * Purpose : Moves a cursor to the first bar of `block`, or of the next non-empty block,
+ *           queuing the read-ahead of every block entered. A block that cannot be loaded
+ *           ends the cursor and marks the feed failed.
+ * Args    : c     - Cursor.
+ *           block - First block to try.
+ **************************************************************************************/
+void PagedBarFeed::enterBlock(SymbolCursor& c, int block)
+{
+    for (c.block = block; c.block <= c.lastBlock; ++c.block)
+    {
+        for (int ahead = 1; ahead <= cache_.config().readAhead && c.block + ahead <= c.lastBlock; ++ahead)
+            cache_.prefetch(c.range.symbol, c.block + ahead);
+
+        c.data = cache_.get(c.range.symbol, c.block);
+        c.pos  = 0;
+        if (!c.data)
+        {
+            failed_ = true;
+            return;
+        }
+        if (!c.data->dates.empty())
+            return;
+    }
+    c.data.reset();
+}
+
+void PagedBarFeed::advance(SymbolCursor& c)
+{
+    if (++c.pos < c.data->dates.size())
+        return;
+    enterBlock(c, c.block + 1);
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bar_block_source.h"
+#include "data_types.h"
+#include "indicators.h"
+
+/***********************************************
+ * Memory budget and paging of an out-of-core
+ * backtest.
+ ***********************************************/
+struct BarCacheConfig {
+    std::size_t maxBytes     = std::size_t(256) << 20;  // Budget of the cached blocks
+    int         blockMonths  = 3;                       // Time-block length (calendar months)
+    int         readAhead    = 1;                       // Blocks prefetched ahead of each symbol's cursor
+    int         warmupBlocks = -1;                      // Blocks replayed before the start for the
+                                                        // indicators (-1 = full history, exact)
+};
+
+/***********************************************
+ * Counters of a BarBlockCache.
+ ***********************************************/
+struct BarCacheStats {
+    std::size_t hits       = 0;            // get() served from the cache (or an in-flight prefetch)
+    std::size_t misses     = 0;            // get() that loaded the block itself
+    std::size_t prefetched = 0;            // Blocks loaded by the read-ahead thread
+    std::size_t evictions  = 0;
+    std::size_t failures   = 0;            // Loads the source reported as failed
+    std::size_t bytes      = 0;            // Bytes currently cached
+};
+
+/**************************************************************************************
+ * Purpose : Bounded LRU of (symbol, time-block) bar blocks over a BarBlockSource.
+ *           Blocks are shared, immutable and reference counted: eviction only drops the
+ *           cache's reference, so a block being read stays valid. A background thread
+ *           serves prefetch() requests; a get() of a block still queued takes it over
+ *           instead of waiting behind the queue. Every source call is serialised.
+ *
+ *           Time blocks are runs of `blockMonths` calendar months, numbered from year 0,
+ *           so block boundaries never depend on the data.
+ **************************************************************************************/
+class BarBlockCache {
+public:
+    using BlockPtr = std::shared_ptr<const BarBlock>;
+
+    /**************************************************************************************
+     * Purpose : Cache over `source`, which must outlive it.
+     * Args    : source - Block source.
+     *           config - Budget and block length.
+     **************************************************************************************/
+    BarBlockCache(BarBlockSource& source, const BarCacheConfig& config);
+    ~BarBlockCache();
+
+    BarBlockCache(const BarBlockCache&) = delete;
+    BarBlockCache& operator=(const BarBlockCache&) = delete;
+
+    // Block holding `date` (YYYYMMDD).
+    int blockOf(Timestamp date) const noexcept;
+
+    // First and last date (YYYYMMDD, inclusive) covered by `block`.
+    Timestamp blockStart(int block) const noexcept;
+    Timestamp blockEnd(int block) const noexcept { return blockStart(block + 1) - 1; }
+
+    /**************************************************************************************
+     * Purpose : Returns the block, loading it on a miss. A failed load is logged,
+     *           counted and not cached, so the next get() retries it.
+     * Args    : symbol - Symbol.
+     *           block  - Time block.
+     * Return  : BlockPtr - The block; nullptr if it could not be loaded.
+     **************************************************************************************/
+    BlockPtr get(const std::string& symbol, int block);
+
+    // Queues a background load of the block unless it is cached or already queued.
+    void prefetch(const std::string& symbol, int block);
+
+    // Symbol ranges of the source (serialised with the loads).
+    std::vector<SymbolRange> ranges();
+
+    const BarCacheConfig& config() const noexcept { return config_; }
+    BarCacheStats stats() const;
+
+private:
+    struct Key {
+        std::string symbol;
+        int         block;
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& k) const noexcept {
+            return std::hash<std::string>{}(k.symbol) ^ (std::hash<int>{}(k.block) * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    struct Entry {
+        std::shared_future<BlockPtr> block;
+        std::size_t                  bytes = 0;    // 0 while loading
+        bool                         ready = false;
+        std::list<Key>::iterator     lru;
+    };
+
+    BarBlockSource&  source_;
+    BarCacheConfig   config_;
+
+    mutable std::mutex      mutex_;        // Guards everything below
+    std::condition_variable wake_;
+    std::unordered_map<Key, Entry, KeyHash> entries_;
+    std::list<Key>          lru_;          // Front = most recently used
+    std::deque<std::pair<Key, std::promise<BlockPtr>>> queue_;
+    BarCacheStats           stats_;
+    bool                    stop_ = false;
+
+    std::mutex  sourceMutex_;              // Serialises source_ calls
+    std::thread worker_;
+
+    BlockPtr load(const Key& key);
+    void loaded(const Key& key, const BlockPtr& block);
+    void evict();
+    void workerLoop();
+};
+
+/**************************************************************************************
+ * Purpose : Out-of-core replacement for an EnrichedData map: walks the dates of a
+ *           BarBlockSource in order and returns the enriched bars of each date, paging
+ *           (symbol, time-block) blocks through a BarBlockCache. One cursor per symbol
+ *           holds its current block and IndicatorState; entering a block prefetches the
+ *           next `readAhead` ones, so sequential runs read ahead of the bar loop.
+ *
+ *           Memory: the cache budget, plus the current block of every symbol (a
+ *           budget under symbols × (readAhead + 1) blocks makes read-ahead thrash).
+ *
+ *           With warmupBlocks = -1 the bars are identical to enrichData() over the
+ *           whole source. Not thread safe; one run at a time per feed.
+ **************************************************************************************/
+class PagedBarFeed {
+public:
+    /**************************************************************************************
+     * Purpose : Feed over `source`, which must outlive it.
+     * Args    : source - Block source (SqliteBarSource, BarSnapshot...).
+     *           config - Budget and paging.
+     **************************************************************************************/
+    explicit PagedBarFeed(BarBlockSource& source, const BarCacheConfig& config = {});
+
+    /**************************************************************************************
+     * Purpose : Positions every symbol on its first bar on or after `start`, replaying
+     *           the bars before it into the indicators. Can be called again to rerun;
+     *           cached blocks are reused.
+     * Args    : start - First date of the run (YYYYMMDD).
+     * Return  : std::size_t - Symbols with bars from `start` on; 0 if a block could not
+     *           be loaded (failed()).
+     **************************************************************************************/
+    std::size_t seek(Timestamp start);
+
+    /**************************************************************************************
+     * Purpose : Advances to the next date that has bars.
+     * Args    : end - Last date of the run (YYYYMMDD, inclusive).
+     *           ts  - Receives the date.
+     * Return  : const CoinBarMap* - Bars of that date, valid until the next call; nullptr
+     *           once past `end`, out of data, or failed().
+     **************************************************************************************/
+    const CoinBarMap* next(Timestamp end, Timestamp& ts);
+
+    // Whether a block of the current run could not be loaded (already logged). The run
+    // stops there rather than skipping the symbol's bars.
+    bool failed() const noexcept { return failed_; }
+
+    const BarBlockCache& cache() const noexcept { return cache_; }
+
+private:
+    struct SymbolCursor {
+        SymbolRange              range;
+        int                      block     = 0;
+        int                      lastBlock = 0;
+        BarBlockCache::BlockPtr  data;          // nullptr once past the last bar
+        std::size_t              pos       = 0;
+        IndicatorState           state;
+
+        Timestamp date() const { return data->dates[pos]; }
+    };
+
+    BarBlockCache             cache_;
+    std::vector<SymbolCursor> cursors_;    // Ordered by symbol
+    CoinBarMap                bars_;
+    bool                      failed_ = false;
+
+    void enterBlock(SymbolCursor& c, int block);
+    void advance(SymbolCursor& c);
+};
@@ -0,0 +1,268 @@
+#include "signal_matrix.h"
+#include "logger.h"
+#include "time_utils.h"
+
+#include <algorithm>
+#include <map>
+
+
+/**************************************************************************************
+ * Purpose : Builds the column-oriented matrix (and the per-day quote-volume ranking) from
+ *           EnrichedData restricted to [start, end].
+ * Args    : data  - Enriched bars (date → pair → BarData).
+ *           start - First date (YYYYMMDD, inclusive).
+ *           end   - Last date (YYYYMMDD, inclusive).
+ * Return  : BarMatrix - Dense day × symbol matrix.
+ **************************************************************************************/
+BarMatrix buildBarMatrix(const EnrichedData& data, Timestamp start, Timestamp end)
+{
+    BarMatrix m;
+
+    // Axes
+    std::map<Coin, uint32_t> symbolIndex;
+    for (auto it = data.lower_bound(start); it != data.end() && it->first <= end; ++it)
+    {
+        m.dates.push_back(it->first);
+        for (const auto& [coin, _] : it->second)
+            symbolIndex.emplace(coin, 0);
+    }
+
+    m.symbols.reserve(symbolIndex.size());
+    for (auto& [coin, idx] : symbolIndex)
+    {
+        idx = static_cast<uint32_t>(m.symbols.size());
+        m.symbols.push_back(coin);
+    }
+
+    const std::size_t n = m.size();
+    m.open.assign(n, 0.0);   m.high.assign(n, 0.0);   m.low.assign(n, 0.0);
+    m.close.assign(n, 0.0);  m.volume.assign(n, 0.0); m.quoteVolume.assign(n, 0.0);
+    m.high20.assign(n, 0.0); m.atr14.assign(n, 0.0);
+    m.barNumber.assign(n, 0);
+    m.valid.assign(n, 0);
+    m.volumeRank.assign(n, 0);
+    m.rankCount.assign(m.nDays(), 0);
+
+    // Fill
+    std::size_t day = 0;
+    for (auto it = data.lower_bound(start); it != data.end() && it->first <= end; ++it, ++day)
+    {
+        for (const auto& [coin, bar] : it->second)
+        {
+            const std::size_t i = m.at(day, symbolIndex[coin]);
+            m.open[i]      = bar.open;
+            m.high[i]      = bar.high;
+            m.low[i]       = bar.low;
+            m.close[i]     = bar.close;
+            m.volume[i]    = bar.volume;
+            m.quoteVolume[i] = quoteVolumeOf(bar);
+            m.high20[i]    = bar.high_20d;
+            m.atr14[i]     = bar.atr_14d;
+            m.barNumber[i] = bar.barNumber;
+            m.valid[i]     = 1;
+        }
+
+        // Quote-volume ranking of the day's valid symbols (same order as Strategy::rank)
+        uint32_t* rank = m.volumeRank.data() + m.at(day, 0);
+        uint32_t count = 0;
+        for (uint32_t s = 0; s < m.nSymbols(); ++s)
+            if (m.valid[m.at(day, s)])
+                rank[count++] = s;
+
+        const double* vol = m.quoteVolume.data() + m.at(day, 0);
+        std::sort(rank, rank + count, [vol](uint32_t a, uint32_t b) { return vol[a] > vol[b]; });
+        m.rankCount[day] = count;
+    }
+
+    LG_INFO("Bar matrix built: {} days x {} symbols", m.nDays(), m.nSymbols());
+    return m;
+}
+
+
+/**************************************************************************************
+ * Purpose : Evaluates the breakout entry predicate over the whole matrix at once. The
+ *           loop is branchless over contiguous arrays so the compiler vectorizes it.
+ * Args    : m    - Bar matrix.
+ *           rule - Rule variant.
+ *           mask - Resized to m.size(); 1 where the entry condition holds.
+ * Return  : void
+ **************************************************************************************/
+void evaluateBreakoutEntries(const BarMatrix& m, const BreakoutRule& rule, std::vector<uint8_t>& mask)
+{
+    const std::size_t n = m.size();
+    mask.resize(n);
+
+    const double   factor  = 1.0 + rule.breakoutPctg;
+    const uint32_t minBars = rule.minBars;
+
+    const double*   __restrict close  = m.close.data();
+    const double*   __restrict high20 = m.high20.data();
+    const uint32_t* __restrict bars   = m.barNumber.data();
+    const uint8_t*  __restrict valid  = m.valid.data();
+    uint8_t*        __restrict out    = mask.data();
+
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = static_cast<uint8_t>((close[i] > high20[i] * factor) & (bars[i] > minBars) & (valid[i] != 0));
+}
+
+
+/***********************************************
+ * Open position tracked by the resolution pass.
+ ***********************************************/
+struct MatrixPosition {
+    uint32_t  symbol;
+    Timestamp start;
+    double    entry;
+    double    sl;
+    double    slReference;
+    double    size;
+    double    commission;
+    double    price;
+    bool      simulated;
+};
+
+
+/**************************************************************************************
+ * Purpose : Sequential position-resolution pass. For each day:
+ *              - Open positions: fill check on their start day (price traded below the
+ *                entry), stop-out at the stop, otherwise trail the stop with the ATR
+ *              - New entries from the entry mask among the top `universe` symbols by
+ *                quote volume, while fewer than maxPosOpen filled positions are open
+ *              - Portfolio accounting of exits and floating PnL
+ *           Semantics match Backtester<StrategyHighBreakout> for the default rule.
+ * Args    : m         - Bar matrix.
+ *           entryMask - Entry matrix (1 = entry condition holds).
+ *           rule      - Rule variant (stops, sizing, limits, commissions).
+ * Return  : MatrixBacktestResult - Final balance/equity, counts and equity curve.
+ **************************************************************************************/
+MatrixBacktestResult resolvePositions(const BarMatrix& m,
+                                      const std::vector<uint8_t>& entryMask,
+                                      const BreakoutRule& rule)
+{
+    MatrixBacktestResult result;
+    result.equity.reserve(m.nDays());
+
+    double balance = 100000.0;
+    double equity  = balance;
+
+    std::vector<MatrixPosition> open;
+    std::vector<uint8_t> hasOpen(m.nSymbols(), 0);
+
+    for (std::size_t d = 0; d < m.nDays(); ++d)
+    {
+        const Timestamp ts = m.dates[d];
+        unsigned int openCount = 0;
+
+        // Exits are booked after the entries: new positions are sized on the balance
+        // before this bar, as in Portfolio::updatePortfolio. Each exit is added to the
+        // running balance in trade order, as it does, so the sums round identically
+        double settled = balance;
+
+        // ---- Open positions: fills, stops, trailing ----
+        for (auto& p : open)
+        {
+            const std::size_t i = m.at(d, p.symbol);
+            if (!m.valid[i])
+                continue;
+
+            p.price = m.close[i];
+
+            if (ts == p.start && m.low[i] < p.entry)
+                p.simulated = false;
+
+            if (m.low[i] <= p.sl)
+            {
+                p.commission += rule.commissionExitPctg;
+                if (!p.simulated) {
+                    settled += p.size * (p.sl - p.entry) - p.commission;
+                    ++result.nTrades;
+                } else {
+                    ++result.nSimulated;
+                }
+                hasOpen[p.symbol] = 0;
+                p.symbol = UINT32_MAX;     // Mark exited
+                continue;
+            }
+
+            if (p.slReference < m.high[i])
+            {
+                p.slReference = m.high[i];
+                p.sl = p.slReference - rule.atrStopMult * m.atr14[i];
+            }
+
+            if (!p.simulated)
+                ++openCount;
+        }
+
+        std::erase_if(open, [](const MatrixPosition& p) { return p.symbol == UINT32_MAX; });
+
+        // ---- Entries among the top quote-volume universe ----
+        if (openCount < rule.maxPosOpen)
+        {
+            const uint32_t* rank = m.volumeRank.data() + m.at(d, 0);
+            const uint32_t limit = std::min<uint32_t>(m.rankCount[d], rule.universe);
+
+            for (uint32_t r = 0; r < limit; ++r)
+            {
+                const uint32_t s = rank[r];
+                const std::size_t i = m.at(d, s);
+
+                if (hasOpen[s] || !entryMask[i])
+                    continue;
+
+                MatrixPosition p;
+                p.symbol      = s;
+                p.start       = static_cast<Timestamp>(nextDay(ts));
+                p.entry       = m.close[i];
+                p.sl          = m.close[i] - rule.atrStopMult * m.atr14[i];
+                p.slReference = m.close[i];
+                p.size        = rule.positionPctg * balance / m.close[i];
+                p.commission  = rule.commissionEntryPctg;
+                p.price       = m.close[i];
+                p.simulated   = true;
+
+                open.push_back(p);
+                hasOpen[s] = 1;
+            }
+        }
+
+        balance = settled;
+
+        // ---- Floating PnL of filled positions ----
+        double floating = 0.0;
+        for (const auto& p : open)
+            if (!p.simulated)
+                floating += p.size * (p.price - p.entry) - p.commission;
+
+        equity = balance + floating;
+        result.equity.push_back(equity);
+    }
+
+    result.finalBalance = balance;
+    result.finalEquity  = equity;
+    return result;
+}
+
+
+/**************************************************************************************
+ * Purpose : Screens many rule variants on the same matrix, reusing the entry mask
+ *           buffer between variants.
+ * Args    : m     - Bar matrix.
+ *           rules - Rule variants.
+ * Return  : std::vector<MatrixBacktestResult> - One result per rule, same order.
+ **************************************************************************************/
+std::vector<MatrixBacktestResult> sweepBreakoutRules(const BarMatrix& m,
+                                                     const std::vector<BreakoutRule>& rules)
+{
+    std::vector<MatrixBacktestResult> results;
+    results.reserve(rules.size());
+
+    std::vector<uint8_t> mask;
+    for (const auto& rule : rules)
+    {
+        evaluateBreakoutEntries(m, rule, mask);
+        results.push_back(resolvePositions(m, mask, rule));
+    }
+
+    return results;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "data_types.h"
+
+
+/**************************************************************************************
+ * Purpose : Column-oriented (day × symbol) copy of EnrichedData for vectorized rule
+ *           screening. Every field is one contiguous array indexed by
+ *           at(day, symbol) = day * nSymbols() + symbol, so elementwise rules compile to
+ *           straight SIMD loops. Missing bars have valid == 0.
+ *
+ *           The per-day quote-volume ranking is computed once here and shared by every
+ *           rule variant evaluated on the matrix.
+ **************************************************************************************/
+struct BarMatrix {
+    std::vector<Timestamp> dates;          // Row axis (ascending)
+    std::vector<Coin>      symbols;        // Column axis (ascending)
+
+    std::vector<double>   open, high, low, close, volume, quoteVolume, high20, atr14;
+    std::vector<uint32_t> barNumber;
+    std::vector<uint8_t>  valid;
+
+    // Per day: symbol indices by descending quote volume (first rankCount[day] entries used).
+    std::vector<uint32_t> volumeRank;
+    std::vector<uint32_t> rankCount;
+
+    std::size_t nDays()    const noexcept { return dates.size(); }
+    std::size_t nSymbols() const noexcept { return symbols.size(); }
+    std::size_t size()     const noexcept { return dates.size() * symbols.size(); }
+    std::size_t at(std::size_t day, std::size_t symbol) const noexcept { return day * symbols.size() + symbol; }
+};
+
+
+/***********************************************
+ * Parameters of a breakout rule variant. The
+ * defaults reproduce StrategyHighBreakout.
+ ***********************************************/
+struct BreakoutRule {
+    double       breakoutPctg        = 0.0;   // Entry when close > high_20d * (1 + breakoutPctg)
+    unsigned int minBars             = 20;    // ... and barNumber > minBars
+    double       atrStopMult         = 3.0;   // Trailing stop distance in ATRs
+    unsigned int maxPosOpen          = 10;    // Max filled positions before new entries stop
+    unsigned int universe            = 20;    // Top-N symbols by quote volume considered each day
+    double       positionPctg        = 0.05;  // Position notional as a fraction of balance
+    double       commissionEntryPctg = 0.0;
+    double       commissionExitPctg  = 0.0;
+};
+
+
+/***********************************************
+ * Summary of a matrix backtest run.
+ ***********************************************/
+struct MatrixBacktestResult {
+    double       finalBalance = 0.0;
+    double       finalEquity  = 0.0;
+    unsigned int nTrades      = 0;        // Closed filled trades
+    unsigned int nSimulated   = 0;        // Signals never filled
+    std::vector<double> equity;           // Equity after each day
+};
+
+
+/**************************************************************************************
+ * Purpose : Builds the column-oriented matrix (and the per-day quote-volume ranking) from
+ *           EnrichedData restricted to [start, end].
+ * Args    : data  - Enriched bars (date → pair → BarData).
+ *           start - First date (YYYYMMDD, inclusive).
+ *           end   - Last date (YYYYMMDD, inclusive).
+ * Return  : BarMatrix - Dense day × symbol matrix.
+ **************************************************************************************/
+BarMatrix buildBarMatrix(const EnrichedData& data, Timestamp start, Timestamp end);
+
+/**************************************************************************************
+ * Purpose : Evaluates the breakout entry predicate over the whole matrix at once.
+ * Args    : m    - Bar matrix.
+ *           rule - Rule variant.
+ *           mask - Resized to m.size(); 1 where the entry condition holds.
+ * Return  : void
+ **************************************************************************************/
+void evaluateBreakoutEntries(const BarMatrix& m, const BreakoutRule& rule, std::vector<uint8_t>& mask);
+
+/**************************************************************************************
+ * Purpose : Sequential position-resolution pass: applies fills, trailing ATR stops,
+ *           maxPosOpen, the volume-ranked universe and portfolio accounting, with the
+ *           same semantics as Backtester<StrategyHighBreakout>.
+ * Args    : m         - Bar matrix.
+ *           entryMask - Entry matrix from evaluateBreakoutEntries (or any other rule).
+ *           rule      - Rule variant (stops, sizing, limits, commissions).
+ * Return  : MatrixBacktestResult - Final balance/equity, counts and equity curve.
+ **************************************************************************************/
+MatrixBacktestResult resolvePositions(const BarMatrix& m,
+                                      const std::vector<uint8_t>& entryMask,
+                                      const BreakoutRule& rule);
+
+/**************************************************************************************
+ * Purpose : Screens many rule variants on the same matrix, reusing the entry mask
+ *           buffer between variants.
+ * Args    : m     - Bar matrix.
+ *           rules - Rule variants.
+ * Return  : std::vector<MatrixBacktestResult> - One result per rule, same order.
+ **************************************************************************************/
+std::vector<MatrixBacktestResult> sweepBreakoutRules(const BarMatrix& m,
+                                                     const std::vector<BreakoutRule>& rules);
@@ -1,8 +1,46 @@
-#include "data_types"
+#include "data_types.h"
+
+#include <algorithm>
 
 bool hasOpenTrade(const std::vector<Trade>& trades,const Coin& coin) {
     return std::any_of(trades.begin(), trades.end(),
         [&](const Trade& t) {
             return !t.exited_ && t.coin_ == coin;
         });
-}
\ No newline at end of file
+}
+
+void writeTrade(BinaryWriter& out, const Trade& trade) {
+    out.write(trade.trade_id_);
+    out.write(trade.start_);
+    out.write(trade.end_);
+    out.write(trade.commission_);
+    out.writeString(trade.coin_);
+    out.write(trade.direction_);
+    out.write(trade.current_price_);
+    out.write(trade.entry_);
+    out.write(trade.exit_);
+    out.write(trade.size_);
+    out.write(trade.sl_);
+    out.write(trade.isSimulated_);
+    out.write(trade.exited_);
+    out.write(trade.slReference_);
+}
+
+Trade readTrade(BinaryReader& in) {
+    Trade trade;
+    trade.trade_id_      = in.read<TradeID>();
+    trade.start_         = in.read<Timestamp>();
+    trade.end_           = in.read<Timestamp>();
+    trade.commission_    = in.read<double>();
+    trade.coin_          = in.readString();
+    trade.direction_     = in.read<Direction>();
+    trade.current_price_ = in.read<double>();
+    trade.entry_         = in.read<double>();
+    trade.exit_          = in.read<double>();
+    trade.size_          = in.read<double>();
+    trade.sl_            = in.read<double>();
+    trade.isSimulated_   = in.read<bool>();
+    trade.exited_        = in.read<bool>();
+    trade.slReference_   = in.read<double>();
+    return trade;
+}
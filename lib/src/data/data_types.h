@@ -1,12 +1,14 @@
+#pragma once
+
+#include <cstdint>
 #include <map>
 #include <string>
-#include<vector>
+#include <vector>
+#include "binary_io.h"
 
 using TradeID = unsigned int;
 using Timestamp =  int;
 using Coin = std::string;
-using CoinBarMap = std::map<Coin, BarData>;
-using EnrichedData =  std::map<Timestamp, CoinBarMap>;
 enum class Direction {Long,Short,Flat};
 
 
@@ -16,6 +18,12 @@ struct OHLCV {
     double low;
     double close;
     double volume;
+
+    // Extended kline fields (0 for rows stored before they were kept)
+    double quoteVolume         = 0.0;   // Quote asset volume (USDT)
+    double trades              = 0.0;   // Number of trades
+    double takerBuyVolume      = 0.0;   // Taker buy base volume
+    double takerBuyQuoteVolume = 0.0;   // Taker buy quote volume
 };
 
 
@@ -24,6 +32,22 @@ struct OHLCVData {
 };
 
 
+struct FundingRateData {
+    // pair → fundingTime (Unix ms) → funding rate of that settlement
+    std::map<std::string, std::map<long long, double>> data;
+};
+
+
+// One aggregated trade (fills of one taker order at one price).
+struct AggTrade {
+    long long id;               // Aggregate trade id (increasing)
+    long long timeMs;           // Transaction time (Unix ms)
+    double    price;
+    double    qty;              // Base quantity
+    bool      buyerMaker;       // true = the taker sold
+};
+
+
 struct BarData{
     // OHLCV
     double open;
@@ -31,12 +55,31 @@ struct BarData{
     double low;
     double close;
     double volume;
+    double quoteVolume         = 0.0;
+    double trades              = 0.0;
+    double takerBuyVolume      = 0.0;
+    double takerBuyQuoteVolume = 0.0;
 
     unsigned int barNumber = 0;
     double high_20d = 0.0;
     double atr_14d = 0.0;
 };
 
+// Traded notional of a bar: the stored quote volume, or volume × close for rows
+// stored before quote volume was kept.
+inline double quoteVolumeOf(const BarData& bar) {
+    return bar.quoteVolume > 0.0 ? bar.quoteVolume : bar.volume * bar.close;
+}
+
+using CoinBarMap = std::map<Coin, BarData>;
+using EnrichedData =  std::map<Timestamp, CoinBarMap>;
+
+
+/***********************************************
+ * Trade::fundingCoin_ before the portfolio
+ * resolved it on the trade's first bar.
+ ***********************************************/
+static constexpr int32_t FUNDING_COIN_UNRESOLVED = -2;
 
 struct Trade{
     TradeID   trade_id_      = 0;
@@ -53,6 +96,11 @@ struct Trade{
     bool      isSimulated_   = true;
     bool      exited_        = false;
     double    slReference_    =0.0; // highest high or lowest low achieved usually for trailling sl
+    int32_t   fundingCoin_   = FUNDING_COIN_UNRESOLVED; // column in the portfolio's FundingSchedule, -1 if none (not serialized)
 };
 
-bool hasOpenTrade(const std::vector<Trade>& trades,const Coin& coin);
\ No newline at end of file
+bool hasOpenTrade(const std::vector<Trade>& trades,const Coin& coin);
+
+// Binary (de)serialization of a Trade, used by state checkpoints.
+void writeTrade(BinaryWriter& out, const Trade& trade);
+Trade readTrade(BinaryReader& in);
@@ -0,0 +1,76 @@
+#include "indicators.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**************************************************************************************
+ * Purpose : Consumes the next candle and advances all indicators by one bar.
+ * Args    : bar - The new OHLCV candle (must be newer than the last one consumed).
+ * Return  : BarData - Candle enriched with the indicators as of this bar.
+ **************************************************************************************/
+BarData IndicatorState::update(const OHLCV& bar)
+{
+    BarData out;
+    out.open   = bar.open;
+    out.high   = bar.high;
+    out.low    = bar.low;
+    out.close  = bar.close;
+    out.volume = bar.volume;
+    out.quoteVolume         = bar.quoteVolume;
+    out.trades              = bar.trades;
+    out.takerBuyVolume      = bar.takerBuyVolume;
+    out.takerBuyQuoteVolume = bar.takerBuyQuoteVolume;
+
+    // ------------------------------------------------------------
+    // high_20d: max of the previous bars only (before inserting this one)
+    // ------------------------------------------------------------
+    unsigned int filled = std::min(barNumber_, HIGH_WINDOW);
+    if (filled > 0)
+        out.high_20d = *std::max_element(highs_.begin(), highs_.begin() + filled);
+
+    highs_[barNumber_ % HIGH_WINDOW] = bar.high;
+
+    // ------------------------------------------------------------
+    // atr_14d: simple average while warming up, then Wilder smoothing
+    // ------------------------------------------------------------
+    double tr = bar.high - bar.low;
+    if (barNumber_ > 0)
+    {
+        tr = std::max({tr,
+                       std::fabs(bar.high - prevClose_),
+                       std::fabs(bar.low  - prevClose_)});
+    }
+
+    if (barNumber_ < ATR_WINDOW)
+        atr_ = (atr_ * barNumber_ + tr) / (barNumber_ + 1);
+    else
+        atr_ = (atr_ * (ATR_WINDOW - 1) + tr) / ATR_WINDOW;
+
+    prevClose_ = bar.close;
+    ++barNumber_;
+
+    out.atr_14d   = atr_;
+    out.barNumber = barNumber_;
+    return out;
+}
+
+
+/**************************************************************************************
+ * Purpose : Builds the EnrichedData map used by Backtester from raw OHLCV candles by
+ *           running one IndicatorState per pair over its dates in ascending order.
+ * Args    : data - OHLCVData (pair → YYYYMMDD → OHLCV).
+ * Return  : EnrichedData - YYYYMMDD → (pair → BarData).
+ **************************************************************************************/
+EnrichedData enrichData(const OHLCVData& data)
+{
+    EnrichedData result;
+
+    for (const auto& [pair, dailyMap] : data.data)
+    {
+        IndicatorState state;
+        for (const auto& [yyyymmdd, candle] : dailyMap)
+            result[static_cast<Timestamp>(yyyymmdd)][pair] = state.update(candle);
+    }
+
+    return result;
+}
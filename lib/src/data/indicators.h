@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include "data_types.h"
+
+/**************************************************************************************
+ * Purpose : Incremental indicator state for a single symbol. Each call to update()
+ *           consumes one new daily candle in O(1) and returns the enriched BarData
+ *           used by strategies (barNumber, high_20d, atr_14d), so live consumers only
+ *           need the latest bar instead of recomputing the whole history.
+ *
+ * Notes   :
+ *    - high_20d is the highest high of the previous 20 bars (current bar excluded),
+ *      so breakout rules like `close > high_20d` are meaningful.
+ *    - atr_14d uses Wilder smoothing; the first 14 bars are a simple average of TR.
+ *    - The state is a fixed-size POD so it can be copied or persisted cheaply.
+ **************************************************************************************/
+class IndicatorState {
+public:
+    static constexpr unsigned int HIGH_WINDOW = 20;
+    static constexpr unsigned int ATR_WINDOW  = 14;
+
+    /**************************************************************************************
+     * Purpose : Consumes the next candle and advances all indicators by one bar.
+     * Args    : bar - The new OHLCV candle (must be newer than the last one consumed).
+     * Return  : BarData - Candle enriched with the indicators as of this bar.
+     **************************************************************************************/
+    BarData update(const OHLCV& bar);
+
+    // Number of bars consumed so far.
+    unsigned int barNumber() const noexcept { return barNumber_; }
+
+private:
+    // Ring buffer with the highs of the last HIGH_WINDOW bars.
+    std::array<double, HIGH_WINDOW> highs_{};
+
+    // Current Wilder ATR (or running TR sum while warming up).
+    double atr_ = 0.0;
+
+    // Close of the previous bar, needed for true range.
+    double prevClose_ = 0.0;
+
+    // Bars consumed so far.
+    unsigned int barNumber_ = 0;
+};
+
+/**************************************************************************************
+ * Purpose : Builds the EnrichedData map used by Backtester from raw OHLCV candles by
+ *           running one IndicatorState per pair over its dates in ascending order.
+ * Args    : data - OHLCVData (pair → YYYYMMDD → OHLCV).
+ * Return  : EnrichedData - YYYYMMDD → (pair → BarData).
+ **************************************************************************************/
+EnrichedData enrichData(const OHLCVData& data);
@@ -0,0 +1,372 @@
+#include "bar_block_source.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <type_traits>
+
+/***********************************************
+ * One snapshot record.
+ ***********************************************/
+struct SnapshotBar {
+    int32_t  date;
+    uint32_t reserved;
+    OHLCV    bar;
+};
+static_assert(std::is_trivially_copyable_v<SnapshotBar> && sizeof(SnapshotBar) == 80,
+              "snapshot records must stay 80-byte PODs");
+
+static constexpr std::size_t BAR_SNAPSHOT_HEADER  = 8;     // Magic + version
+static constexpr std::size_t BAR_SNAPSHOT_TRAILER = 12;    // Directory offset + magic
+
+// Widens the ranges in `merged` with `ranges` (read from another shard or pass).
+static void mergeRanges(std::map<std::string, SymbolRange>& merged, std::vector<SymbolRange> ranges)
+{
+    for (auto& range : ranges)
+    {
+        auto [it, inserted] = merged.try_emplace(range.symbol, std::move(range));
+        if (inserted)
+            continue;
+        it->second.first = std::min(it->second.first, range.first);
+        it->second.last  = std::max(it->second.last, range.last);
+    }
+}
+
+// Symbol order of the merged ranges.
+static std::vector<SymbolRange> sortedRanges(std::map<std::string, SymbolRange>& merged)
+{
+    std::vector<SymbolRange> out;
+    out.reserve(merged.size());
+    for (auto& [symbol, range] : merged)
+        out.push_back(std::move(range));
+    return out;
+}
+
+bool SqliteBarSource::open(const boost::filesystem::path& path, const std::string& table)
+{
+    if (!db_.open(path, SQLITE_OPEN_READONLY))
+    {
+        LG_ERROR("SQLite failed to open bar source {}: {}", path.string(), db_.errmsg());
+        return false;
+    }
+    // The database service may be writing at the same time
+    db_.setBusyTimeout(5000);
+
+    if (!view_.refresh(path))
+        return false;
+
+    reader_.emplace(db_, table);
+    return true;
+}
+
+std::vector<SymbolRange> SqliteBarSource::ranges()
+{
+    if (!reader_)
+        return {};
+    if (!view_.sharded())
+        return reader_->ranges();
+
+    std::map<std::string, SymbolRange> merged;
+    for (const auto& [from, to] : view_.passes({}))
+    {
+        if (!view_.attach(db_, {}, from, to))
+            return {};
+        mergeRanges(merged, reader_->ranges());
+    }
+    return sortedRanges(merged);
+}
+
+bool SqliteBarSource::load(const std::string& symbol, int from, int to, BarBlock& out)
+{
+    out.dates.clear();
+    out.bars.clear();
+    if (!reader_)
+        return false;
+
+    // Passes are in date order: the blocks concatenate
+    for (const auto& [first, last] : view_.passes({symbol}, from, to))
+    {
+        if (!view_.attach(db_, {symbol}, first, last))
+            return false;
+
+        BarCursor cursor = reader_->scan(BarQuery{{symbol}, first, last, BarOrder::BySymbol});
+        while (cursor.fill(batch_) > 0)
+        {
+            out.dates.insert(out.dates.end(), batch_.date.begin(), batch_.date.end());
+            for (std::size_t row = 0; row < batch_.size(); ++row)
+                out.bars.push_back(batch_.bar(row));
+        }
+
+        if (cursor.failed())
+            return false;
+    }
+
+    return true;
+}
+
+bool ShardedBarSource::open(const boost::filesystem::path& database, const std::string& table)
+{
+    shards_.clear();
+
+    if (!catalog_.load(database))
+        return false;
+    if (!catalog_.enabled())
+    {
+        LG_ERROR("{} is not sharded", database.string());
+        return false;
+    }
+
+    for (const auto& info : catalog_.shards())
+    {
+        auto shard = std::make_unique<Shard>();
+        const boost::filesystem::path path = catalog_.pathOf(info);
+        if (!shard->db.open(path, SQLITE_OPEN_READONLY))
+        {
+            LG_ERROR("SQLite failed to open shard {}: {}", path.string(), shard->db.errmsg());
+            shards_.clear();
+            return false;
+        }
+        shard->db.setBusyTimeout(5000);
+        shard->reader.emplace(shard->db, table);
+        shards_.push_back(std::move(shard));
+    }
+
+    LG_INFO("Sharded bar source {}: {} shards", database.string(), shards_.size());
+    return true;
+}
+
+std::vector<SymbolRange> ShardedBarSource::ranges()
+{
+    std::map<std::string, SymbolRange> merged;
+    for (const auto& shard : shards_)
+        mergeRanges(merged, shard->reader->ranges());
+    return sortedRanges(merged);
+}
+
+bool ShardedBarSource::load(const std::string& symbol, int from, int to, BarBlock& out)
+{
+    out.dates.clear();
+    out.bars.clear();
+
+    // shardsFor() returns them in date order: the blocks concatenate
+    for (const ShardInfo* info : catalog_.shardsFor(symbol, from, to))
+    {
+        Shard& shard = *shards_[static_cast<std::size_t>(info - catalog_.shards().data())];
+
+        BarCursor cursor = shard.reader->scan(BarQuery{{symbol}, from, to, BarOrder::BySymbol});
+        while (cursor.fill(batch_) > 0)
+        {
+            out.dates.insert(out.dates.end(), batch_.date.begin(), batch_.date.end());
+            for (std::size_t row = 0; row < batch_.size(); ++row)
+                out.bars.push_back(batch_.bar(row));
+        }
+
+        if (cursor.failed())
+            return false;
+    }
+
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Streams the table into a snapshot: records batch by batch, then the
+ *           directory built along the way, then the trailer pointing at it.
+ * Args    : path   - Snapshot file.
+ *           reader - Reader of the OHLCV table.
+ *           from   - First date (YYYYMMDD, inclusive).
+ *           to     - Last date (YYYYMMDD, inclusive).
+ * Return  : bool - true on success.
+ **************************************************************************************/
+bool writeBarSnapshot(const boost::filesystem::path& path, MarketDataReader& reader, int from, int to)
+{
+    namespace fs = boost::filesystem;
+
+    if (!path.parent_path().empty() && !fs::exists(path.parent_path()))
+        fs::create_directories(path.parent_path());
+
+    const fs::path tmp = path.string() + ".tmp";
+    std::ofstream out(tmp.string(), std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        LG_ERROR("Cannot create bar snapshot {}", tmp.string());
+        return false;
+    }
+
+    BinaryWriter header;
+    header.write(BAR_SNAPSHOT_MAGIC);
+    header.write(BAR_SNAPSHOT_VERSION);
+    out.write(header.data().data(), static_cast<std::streamsize>(header.data().size()));
+
+    struct Entry { SymbolRange range; uint64_t firstRecord; uint64_t count; };
+    std::vector<Entry> directory;
+    uint64_t records = 0;
+
+    BarCursor cursor = reader.scan(BarQuery{{}, from, to, BarOrder::BySymbol});
+    BarColumns batch;
+    std::vector<SnapshotBar> buffer;
+    while (cursor.fill(batch) > 0)
+    {
+        buffer.clear();
+        for (std::size_t row = 0; row < batch.size(); ++row)
+        {
+            if (directory.empty() || directory.back().range.symbol != batch.symbolOf(row))
+                directory.push_back({{batch.symbolOf(row), batch.date[row], batch.date[row]}, records, 0});
+
+            directory.back().range.last = batch.date[row];
+            ++directory.back().count;
+            ++records;
+
+            buffer.push_back(SnapshotBar{batch.date[row], 0, batch.bar(row)});
+        }
+        out.write(reinterpret_cast<const char*>(buffer.data()),
+                  static_cast<std::streamsize>(buffer.size() * sizeof(SnapshotBar)));
+    }
+
+    if (cursor.failed())
+    {
+        out.close();
+        fs::remove(tmp);
+        return false;
+    }
+
+    BinaryWriter trailer;
+    trailer.write(static_cast<uint32_t>(directory.size()));
+    for (const auto& e : directory)
+    {
+        trailer.writeString(e.range.symbol);
+        trailer.write(static_cast<int32_t>(e.range.first));
+        trailer.write(static_cast<int32_t>(e.range.last));
+        trailer.write(e.firstRecord);
+        trailer.write(e.count);
+    }
+    trailer.write(static_cast<uint64_t>(BAR_SNAPSHOT_HEADER + records * sizeof(SnapshotBar)));
+    trailer.write(BAR_SNAPSHOT_MAGIC);
+    out.write(trailer.data().data(), static_cast<std::streamsize>(trailer.data().size()));
+
+    out.close();
+    if (!out)
+    {
+        LG_ERROR("Write of bar snapshot {} failed", tmp.string());
+        fs::remove(tmp);
+        return false;
+    }
+
+    boost::system::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec)
+    {
+        LG_ERROR("Cannot rename bar snapshot to {}: {}", path.string(), ec.message());
+        return false;
+    }
+
+    LG_INFO("Bar snapshot {}: {} symbols, {} bars", path.string(), directory.size(), records);
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Maps the file, checks both magics and loads the directory, rejecting
+ *           entries that point outside the record area.
+ * Args    : path - Snapshot file.
+ * Return  : bool - false if the file is missing or malformed.
+ **************************************************************************************/
+bool BarSnapshot::open(const boost::filesystem::path& path)
+{
+    directory_.clear();
+    index_.clear();
+
+    if (!file_.open(path))
+    {
+        LG_ERROR("Cannot map bar snapshot {}", path.string());
+        return false;
+    }
+
+    const std::string_view data = file_.data();
+    const std::string_view magic(BAR_SNAPSHOT_MAGIC, sizeof(BAR_SNAPSHOT_MAGIC));
+
+    try
+    {
+        if (data.size() < BAR_SNAPSHOT_HEADER + BAR_SNAPSHOT_TRAILER ||
+            data.substr(0, sizeof(BAR_SNAPSHOT_MAGIC)) != magic ||
+            data.substr(data.size() - sizeof(BAR_SNAPSHOT_MAGIC)) != magic)
+            throw std::runtime_error("bad magic");
+
+        BinaryReader header(data.substr(sizeof(BAR_SNAPSHOT_MAGIC), sizeof(uint32_t)));
+        if (header.read<uint32_t>() != BAR_SNAPSHOT_VERSION)
+            throw std::runtime_error("unsupported version");
+
+        BinaryReader trailer(data.substr(data.size() - BAR_SNAPSHOT_TRAILER, sizeof(uint64_t)));
+        const uint64_t dirOffset = trailer.read<uint64_t>();
+        if (dirOffset < BAR_SNAPSHOT_HEADER || dirOffset > data.size() - BAR_SNAPSHOT_TRAILER ||
+            (dirOffset - BAR_SNAPSHOT_HEADER) % sizeof(SnapshotBar) != 0)
+            throw std::runtime_error("bad directory offset");
+
+        const uint64_t records = (dirOffset - BAR_SNAPSHOT_HEADER) / sizeof(SnapshotBar);
+
+        BinaryReader dir(data.substr(dirOffset, data.size() - BAR_SNAPSHOT_TRAILER - dirOffset));
+        const uint32_t count = dir.read<uint32_t>();
+        directory_.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            Entry e;
+            e.range.symbol = dir.readString();
+            e.range.first  = dir.read<int32_t>();
+            e.range.last   = dir.read<int32_t>();
+            e.firstRecord  = dir.read<uint64_t>();
+            e.count        = dir.read<uint64_t>();
+            if (e.firstRecord > records || e.count > records - e.firstRecord)
+                throw std::runtime_error("directory entry out of range");
+
+            index_.emplace(e.range.symbol, directory_.size());
+            directory_.push_back(std::move(e));
+        }
+    }
+    catch (const std::exception& e)
+    {
+        LG_ERROR("Malformed bar snapshot {}: {}", path.string(), e.what());
+        directory_.clear();
+        index_.clear();
+        file_ = MappedFile{};
+        return false;
+    }
+
+    return true;
+}
+
+std::vector<SymbolRange> BarSnapshot::ranges()
+{
+    std::vector<SymbolRange> out;
+    out.reserve(directory_.size());
+    for (const auto& e : directory_)
+        out.push_back(e.range);
+    return out;
+}
+
+bool BarSnapshot::load(const std::string& symbol, int from, int to, BarBlock& out)
+{
+    out.dates.clear();
+    out.bars.clear();
+
+    auto it = index_.find(symbol);
+    if (it == index_.end())
+        return true;                       // No bars is not an error
+
+    const Entry& e = directory_[it->second];
+    // Records start 8 bytes into a page-aligned mapping: 8-byte aligned
+    const SnapshotBar* begin = reinterpret_cast<const SnapshotBar*>(file_.data().data() + BAR_SNAPSHOT_HEADER) + e.firstRecord;
+    const SnapshotBar* end   = begin + e.count;
+
+    const SnapshotBar* first = std::lower_bound(begin, end, from,
+        [](const SnapshotBar& r, int date) { return r.date < date; });
+    const SnapshotBar* last  = std::upper_bound(first, end, to,
+        [](int date, const SnapshotBar& r) { return date < r.date; });
+
+    out.dates.reserve(static_cast<std::size_t>(last - first));
+    out.bars.reserve(static_cast<std::size_t>(last - first));
+    for (const SnapshotBar* r = first; r != last; ++r)
+    {
+        out.dates.push_back(r->date);
+        out.bars.push_back(r->bar);
+    }
+    return true;
+}
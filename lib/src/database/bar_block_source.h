@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "binary_io.h"
+#include "data_types.h"
+#include "market_data_reader.h"
+#include "shard_catalog.h"
+#include "sqlite_connection.h"
+
+/***********************************************
+ * Daily bars of one symbol over one time block,
+ * in date order.
+ ***********************************************/
+struct BarBlock {
+    std::vector<Timestamp> dates;          // YYYYMMDD
+    std::vector<OHLCV>     bars;
+
+    // Heap bytes held by the block (what a cache budget counts).
+    std::size_t bytes() const noexcept { return dates.capacity() * sizeof(Timestamp) + bars.capacity() * sizeof(OHLCV); }
+};
+
+/**************************************************************************************
+ * Purpose : Random access to stored bars by (symbol, date range), the unit an
+ *           out-of-core backtest pages in. Implementations need not be thread safe:
+ *           callers serialise access (BarBlockCache does).
+ **************************************************************************************/
+class BarBlockSource {
+public:
+    virtual ~BarBlockSource() = default;
+
+    // First and last date of every symbol, ordered by symbol (empty on error).
+    virtual std::vector<SymbolRange> ranges() = 0;
+
+    /**************************************************************************************
+     * Purpose : Reads the bars of `symbol` over [from, to].
+     * Args    : symbol - Symbol.
+     *           from   - First date (YYYYMMDD, inclusive).
+     *           to     - Last date (YYYYMMDD, inclusive).
+     *           out    - Replaced with the bars, in date order.
+     * Return  : bool - false on error (already logged).
+     **************************************************************************************/
+    virtual bool load(const std::string& symbol, int from, int to, BarBlock& out) = 0;
+};
+
+/**************************************************************************************
+ * Purpose : Block source over an OHLCV table, on its own read-only connection so it
+ *           can be used from a loader thread. Each block is one primary key range scan.
+ *           Sharded databases are read through a ShardedView, attaching the shards of
+ *           the block (the catalog is read once, by open()).
+ **************************************************************************************/
+class SqliteBarSource final : public BarBlockSource {
+public:
+    SqliteBarSource() = default;
+
+    /**************************************************************************************
+     * Purpose : Opens the market database read-only.
+     * Args    : path  - Database file.
+     *           table - OHLCV table.
+     * Return  : bool - false if the database cannot be opened (already logged).
+     **************************************************************************************/
+    bool open(const boost::filesystem::path& path, const std::string& table = "ohlcv_data");
+
+    std::vector<SymbolRange> ranges() override;
+    bool load(const std::string& symbol, int from, int to, BarBlock& out) override;
+
+private:
+    SqliteConnection                db_;
+    ShardedView                     view_;
+    std::optional<MarketDataReader> reader_;       // Set by open()
+    BarColumns                      batch_;        // Reused between loads
+};
+
+/**************************************************************************************
+ * Purpose : Block source over the shards of a sharded database, one read-only
+ *           connection per shard and no ATTACH, so any number of shards can be read.
+ *           A block only reads the shards the catalog says can hold it (the symbol's
+ *           bucket, the years of the block). The catalog is read once, by open().
+ **************************************************************************************/
+class ShardedBarSource final : public BarBlockSource {
+public:
+    ShardedBarSource() = default;
+
+    /**************************************************************************************
+     * Purpose : Loads the catalog and opens every shard read-only.
+     * Args    : database - Main database file.
+     *           table    - Sharded OHLCV table.
+     * Return  : bool - false if the database is not sharded or a shard cannot be opened
+     *           (already logged).
+     **************************************************************************************/
+    bool open(const boost::filesystem::path& database, const std::string& table = "ohlcv_data");
+
+    std::vector<SymbolRange> ranges() override;
+    bool load(const std::string& symbol, int from, int to, BarBlock& out) override;
+
+private:
+    struct Shard {
+        SqliteConnection                db;
+        std::optional<MarketDataReader> reader;
+    };
+
+    ShardCatalog                        catalog_;
+    std::vector<std::unique_ptr<Shard>> shards_;   // In catalog_.shards() order
+    BarColumns                          batch_;    // Reused between loads
+};
+
+/**************************************************************************************
+ * Binary bar snapshot: a read-only, memory-mapped copy of an OHLCV table laid out for
+ * block reads. Records of a symbol are contiguous and sorted by date, so a block is a
+ * binary search and a copy.
+ *
+ * Layout (host byte order, like every BinaryWriter file):
+ *   "BSN1"  u32 version
+ *   records: { i32 date, u32 reserved, OHLCV }   (80 bytes, 8-byte aligned)
+ *   directory: u32 count, then per symbol: string symbol, i32 first, i32 last,
+ *              u64 firstRecord, u64 recordCount
+ *   u64 directoryOffset  "BSN1"
+ **************************************************************************************/
+static constexpr char     BAR_SNAPSHOT_MAGIC[4] = {'B', 'S', 'N', '1'};
+static constexpr uint32_t BAR_SNAPSHOT_VERSION  = 1;
+
+/**************************************************************************************
+ * Purpose : Writes a snapshot of every bar readable through `reader` over [from, to].
+ *           Bars are streamed symbol by symbol, so the writer runs in the memory of
+ *           one batch; the file is written to "<path>.tmp" and renamed when complete.
+ * Args    : path   - Snapshot file.
+ *           reader - Reader of the OHLCV table.
+ *           from   - First date (YYYYMMDD, inclusive).
+ *           to     - Last date (YYYYMMDD, inclusive).
+ * Return  : bool - true on success.
+ **************************************************************************************/
+bool writeBarSnapshot(const boost::filesystem::path& path, MarketDataReader& reader,
+                      int from = 0, int to = INT_MAX);
+
+/**************************************************************************************
+ * Purpose : Block source over a snapshot file. Loads only copy from the mapping, so
+ *           they are limited by memory bandwidth (and by the page cache on first touch).
+ **************************************************************************************/
+class BarSnapshot final : public BarBlockSource {
+public:
+    BarSnapshot() = default;
+
+    /**************************************************************************************
+     * Purpose : Maps a snapshot and reads its directory.
+     * Args    : path - Snapshot file.
+     * Return  : bool - false if the file is missing or malformed (already logged).
+     **************************************************************************************/
+    bool open(const boost::filesystem::path& path);
+
+    std::vector<SymbolRange> ranges() override;
+    bool load(const std::string& symbol, int from, int to, BarBlock& out) override;
+
+private:
+    struct Entry {
+        SymbolRange range;
+        uint64_t    firstRecord = 0;
+        uint64_t    count       = 0;
+    };
+
+    MappedFile                             file_;
+    std::vector<Entry>                     directory_;     // Ordered by symbol
+    std::unordered_map<std::string, std::size_t> index_;   // Symbol → directory_ slot
+};
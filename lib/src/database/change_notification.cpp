@@ -0,0 +1,256 @@
+#include "change_notification.h"
+#include "logger.h"
+
+#include <nlohmann/json.hpp>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+
+/***********************************************
+ * Largest payload published. Unix datagrams
+ * above the sender's SO_SNDBUF (~208 KiB by
+ * default) fail with EMSGSIZE, so stay well
+ * under it; a larger change list is dropped
+ * from the datagram.
+ ***********************************************/
+static constexpr std::size_t MAX_DATAGRAM_SIZE = 64 * 1024;
+
+/**************************************************************************************
+ * Purpose : Fills a sockaddr_un for the given path.
+ * Args    : path - Socket path (must fit in sun_path).
+ *           addr - Output address.
+ * Return  : bool - false if the path is too long.
+ **************************************************************************************/
+static bool makeAddress(const std::string& path, sockaddr_un& addr)
+{
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        return false;
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+
+/**************************************************************************************
+ * Purpose : Serializes a DayCommitted notification as compact JSON.
+ * Args    : msg - Notification to serialize.
+ * Return  : std::string - JSON payload.
+ **************************************************************************************/
+std::string serializeDayCommitted(const DayCommitted& msg)
+{
+    json changes = json::array();
+    for (const auto& c : msg.changes)
+        changes.push_back({{"pair", c.pair}, {"from", c.firstDate}, {"to", c.lastDate}});
+
+    json j{
+        {"version", msg.version},
+        {"date", msg.date},
+        {"changes", changes}
+    };
+    if (msg.changesDropped)
+        j["changes_dropped"] = true;
+    return j.dump();
+}
+
+
+/**************************************************************************************
+ * Purpose : Parses a DayCommitted JSON payload.
+ * Args    : payload - JSON payload received from the publisher.
+ * Return  : DayCommitted - Decoded notification.
+ *
+ * Throws  : std::runtime_error if the payload is not a valid notification.
+ **************************************************************************************/
+DayCommitted parseDayCommitted(const std::string& payload)
+{
+    try {
+        json j = json::parse(payload);
+
+        DayCommitted msg;
+        msg.version = j.at("version").get<long long>();
+        msg.date    = j.at("date").get<int>();
+        msg.changesDropped = j.value("changes_dropped", false);
+
+        for (const auto& c : j.at("changes"))
+        {
+            msg.changes.push_back({
+                c.at("pair").get<std::string>(),
+                c.at("from").get<int>(),
+                c.at("to").get<int>()
+            });
+        }
+        return msg;
+    }
+    catch (const std::exception& e) {
+        throw std::runtime_error(std::string("invalid DayCommitted payload: ") + e.what());
+    }
+}
+
+
+/**************************************************************************************
+ * Purpose : Creates the notifier and its unbound datagram socket.
+ * Args    : socketPaths - Unix datagram socket paths consumers listen on.
+ * Return  : None
+ **************************************************************************************/
+ChangeNotifier::ChangeNotifier(std::vector<std::string> socketPaths)
+    : socketPaths_(std::move(socketPaths))
+{
+    if (socketPaths_.empty())
+        return;
+
+    fd_ = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0)
+        LG_ERROR("ChangeNotifier socket() failed: {}", std::strerror(errno));
+}
+
+ChangeNotifier::~ChangeNotifier()
+{
+    if (fd_ >= 0)
+        ::close(fd_);
+}
+
+
+/**************************************************************************************
+ * Purpose : Sends the notification to every configured subscriber without blocking.
+ *           Missing or stopped subscribers (ENOENT, ECONNREFUSED) are only logged at
+ *           debug level. A payload over MAX_DATAGRAM_SIZE is sent without its change
+ *           list (changesDropped), so the wake-up still arrives.
+ * Args    : msg - Notification to publish.
+ * Return  : std::size_t - Number of subscribers the datagram was delivered to.
+ **************************************************************************************/
+std::size_t ChangeNotifier::publish(const DayCommitted& msg)
+{
+    if (fd_ < 0)
+        return 0;
+
+    std::string payload = serializeDayCommitted(msg);
+    if (payload.size() > MAX_DATAGRAM_SIZE)
+    {
+        LG_WARN("DayCommitted payload is {} bytes (limit {}); publishing it without its {} changes",
+                payload.size(), MAX_DATAGRAM_SIZE, msg.changes.size());
+        payload = serializeDayCommitted(DayCommitted{msg.version, msg.date, {}, true});
+    }
+
+    std::size_t delivered = 0;
+
+    for (const auto& path : socketPaths_)
+    {
+        sockaddr_un addr;
+        if (!makeAddress(path, addr)) {
+            LG_ERROR("Notification socket path too long: {}", path);
+            continue;
+        }
+
+        ssize_t n = ::sendto(fd_, payload.data(), payload.size(), MSG_DONTWAIT,
+                             reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+        if (n < 0)
+        {
+            if (errno == ENOENT || errno == ECONNREFUSED)
+                LG_DEBUG("No listener on {}", path);
+            else
+                LG_WARN("Notification to {} failed: {}", path, std::strerror(errno));
+            continue;
+        }
+
+        ++delivered;
+    }
+
+    LG_INFO("Published DayCommitted v{} ({} pairs) to {}/{} subscribers",
+            msg.version, msg.changes.size(), delivered, socketPaths_.size());
+    return delivered;
+}
+
+
+/**************************************************************************************
+ * Purpose : Binds the listening socket, removing a stale socket file first.
+ * Args    : socketPath - Path of the Unix datagram socket to bind.
+ * Return  : None
+ *
+ * Throws  : std::runtime_error if the socket cannot be created or bound.
+ **************************************************************************************/
+ChangeListener::ChangeListener(std::string socketPath)
+    : socketPath_(std::move(socketPath))
+{
+    sockaddr_un addr;
+    if (!makeAddress(socketPath_, addr))
+        throw std::runtime_error("notification socket path too long: " + socketPath_);
+
+    fd_ = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd_ < 0)
+        throw std::runtime_error(std::string("socket() failed: ") + std::strerror(errno));
+
+    ::unlink(socketPath_.c_str());
+
+    if (::bind(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        std::string err = std::strerror(errno);
+        ::close(fd_);
+        fd_ = -1;
+        throw std::runtime_error("bind(" + socketPath_ + ") failed: " + err);
+    }
+
+    LG_INFO("Listening for DayCommitted notifications on {}", socketPath_);
+}
+
+ChangeListener::~ChangeListener()
+{
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        ::unlink(socketPath_.c_str());
+    }
+}
+
+
+/**************************************************************************************
+ * Purpose : Waits until a notification arrives or the timeout expires. All pending
+ *           datagrams are drained so a burst of commits results in a single wake-up.
+ * Args    : timeout - Maximum time to wait.
+ *           out     - Receives the last notification (version 0 if the payload could
+ *                     not be decoded, e.g. truncated).
+ * Return  : bool - true if at least one notification was received.
+ **************************************************************************************/
+bool ChangeListener::wait(std::chrono::milliseconds timeout, DayCommitted& out)
+{
+    pollfd pfd{fd_, POLLIN, 0};
+    int rc = ::poll(&pfd, 1, static_cast<int>(timeout.count()));
+    if (rc <= 0)
+    {
+        if (rc < 0 && errno != EINTR)
+            LG_ERROR("poll() on {} failed: {}", socketPath_, std::strerror(errno));
+        return false;
+    }
+
+    std::string buffer(MAX_DATAGRAM_SIZE, '\0');
+    bool received = false;
+
+    while (true)
+    {
+        ssize_t n = ::recv(fd_, buffer.data(), buffer.size(), MSG_TRUNC);
+        if (n < 0)
+            break;   // EAGAIN: drained
+
+        received = true;
+        out = DayCommitted{};
+
+        if (static_cast<std::size_t>(n) > buffer.size()) {
+            LG_WARN("DayCommitted notification truncated ({} bytes)", n);
+            continue;
+        }
+
+        try {
+            out = parseDayCommitted(buffer.substr(0, static_cast<std::size_t>(n)));
+        }
+        catch (const std::exception& e) {
+            LG_WARN("{}", e.what());
+        }
+    }
+
+    return received;
+}
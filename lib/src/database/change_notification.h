@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/***********************************************
+ * Range of dates (YYYYMMDD, inclusive) written
+ * for one pair in a committed update.
+ ***********************************************/
+struct ChangedRange {
+    std::string pair;
+    int firstDate = 0;
+    int lastDate  = 0;
+};
+
+/***********************************************
+ * "Day committed" notification published by the
+ * database service after each successful store.
+ * `version` matches the row in the data_version
+ * table, which stays the source of truth.
+ ***********************************************/
+struct DayCommitted {
+    long long version = 0;                 // data_version watermark of the commit
+    int date = 0;                          // Target date of the download (YYYYMMDD)
+    std::vector<ChangedRange> changes;     // Pairs/dates written by this commit
+    bool changesDropped = false;           // changes did not fit one datagram and were left
+                                           // out: read them from data_changes
+};
+
+/**************************************************************************************
+ * Purpose : Serializes / parses a DayCommitted notification as a compact JSON payload.
+ * Throws  : parseDayCommitted throws std::runtime_error on malformed payloads.
+ **************************************************************************************/
+std::string serializeDayCommitted(const DayCommitted& msg);
+DayCommitted parseDayCommitted(const std::string& payload);
+
+/**************************************************************************************
+ * Purpose : Publishes DayCommitted notifications as datagrams to a set of Unix domain
+ *           socket paths. Delivery is best-effort and never blocks the publisher: a
+ *           consumer that is not running simply misses the wake-up and catches up from
+ *           the data_version table.
+ **************************************************************************************/
+class ChangeNotifier {
+public:
+    /**************************************************************************************
+     * Purpose : Creates the notifier for the given subscriber socket paths.
+     * Args    : socketPaths - Unix datagram socket paths consumers listen on.
+     **************************************************************************************/
+    explicit ChangeNotifier(std::vector<std::string> socketPaths);
+    ~ChangeNotifier();
+
+    ChangeNotifier(const ChangeNotifier&) = delete;
+    ChangeNotifier& operator=(const ChangeNotifier&) = delete;
+
+    /**************************************************************************************
+     * Purpose : Sends the notification to every configured subscriber.
+     * Args    : msg - Notification to publish.
+     * Return  : std::size_t - Number of subscribers the datagram was delivered to.
+     **************************************************************************************/
+    std::size_t publish(const DayCommitted& msg);
+
+private:
+    std::vector<std::string> socketPaths_;
+    int fd_ = -1;
+};
+
+/**************************************************************************************
+ * Purpose : Receives DayCommitted notifications on a bound Unix datagram socket. The
+ *           socket file is (re)created on construction and removed on destruction.
+ **************************************************************************************/
+class ChangeListener {
+public:
+    /**************************************************************************************
+     * Purpose : Binds the listening socket.
+     * Args    : socketPath - Path of the Unix datagram socket to bind.
+     * Throws  : std::runtime_error if the socket cannot be created or bound.
+     **************************************************************************************/
+    explicit ChangeListener(std::string socketPath);
+    ~ChangeListener();
+
+    ChangeListener(const ChangeListener&) = delete;
+    ChangeListener& operator=(const ChangeListener&) = delete;
+
+    /**************************************************************************************
+     * Purpose : Waits until a notification arrives or the timeout expires. Pending
+     *           notifications are drained; the most recent one is returned.
+     * Args    : timeout - Maximum time to wait.
+     *           out     - Receives the last notification (version 0 if the payload
+     *                     could not be decoded, e.g. truncated).
+     * Return  : bool - true if at least one notification was received.
+     **************************************************************************************/
+    bool wait(std::chrono::milliseconds timeout, DayCommitted& out);
+
+private:
+    std::string socketPath_;
+    int fd_ = -1;
+};
@@ -0,0 +1,289 @@
+#include "market_data_bus.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(std::is_trivially_copyable_v<IndicatorState>, "IndicatorState must be POD-like");
+static_assert(std::is_trivially_copyable_v<BarData>, "BarData must be POD-like");
+
+static constexpr std::size_t alignUp(std::size_t v, std::size_t a = 64)
+{
+    return (v + a - 1) / a * a;
+}
+
+/**************************************************************************************
+ * Purpose : Computes the byte offset of every region for the given capacities.
+ * Args    : maxSymbols - Maximum number of symbols.
+ *           windowBars - Number of bars kept per symbol.
+ * Return  : MarketBusLayout - Region offsets and total segment size.
+ **************************************************************************************/
+MarketBusLayout MarketBusLayout::compute(uint32_t maxSymbols, uint32_t windowBars)
+{
+    MarketBusLayout l;
+    std::size_t off = alignUp(sizeof(MarketBusHeader));
+
+    l.symbols = off;  off = alignUp(off + std::size_t(maxSymbols) * BUS_SYMBOL_LEN);
+    l.dates   = off;  off = alignUp(off + std::size_t(windowBars) * sizeof(int32_t));
+    l.columns = off;  off = alignUp(off + BUS_FIELDS * maxSymbols * std::size_t(windowBars) * sizeof(double));
+    l.states  = off;  off = alignUp(off + std::size_t(maxSymbols) * sizeof(IndicatorState));
+    l.latest  = off;  off = alignUp(off + std::size_t(maxSymbols) * sizeof(BarData));
+    l.total   = off;
+
+    return l;
+}
+
+
+std::string_view MarketBusView::symbol(uint32_t i) const noexcept
+{
+    const char* s = reinterpret_cast<const char*>(base_ + layout_.symbols) + i * BUS_SYMBOL_LEN;
+    return std::string_view(s, strnlen(s, BUS_SYMBOL_LEN));
+}
+
+int MarketBusView::findSymbol(std::string_view name) const noexcept
+{
+    uint32_t lo = 0, hi = nSymbols();
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        std::string_view s = symbol(mid);
+        if (s == name) return static_cast<int>(mid);
+        if (s < name) lo = mid + 1;
+        else          hi = mid;
+    }
+    return -1;
+}
+
+const double* MarketBusView::column(BusField field, uint32_t symbolIdx) const noexcept
+{
+    const double* cols = reinterpret_cast<const double*>(base_ + layout_.columns);
+    const std::size_t perField = std::size_t(header_->maxSymbols) * header_->windowBars;
+    return cols + static_cast<std::size_t>(field) * perField
+                + std::size_t(symbolIdx) * header_->windowBars;
+}
+
+
+/**************************************************************************************
+ * Purpose : Creates the named POSIX shared memory segment sized for the capacities and
+ *           initializes its header. The writer holds an exclusive flock on its segment
+ *           for its lifetime, so a second writer (another service, an import tool) can
+ *           tell a live segment from one left by a writer that exited: only the latter
+ *           is unlinked and re-created (readers re-open it, see replaced()).
+ * Args    : name       - Segment name (e.g., "/algotrading_bus").
+ *           maxSymbols - Maximum number of symbols.
+ *           windowBars - Number of bars kept per symbol.
+ * Return  : None
+ *
+ * Throws  : std::runtime_error if the segment is held by a live writer, or cannot be
+ *           created or mapped.
+ **************************************************************************************/
+MarketBusWriter::MarketBusWriter(std::string name, uint32_t maxSymbols, uint32_t windowBars)
+    : name_(std::move(name)),
+      maxSymbols_(maxSymbols),
+      windowBars_(windowBars),
+      layout_(MarketBusLayout::compute(maxSymbols, windowBars))
+{
+    // A segment left in place: replace it only if no writer holds it
+    if (int old = ::shm_open(name_.c_str(), O_RDWR, 0); old >= 0)
+    {
+        const bool held = ::flock(old, LOCK_EX | LOCK_NB) < 0 && errno == EWOULDBLOCK;
+        if (!held)
+            ::shm_unlink(name_.c_str());
+        ::close(old);
+        if (held)
+            throw std::runtime_error("segment " + name_ + " is in use by another writer");
+    }
+
+    fd_ = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd_ < 0)
+        throw std::runtime_error("shm_open(" + name_ + ") failed: " + std::strerror(errno));
+
+    if (::flock(fd_, LOCK_EX | LOCK_NB) < 0 || ::ftruncate(fd_, static_cast<off_t>(layout_.total)) < 0)
+    {
+        std::string err = std::strerror(errno);
+        ::close(fd_);
+        fd_ = -1;
+        ::shm_unlink(name_.c_str());
+        throw std::runtime_error("setting up " + name_ + " failed: " + err);
+    }
+
+    void* p = ::mmap(nullptr, layout_.total, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED)
+    {
+        std::string err = std::strerror(errno);
+        ::close(fd_);
+        fd_ = -1;
+        ::shm_unlink(name_.c_str());
+        throw std::runtime_error("mmap(" + name_ + ") failed: " + err);
+    }
+
+    base_ = static_cast<std::byte*>(p);
+
+    auto* h = new (base_) MarketBusHeader{};
+    h->magic         = BUS_MAGIC;
+    h->layoutVersion = BUS_LAYOUT_VERSION;
+    h->maxSymbols    = maxSymbols_;
+    h->windowBars    = windowBars_;
+    h->sequence.store(0, std::memory_order_release);
+
+    LG_INFO("Market data bus {} created ({} symbols x {} bars, {} KiB)",
+            name_, maxSymbols_, windowBars_, layout_.total / 1024);
+}
+
+MarketBusWriter::~MarketBusWriter()
+{
+    if (base_)
+        ::munmap(base_, layout_.total);
+    // Closing releases the lock. The segment is intentionally left in place so readers
+    // keep the last snapshot; the next writer replaces it.
+    if (fd_ >= 0)
+        ::close(fd_);
+}
+
+
+/**************************************************************************************
+ * Purpose : Publishes a snapshot under the seqlock. Symbols beyond capacity are dropped
+ *           and the header keeps the snapshot's symbol count, so readers see the bus is
+ *           truncated; if the snapshot has more dates than the window, the most recent
+ *           are kept.
+ * Args    : snapshot - Data to publish.
+ * Return  : void
+ **************************************************************************************/
+void MarketBusWriter::publish(const MarketBusSnapshot& snapshot)
+{
+    auto* h = reinterpret_cast<MarketBusHeader*>(base_);
+
+    const uint32_t nSymbols = static_cast<uint32_t>(std::min<std::size_t>(snapshot.symbols.size(), maxSymbols_));
+    const std::size_t srcBars = snapshot.dates.size();
+    const uint32_t nBars = static_cast<uint32_t>(std::min<std::size_t>(srcBars, windowBars_));
+    const std::size_t skip = srcBars - nBars;
+
+    if (snapshot.symbols.size() > maxSymbols_)
+        LG_WARN("Market data bus full: {} of {} symbols published, readers use SQLite (raise market_bus_max_symbols)",
+                maxSymbols_, snapshot.symbols.size());
+
+    // ---- begin write (sequence becomes odd) ----
+    const uint64_t seq = h->sequence.load(std::memory_order_relaxed);
+    h->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    char* symbols = reinterpret_cast<char*>(base_ + layout_.symbols);
+    std::memset(symbols, 0, std::size_t(maxSymbols_) * BUS_SYMBOL_LEN);
+    for (uint32_t s = 0; s < nSymbols; ++s)
+        std::strncpy(symbols + s * BUS_SYMBOL_LEN, snapshot.symbols[s].c_str(), BUS_SYMBOL_LEN - 1);
+
+    std::memcpy(base_ + layout_.dates, snapshot.dates.data() + skip, nBars * sizeof(int32_t));
+
+    double* cols = reinterpret_cast<double*>(base_ + layout_.columns);
+    const std::size_t perField = std::size_t(maxSymbols_) * windowBars_;
+    for (std::size_t f = 0; f < BUS_FIELDS; ++f)
+    {
+        for (uint32_t s = 0; s < nSymbols; ++s)
+        {
+            double* dst = cols + f * perField + std::size_t(s) * windowBars_;
+            const double* src = snapshot.columns[f].data() + std::size_t(s) * srcBars + skip;
+            std::memcpy(dst, src, nBars * sizeof(double));
+        }
+    }
+
+    std::memcpy(base_ + layout_.states, snapshot.states.data(), nSymbols * sizeof(IndicatorState));
+    std::memcpy(base_ + layout_.latest, snapshot.latest.data(), nSymbols * sizeof(BarData));
+
+    h->dataVersion  = snapshot.dataVersion;
+    h->latestDate   = nBars ? snapshot.dates.back() : 0;
+    h->nSymbols     = nSymbols;
+    h->nBars        = nBars;
+    h->totalSymbols = static_cast<uint32_t>(snapshot.symbols.size());
+
+    // ---- end write (sequence becomes even) ----
+    h->sequence.store(seq + 2, std::memory_order_release);
+
+    LG_INFO("Market data bus published: data_version {}, {} symbols x {} bars up to {}",
+            snapshot.dataVersion, nSymbols, nBars, h->latestDate);
+}
+
+
+/**************************************************************************************
+ * Purpose : Opens and maps the named segment read-only and validates its layout.
+ * Args    : name - Segment name used by the writer.
+ * Return  : None
+ *
+ * Throws  : std::runtime_error if the segment is missing or has another layout.
+ **************************************************************************************/
+MarketBusReader::MarketBusReader(std::string name)
+    : name_(std::move(name))
+{
+    int fd = ::shm_open(name_.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        throw std::runtime_error("shm_open(" + name_ + ") failed: " + std::strerror(errno));
+
+    struct stat st{};
+    if (::fstat(fd, &st) < 0 || static_cast<std::size_t>(st.st_size) < sizeof(MarketBusHeader))
+    {
+        ::close(fd);
+        throw std::runtime_error("market data bus " + name_ + " is not initialized");
+    }
+
+    void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+        throw std::runtime_error("mmap(" + name_ + ") failed: " + std::strerror(errno));
+
+    base_   = static_cast<const std::byte*>(p);
+    device_ = st.st_dev;
+    inode_  = st.st_ino;
+    const MarketBusHeader* h = header();
+
+    layout_ = MarketBusLayout::compute(h->maxSymbols, h->windowBars);
+
+    if (h->magic != BUS_MAGIC || h->layoutVersion != BUS_LAYOUT_VERSION ||
+        layout_.total != static_cast<std::size_t>(st.st_size))
+    {
+        ::munmap(const_cast<std::byte*>(base_), static_cast<std::size_t>(st.st_size));
+        base_ = nullptr;
+        throw std::runtime_error("market data bus " + name_ + " has an incompatible layout");
+    }
+}
+
+MarketBusReader::~MarketBusReader()
+{
+    if (base_)
+        ::munmap(const_cast<std::byte*>(base_), layout_.total);
+}
+
+int64_t MarketBusReader::dataVersion() const
+{
+    int64_t version = -1;
+    if (!read([&](const MarketBusView& view) { version = view.dataVersion(); }))
+        return -1;
+    return version;
+}
+
+/**************************************************************************************
+ * Purpose : Compares the segment the name resolves to now with the mapped one (device
+ *           and inode: a re-created segment always gets a new inode while this mapping
+ *           holds the old one).
+ * Args    : None
+ * Return  : bool - true if the name resolves to another segment.
+ **************************************************************************************/
+bool MarketBusReader::replaced() const
+{
+    int fd = ::shm_open(name_.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+
+    struct stat st{};
+    const bool ok = ::fstat(fd, &st) == 0;
+    ::close(fd);
+
+    return ok && (st.st_dev != device_ || st.st_ino != inode_);
+}
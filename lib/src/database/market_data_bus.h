@@ -0,0 +1,250 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/types.h>
+
+#include "data_types.h"
+#include "indicators.h"
+
+/**************************************************************************************
+ * Shared-memory market data bus.
+ *
+ * One writer (the database service) publishes the latest window of daily bars for
+ * every tracked symbol, plus the indicator state after the last bar, into a POSIX
+ * shared memory segment. Any number of local readers (signalizer, research tools)
+ * map it read-only and access the columns in place, without touching SQLite.
+ *
+ * Consistency uses a seqlock: the writer makes `sequence` odd while writing and even
+ * when done; readers retry if the sequence changed while they were reading.
+ *
+ * Segment layout (all offsets 64-byte aligned):
+ *   MarketBusHeader
+ *   char      symbols  [maxSymbols][BUS_SYMBOL_LEN]   (sorted, NUL padded)
+ *   int32_t   dates    [windowBars]                    (ascending, shared axis)
+ *   double    columns  [BUS_FIELDS][maxSymbols][windowBars]   (NaN = no bar)
+ *   IndicatorState states[maxSymbols]                  (after the symbol's last bar)
+ *   BarData   latest   [maxSymbols]                    (barNumber 0 = no bar on latestDate)
+ **************************************************************************************/
+
+static constexpr uint32_t    BUS_MAGIC          = 0x4D444231;   // "MDB1"
+static constexpr uint32_t    BUS_LAYOUT_VERSION = 3;
+static constexpr std::size_t BUS_SYMBOL_LEN     = 32;
+
+// Columnar fields stored per symbol.
+enum class BusField : uint32_t {
+    Open = 0, High, Low, Close, Volume,
+    QuoteVolume, Trades, TakerBuyVolume, TakerBuyQuoteVolume,
+    Count
+};
+static constexpr std::size_t BUS_FIELDS = static_cast<std::size_t>(BusField::Count);
+
+struct MarketBusHeader {
+    uint32_t              magic;
+    uint32_t              layoutVersion;
+    uint32_t              maxSymbols;
+    uint32_t              windowBars;
+    std::atomic<uint64_t> sequence;      // Seqlock: odd while the writer is publishing
+    int64_t               dataVersion;   // data_version watermark of the published data
+    int32_t               latestDate;    // Last date of the window (YYYYMMDD)
+    uint32_t              nSymbols;
+    uint32_t              nBars;
+    uint32_t              totalSymbols;  // Symbols of the snapshot (> nSymbols: truncated)
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "seqlock requires a lock-free 64-bit atomic in shared memory");
+
+/***********************************************
+ * Byte offsets of each region in the segment.
+ ***********************************************/
+struct MarketBusLayout {
+    std::size_t symbols = 0;
+    std::size_t dates   = 0;
+    std::size_t columns = 0;
+    std::size_t states  = 0;
+    std::size_t latest  = 0;
+    std::size_t total   = 0;
+
+    static MarketBusLayout compute(uint32_t maxSymbols, uint32_t windowBars);
+};
+
+/**************************************************************************************
+ * Purpose : Read-only view over a mapped segment. Pointers are only valid inside the
+ *           MarketBusReader::read() callback that produced the view.
+ **************************************************************************************/
+class MarketBusView {
+public:
+    MarketBusView(const std::byte* base, const MarketBusLayout& layout)
+        : base_(base), layout_(layout),
+          header_(reinterpret_cast<const MarketBusHeader*>(base)) {}
+
+    int64_t  dataVersion() const noexcept { return header_->dataVersion; }
+    int32_t  latestDate()  const noexcept { return header_->latestDate; }
+    uint32_t nSymbols()    const noexcept { return header_->nSymbols; }
+    uint32_t nBars()       const noexcept { return header_->nBars; }
+    uint32_t totalSymbols() const noexcept { return header_->totalSymbols; }
+
+    // Whether symbols were dropped for lack of capacity: the view is not the whole universe.
+    bool truncated() const noexcept { return header_->totalSymbols > header_->nSymbols; }
+
+    // Symbol name at index i.
+    std::string_view symbol(uint32_t i) const noexcept;
+
+    // Index of a symbol (binary search), or -1 if not published.
+    int findSymbol(std::string_view symbol) const noexcept;
+
+    // Date (YYYYMMDD) of bar b on the shared axis.
+    int32_t date(uint32_t b) const noexcept {
+        return reinterpret_cast<const int32_t*>(base_ + layout_.dates)[b];
+    }
+
+    // Contiguous nBars() values of one field for one symbol (NaN where no bar).
+    const double* column(BusField field, uint32_t symbolIdx) const noexcept;
+
+    // Indicator state after the symbol's last published bar.
+    const IndicatorState& indicatorState(uint32_t symbolIdx) const noexcept {
+        return reinterpret_cast<const IndicatorState*>(base_ + layout_.states)[symbolIdx];
+    }
+
+    // Enriched bar for latestDate() (barNumber == 0 if the symbol has no bar that day).
+    const BarData& latestBar(uint32_t symbolIdx) const noexcept {
+        return reinterpret_cast<const BarData*>(base_ + layout_.latest)[symbolIdx];
+    }
+
+private:
+    const std::byte*       base_;
+    MarketBusLayout        layout_;
+    const MarketBusHeader* header_;
+};
+
+/***********************************************
+ * Heap-side data the writer publishes. Columns
+ * are symbol-major: col[s * dates.size() + b].
+ ***********************************************/
+struct MarketBusSnapshot {
+    int64_t                     dataVersion = 0;
+    std::vector<std::string>    symbols;            // Sorted ascending
+    std::vector<int32_t>        dates;              // Ascending
+    std::vector<double>         columns[BUS_FIELDS];
+    std::vector<IndicatorState> states;
+    std::vector<BarData>        latest;
+};
+
+/**************************************************************************************
+ * Purpose : Creates (or re-creates) the shared segment and publishes snapshots into it.
+ *           One writer per segment: the writer locks it, and a segment locked by a
+ *           live writer is never unlinked.
+ **************************************************************************************/
+class MarketBusWriter {
+public:
+    /**************************************************************************************
+     * Purpose : Creates the named POSIX shared memory segment sized for the capacities.
+     * Args    : name       - Segment name (e.g., "/algotrading_bus").
+     *           maxSymbols - Maximum number of symbols.
+     *           windowBars - Number of bars kept per symbol.
+     * Throws  : std::runtime_error if another writer holds the segment, or it cannot be
+     *           created or mapped.
+     **************************************************************************************/
+    MarketBusWriter(std::string name, uint32_t maxSymbols, uint32_t windowBars);
+    ~MarketBusWriter();
+
+    MarketBusWriter(const MarketBusWriter&) = delete;
+    MarketBusWriter& operator=(const MarketBusWriter&) = delete;
+
+    /**************************************************************************************
+     * Purpose : Publishes a snapshot under the seqlock. Symbols or bars beyond capacity
+     *           are dropped (the most recent bars are kept); dropped symbols are recorded
+     *           in the header (truncated()), so readers do not take the bus as complete.
+     * Args    : snapshot - Data to publish.
+     * Return  : void
+     **************************************************************************************/
+    void publish(const MarketBusSnapshot& snapshot);
+
+    uint32_t windowBars() const noexcept { return windowBars_; }
+
+private:
+    std::string     name_;
+    uint32_t        maxSymbols_;
+    uint32_t        windowBars_;
+    MarketBusLayout layout_;
+    std::byte*      base_ = nullptr;
+    int             fd_   = -1;          // Kept open: holds the writer's flock
+};
+
+/**************************************************************************************
+ * Purpose : Maps an existing segment read-only and gives consistent zero-copy access.
+ **************************************************************************************/
+class MarketBusReader {
+public:
+    /**************************************************************************************
+     * Purpose : Opens and maps the named segment.
+     * Args    : name - Segment name used by the writer.
+     * Throws  : std::runtime_error if the segment is missing or has another layout.
+     **************************************************************************************/
+    explicit MarketBusReader(std::string name);
+    ~MarketBusReader();
+
+    MarketBusReader(const MarketBusReader&) = delete;
+    MarketBusReader& operator=(const MarketBusReader&) = delete;
+
+    // Current seqlock sequence (even = stable). Cheap change detection.
+    uint64_t sequence() const noexcept {
+        return header()->sequence.load(std::memory_order_acquire);
+    }
+
+    // data_version of the mapped snapshot (-1 if never published or not readable).
+    int64_t dataVersion() const;
+
+    /**************************************************************************************
+     * Purpose : Checks whether the name now resolves to another segment than the mapped
+     *           one (a restarted writer unlinks and re-creates it; this mapping then
+     *           never changes again). A removed name is not a replacement: the mapping
+     *           keeps the last snapshot.
+     * Return  : bool - true if the reader should be re-opened.
+     **************************************************************************************/
+    bool replaced() const;
+
+    /**************************************************************************************
+     * Purpose : Runs fn(const MarketBusView&) on a consistent snapshot. The callback may
+     *           run several times if the writer publishes concurrently, so it must only
+     *           copy what it needs and must not keep pointers into the view.
+     * Args    : fn         - Callback receiving the view.
+     *           maxRetries - Attempts before giving up.
+     * Return  : bool - true if fn completed on a consistent, non-empty snapshot.
+     **************************************************************************************/
+    template<typename F>
+    bool read(F&& fn, int maxRetries = 100) const
+    {
+        for (int attempt = 0; attempt < maxRetries; ++attempt)
+        {
+            const uint64_t before = header()->sequence.load(std::memory_order_acquire);
+            if (before == 0)
+                return false;          // never published
+            if (before & 1U)
+                continue;              // writer in progress
+
+            fn(MarketBusView(base_, layout_));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header()->sequence.load(std::memory_order_relaxed) == before)
+                return true;
+        }
+        return false;
+    }
+
+private:
+    std::string       name_;
+    MarketBusLayout   layout_;
+    const std::byte*  base_ = nullptr;
+    dev_t             device_ = 0;        // Identity of the mapped segment (fstat)
+    ino_t             inode_  = 0;
+
+    const MarketBusHeader* header() const noexcept {
+        return reinterpret_cast<const MarketBusHeader*>(base_);
+    }
+};
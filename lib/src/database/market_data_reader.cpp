@@ -0,0 +1,324 @@
+#include "market_data_reader.h"
+#include "logger.h"
+
+#include <string_view>
+#include <unordered_map>
+
+/***********************************************
+ * Selected columns, in BarColumns order.
+ ***********************************************/
+static constexpr const char* BAR_COLUMNS =
+    "pair, date, open, high, low, close, volume, "
+    "quote_volume, trades, taker_buy_volume, taker_buy_quote_volume";
+
+OHLCV BarColumns::bar(std::size_t row) const
+{
+    OHLCV c;
+    c.open   = open[row];
+    c.high   = high[row];
+    c.low    = low[row];
+    c.close  = close[row];
+    c.volume = volume[row];
+    c.quoteVolume         = quoteVolume[row];
+    c.trades              = trades[row];
+    c.takerBuyVolume      = takerBuyVolume[row];
+    c.takerBuyQuoteVolume = takerBuyQuoteVolume[row];
+    return c;
+}
+
+void BarColumns::clear()
+{
+    symbols.clear();
+    symbol.clear();
+    date.clear();
+    for (auto* col : {&open, &high, &low, &close, &volume,
+                      &quoteVolume, &trades, &takerBuyVolume, &takerBuyQuoteVolume})
+        col->clear();
+}
+
+void BarColumns::reserve(std::size_t rows)
+{
+    symbol.reserve(rows);
+    date.reserve(rows);
+    for (auto* col : {&open, &high, &low, &close, &volume,
+                      &quoteVolume, &trades, &takerBuyVolume, &takerBuyQuoteVolume})
+        col->reserve(rows);
+}
+
+BarCursor::BarCursor(SqliteConnection& db, CachedStatement stmt)
+    : db_(&db),
+      stmt_(std::move(stmt)),
+      done_(false)
+{
+}
+
+std::size_t BarCursor::fill(BarColumns& out, std::size_t maxRows)
+{
+    out.clear();
+    return append(out, maxRows);
+}
+
+/**************************************************************************************
+ * Purpose : Steps the statement and decodes each row into the columns. Symbols are
+ *           interned per buffer: consecutive rows of the same symbol (BySymbol order)
+ *           reuse the previous index without a lookup.
+ * Args    : out     - Column buffers.
+ *           maxRows - Maximum rows to append.
+ * Return  : std::size_t - Rows appended.
+ **************************************************************************************/
+std::size_t BarCursor::append(BarColumns& out, std::size_t maxRows)
+{
+    if (done_)
+        return 0;
+
+    std::unordered_map<std::string, uint32_t> index;
+    for (uint32_t i = 0; i < out.symbols.size(); ++i)
+        index.emplace(out.symbols[i], i);
+
+    uint32_t current = UINT32_MAX;
+    std::size_t rows = 0;
+
+    while (rows < maxRows)
+    {
+        const int rc = sqlite3_step(stmt_);
+        if (rc != SQLITE_ROW)
+        {
+            if (rc != SQLITE_DONE)
+            {
+                LG_ERROR("Bar scan failed: {}", db_->errmsg());
+                failed_ = true;
+            }
+            done_ = true;
+            stmt_ = CachedStatement{};     // Hand the statement back to the cache
+            break;
+        }
+
+        const char* pair_c = reinterpret_cast<const char*>(sqlite3_column_text(stmt_, 0));
+        if (!pair_c)
+            continue;
+        const std::string_view pair(pair_c, static_cast<std::size_t>(sqlite3_column_bytes(stmt_, 0)));
+
+        if (current == UINT32_MAX || out.symbols[current] != pair)
+        {
+            auto [it, inserted] = index.try_emplace(std::string(pair), static_cast<uint32_t>(out.symbols.size()));
+            if (inserted)
+                out.symbols.push_back(it->first);
+            current = it->second;
+        }
+
+        out.symbol.push_back(current);
+        out.date.push_back(sqlite3_column_int(stmt_, 1));
+        out.open.push_back(sqlite3_column_double(stmt_, 2));
+        out.high.push_back(sqlite3_column_double(stmt_, 3));
+        out.low.push_back(sqlite3_column_double(stmt_, 4));
+        out.close.push_back(sqlite3_column_double(stmt_, 5));
+        out.volume.push_back(sqlite3_column_double(stmt_, 6));
+        out.quoteVolume.push_back(sqlite3_column_double(stmt_, 7));
+        out.trades.push_back(sqlite3_column_double(stmt_, 8));
+        out.takerBuyVolume.push_back(sqlite3_column_double(stmt_, 9));
+        out.takerBuyQuoteVolume.push_back(sqlite3_column_double(stmt_, 10));
+        ++rows;
+    }
+
+    return rows;
+}
+
+/**************************************************************************************
+ * Purpose : Symbols as a JSON array, bound to "IN (SELECT value FROM json_each(?))".
+ * Args    : symbols - Symbols.
+ * Return  : std::string - JSON array text.
+ **************************************************************************************/
+static std::string symbolArray(const std::vector<std::string>& symbols)
+{
+    std::string out = "[";
+    for (const auto& s : symbols)
+    {
+        if (out.size() > 1)
+            out += ',';
+        out += '"';
+        for (char c : s)
+        {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            out += c;
+        }
+        out += '"';
+    }
+    out += ']';
+    return out;
+}
+
+MarketDataReader::MarketDataReader(SqliteConnection& db, std::string table)
+    : db_(db),
+      table_(std::move(table))
+{
+}
+
+/**************************************************************************************
+ * Purpose : Prepares (from the cache) the statement of `query` and binds it. The
+ *           symbols go in as one JSON array expanded by json_each, so the statement
+ *           text only depends on the order and on whether there is a filter.
+ * Args    : query - Symbols, date range and order.
+ * Return  : BarCursor - failed() and done() if the statement could not be prepared.
+ **************************************************************************************/
+BarCursor MarketDataReader::scan(const BarQuery& query)
+{
+    const bool filtered = !query.symbols.empty();
+    const char* order = query.order == BarOrder::BySymbol ? "pair ASC, date ASC" : "date ASC, pair ASC";
+
+    const std::string sql = fmt::format(
+        "SELECT {} FROM {} WHERE {}date >= ? AND date <= ? ORDER BY {};",
+        BAR_COLUMNS, table_, filtered ? "pair IN (SELECT value FROM json_each(?)) AND " : "", order);
+
+    CachedStatement stmt = db_.cached(sql);
+    if (!stmt)
+    {
+        LG_ERROR("Prepare bar scan of {} failed: {}", table_, db_.errmsg());
+        BarCursor failed;
+        failed.failed_ = true;
+        return failed;
+    }
+
+    int param = 1;
+    if (filtered)
+    {
+        const std::string symbols = symbolArray(query.symbols);
+        sqlite3_bind_text(stmt, param++, symbols.c_str(), static_cast<int>(symbols.size()), SQLITE_TRANSIENT);
+    }
+    sqlite3_bind_int(stmt, param++, query.from);
+    sqlite3_bind_int(stmt, param++, query.to);
+
+    return BarCursor(db_, std::move(stmt));
+}
+
+BarColumns MarketDataReader::bars(const std::vector<std::string>& symbols, int from, int to)
+{
+    BarColumns out;
+    BarCursor cursor = scan(BarQuery{symbols, from, to, BarOrder::BySymbol});
+    cursor.append(out);
+    if (cursor.failed())
+        out.clear();
+    return out;
+}
+
+BarColumns MarketDataReader::crossSection(int date)
+{
+    BarColumns out;
+    BarCursor cursor = scan(BarQuery{{}, date, date, BarOrder::ByDate});
+    cursor.append(out);
+    if (cursor.failed())
+        out.clear();
+    return out;
+}
+
+bool MarketDataReader::latest(const std::string& symbol, SymbolBar& out)
+{
+    CachedStatement stmt = db_.cached(fmt::format(
+        "SELECT {} FROM {} WHERE pair = ? ORDER BY date DESC LIMIT 1;", BAR_COLUMNS, table_));
+    if (!stmt)
+    {
+        LG_ERROR("Prepare latest bar of {} failed: {}", table_, db_.errmsg());
+        return false;
+    }
+
+    sqlite3_bind_text(stmt, 1, symbol.c_str(), -1, SQLITE_TRANSIENT);
+
+    BarCursor cursor(db_, std::move(stmt));
+    BarColumns row;
+    if (cursor.append(row, 1) == 0)
+        return false;
+
+    out.symbol = symbol;
+    out.date   = row.date[0];
+    out.bar    = row.bar(0);
+    return true;
+}
+
+int MarketDataReader::latestDate()
+{
+    // Not MAX(date): through the UNION ALL view of a sharded table the aggregate reads
+    // every row, the ordered form one index entry per shard
+    CachedStatement stmt = db_.cached("SELECT date FROM " + table_ + " ORDER BY date DESC LIMIT 1;");
+    if (!stmt)
+    {
+        LG_ERROR("Prepare latest date of {} failed: {}", table_, db_.errmsg());
+        return 0;
+    }
+
+    return sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : 0;
+}
+
+std::vector<SymbolRange> MarketDataReader::ranges()
+{
+    std::vector<SymbolRange> out;
+
+    // Answered from the (pair, date) primary key alone
+    CachedStatement stmt = db_.cached("SELECT pair, MIN(date), MAX(date) FROM " + table_ + " GROUP BY pair ORDER BY pair;");
+    if (!stmt)
+    {
+        LG_ERROR("Prepare symbol ranges of {} failed: {}", table_, db_.errmsg());
+        return out;
+    }
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        const char* pair_c = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        if (!pair_c)
+            continue;
+        out.push_back({pair_c, sqlite3_column_int(stmt, 1), sqlite3_column_int(stmt, 2)});
+    }
+
+    if (rc != SQLITE_DONE)
+    {
+        LG_ERROR("Symbol ranges of {} failed: {}", table_, db_.errmsg());
+        out.clear();
+    }
+    return out;
+}
+
+FundingRateReader::FundingRateReader(SqliteConnection& db, std::string table)
+    : db_(db),
+      table_(std::move(table))
+{
+}
+
+FundingRateData FundingRateReader::rates(const std::vector<std::string>& symbols, int from, int to)
+{
+    FundingRateData out;
+
+    const bool filtered = !symbols.empty();
+    CachedStatement stmt = db_.cached(fmt::format(
+        "SELECT pair, funding_time, rate FROM {} WHERE {}date >= ? AND date <= ?;",
+        table_, filtered ? "pair IN (SELECT value FROM json_each(?)) AND " : ""));
+    if (!stmt)
+    {
+        LG_ERROR("Prepare funding rates of {} failed: {}", table_, db_.errmsg());
+        return out;
+    }
+
+    int param = 1;
+    if (filtered)
+    {
+        const std::string array = symbolArray(symbols);
+        sqlite3_bind_text(stmt, param++, array.c_str(), static_cast<int>(array.size()), SQLITE_TRANSIENT);
+    }
+    sqlite3_bind_int(stmt, param++, from);
+    sqlite3_bind_int(stmt, param++, to);
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        const char* pair_c = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        if (!pair_c)
+            continue;
+        out.data[pair_c][sqlite3_column_int64(stmt, 1)] = sqlite3_column_double(stmt, 2);
+    }
+
+    if (rc != SQLITE_DONE)
+    {
+        LG_ERROR("Funding rates of {} failed: {}", table_, db_.errmsg());
+        out.data.clear();
+    }
+    return out;
+}
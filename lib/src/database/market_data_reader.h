@@ -0,0 +1,210 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "data_types.h"
+#include "sqlite_connection.h"
+
+/***********************************************
+ * Rows per batch of a streaming read when the
+ * caller does not choose.
+ ***********************************************/
+static constexpr std::size_t BAR_CURSOR_BATCH = 4096;
+
+/**************************************************************************************
+ * Purpose : Caller-owned column buffers for a batch of daily bars. Row i is the bar of
+ *           symbols[symbol[i]] on date[i]. clear() keeps the capacity, so a buffer
+ *           reused across batches stops allocating after the first one.
+ **************************************************************************************/
+struct BarColumns {
+    std::vector<std::string> symbols;      // Distinct symbols of the batch
+    std::vector<uint32_t>    symbol;       // Row → index into symbols
+    std::vector<int>         date;         // YYYYMMDD
+    std::vector<double>      open, high, low, close, volume;
+    std::vector<double>      quoteVolume, trades, takerBuyVolume, takerBuyQuoteVolume;
+
+    std::size_t size() const noexcept { return date.size(); }
+    bool empty() const noexcept { return date.empty(); }
+
+    const std::string& symbolOf(std::size_t row) const { return symbols[symbol[row]]; }
+
+    // Bar of `row` as an OHLCV struct.
+    OHLCV bar(std::size_t row) const;
+
+    void clear();
+    void reserve(std::size_t rows);
+};
+
+/***********************************************
+ * One bar with its symbol and date.
+ ***********************************************/
+struct SymbolBar {
+    std::string symbol;
+    int         date = 0;                  // YYYYMMDD
+    OHLCV       bar{};
+};
+
+/***********************************************
+ * Dates stored for one symbol.
+ ***********************************************/
+struct SymbolRange {
+    std::string symbol;
+    int         first = 0;                 // YYYYMMDD
+    int         last  = 0;                 // YYYYMMDD
+};
+
+/***********************************************
+ * Row order of a range read.
+ ***********************************************/
+enum class BarOrder {
+    BySymbol,                              // (symbol, date): one symbol's history after another
+    ByDate                                 // (date, symbol): one cross-section after another
+};
+
+/***********************************************
+ * Range read: symbols × [from, to].
+ ***********************************************/
+struct BarQuery {
+    std::vector<std::string> symbols;      // Empty = every symbol
+    int      from  = 0;                    // First date (YYYYMMDD, inclusive)
+    int      to    = INT_MAX;              // Last date (YYYYMMDD, inclusive)
+    BarOrder order = BarOrder::BySymbol;
+};
+
+/**************************************************************************************
+ * Purpose : Streaming read of a BarQuery. Each fill() decodes the next rows straight
+ *           into the caller's BarColumns, so a scan of any length runs in the memory of
+ *           one batch. Holds a cached statement of the connection: finish (or destroy)
+ *           a cursor before opening another one with the same query shape, and before
+ *           the connection closes.
+ **************************************************************************************/
+class BarCursor {
+public:
+    BarCursor() = default;
+
+    /**************************************************************************************
+     * Purpose : Replaces the content of `out` with the next rows.
+     * Args    : out     - Column buffers (cleared first).
+     *           maxRows - Batch size.
+     * Return  : std::size_t - Rows read (0 at the end of the range or on error).
+     **************************************************************************************/
+    std::size_t fill(BarColumns& out, std::size_t maxRows = BAR_CURSOR_BATCH);
+
+    /**************************************************************************************
+     * Purpose : Appends the next rows to `out` without clearing it.
+     * Args    : out     - Column buffers.
+     *           maxRows - Maximum rows to append.
+     * Return  : std::size_t - Rows appended.
+     **************************************************************************************/
+    std::size_t append(BarColumns& out, std::size_t maxRows = SIZE_MAX);
+
+    // Whether the whole range was read.
+    bool done() const noexcept { return done_; }
+
+    // Whether the query failed (already logged).
+    bool failed() const noexcept { return failed_; }
+
+private:
+    friend class MarketDataReader;
+
+    BarCursor(SqliteConnection& db, CachedStatement stmt);
+
+    SqliteConnection* db_ = nullptr;
+    CachedStatement   stmt_;
+    bool              done_   = true;
+    bool              failed_ = false;
+};
+
+/**************************************************************************************
+ * Purpose : Typed queries over an OHLCV table (ohlcv_data or ohlcv_data_<exchange>)
+ *           for backtests, the signalizer and the database service itself, so none of
+ *           them parses rows column call by column call. Statements come from the
+ *           connection's cache: each query shape is compiled once per connection.
+ *
+ *           Indexes used: the primary key (pair, date) for symbol ranges and latest(),
+ *           idx_<table>_date_pair (date, pair) for cross-sections, date-ordered scans
+ *           and latestDate(). Symbol filters are bound as one JSON array, so any number
+ *           of symbols shares one cached statement.
+ *
+ *           Not thread safe, like the connection it reads.
+ **************************************************************************************/
+class MarketDataReader {
+public:
+    /**************************************************************************************
+     * Purpose : Reader over `table` of `db`. The connection may be opened later; it
+     *           must outlive the reader.
+     * Args    : db    - SQLite connection.
+     *           table - OHLCV table.
+     **************************************************************************************/
+    explicit MarketDataReader(SqliteConnection& db, std::string table = "ohlcv_data");
+
+    /**************************************************************************************
+     * Purpose : Starts a streaming read of `query`.
+     * Args    : query - Symbols, date range and order.
+     * Return  : BarCursor - failed() if the query could not be prepared.
+     **************************************************************************************/
+    BarCursor scan(const BarQuery& query);
+
+    /**************************************************************************************
+     * Purpose : Every bar of `symbols` over [from, to], symbol by symbol.
+     * Args    : symbols - Symbols (empty = all).
+     *           from    - First date (YYYYMMDD, inclusive).
+     *           to      - Last date (YYYYMMDD, inclusive).
+     * Return  : BarColumns - Bars ordered by (symbol, date); empty on error.
+     **************************************************************************************/
+    BarColumns bars(const std::vector<std::string>& symbols, int from, int to);
+
+    /**************************************************************************************
+     * Purpose : Every bar stored for `date`.
+     * Args    : date - YYYYMMDD.
+     * Return  : BarColumns - Bars ordered by symbol; empty on error.
+     **************************************************************************************/
+    BarColumns crossSection(int date);
+
+    /**************************************************************************************
+     * Purpose : Most recent bar of `symbol`.
+     * Args    : symbol - Symbol.
+     *           out    - Filled with the bar.
+     * Return  : bool - false if the symbol has no bar (or on error).
+     **************************************************************************************/
+    bool latest(const std::string& symbol, SymbolBar& out);
+
+    // Latest date of the table (YYYYMMDD, 0 if empty or on error).
+    int latestDate();
+
+    // First and last date of every symbol, ordered by symbol (empty on error).
+    std::vector<SymbolRange> ranges();
+
+private:
+    SqliteConnection& db_;
+    std::string       table_;
+};
+
+/**************************************************************************************
+ * Purpose : Typed range query over a funding table (funding_rates or
+ *           funding_rates_<exchange>), the input of FundingSchedule. Date ranges use
+ *           idx_<table>_date, on the UTC day each event settles in. Statements come
+ *           from the connection's cache, as for MarketDataReader.
+ **************************************************************************************/
+class FundingRateReader {
+public:
+    // Reader over `table` of `db`; the connection must outlive the reader.
+    explicit FundingRateReader(SqliteConnection& db, std::string table = "funding_rates");
+
+    /**************************************************************************************
+     * Purpose : Every funding event of `symbols` settled on the days [from, to].
+     * Args    : symbols - Symbols (empty = all).
+     *           from    - First date (YYYYMMDD, inclusive).
+     *           to      - Last date (YYYYMMDD, inclusive).
+     * Return  : FundingRateData - pair → fundingTime (ms) → rate; empty on error.
+     **************************************************************************************/
+    FundingRateData rates(const std::vector<std::string>& symbols, int from, int to);
+
+private:
+    SqliteConnection& db_;
+    std::string       table_;
+};
@@ -0,0 +1,436 @@
+#include "shard_catalog.h"
+#include "binary_io.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <nlohmann/json.hpp>
+
+/***********************************************
+ * Layout version written in the catalog.
+ ***********************************************/
+static constexpr int SHARD_CATALOG_VERSION = 1;
+
+const char* shardSchemeName(ShardScheme scheme)
+{
+    switch (scheme)
+    {
+        case ShardScheme::Year:       return "year";
+        case ShardScheme::Symbol:     return "symbol";
+        case ShardScheme::YearSymbol: return "year_symbol";
+        default:                      return "none";
+    }
+}
+
+bool parseShardScheme(std::string_view name, ShardScheme& scheme)
+{
+    for (ShardScheme s : {ShardScheme::None, ShardScheme::Year, ShardScheme::Symbol, ShardScheme::YearSymbol})
+    {
+        if (name == shardSchemeName(s))
+        {
+            scheme = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+int maxAttachedShards()
+{
+    static const int limit = []
+    {
+        sqlite3* db = nullptr;
+        int value = 10;
+        if (sqlite3_open_v2(":memory:", &db, SQLITE_OPEN_READWRITE, nullptr) == SQLITE_OK)
+        {
+            // Raising a limit past its hard bound truncates it to the bound
+            sqlite3_limit(db, SQLITE_LIMIT_ATTACHED, INT_MAX);
+            value = sqlite3_limit(db, SQLITE_LIMIT_ATTACHED, -1);
+        }
+        sqlite3_close(db);
+        return value;
+    }();
+    return limit;
+}
+
+boost::filesystem::path ShardCatalog::pathFor(const boost::filesystem::path& database)
+{
+    return database.string() + ".shards.json";
+}
+
+/**************************************************************************************
+ * Purpose : Reads and validates the catalog of `database`; the object is reset to "not
+ *           sharded" first, and left that way on error.
+ * Args    : database - Main database file.
+ * Return  : bool - false if the catalog exists but is malformed.
+ **************************************************************************************/
+bool ShardCatalog::load(const boost::filesystem::path& database)
+{
+    database_      = database;
+    scheme_        = ShardScheme::None;
+    symbolBuckets_ = 8;
+    tables_.clear();
+    shards_.clear();
+
+    const boost::filesystem::path path = pathFor(database);
+    std::string content;
+    if (!boost::filesystem::exists(path))
+        return true;
+    if (!readFile(path, content))
+    {
+        LG_ERROR("Cannot read shard catalog {}", path.string());
+        return false;
+    }
+
+    try
+    {
+        const nlohmann::json j = nlohmann::json::parse(content);
+
+        if (j.at("version").get<int>() != SHARD_CATALOG_VERSION)
+            throw std::runtime_error("unsupported version");
+
+        ShardScheme scheme;
+        if (!parseShardScheme(j.at("scheme").get<std::string>(), scheme))
+            throw std::runtime_error("unknown scheme");
+
+        const int buckets = j.value("symbol_buckets", 8);
+        if (buckets < 1)
+            throw std::runtime_error("symbol_buckets must be >= 1");
+        if (scheme != ShardScheme::Year && buckets > maxAttachedShards())
+            throw std::runtime_error(fmt::format("{} symbol buckets exceed SQLite's attach limit ({})",
+                                                 buckets, maxAttachedShards()));
+
+        std::vector<ShardInfo> shards;
+        for (const auto& s : j.at("shards"))
+        {
+            ShardInfo info;
+            info.key.year   = s.value("year", -1);
+            info.key.bucket = s.value("bucket", -1);
+            info.file       = s.at("file").get<std::string>();
+            info.firstDate  = s.value("first_date", 0);
+            info.lastDate   = s.value("last_date", 0);
+            shards.push_back(std::move(info));
+        }
+        std::sort(shards.begin(), shards.end(), [](const auto& a, const auto& b) { return a.key < b.key; });
+
+        scheme_        = scheme;
+        symbolBuckets_ = buckets;
+        tables_        = j.at("tables").get<std::vector<std::string>>();
+        shards_        = std::move(shards);
+    }
+    catch (const std::exception& e)
+    {
+        LG_ERROR("Malformed shard catalog {}: {}", path.string(), e.what());
+        scheme_ = ShardScheme::None;
+        tables_.clear();
+        shards_.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void ShardCatalog::create(const boost::filesystem::path& database, ShardScheme scheme, int symbolBuckets)
+{
+    database_      = database;
+    scheme_        = scheme;
+    symbolBuckets_ = std::max(symbolBuckets, 1);
+    tables_.clear();
+    shards_.clear();
+}
+
+bool ShardCatalog::save() const
+{
+    nlohmann::json shards = nlohmann::json::array();
+    for (const auto& s : shards_)
+    {
+        shards.push_back({
+            {"file", s.file},
+            {"year", s.key.year},
+            {"bucket", s.key.bucket},
+            {"first_date", s.firstDate},
+            {"last_date", s.lastDate}
+        });
+    }
+
+    const nlohmann::json j = {
+        {"version", SHARD_CATALOG_VERSION},
+        {"scheme", shardSchemeName(scheme_)},
+        {"symbol_buckets", symbolBuckets_},
+        {"tables", tables_},
+        {"shards", shards}
+    };
+
+    return writeFileAtomic(pathFor(database_), j.dump(4) + "\n");
+}
+
+ShardKey ShardCatalog::keyOf(std::string_view pair, int date) const
+{
+    ShardKey key;
+    if (scheme_ == ShardScheme::Year || scheme_ == ShardScheme::YearSymbol)
+        key.year = date / 10000;
+    if (scheme_ == ShardScheme::Symbol || scheme_ == ShardScheme::YearSymbol)
+        key.bucket = static_cast<int>(fnv1a64(pair) % static_cast<uint64_t>(symbolBuckets_));
+    return key;
+}
+
+ShardInfo& ShardCatalog::shard(const ShardKey& key)
+{
+    auto it = std::lower_bound(shards_.begin(), shards_.end(), key,
+                               [](const ShardInfo& s, const ShardKey& k) { return s.key < k; });
+    if (it != shards_.end() && it->key == key)
+        return *it;
+
+    const std::string stem = database_.stem().string();
+
+    std::string name = stem;
+    if (key.year >= 0)
+        name += "_" + std::to_string(key.year);
+    if (key.bucket >= 0)
+        name += "_h" + std::to_string(key.bucket);
+
+    ShardInfo info;
+    info.key  = key;
+    info.file = stem + "_shards/" + name + ".db";
+    return *shards_.insert(it, std::move(info));
+}
+
+std::vector<const ShardInfo*> ShardCatalog::shardsFor(std::string_view symbol, int from, int to) const
+{
+    const ShardKey key = keyOf(symbol, 0);
+
+    std::vector<const ShardInfo*> out;
+    for (const auto& s : shards_)
+    {
+        if (key.bucket >= 0 && s.key.bucket != key.bucket)
+            continue;
+        if (s.key.year >= 0 && (s.key.year < from / 10000 || s.key.year > to / 10000))
+            continue;
+        if (s.lastDate != 0 && (s.lastDate < from || s.firstDate > to))
+            continue;
+        out.push_back(&s);
+    }
+
+    // Keys sort by bucket within a year: restore date order across years
+    std::stable_sort(out.begin(), out.end(), [](const ShardInfo* a, const ShardInfo* b) { return a->key.year < b->key.year; });
+    return out;
+}
+
+std::vector<const ShardInfo*> ShardCatalog::shardsOver(const std::vector<std::string>& symbols, int from, int to) const
+{
+    std::vector<const ShardInfo*> out;
+    if (symbols.empty())
+    {
+        for (const auto& shard : shards_)
+        {
+            if (shard.key.year >= 0 && (shard.key.year < from / 10000 || shard.key.year > to / 10000))
+                continue;
+            if (shard.lastDate == 0 || (shard.lastDate >= from && shard.firstDate <= to))
+                out.push_back(&shard);
+        }
+        return out;
+    }
+
+    for (const auto& symbol : symbols)
+        for (const ShardInfo* shard : shardsFor(symbol, from, to))
+            if (std::find(out.begin(), out.end(), shard) == out.end())
+                out.push_back(shard);
+    return out;
+}
+
+boost::filesystem::path ShardCatalog::pathOf(const ShardInfo& shard) const
+{
+    return database_.parent_path() / shard.file;
+}
+
+bool ShardCatalog::addTable(const std::string& table)
+{
+    if (std::find(tables_.begin(), tables_.end(), table) != tables_.end())
+        return false;
+    tables_.push_back(table);
+    return true;
+}
+
+bool ShardedView::refresh(const boost::filesystem::path& database)
+{
+    const boost::filesystem::path path = ShardCatalog::pathFor(database);
+
+    // std::filesystem for sub-second times: two saves within a second must both be seen
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(path.string(), ec);
+    if (ec)
+        return catalog_.load(database);    // Not sharded
+    if (mtime == catalogTime_ && catalog_.enabled())
+        return true;
+
+    if (!catalog_.load(database))
+        return false;
+
+    catalogTime_ = mtime;
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Groups the years holding shards of the read, in order, as long as the
+ *           group's shards fit maxAttachedShards(); each group is one pass. A pass
+ *           starts on January 1 of its first year (the first one at `from`) and ends
+ *           the day before the next pass (the last one at `to`), so the passes cover
+ *           [from, to] without overlapping.
+ * Args    : symbols - Symbols read (empty = all).
+ *           from    - First date (YYYYMMDD, inclusive).
+ *           to      - Last date (YYYYMMDD, inclusive).
+ * Return  : std::vector<std::pair<int, int>> - Date ranges of the passes.
+ **************************************************************************************/
+std::vector<std::pair<int, int>> ShardedView::passes(const std::vector<std::string>& symbols, int from, int to) const
+{
+    const std::size_t limit = static_cast<std::size_t>(maxAttachedShards());
+
+    const std::vector<const ShardInfo*> shards = catalog_.shardsOver(symbols, from, to);
+    if (shards.size() <= limit)
+        return {{from, to}};
+
+    // Shards of each year (Symbol shards have none, but never exceed the limit)
+    std::map<int, std::size_t> perYear;
+    for (const ShardInfo* shard : shards)
+        if (shard->key.year >= 0)
+            ++perYear[shard->key.year];
+    if (perYear.empty())
+        return {{from, to}};
+
+    std::vector<std::pair<int, int>> out;
+    std::size_t count = 0;
+    for (const auto& [year, n] : perYear)
+    {
+        if (!out.empty() && count + n <= limit)
+        {
+            count += n;
+            continue;
+        }
+
+        if (!out.empty())
+            out.back().second = (year - 1) * 10000 + 1231;
+        out.emplace_back(out.empty() ? from : year * 10000 + 101, to);
+        count = n;
+    }
+    return out;
+}
+
+/**************************************************************************************
+ * Purpose : Brings the attached set in line with a read:
+ *              - Selects the shards the catalog says can hold `symbols` over [from, to]
+ *              - DETACHes the attached shards out of that set, freeing their slots
+ *              - ATTACHes the missing ones as shard_<slot> (raising the connection's
+ *                attach limit to the set's size)
+ *              - Recreates the TEMP view of every sharded table over the attached
+ *                shards, or drops the views if none is
+ *
+ * Args    : db      - Connection on the main database.
+ *           symbols - Symbols read (empty = all).
+ *           from    - First date (YYYYMMDD, inclusive).
+ *           to      - Last date (YYYYMMDD, inclusive).
+ *
+ * Return  : bool - false on error or if the set does not fit the attach limit.
+ **************************************************************************************/
+bool ShardedView::attach(SqliteConnection& db, const std::vector<std::string>& symbols, int from, int to)
+{
+    if (!catalog_.enabled())
+        return true;
+
+    const std::vector<const ShardInfo*> shards = catalog_.shardsOver(symbols, from, to);
+    std::vector<std::string> wanted;
+    for (const ShardInfo* shard : shards)
+        wanted.push_back(shard->file);
+
+    const int needed = static_cast<int>(wanted.size());
+    if (needed > maxAttachedShards())
+    {
+        LG_ERROR("{} shards can hold [{}, {}], more than SQLite attaches ({}): read the range in passes",
+                 needed, from, to, maxAttachedShards());
+        return false;
+    }
+
+    bool changed = false;
+    for (std::size_t i = 0; i < slots_.size(); ++i)
+    {
+        if (slots_[i].empty() || std::find(wanted.begin(), wanted.end(), slots_[i]) != wanted.end())
+            continue;
+
+        if (!db.exec(fmt::format("DETACH DATABASE shard_{};", i)))
+        {
+            LG_ERROR("Cannot detach shard {}: {}", slots_[i], db.errmsg());
+            return false;
+        }
+        slots_[i].clear();
+        changed = true;
+    }
+
+    if (sqlite3_limit(db.handle(), SQLITE_LIMIT_ATTACHED, -1) < needed)
+        sqlite3_limit(db.handle(), SQLITE_LIMIT_ATTACHED, needed);
+
+    for (const ShardInfo* shard : shards)
+    {
+        if (std::find(slots_.begin(), slots_.end(), shard->file) != slots_.end())
+            continue;
+
+        const std::size_t slot = static_cast<std::size_t>(
+            std::find(slots_.begin(), slots_.end(), std::string{}) - slots_.begin());
+
+        SqliteStatement attach = db.prepare(fmt::format("ATTACH DATABASE ? AS shard_{};", slot));
+        const std::string file = catalog_.pathOf(*shard).string();
+        if (attach)
+            sqlite3_bind_text(attach, 1, file.c_str(), -1, SQLITE_TRANSIENT);
+        if (!attach || sqlite3_step(attach) != SQLITE_DONE)
+        {
+            LG_ERROR("Cannot attach shard {}: {}", file, db.errmsg());
+            return false;
+        }
+
+        if (slot == slots_.size())
+            slots_.push_back(shard->file);
+        else
+            slots_[slot] = shard->file;
+        changed = true;
+    }
+
+    if (!changed && catalog_.tables() == tables_)
+        return true;
+
+    // Views over the old set (or tables dropped from the catalog) go first
+    std::string sql;
+    for (const auto& table : tables_)
+        sql += fmt::format("DROP VIEW IF EXISTS temp.{};", table);
+
+    if (!wanted.empty())
+    {
+        for (const auto& table : catalog_.tables())
+        {
+            sql += fmt::format("DROP VIEW IF EXISTS temp.{0}; CREATE TEMP VIEW {0} AS ", table);
+            const char* separator = "";
+            for (std::size_t i = 0; i < slots_.size(); ++i)
+            {
+                if (slots_[i].empty())
+                    continue;
+                sql += fmt::format("{}SELECT * FROM shard_{}.{}", separator, i, table);
+                separator = " UNION ALL ";
+            }
+            sql += ";";
+        }
+    }
+
+    if (!sql.empty() && !db.exec(sql))
+    {
+        LG_ERROR("Cannot create the shard views: {}", db.errmsg());
+        return false;
+    }
+    tables_ = wanted.empty() ? std::vector<std::string>{} : catalog_.tables();
+
+    LG_DEBUG("Reading {} tables over {} shards", tables_.size(), attached());
+    return true;
+}
+
+std::size_t ShardedView::attached() const noexcept
+{
+    return static_cast<std::size_t>(std::count_if(slots_.begin(), slots_.end(),
+                                                  [](const std::string& file) { return !file.empty(); }));
+}
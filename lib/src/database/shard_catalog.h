@@ -0,0 +1,210 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <climits>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "sqlite_connection.h"
+
+/***********************************************
+ * How candles are split across shard files.
+ ***********************************************/
+enum class ShardScheme {
+    None,                                  // Single database file
+    Year,                                  // One file per calendar year
+    Symbol,                                // One file per symbol hash bucket
+    YearSymbol                             // One file per (year, bucket)
+};
+
+// Scheme name as used in the configuration and the catalog ("none", "year", ...).
+const char* shardSchemeName(ShardScheme scheme);
+
+// Parses a scheme name. Return: false if unknown.
+bool parseShardScheme(std::string_view name, ShardScheme& scheme);
+
+// Most shards one connection can ATTACH: SQLite's hard SQLITE_LIMIT_ATTACHED (10 in
+// stock builds, SQLITE_MAX_ATTACHED at most 125). A ShardedView attaches one year of
+// symbol buckets at a time, so the bucket count must stay within it.
+int maxAttachedShards();
+
+/***********************************************
+ * Storage sharding of the OHLCV tables.
+ ***********************************************/
+struct ShardingSettings {
+    ShardScheme scheme        = ShardScheme::None;
+    int         symbolBuckets = 8;         // Hash buckets of the Symbol schemes
+    int         writerThreads = 0;         // Shards written in parallel (0 = hardware threads)
+
+    bool operator==(const ShardingSettings&) const = default;
+};
+
+/***********************************************
+ * Shard identity: the year and/or the symbol
+ * bucket its candles belong to (-1 = not split
+ * on that axis).
+ ***********************************************/
+struct ShardKey {
+    int year   = -1;
+    int bucket = -1;
+
+    auto operator<=>(const ShardKey&) const = default;
+};
+
+/***********************************************
+ * One shard file of the catalog.
+ ***********************************************/
+struct ShardInfo {
+    ShardKey    key;
+    std::string file;                      // Relative to the catalog's directory
+    int         firstDate = 0;             // YYYYMMDD range written so far (0 = none)
+    int         lastDate  = 0;
+};
+
+/**************************************************************************************
+ * Purpose : Catalog of a sharded database: "<database>.shards.json" next to the main
+ *           file, listing the scheme, the sharded tables and every shard file with the
+ *           dates it holds. The catalog is the source of truth for readers: a shard
+ *           only becomes visible once the catalog that lists it has been saved, and it
+ *           is saved atomically (writeFileAtomic). The number of shards is not
+ *           bounded: readers only open the shards a query can touch (shardsOver).
+ *
+ *           Shard files live in "<stem>_shards/" and are named after their key:
+ *           <stem>_2024.db, <stem>_h3.db, <stem>_2024_h3.db. Symbols are bucketed by
+ *           FNV-1a, so the layout is the same on every machine.
+ **************************************************************************************/
+class ShardCatalog {
+public:
+    // Catalog file of `database`.
+    static boost::filesystem::path pathFor(const boost::filesystem::path& database);
+
+    /**************************************************************************************
+     * Purpose : Loads the catalog of `database`. A missing catalog is not an error: the
+     *           database is simply not sharded (enabled() == false).
+     * Args    : database - Main database file.
+     * Return  : bool - false if the catalog exists but is malformed, or has more symbol
+     *           buckets than SQLite can attach at once (already logged). The
+     *           number of shards is not capped: reads attach them in passes
+     *           (ShardedView::passes()).
+     **************************************************************************************/
+    bool load(const boost::filesystem::path& database);
+
+    // Starts an empty catalog for `database` (not saved until save()).
+    void create(const boost::filesystem::path& database, ShardScheme scheme, int symbolBuckets);
+
+    // Writes the catalog atomically. Return: true on success.
+    bool save() const;
+
+    bool enabled() const noexcept { return scheme_ != ShardScheme::None; }
+    ShardScheme scheme() const noexcept { return scheme_; }
+    int symbolBuckets() const noexcept { return symbolBuckets_; }
+
+    // Shard of the candle of `pair` on `date`.
+    ShardKey keyOf(std::string_view pair, int date) const;
+
+    // Shard of `key`, added to the catalog (with its file name) if missing.
+    ShardInfo& shard(const ShardKey& key);
+
+    const std::vector<ShardInfo>& shards() const noexcept { return shards_; }
+
+    /**************************************************************************************
+     * Purpose : Shards that can hold bars of `symbol` over [from, to]: one bucket, and
+     *           only the years (and recorded date ranges) overlapping the range.
+     * Args    : symbol - Symbol.
+     *           from   - First date (YYYYMMDD, inclusive).
+     *           to     - Last date (YYYYMMDD, inclusive).
+     * Return  : std::vector<const ShardInfo*> - Shards in date order.
+     **************************************************************************************/
+    std::vector<const ShardInfo*> shardsFor(std::string_view symbol, int from, int to) const;
+
+    // Shards that can hold `symbols` over [from, to] (every symbol if empty), each once.
+    std::vector<const ShardInfo*> shardsOver(const std::vector<std::string>& symbols, int from, int to) const;
+
+    // Absolute path of a shard file.
+    boost::filesystem::path pathOf(const ShardInfo& shard) const;
+
+    // Sharded tables (every shard file has all of them).
+    const std::vector<std::string>& tables() const noexcept { return tables_; }
+
+    // Adds a sharded table. Return: true if it was not listed yet.
+    bool addTable(const std::string& table);
+
+private:
+    boost::filesystem::path  database_;
+    ShardScheme              scheme_        = ShardScheme::None;
+    int                      symbolBuckets_ = 8;
+    std::vector<std::string> tables_;
+    std::vector<ShardInfo>   shards_;      // Ordered by key
+};
+
+/**************************************************************************************
+ * Purpose : Makes a sharded database readable through one connection: ATTACHes the
+ *           shards a query can touch (the buckets of its symbols, the years and
+ *           recorded dates overlapping its range) and creates one TEMP view per sharded
+ *           table over them,
+ *               CREATE TEMP VIEW ohlcv_data AS
+ *                   SELECT * FROM shard_0.ohlcv_data UNION ALL SELECT * FROM shard_1...
+ *           TEMP objects shadow main ones, so existing queries (and MarketDataReader)
+ *           read the shards unchanged. SQLite merges the per-shard index scans of range
+ *           queries ordered by the key (MERGE (UNION ALL)).
+ *
+ *           SQLite caps attached databases (SQLITE_MAX_ATTACHED, 10 by default, 125 at
+ *           most). A range holding more shards than that is read in passes(): groups
+ *           of consecutive years, each within the cap, with shards out of the pass
+ *           detached. Rows are ordered within a pass. Databases without a catalog read
+ *           their main tables in a single pass and attach nothing.
+ *
+ *           Usage: refresh() once per read (or tick), then for each of passes(),
+ *           attach() and query. Finish the statements of a pass before the next one.
+ **************************************************************************************/
+class ShardedView {
+public:
+    /**************************************************************************************
+     * Purpose : Reloads the catalog if its file changed since the last call (a stat
+     *           otherwise), so shards added by the database service become visible.
+     * Args    : database - Main database file (locates the catalog).
+     * Return  : bool - false if the catalog is malformed (already logged).
+     **************************************************************************************/
+    bool refresh(const boost::filesystem::path& database);
+
+    /**************************************************************************************
+     * Purpose : Splits a read into date ranges whose shards can all be attached at once.
+     * Args    : symbols - Symbols read (empty = all).
+     *           from    - First date (YYYYMMDD, inclusive).
+     *           to      - Last date (YYYYMMDD, inclusive).
+     * Return  : std::vector<std::pair<int, int>> - [from, to] ranges in date order,
+     *           covering the read; a single one when not sharded.
+     **************************************************************************************/
+    std::vector<std::pair<int, int>> passes(const std::vector<std::string>& symbols,
+                                            int from = 0, int to = INT_MAX) const;
+
+    /**************************************************************************************
+     * Purpose : Attaches the shards that can hold `symbols` over [from, to], detaches
+     *           the others and recreates the views if the set changed. No-op on
+     *           databases without a catalog.
+     * Args    : db      - Connection on the main database (the one given to every call).
+     *           symbols - Symbols read (empty = all).
+     *           from    - First date (YYYYMMDD, inclusive).
+     *           to      - Last date (YYYYMMDD, inclusive).
+     * Return  : bool - false on error, or if the range holds more shards than can be
+     *           attached (already logged; read it in passes()).
+     **************************************************************************************/
+    bool attach(SqliteConnection& db, const std::vector<std::string>& symbols = {},
+                int from = 0, int to = INT_MAX);
+
+    bool sharded() const noexcept { return catalog_.enabled(); }
+
+    // Number of shards attached.
+    std::size_t attached() const noexcept;
+
+private:
+    ShardCatalog                    catalog_;
+    std::filesystem::file_time_type catalogTime_{};
+    std::vector<std::string>        slots_;        // shard_<index> → attached file ("" = free)
+    std::vector<std::string>        tables_;       // Views created
+};
@@ -0,0 +1,438 @@
+#include "sharded_candle_store.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <map>
+#include <thread>
+#include <tuple>
+
+std::string candleUpsertSql(const std::string& table)
+{
+    return "INSERT INTO " + table + " (pair, date, open, high, low, close, volume, "
+           "quote_volume, trades, taker_buy_volume, taker_buy_quote_volume) "
+           "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+           "ON CONFLICT(pair, date) DO UPDATE SET "
+           "open   = excluded.open, "
+           "high   = excluded.high, "
+           "low    = excluded.low, "
+           "close  = excluded.close, "
+           "volume = excluded.volume, "
+           "quote_volume           = excluded.quote_volume, "
+           "trades                 = excluded.trades, "
+           "taker_buy_volume       = excluded.taker_buy_volume, "
+           "taker_buy_quote_volume = excluded.taker_buy_quote_volume;";
+}
+
+bool writeCandles(SqliteConnection& db, const std::string& table, const OHLCVData& data)
+{
+    CachedStatement stmt = db.cached(candleUpsertSql(table));
+    if (!stmt)
+    {
+        LG_ERROR("SQLite prepare failed: {}", db.errmsg());
+        return false;
+    }
+
+    // Iterate over all pairs and their daily candles
+    for (const auto& [pair, dailyMap] : data.data)
+    {
+        for (const auto& [yyyymmdd, candle] : dailyMap)
+        {
+            // Bind parameters: pair, date, open, high, low, close, volume + extended fields
+            sqlite3_bind_text(stmt, 1, pair.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(stmt, 2, yyyymmdd);
+            sqlite3_bind_double(stmt, 3, candle.open);
+            sqlite3_bind_double(stmt, 4, candle.high);
+            sqlite3_bind_double(stmt, 5, candle.low);
+            sqlite3_bind_double(stmt, 6, candle.close);
+            sqlite3_bind_double(stmt, 7, candle.volume);
+            sqlite3_bind_double(stmt, 8, candle.quoteVolume);
+            sqlite3_bind_int64(stmt, 9, static_cast<sqlite3_int64>(candle.trades));
+            sqlite3_bind_double(stmt, 10, candle.takerBuyVolume);
+            sqlite3_bind_double(stmt, 11, candle.takerBuyQuoteVolume);
+
+            if (sqlite3_step(stmt) != SQLITE_DONE)
+            {
+                LG_ERROR("Insert failed: {}", db.errmsg());
+                return false;
+            }
+
+            // Reset statement for next row
+            sqlite3_reset(stmt);
+        }
+    }
+
+    return true;
+}
+
+/**************************************************************************************
+ * Purpose : Sets the store up for `database`:
+ *              - Loads the catalog, or starts an empty one when sharding is configured
+ *              - Copies the DDL of every sharded table (table and indexes) from the main
+ *                database
+ *              - Adds the configured tables to the catalog; new ones are created in the
+ *                existing shards before the catalog is saved
+ *
+ * Args    : main     - Connection on the main database.
+ *           database - Main database file.
+ *           settings - Configured sharding.
+ *           tables   - OHLCV tables to shard.
+ *
+ * Return  : bool - false on error.
+ **************************************************************************************/
+bool ShardedCandleStore::open(SqliteConnection& main, const boost::filesystem::path& database,
+                              const ShardingSettings& settings, const std::vector<std::string>& tables)
+{
+    close();
+    schema_.clear();
+    writerThreads_ = settings.writerThreads;
+
+    if (!catalog_.load(database))
+        return false;
+
+    if (!catalog_.enabled())
+    {
+        if (settings.scheme == ShardScheme::None)
+            return true;
+        catalog_.create(database, settings.scheme, settings.symbolBuckets);
+    }
+    else if (settings.scheme != catalog_.scheme() || settings.symbolBuckets != catalog_.symbolBuckets())
+    {
+        LG_WARN("Sharding of {} is {} with {} buckets; the configured layout ({}, {} buckets) is ignored",
+                database.string(), shardSchemeName(catalog_.scheme()), catalog_.symbolBuckets(),
+                shardSchemeName(settings.scheme), settings.symbolBuckets);
+    }
+
+    bool added = false;
+    for (const auto& table : tables)
+        added |= catalog_.addTable(table);
+
+    // main. explicitly: the TEMP views of a ShardedView shadow the tables
+    for (const auto& table : catalog_.tables())
+    {
+        CachedStatement stmt = main.cached(
+            "SELECT sql FROM main.sqlite_master WHERE tbl_name = ? AND sql IS NOT NULL ORDER BY type DESC;");
+        if (!stmt)
+        {
+            LG_ERROR("SQLite prepare failed: {}", main.errmsg());
+            return false;
+        }
+
+        sqlite3_bind_text(stmt, 1, table.c_str(), -1, SQLITE_TRANSIENT);
+        std::string ddl;
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+            ddl += std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0))) + ";";
+
+        if (ddl.empty())
+        {
+            LG_ERROR("Sharded table {} does not exist in {}", table, database.string());
+            return false;
+        }
+        schema_.emplace(table, std::move(ddl));
+    }
+
+    // Every shard holds every table: the views select from all of them
+    if (added)
+    {
+        for (const auto& shard : catalog_.shards())
+            if (!connect(shard))
+                return false;
+    }
+
+    if (added && !catalog_.save())
+    {
+        LG_ERROR("Cannot save the shard catalog of {}", database.string());
+        return false;
+    }
+
+    LG_INFO("Candles of {} sharded by {} ({} shards)", database.string(),
+            shardSchemeName(catalog_.scheme()), catalog_.shards().size());
+    return true;
+}
+
+void ShardedCandleStore::close()
+{
+    shards_.clear();
+}
+
+/**************************************************************************************
+ * Purpose : Writes candles to their shards:
+ *              - Splits the rows by shard key, registering new shards in the catalog
+ *              - Opens the connections (and tables) of the shards touched
+ *              - Writes the shards on up to writerThreads threads, one transaction each
+ *              - Extends the date range of the shards that committed and saves the
+ *                catalog if it changed, which publishes new shards to the readers
+ *
+ * Args    : table - Sharded OHLCV table.
+ *           data  - OHLCVData containing pair → date → OHLCV.
+ *
+ * Return  : bool - true if every shard committed.
+ **************************************************************************************/
+bool ShardedCandleStore::store(const std::string& table, const OHLCVData& data)
+{
+    if (!enabled() || !schema_.contains(table))
+    {
+        LG_ERROR("Table {} is not sharded", table);
+        return false;
+    }
+
+    std::map<ShardKey, OHLCVData> parts;
+    std::size_t rows = 0;
+    for (const auto& [pair, dailyMap] : data.data)
+    {
+        for (const auto& [yyyymmdd, candle] : dailyMap)
+            parts[catalog_.keyOf(pair, static_cast<int>(yyyymmdd))].data[pair][yyyymmdd] = candle;
+        rows += dailyMap.size();
+    }
+
+    // Register the new shards first: adding one moves the others
+    const std::size_t shardCount = catalog_.shards().size();
+    for (const auto& [key, part] : parts)
+        catalog_.shard(key);
+    bool changed = catalog_.shards().size() != shardCount;
+
+    struct Job {
+        ShardInfo*        shard;
+        SqliteConnection* db;
+        const OHLCVData*  data;
+        int               firstDate = 0;
+        int               lastDate  = 0;
+        bool              ok        = false;
+    };
+
+    std::vector<Job> jobs;
+    for (const auto& [key, part] : parts)
+    {
+        ShardInfo& shard = catalog_.shard(key);
+        SqliteConnection* db = connect(shard);
+        if (!db)
+            return false;
+
+        Job job{&shard, db, &part};
+        for (const auto& [pair, dailyMap] : part.data)
+        {
+            const int first = static_cast<int>(dailyMap.begin()->first);
+            const int last  = static_cast<int>(dailyMap.rbegin()->first);
+            job.firstDate = job.firstDate ? std::min(job.firstDate, first) : first;
+            job.lastDate  = std::max(job.lastDate, last);
+        }
+        jobs.push_back(job);
+    }
+
+    const unsigned hardware = std::max(std::thread::hardware_concurrency(), 1u);
+    const std::size_t threads = std::min<std::size_t>(jobs.size(), writerThreads_ > 0 ? writerThreads_ : hardware);
+
+    std::atomic<std::size_t> nextJob{0};
+    auto writer = [&]
+    {
+        for (std::size_t i = nextJob++; i < jobs.size(); i = nextJob++)
+        {
+            Job& job = jobs[i];
+
+            SqliteTransaction tx(*job.db);
+            if (!tx.active())
+            {
+                LG_ERROR("Begin transaction on shard {} failed: {}", job.shard->file, tx.error());
+                continue;
+            }
+            if (!writeCandles(*job.db, table, *job.data))
+                continue;
+            if (!tx.commit())
+            {
+                LG_ERROR("Commit on shard {} failed: {}", job.shard->file, tx.error());
+                continue;
+            }
+            job.ok = true;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (std::size_t t = 1; t < threads; ++t)
+        pool.emplace_back(writer);
+    writer();
+    for (auto& thread : pool)
+        thread.join();
+
+    bool ok = true;
+    for (const auto& job : jobs)
+    {
+        if (!job.ok)
+        {
+            ok = false;
+            continue;
+        }
+
+        ShardInfo& shard = *job.shard;
+        if (shard.firstDate == 0 || job.firstDate < shard.firstDate)
+        {
+            shard.firstDate = job.firstDate;
+            changed = true;
+        }
+        if (job.lastDate > shard.lastDate)
+        {
+            shard.lastDate = job.lastDate;
+            changed = true;
+        }
+    }
+
+    if (changed && !catalog_.save())
+    {
+        LG_ERROR("Cannot save the shard catalog");
+        return false;
+    }
+
+    LG_INFO("Stored {} candles of {} pairs into {} shards ({} writers)",
+            rows, data.data.size(), jobs.size(), threads);
+    return ok;
+}
+
+int ShardedCandleStore::latestDate(const std::string& table)
+{
+    int latest = 0;
+    for (const auto& shard : catalog_.shards())
+    {
+        SqliteConnection* db = connect(shard);
+        if (!db)
+            return 0;
+        latest = std::max(latest, MarketDataReader(*db, table).latestDate());
+    }
+    return latest;
+}
+
+int ShardedCandleStore::lastDate(const std::string& table, const std::string& pair)
+{
+    int last = 0;
+    for (const ShardInfo* shard : catalog_.shardsFor(pair, 0, INT_MAX))
+    {
+        SqliteConnection* db = connect(*shard);
+        if (!db)
+            return 0;
+
+        SymbolBar bar;
+        if (MarketDataReader(*db, table).latest(pair, bar))
+            last = std::max(last, bar.date);
+    }
+    return last;
+}
+
+/**************************************************************************************
+ * Purpose : Range read over the shards:
+ *              - Reads [from, to] of `symbols` from every shard that can hold them
+ *              - Merges the per-shard results by (symbol, date); a symbol split across
+ *                year shards comes back as one contiguous history
+ *
+ * Args    : table   - Sharded OHLCV table.
+ *           symbols - Symbols (empty = all).
+ *           from    - First date (YYYYMMDD, inclusive).
+ *           to      - Last date (YYYYMMDD, inclusive).
+ *
+ * Return  : BarColumns - Bars ordered by (symbol, date); empty on error.
+ **************************************************************************************/
+BarColumns ShardedCandleStore::bars(const std::string& table, const std::vector<std::string>& symbols, int from, int to)
+{
+    std::vector<BarColumns> parts;
+    for (const ShardInfo* shard : catalog_.shardsOver(symbols, from, to))
+    {
+        SqliteConnection* db = connect(*shard);
+        if (!db)
+            return {};
+        parts.push_back(MarketDataReader(*db, table).bars(symbols, from, to));
+    }
+
+    if (parts.size() == 1)
+        return std::move(parts.front());
+
+    struct Row {
+        const std::string* symbol;
+        int                date;
+        uint32_t           part;
+        uint32_t           row;
+    };
+
+    std::vector<Row> rows;
+    for (uint32_t p = 0; p < parts.size(); ++p)
+        for (uint32_t r = 0; r < parts[p].size(); ++r)
+            rows.push_back({&parts[p].symbolOf(r), parts[p].date[r], p, r});
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b)
+    {
+        return std::tie(*a.symbol, a.date) < std::tie(*b.symbol, b.date);
+    });
+
+    BarColumns out;
+    out.reserve(rows.size());
+    for (const Row& row : rows)
+    {
+        const BarColumns& in = parts[row.part];
+        if (out.symbols.empty() || out.symbols.back() != *row.symbol)
+            out.symbols.push_back(*row.symbol);
+
+        out.symbol.push_back(static_cast<uint32_t>(out.symbols.size() - 1));
+        out.date.push_back(row.date);
+        out.open.push_back(in.open[row.row]);
+        out.high.push_back(in.high[row.row]);
+        out.low.push_back(in.low[row.row]);
+        out.close.push_back(in.close[row.row]);
+        out.volume.push_back(in.volume[row.row]);
+        out.quoteVolume.push_back(in.quoteVolume[row.row]);
+        out.trades.push_back(in.trades[row.row]);
+        out.takerBuyVolume.push_back(in.takerBuyVolume[row.row]);
+        out.takerBuyQuoteVolume.push_back(in.takerBuyQuoteVolume[row.row]);
+    }
+    return out;
+}
+
+/**************************************************************************************
+ * Purpose : Connection of a shard, opened (and its tables created) on first use.
+ * Args    : shard - Shard.
+ * Return  : SqliteConnection* - nullptr on error.
+ **************************************************************************************/
+SqliteConnection* ShardedCandleStore::connect(const ShardInfo& shard)
+{
+    auto it = shards_.find(shard.file);
+    if (it != shards_.end())
+        return it->second.get();
+
+    auto db = std::make_unique<SqliteConnection>();
+    const boost::filesystem::path path = catalog_.pathOf(shard);
+    if (!db->open(path))
+    {
+        LG_ERROR("SQLite failed to open shard {}: {}", path.string(), db->errmsg());
+        return nullptr;
+    }
+    // Readers attach the shards: WAL so they do not block the shard commits
+    db->setBusyTimeout(5000);
+    if (!db->enableWal())
+        LG_WARN("WAL unavailable on shard {}, rollback journal kept", path.string());
+
+    if (!ensureTables(*db, shard))
+        return nullptr;
+
+    return shards_.emplace(shard.file, std::move(db)).first->second.get();
+}
+
+bool ShardedCandleStore::ensureTables(SqliteConnection& db, const ShardInfo& shard)
+{
+    for (const auto& [table, ddl] : schema_)
+    {
+        {
+            CachedStatement stmt = db.cached("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?;");
+            if (!stmt)
+            {
+                LG_ERROR("SQLite prepare failed: {}", db.errmsg());
+                return false;
+            }
+
+            sqlite3_bind_text(stmt, 1, table.c_str(), -1, SQLITE_TRANSIENT);
+            if (sqlite3_step(stmt) == SQLITE_ROW)
+                continue;
+        }
+
+        if (!db.exec(ddl))
+        {
+            LG_ERROR("Schema creation of {} in shard {} failed: {}", table, shard.file, db.errmsg());
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "data_types.h"
+#include "market_data_reader.h"
+#include "shard_catalog.h"
+#include "sqlite_connection.h"
+
+/**************************************************************************************
+ * Purpose : SQL of the candle upsert writeCandles() runs on `table` (the key of its
+ *           cached statement, so it can be compiled ahead of a store).
+ * Args    : table - OHLCV table.
+ * Return  : std::string - SQL text.
+ **************************************************************************************/
+std::string candleUpsertSql(const std::string& table);
+
+/**************************************************************************************
+ * Purpose : Upserts candles into an OHLCV table, one cached statement for every row;
+ *           re-stored (pair, date) rows are overwritten. Runs in the caller's
+ *           transaction.
+ * Args    : db    - SQLite connection (transaction already open).
+ *           table - OHLCV table.
+ *           data  - OHLCVData containing pair → date → OHLCV.
+ * Return  : bool - false on error (already logged).
+ **************************************************************************************/
+bool writeCandles(SqliteConnection& db, const std::string& table, const OHLCVData& data);
+
+/**************************************************************************************
+ * Purpose : Writer of a sharded database. Candles are routed to their shard
+ *           (ShardCatalog::keyOf) and the shards touched by one store() are written in
+ *           parallel, each on its own connection and in its own transaction.
+ *
+ *           Shard tables are created from the main database's schema (sqlite_master),
+ *           so they match the main tables column for column, indexes included.
+ *
+ *           A store is atomic per shard, not across shards: after a failure some shards
+ *           may hold the new rows. Candles are upserts, so storing the data again
+ *           repairs it.
+ *
+ *           The writer reads its own candles back through the same per-shard
+ *           connections (latestDate, lastDate, bars), never through a ShardedView, so
+ *           the number of shards is not bounded by SQLite's attach limit.
+ *
+ *           Not thread safe: callers serialise store() calls.
+ **************************************************************************************/
+class ShardedCandleStore {
+public:
+    /**************************************************************************************
+     * Purpose : Loads the catalog of `database`, or starts one if sharding is configured
+     *           and there is none yet. Once a catalog exists it decides the layout; a
+     *           configuration asking for another one is reported and ignored.
+     * Args    : main     - Connection on the main database (schema of the tables).
+     *           database - Main database file.
+     *           settings - Configured sharding.
+     *           tables   - OHLCV tables to shard.
+     * Return  : bool - false on error (already logged).
+     **************************************************************************************/
+    bool open(SqliteConnection& main, const boost::filesystem::path& database,
+              const ShardingSettings& settings, const std::vector<std::string>& tables);
+
+    // Closes every shard connection.
+    void close();
+
+    bool enabled() const noexcept { return catalog_.enabled(); }
+    const ShardCatalog& catalog() const noexcept { return catalog_; }
+
+    /**************************************************************************************
+     * Purpose : Writes candles to their shards.
+     * Args    : table - Sharded OHLCV table.
+     *           data  - OHLCVData containing pair → date → OHLCV.
+     * Return  : bool - true if every shard committed.
+     **************************************************************************************/
+    bool store(const std::string& table, const OHLCVData& data);
+
+    // Latest date of `table` across the shards (YYYYMMDD, 0 if empty or on error).
+    int latestDate(const std::string& table);
+
+    // Latest date of `pair` in `table` (YYYYMMDD, 0 if none or on error).
+    int lastDate(const std::string& table, const std::string& pair);
+
+    /**************************************************************************************
+     * Purpose : Every bar of `symbols` over [from, to], read from the shards that can
+     *           hold them and merged.
+     * Args    : table   - Sharded OHLCV table.
+     *           symbols - Symbols (empty = all).
+     *           from    - First date (YYYYMMDD, inclusive).
+     *           to      - Last date (YYYYMMDD, inclusive).
+     * Return  : BarColumns - Bars ordered by (symbol, date); empty on error.
+     **************************************************************************************/
+    BarColumns bars(const std::string& table, const std::vector<std::string>& symbols, int from, int to);
+
+private:
+    ShardCatalog catalog_;
+    int          writerThreads_ = 0;
+    std::unordered_map<std::string, std::string> schema_;              // Table → DDL
+    std::unordered_map<std::string, std::unique_ptr<SqliteConnection>> shards_;   // By file
+
+    SqliteConnection* connect(const ShardInfo& shard);
+    bool ensureTables(SqliteConnection& db, const ShardInfo& shard);
+};
@@ -0,0 +1,127 @@
+#include "sqlite_connection.h"
+
+#include <string_view>
+
+bool SqliteConnection::open(const boost::filesystem::path& path, int flags)
+{
+    close();
+
+    if ((flags & SQLITE_OPEN_CREATE) &&
+        !path.parent_path().empty() && !boost::filesystem::exists(path.parent_path()))
+        boost::filesystem::create_directories(path.parent_path());
+
+    sqlite3* db = nullptr;
+    if (sqlite3_open_v2(path.string().c_str(), &db, flags, nullptr) != SQLITE_OK)
+    {
+        lastError_ = db ? sqlite3_errmsg(db) : "out of memory";
+        sqlite3_close(db);
+        return false;
+    }
+
+    db_ = db;
+    return true;
+}
+
+void SqliteConnection::close()
+{
+    // Statements must be finalized before the connection can close
+    cache_.clear();
+
+    if (db_)
+        sqlite3_close(db_);
+    db_ = nullptr;
+}
+
+bool SqliteConnection::exec(const std::string& sql)
+{
+    if (!db_)
+        return false;
+    return sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK;
+}
+
+bool SqliteConnection::enableWal()
+{
+    SqliteStatement mode = prepare("PRAGMA journal_mode = WAL;");
+    if (!mode || sqlite3_step(mode) != SQLITE_ROW)
+        return false;
+
+    const unsigned char* text = sqlite3_column_text(mode, 0);
+    return text && std::string_view(reinterpret_cast<const char*>(text)) == "wal";
+}
+
+SqliteStatement SqliteConnection::prepare(const std::string& sql)
+{
+    sqlite3_stmt* stmt = nullptr;
+    if (!db_ || sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        sqlite3_finalize(stmt);
+        return SqliteStatement{};
+    }
+    return SqliteStatement(stmt);
+}
+
+/**************************************************************************************
+ * Purpose : Returns the cached statement for `sql`. Statements are compiled with
+ *           SQLITE_PREPARE_PERSISTENT, the hint for statements reused many times.
+ *           Failed compilations are not cached, so a later call retries.
+ * Args    : sql - SQL text.
+ * Return  : CachedStatement - Empty on failure.
+ **************************************************************************************/
+CachedStatement SqliteConnection::cached(const std::string& sql)
+{
+    if (!db_)
+        return CachedStatement{};
+
+    auto it = cache_.find(sql);
+    if (it == cache_.end())
+    {
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v3(db_, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK)
+        {
+            sqlite3_finalize(stmt);
+            return CachedStatement{};
+        }
+        it = cache_.emplace(sql, SqliteStatement(stmt)).first;
+    }
+    return CachedStatement(it->second.get());
+}
+
+SqliteTransaction::SqliteTransaction(SqliteConnection& db)
+    : db_(db)
+{
+    active_ = step("BEGIN IMMEDIATE;");
+}
+
+SqliteTransaction::~SqliteTransaction()
+{
+    if (active_)
+        step("ROLLBACK;");
+}
+
+bool SqliteTransaction::commit()
+{
+    if (!active_)
+        return false;
+
+    if (!step("COMMIT;"))
+    {
+        const std::string error = error_;
+        step("ROLLBACK;");
+        error_ = error;
+        active_ = false;
+        return false;
+    }
+
+    active_ = false;
+    return true;
+}
+
+bool SqliteTransaction::step(const char* sql)
+{
+    CachedStatement stmt = db_.cached(sql);
+    if (stmt && sqlite3_step(stmt) == SQLITE_DONE)
+        return true;
+
+    error_ = db_.errmsg();
+    return false;
+}
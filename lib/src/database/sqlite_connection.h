@@ -0,0 +1,190 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <boost/filesystem.hpp>
+#include <sqlite3.h>
+
+/**************************************************************************************
+ * Purpose : Owning handle of a prepared statement, finalized on destruction. Converts
+ *           to sqlite3_stmt* so the sqlite3_bind / step / column calls take it as is.
+ **************************************************************************************/
+class SqliteStatement {
+public:
+    SqliteStatement() = default;
+    explicit SqliteStatement(sqlite3_stmt* stmt) noexcept : stmt_(stmt) {}
+    ~SqliteStatement() { sqlite3_finalize(stmt_); }
+
+    SqliteStatement(SqliteStatement&& other) noexcept : stmt_(std::exchange(other.stmt_, nullptr)) {}
+    SqliteStatement& operator=(SqliteStatement&& other) noexcept
+    {
+        if (this != &other)
+        {
+            sqlite3_finalize(stmt_);
+            stmt_ = std::exchange(other.stmt_, nullptr);
+        }
+        return *this;
+    }
+
+    SqliteStatement(const SqliteStatement&) = delete;
+    SqliteStatement& operator=(const SqliteStatement&) = delete;
+
+    sqlite3_stmt* get() const noexcept { return stmt_; }
+    operator sqlite3_stmt*() const noexcept { return stmt_; }
+    explicit operator bool() const noexcept { return stmt_ != nullptr; }
+
+private:
+    sqlite3_stmt* stmt_ = nullptr;
+};
+
+/**************************************************************************************
+ * Purpose : Borrowed statement of a connection's cache. Releasing it resets the
+ *           statement and clears its bindings, so the next user starts clean and no
+ *           read transaction is left open by a partially stepped query.
+ **************************************************************************************/
+class CachedStatement {
+public:
+    CachedStatement() = default;
+    explicit CachedStatement(sqlite3_stmt* stmt) noexcept : stmt_(stmt) {}
+    ~CachedStatement() { release(); }
+
+    CachedStatement(CachedStatement&& other) noexcept : stmt_(std::exchange(other.stmt_, nullptr)) {}
+    CachedStatement& operator=(CachedStatement&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            stmt_ = std::exchange(other.stmt_, nullptr);
+        }
+        return *this;
+    }
+
+    CachedStatement(const CachedStatement&) = delete;
+    CachedStatement& operator=(const CachedStatement&) = delete;
+
+    sqlite3_stmt* get() const noexcept { return stmt_; }
+    operator sqlite3_stmt*() const noexcept { return stmt_; }
+    explicit operator bool() const noexcept { return stmt_ != nullptr; }
+
+private:
+    sqlite3_stmt* stmt_ = nullptr;
+
+    void release() noexcept
+    {
+        if (!stmt_)
+            return;
+        sqlite3_reset(stmt_);
+        sqlite3_clear_bindings(stmt_);
+        stmt_ = nullptr;
+    }
+};
+
+/**************************************************************************************
+ * Purpose : Long-lived SQLite connection with a prepared-statement cache keyed by the
+ *           SQL text: a query is compiled the first time it is used and only reset
+ *           afterwards. Cached statements live as long as the connection (they are
+ *           finalized before it closes).
+ *
+ *           Not thread safe: callers serialise every use of a connection (and keep a
+ *           CachedStatement within that critical section). A cached statement is
+ *           borrowed by one user at a time; do not hold two leases of the same SQL.
+ **************************************************************************************/
+class SqliteConnection {
+public:
+    SqliteConnection() = default;
+    ~SqliteConnection() { close(); }
+
+    SqliteConnection(const SqliteConnection&) = delete;
+    SqliteConnection& operator=(const SqliteConnection&) = delete;
+
+    /**************************************************************************************
+     * Purpose : Opens (or creates) the database file, creating its directory if needed.
+     *           Closes the current database first.
+     * Args    : path  - Database file.
+     *           flags - sqlite3_open_v2 flags (SQLITE_OPEN_READONLY for readers of a
+     *                   database another process writes).
+     * Return  : bool - true on success (errmsg() tells why otherwise).
+     **************************************************************************************/
+    bool open(const boost::filesystem::path& path, int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+
+    // How long a statement waits for another connection's lock before SQLITE_BUSY.
+    void setBusyTimeout(int ms) { if (db_) sqlite3_busy_timeout(db_, ms); }
+
+    /**************************************************************************************
+     * Purpose : Switches the database file to write-ahead logging, so readers on other
+     *           connections do not block a commit and are not blocked by one. The mode is
+     *           persistent (stored in the file); read-only connections follow it.
+     * Return  : bool - true if the file is in WAL mode (false e.g. on file systems
+     *           without shared memory, where the rollback journal is kept).
+     **************************************************************************************/
+    bool enableWal();
+
+    // Finalizes the cached statements and closes the database.
+    void close();
+
+    bool isOpen() const noexcept { return db_ != nullptr; }
+    sqlite3* handle() const noexcept { return db_; }
+
+    // Message of the last failed call on this connection.
+    const char* errmsg() const { return db_ ? sqlite3_errmsg(db_) : lastError_.c_str(); }
+
+    /**************************************************************************************
+     * Purpose : Runs one or more statements without results (schema scripts, pragmas).
+     * Args    : sql - SQL text.
+     * Return  : bool - true on success.
+     **************************************************************************************/
+    bool exec(const std::string& sql);
+
+    /**************************************************************************************
+     * Purpose : Compiles a statement owned by the caller (one-off queries such as
+     *           schema inspection, which are not worth keeping).
+     * Args    : sql - SQL text.
+     * Return  : SqliteStatement - Empty on failure.
+     **************************************************************************************/
+    SqliteStatement prepare(const std::string& sql);
+
+    /**************************************************************************************
+     * Purpose : Borrows the cached statement for `sql`, compiling it on first use.
+     * Args    : sql - SQL text (the cache key).
+     * Return  : CachedStatement - Empty on failure.
+     **************************************************************************************/
+    CachedStatement cached(const std::string& sql);
+
+    // Number of statements in the cache.
+    std::size_t cachedCount() const noexcept { return cache_.size(); }
+
+private:
+    sqlite3*    db_ = nullptr;
+    std::string lastError_;
+    std::unordered_map<std::string, SqliteStatement> cache_;
+};
+
+/**************************************************************************************
+ * Purpose : Write transaction scope (BEGIN IMMEDIATE). Rolled back on destruction
+ *           unless commit() succeeded, so every early return undoes the partial work.
+ **************************************************************************************/
+class SqliteTransaction {
+public:
+    explicit SqliteTransaction(SqliteConnection& db);
+    ~SqliteTransaction();
+
+    SqliteTransaction(const SqliteTransaction&) = delete;
+    SqliteTransaction& operator=(const SqliteTransaction&) = delete;
+
+    // Whether BEGIN succeeded and the transaction is still open.
+    bool active() const noexcept { return active_; }
+
+    // Commits; on failure the transaction is rolled back. Return: true on success.
+    bool commit();
+
+    // Message of the failed BEGIN or COMMIT.
+    const std::string& error() const noexcept { return error_; }
+
+private:
+    SqliteConnection& db_;
+    bool              active_ = false;
+    std::string       error_;
+
+    bool step(const char* sql);
+};
@@ -0,0 +1,259 @@
+#include "tick_store.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+/***********************************************
+ * Powers of ten exactly representable in a
+ * double (scales up to 1e15).
+ ***********************************************/
+static constexpr int TICK_MAX_DECIMALS = 15;
+
+static constexpr double POW10[TICK_MAX_DECIMALS + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+};
+
+// Largest scaled magnitude: integral in a double, and deltas of two fit an int64
+static constexpr double TICK_MAX_SCALED = 9e15;
+
+/**************************************************************************************
+ * Purpose : Smallest number of decimals d such that value·10^d is an integer (up to
+ *           float noise), so value == round(value·10^d) / 10^d exactly.
+ * Args    : value - Price or quantity.
+ * Return  : int - Decimals (capped at TICK_MAX_DECIMALS).
+ **************************************************************************************/
+static int decimalsOf(double value)
+{
+    for (int d = 0; d < TICK_MAX_DECIMALS; ++d)
+    {
+        const double scaled = value * POW10[d];
+        if (std::abs(scaled) >= TICK_MAX_SCALED)
+            return std::max(d - 1, 0);
+        if (std::round(scaled) / POW10[d] == value)
+            return d;
+    }
+    return TICK_MAX_DECIMALS;
+}
+
+/**************************************************************************************
+ * Purpose : Lowers a column's decimals until its largest value still scales below
+ *           TICK_MAX_SCALED. The column scale comes from its most precise value, so a
+ *           block mixing large and very precise values would otherwise overflow int64;
+ *           the precise values are then rounded to the decimals that fit.
+ * Args    : decimals - Decimals of the most precise value of the column.
+ *           maxAbs   - Largest absolute value of the column.
+ * Return  : int - Decimals to encode the column with.
+ **************************************************************************************/
+static int fitDecimals(int decimals, double maxAbs)
+{
+    while (decimals > 0 && maxAbs * POW10[decimals] >= TICK_MAX_SCALED)
+        --decimals;
+    return decimals;
+}
+
+static void putVarint(std::string& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+static uint64_t zigzagEncode(long long v)
+{
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+/**************************************************************************************
+ * Purpose : Encodes one block: picks the price and quantity scales (per column, the
+ *           most precise value's, lowered if the largest value would overflow), then
+ *           writes each trade as varint deltas against the previous one, and the
+ *           checksum.
+ * Args    : trades - Trades sorted by id.
+ * Return  : std::string - Block bytes.
+ **************************************************************************************/
+std::string encodeTickBlock(const std::vector<AggTrade>& trades)
+{
+    int priceDecimals = 0, qtyDecimals = 0;
+    double maxPrice = 0.0, maxQty = 0.0;
+    for (const auto& t : trades)
+    {
+        priceDecimals = std::max(priceDecimals, decimalsOf(t.price));
+        qtyDecimals   = std::max(qtyDecimals, decimalsOf(t.qty));
+        maxPrice      = std::max(maxPrice, std::abs(t.price));
+        maxQty        = std::max(maxQty, std::abs(t.qty));
+    }
+    priceDecimals = fitDecimals(priceDecimals, maxPrice);
+    qtyDecimals   = fitDecimals(qtyDecimals, maxQty);
+
+    std::string out;
+    out.reserve(TICK_BLOCK_HEADER + 10 + trades.size() * 8 + TICK_BLOCK_TRAILER);
+
+    out.append(TICK_BLOCK_MAGIC, sizeof(TICK_BLOCK_MAGIC));
+    out += static_cast<char>(priceDecimals);
+    out += static_cast<char>(qtyDecimals);
+    out.append(2, '\0');
+    putVarint(out, trades.size());
+
+    const double priceScale = POW10[priceDecimals];
+    const double qtyScale   = POW10[qtyDecimals];
+
+    long long prevId = 0, prevTime = 0, prevPrice = 0;
+    for (const auto& t : trades)
+    {
+        const long long price = std::llround(t.price * priceScale);
+
+        putVarint(out, (static_cast<uint64_t>(t.id - prevId) << 1) | (t.buyerMaker ? 1u : 0u));
+        putVarint(out, zigzagEncode(t.timeMs - prevTime));
+        putVarint(out, zigzagEncode(price - prevPrice));
+        putVarint(out, static_cast<uint64_t>(std::llround(t.qty * qtyScale)));
+
+        prevId    = t.id;
+        prevTime  = t.timeMs;
+        prevPrice = price;
+    }
+
+    const uint64_t checksum = fnv1a64(out);
+    for (int i = 0; i < 8; ++i)
+        out += static_cast<char>((checksum >> (8 * i)) & 0xFF);
+
+    return out;
+}
+
+/**************************************************************************************
+ * Purpose : Checks the magic and checksum of a block and reads its header.
+ * Args    : block - Block bytes.
+ **************************************************************************************/
+TickBlockCursor::TickBlockCursor(std::string_view block)
+{
+    if (block.size() < TICK_BLOCK_HEADER + 1 + TICK_BLOCK_TRAILER ||
+        block.compare(0, sizeof(TICK_BLOCK_MAGIC), std::string_view(TICK_BLOCK_MAGIC, sizeof(TICK_BLOCK_MAGIC))) != 0)
+        return;
+
+    const std::size_t bodyEnd = block.size() - TICK_BLOCK_TRAILER;
+
+    uint64_t stored = 0;
+    for (int i = 0; i < 8; ++i)
+        stored |= static_cast<uint64_t>(static_cast<uint8_t>(block[bodyEnd + i])) << (8 * i);
+    if (stored != fnv1a64(block.substr(0, bodyEnd)))
+        return;
+
+    const int priceDecimals = static_cast<uint8_t>(block[4]);
+    const int qtyDecimals   = static_cast<uint8_t>(block[5]);
+    if (priceDecimals > TICK_MAX_DECIMALS || qtyDecimals > TICK_MAX_DECIMALS)
+        return;
+
+    priceScale_ = POW10[priceDecimals];
+    qtyScale_   = POW10[qtyDecimals];
+
+    p_   = reinterpret_cast<const uint8_t*>(block.data()) + TICK_BLOCK_HEADER;
+    end_ = reinterpret_cast<const uint8_t*>(block.data()) + bodyEnd;
+
+    count_     = static_cast<std::size_t>(varint());
+    remaining_ = count_;
+    valid_     = true;
+}
+
+boost::filesystem::path TickStore::blockPath(const std::string& symbol, unsigned int yyyymmdd) const
+{
+    return root_ / symbol / (std::to_string(yyyymmdd) + ".ticks");
+}
+
+bool TickStore::has(const std::string& symbol, unsigned int yyyymmdd) const
+{
+    return boost::filesystem::exists(blockPath(symbol, yyyymmdd));
+}
+
+/**************************************************************************************
+ * Purpose : Encodes and atomically writes the block of one symbol and day.
+ * Args    : symbol   - Symbol.
+ *           yyyymmdd - UTC day of the trades.
+ *           trades   - Trades of that day, sorted by id.
+ * Return  : std::size_t - Block size in bytes (0 on failure).
+ **************************************************************************************/
+std::size_t TickStore::write(const std::string& symbol, unsigned int yyyymmdd,
+                             const std::vector<AggTrade>& trades) const
+{
+    const std::string block = encodeTickBlock(trades);
+    if (!writeFileAtomic(blockPath(symbol, yyyymmdd), block))
+        return 0;
+    return block.size();
+}
+
+/**************************************************************************************
+ * Purpose : Lists the days stored for `symbol` (file names <YYYYMMDD>.ticks).
+ * Args    : symbol - Symbol.
+ * Return  : std::vector<unsigned int> - Days, ascending.
+ **************************************************************************************/
+std::vector<unsigned int> TickStore::days(const std::string& symbol) const
+{
+    namespace fs = boost::filesystem;
+
+    std::vector<unsigned int> result;
+    const fs::path dir = root_ / symbol;
+    if (!fs::is_directory(dir))
+        return result;
+
+    for (const auto& entry : fs::directory_iterator(dir))
+    {
+        if (entry.path().extension() != ".ticks")
+            continue;
+        const std::string stem = entry.path().stem().string();
+        char* end = nullptr;
+        const unsigned long day = std::strtoul(stem.c_str(), &end, 10);
+        if (end && *end == '\0' && day > 0)
+            result.push_back(static_cast<unsigned int>(day));
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void TickStore::reportCorrupt(const std::string& symbol, unsigned int yyyymmdd) const
+{
+    LG_ERROR("Corrupt tick block {}", blockPath(symbol, yyyymmdd).string());
+}
+
+/**************************************************************************************
+ * Purpose : Rebuilds candles of `interval` in one streaming pass over the ticks.
+ * Args    : symbol   - Symbol.
+ *           fromYmd  - First day (YYYYMMDD).
+ *           toYmd    - Last day (YYYYMMDD).
+ *           interval - Candle length.
+ * Return  : std::vector<TickCandle> - Candles in time order.
+ **************************************************************************************/
+std::vector<TickCandle> TickStore::candles(const std::string& symbol, unsigned int fromYmd, unsigned int toYmd,
+                                           std::chrono::milliseconds interval) const
+{
+    std::vector<TickCandle> result;
+    const long long step = std::max<long long>(interval.count(), 1);
+
+    TickCandle* current = nullptr;
+    forEachTrade(symbol, fromYmd, toYmd, [&](const AggTrade& t) {
+        const long long bucket = t.timeMs - ((t.timeMs % step) + step) % step;
+        if (!current || current->openTimeMs != bucket)
+        {
+            result.push_back(TickCandle{bucket, OHLCV{t.price, t.price, t.price, t.price, 0.0}});
+            current = &result.back();
+        }
+
+        OHLCV& bar = current->bar;
+        bar.high   = std::max(bar.high, t.price);
+        bar.low    = std::min(bar.low, t.price);
+        bar.close  = t.price;
+        bar.volume      += t.qty;
+        bar.quoteVolume += t.qty * t.price;
+        bar.trades      += 1.0;
+        if (!t.buyerMaker)
+        {
+            bar.takerBuyVolume      += t.qty;
+            bar.takerBuyQuoteVolume += t.qty * t.price;
+        }
+    });
+
+    return result;
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "binary_io.h"
+#include "data_types.h"
+
+/**************************************************************************************
+ * Compressed tick store: aggregated trades, one block file per symbol and UTC day
+ * (<root>/<SYMBOL>/<YYYYMMDD>.ticks).
+ *
+ * Prices and quantities are stored as integers scaled by the smallest power of ten
+ * that represents every value of the block exactly (decimal exchange prices round
+ * trip bit for bit), chosen per column. A column whose largest value would not fit
+ * an int64 at that scale gets fewer decimals, and its finest values are rounded.
+ * Each trade is then encoded against the previous one, as LEB128
+ * varints:
+ *   (id delta << 1 | buyerMaker)   zigzag(time delta)   zigzag(price delta)   qty
+ * Consecutive aggregate ids, millisecond-close timestamps and tick-sized price moves
+ * make most trades 5-8 bytes instead of the 33 of the raw struct.
+ *
+ * Block layout:
+ *   "TIK1"  u8 priceDecimals  u8 qtyDecimals  u16 reserved   varint count
+ *   trades...
+ *   u64 FNV-1a of everything before (little endian)
+ **************************************************************************************/
+
+static constexpr char          TICK_BLOCK_MAGIC[4] = {'T', 'I', 'K', '1'};
+static constexpr std::size_t   TICK_BLOCK_HEADER   = 8;
+static constexpr std::size_t   TICK_BLOCK_TRAILER  = 8;
+
+/**************************************************************************************
+ * Purpose : Encodes the trades of one block.
+ * Args    : trades - Trades sorted by id.
+ * Return  : std::string - Block bytes.
+ **************************************************************************************/
+std::string encodeTickBlock(const std::vector<AggTrade>& trades);
+
+/**************************************************************************************
+ * Purpose : Sequential decoder over a block held in memory (usually a MappedFile).
+ *           next() is inline: decoding is a few shifts and adds per field, so readers
+ *           are bound by memory bandwidth rather than by calls.
+ **************************************************************************************/
+class TickBlockCursor {
+public:
+    /**************************************************************************************
+     * Purpose : Validates the header and checksum of `block`.
+     * Args    : block - Block bytes; must outlive the cursor.
+     **************************************************************************************/
+    explicit TickBlockCursor(std::string_view block);
+
+    // Whether the block was well formed.
+    bool valid() const noexcept { return valid_; }
+
+    // Number of trades in the block.
+    std::size_t size() const noexcept { return count_; }
+
+    // Decodes the next trade into `t`; false at the end of the block.
+    bool next(AggTrade& t)
+    {
+        if (remaining_ == 0)
+            return false;
+        --remaining_;
+
+        const uint64_t idField = varint();
+        id_    += static_cast<long long>(idField >> 1);
+        time_  += zigzag(varint());
+        price_ += zigzag(varint());
+
+        t.id         = id_;
+        t.timeMs     = time_;
+        t.price      = static_cast<double>(price_) / priceScale_;
+        t.qty        = static_cast<double>(varint()) / qtyScale_;
+        t.buyerMaker = (idField & 1) != 0;
+        return true;
+    }
+
+private:
+    const uint8_t* p_   = nullptr;
+    const uint8_t* end_ = nullptr;
+    bool           valid_ = false;
+    std::size_t    count_ = 0;
+    std::size_t    remaining_ = 0;
+    double         priceScale_ = 1.0;
+    double         qtyScale_   = 1.0;
+    long long      id_ = 0, time_ = 0, price_ = 0;
+
+    uint64_t varint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; p_ < end_; shift += 7)
+        {
+            const uint8_t byte = *p_++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                break;
+        }
+        return value;
+    }
+
+    static long long zigzag(uint64_t v) { return static_cast<long long>(v >> 1) ^ -static_cast<long long>(v & 1); }
+};
+
+/***********************************************
+ * Candle rebuilt from ticks.
+ ***********************************************/
+struct TickCandle {
+    long long openTimeMs;       // Bucket start (Unix ms, multiple of the interval)
+    OHLCV     bar;
+};
+
+/**************************************************************************************
+ * Purpose : Directory of tick blocks. Writes are atomic per block (writeFileAtomic), so
+ *           a block is either complete or absent; each (symbol, day) is independent,
+ *           which lets importers write blocks from many threads.
+ **************************************************************************************/
+class TickStore {
+public:
+    explicit TickStore(boost::filesystem::path root) : root_(std::move(root)) {}
+
+    const boost::filesystem::path& root() const noexcept { return root_; }
+
+    // File of the block of `symbol` on `yyyymmdd`.
+    boost::filesystem::path blockPath(const std::string& symbol, unsigned int yyyymmdd) const;
+
+    // Whether the block of `symbol` on `yyyymmdd` exists.
+    bool has(const std::string& symbol, unsigned int yyyymmdd) const;
+
+    /**************************************************************************************
+     * Purpose : Writes (replaces) the block of one symbol and day.
+     * Args    : symbol   - Symbol.
+     *           yyyymmdd - UTC day of the trades.
+     *           trades   - Trades of that day, sorted by id.
+     * Return  : std::size_t - Block size in bytes (0 on failure).
+     **************************************************************************************/
+    std::size_t write(const std::string& symbol, unsigned int yyyymmdd, const std::vector<AggTrade>& trades) const;
+
+    // Days stored for `symbol`, ascending.
+    std::vector<unsigned int> days(const std::string& symbol) const;
+
+    /**************************************************************************************
+     * Purpose : Streams the trades of `symbol` over [fromYmd, toYmd] in time order, one
+     *           memory-mapped block at a time. Missing days are skipped; corrupt blocks
+     *           are logged and skipped.
+     * Args    : symbol  - Symbol.
+     *           fromYmd - First day (YYYYMMDD).
+     *           toYmd   - Last day (YYYYMMDD).
+     *           fn      - Called as fn(const AggTrade&) for every trade.
+     * Return  : std::size_t - Trades visited.
+     **************************************************************************************/
+    template<typename Fn>
+    std::size_t forEachTrade(const std::string& symbol, unsigned int fromYmd, unsigned int toYmd, Fn&& fn) const
+    {
+        std::size_t visited = 0;
+        for (unsigned int day : days(symbol))
+        {
+            if (day < fromYmd || day > toYmd)
+                continue;
+
+            MappedFile block;
+            if (!block.open(blockPath(symbol, day)))
+                continue;
+
+            TickBlockCursor cursor(block.data());
+            if (!cursor.valid())
+            {
+                reportCorrupt(symbol, day);
+                continue;
+            }
+
+            AggTrade t;
+            while (cursor.next(t))
+                fn(t);
+            visited += cursor.size();
+        }
+        return visited;
+    }
+
+    /**************************************************************************************
+     * Purpose : Rebuilds candles of any interval from the ticks of `symbol` over
+     *           [fromYmd, toYmd]. Buckets are aligned on the Unix epoch; buckets without
+     *           trades are not emitted. Taker buy volumes come from trades whose buyer
+     *           was the taker (!buyerMaker); trades counts aggregated trades.
+     * Args    : symbol   - Symbol.
+     *           fromYmd  - First day (YYYYMMDD).
+     *           toYmd    - Last day (YYYYMMDD).
+     *           interval - Candle length (e.g. 1 min, 1 h, 1 day).
+     * Return  : std::vector<TickCandle> - Candles in time order.
+     **************************************************************************************/
+    std::vector<TickCandle> candles(const std::string& symbol, unsigned int fromYmd, unsigned int toYmd,
+                                    std::chrono::milliseconds interval) const;
+
+private:
+    boost::filesystem::path root_;
+
+    void reportCorrupt(const std::string& symbol, unsigned int yyyymmdd) const;
+};
@@ -0,0 +1,92 @@
+#include "funding_schedule.h"
+#include "logger.h"
+#include "market_data_reader.h"
+#include "time_utils.h"
+
+#include <algorithm>
+#include <atomic>
+
+
+/**************************************************************************************
+ * Purpose : Aligns raw funding events onto one row per calendar day in [start, end].
+ *           Each event is added to the row of the UTC day its fundingTime falls in.
+ * Args    : rates - Funding events (pair → fundingTime ms → rate).
+ *           start - First date (YYYYMMDD, inclusive).
+ *           end   - Last date (YYYYMMDD, inclusive).
+ * Return  : FundingSchedule - Dense day × coin schedule.
+ **************************************************************************************/
+FundingSchedule FundingSchedule::build(const FundingRateData& rates, Timestamp start, Timestamp end)
+{
+    static std::atomic<uint64_t> nextId{1};
+
+    FundingSchedule s;
+    s.id_ = nextId++;
+
+    for (Timestamp d = start; d <= end; d = static_cast<Timestamp>(nextDay(d)))
+        s.dates_.push_back(d);
+
+    for (const auto& [pair, _] : rates.data)
+        s.coins_.emplace(pair, static_cast<int32_t>(s.coins_.size()));
+
+    s.rates_.assign(s.nDays() * s.nCoins(), 0.0);
+    if (s.dates_.empty())
+        return s;
+
+    // Day boundaries in ms: event at t belongs to day i if bounds[i] <= t < bounds[i + 1]
+    std::vector<long long> bounds;
+    bounds.reserve(s.nDays() + 1);
+    for (Timestamp d : s.dates_)
+        bounds.push_back(toUnixMillis(d));
+    bounds.push_back(toUnixMillis(static_cast<int>(nextDay(s.dates_.back()))));
+
+    std::size_t nEvents = 0;
+    for (const auto& [pair, events] : rates.data)
+    {
+        const std::size_t coin = static_cast<std::size_t>(s.coins_.at(pair));
+
+        for (auto it = events.lower_bound(bounds.front()); it != events.end() && it->first < bounds.back(); ++it)
+        {
+            const std::size_t day = static_cast<std::size_t>(
+                std::upper_bound(bounds.begin(), bounds.end(), it->first) - bounds.begin() - 1);
+
+            s.rates_[day * s.nCoins() + coin] += it->second;
+            ++nEvents;
+        }
+    }
+
+    LG_INFO("Funding schedule built: {} days x {} pairs ({} events)", s.nDays(), s.nCoins(), nEvents);
+    return s;
+}
+
+
+FundingSchedule FundingSchedule::load(SqliteConnection& db, Timestamp start, Timestamp end, const std::string& table)
+{
+    return build(FundingRateReader(db, table).rates({}, start, end), start, end);
+}
+
+
+/**************************************************************************************
+ * Purpose : Row of daily funding rates for a bar.
+ * Args    : ts - Bar date (YYYYMMDD).
+ * Return  : const double* - nCoins() rates, nullptr if ts is outside the schedule.
+ **************************************************************************************/
+const double* FundingSchedule::row(Timestamp ts) const noexcept
+{
+    auto it = std::lower_bound(dates_.begin(), dates_.end(), ts);
+    if (it == dates_.end() || *it != ts)
+        return nullptr;
+
+    return rates_.data() + static_cast<std::size_t>(it - dates_.begin()) * nCoins();
+}
+
+
+/**************************************************************************************
+ * Purpose : Column of a coin in the schedule rows.
+ * Args    : coin - Pair symbol.
+ * Return  : int32_t - Column index, -1 if the coin has no funding rates.
+ **************************************************************************************/
+int32_t FundingSchedule::coinIndex(const Coin& coin) const noexcept
+{
+    auto it = coins_.find(coin);
+    return it == coins_.end() ? -1 : it->second;
+}
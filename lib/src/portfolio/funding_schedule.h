@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "data_types.h"
+#include "sqlite_connection.h"
+
+
+/**************************************************************************************
+ * Purpose : Funding rates of perpetual futures pre-aligned to the daily bar axis, so the
+ *           portfolio accrues funding with array lookups instead of map searches.
+ *
+ *           rates are day-major: rate(day, coin) = rates_[day * nCoins() + coin] and hold
+ *           the sum of the funding events settled during that UTC day (3 for 8h
+ *           contracts, more for pairs on shorter intervals). Missing rates are 0.
+ *
+ *           Positive rate: longs pay shorts.
+ **************************************************************************************/
+class FundingSchedule {
+public:
+    FundingSchedule() = default;
+
+    /**************************************************************************************
+     * Purpose : Aligns raw funding events onto one row per calendar day in [start, end].
+     * Args    : rates - Funding events (pair → fundingTime ms → rate).
+     *           start - First date (YYYYMMDD, inclusive).
+     *           end   - Last date (YYYYMMDD, inclusive).
+     * Return  : FundingSchedule - Dense day × coin schedule.
+     **************************************************************************************/
+    static FundingSchedule build(const FundingRateData& rates, Timestamp start, Timestamp end);
+
+    /**************************************************************************************
+     * Purpose : Builds the schedule of [start, end] from the events stored in a funding
+     *           table (FundingRateReader).
+     * Args    : db    - SQLite connection on the market database.
+     *           start - First date (YYYYMMDD, inclusive).
+     *           end   - Last date (YYYYMMDD, inclusive).
+     *           table - Funding table (funding_rates or funding_rates_<exchange>).
+     * Return  : FundingSchedule - Dense day × coin schedule (no coins on error).
+     **************************************************************************************/
+    static FundingSchedule load(SqliteConnection& db, Timestamp start, Timestamp end,
+                                const std::string& table = "funding_rates");
+
+    // Row of daily rates for `ts`, indexed by coinIndex(); nullptr if ts is off the axis.
+    const double* row(Timestamp ts) const noexcept;
+
+    // Column of `coin` in every row, -1 if the schedule has no rates for it.
+    int32_t coinIndex(const Coin& coin) const noexcept;
+
+    // Unique per build: columns cached against one schedule are stale under another.
+    uint64_t id() const noexcept { return id_; }
+
+    std::size_t nDays()  const noexcept { return dates_.size(); }
+    std::size_t nCoins() const noexcept { return coins_.size(); }
+
+private:
+    uint64_t id_ = 0;
+    std::vector<Timestamp> dates_;                  // Row axis (ascending, contiguous days)
+    std::unordered_map<Coin, int32_t> coins_;       // Column axis
+    std::vector<double> rates_;                     // Day-major daily funding rates
+};
@@ -1,21 +1,48 @@
 #include "portfolio.h"
 
 
-int directionToMultiplier(Direction& dir){
-    if(dir == 0){
+static int directionToMultiplier(Direction dir){
+    if(dir == Direction::Long){
         return 1;
     }
-    if(dir == 1){
+    if(dir == Direction::Short){
         return -1;
     }
     
-    return 0
+    return 0;
 }
 
-void Portfolio::updatePortfolio(std::vector<Trade>& current_trades){
+void Portfolio::updatePortfolio(std::vector<Trade>& current_trades, Timestamp ts){
     double floatingPNL = 0;
     double balance = this->current_balance_;
 
+    // Funding of every real position held during this bar (including the ones just
+    // closed), settled into the balance. Rates come pre-aligned per day and each trade
+    // keeps its column, looked up once on its first bar (again if the schedule is
+    // rebuilt), so a bar costs one indexed multiply-add per open trade.
+    if (funding_) {
+        if (funding_->id() != fundingId_) {
+            for (Trade& trade : current_trades) {
+                trade.fundingCoin_ = FUNDING_COIN_UNRESOLVED;
+            }
+            fundingId_ = funding_->id();
+        }
+        if (const double* rates = funding_->row(ts)) {
+            double funding = 0.0;
+            for (Trade& trade : current_trades) {
+                if (trade.fundingCoin_ == FUNDING_COIN_UNRESOLVED) {
+                    trade.fundingCoin_ = funding_->coinIndex(trade.coin_);
+                }
+                if (trade.isSimulated_ || trade.fundingCoin_ < 0) {
+                    continue;
+                }
+                funding += trade.size_*trade.current_price_*directionToMultiplier(trade.direction_)*rates[trade.fundingCoin_];
+            }
+            balance -= funding;
+            this->funding_paid_ += funding;
+        }
+    }
+
     for (auto it = current_trades.begin(); it != current_trades.end(); ) {
         Trade& trade = *it;
 
@@ -40,3 +67,24 @@ void Portfolio::updatePortfolio(std::vector<Trade>& current_trades){
     this->current_equity_ = balance + floatingPNL;
     this->balance_equity_historic_.emplace_back(std::make_pair(current_balance_,current_equity_));
 }
+
+void Portfolio::saveState(BinaryWriter& out) const{
+    // Resume state only: the checkpoint is rewritten every bar, so it must not grow
+    // with history. Closed trades are kept as entry/exit rows by the signals table.
+    out.write(start_);
+    out.write(current_equity_);
+    out.write(current_balance_);
+    out.write(nSimulated_);
+    out.write(funding_paid_);
+}
+
+void Portfolio::loadState(BinaryReader& in){
+    start_           = in.read<Timestamp>();
+    current_equity_  = in.read<double>();
+    current_balance_ = in.read<double>();
+    nSimulated_      = in.read<unsigned int>();
+    funding_paid_    = in.read<double>();
+
+    balance_equity_historic_.clear();
+    trades_history_.clear();
+}
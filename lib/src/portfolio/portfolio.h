@@ -1,4 +1,9 @@
+#pragma once
+
+#include <map>
+#include <vector>
 #include "data_types.h"
+#include "funding_schedule.h"
 
 
 class Portfolio{
@@ -6,16 +11,30 @@ public:
 
     Portfolio(Timestamp start) : start_(start){};
 
-    double GetCurrentEquity(){
+    double GetCurrentEquity() const{
         return current_equity_;
     }
-    double GetCurrentBalance(){
+    double GetCurrentBalance() const{
         return current_balance_;
     }
-    unsigned int GetNSimulated(){
+    unsigned int GetNSimulated() const{
         return nSimulated_;
     }
-    void updatePortfolio(std::vector<Trade>& current_trades);
+    double GetFundingPaid() const{
+        return funding_paid_;
+    }
+
+    // Funding accrued on open positions each bar (nullptr = no funding). Must outlive the portfolio's use.
+    void setFundingSchedule(const FundingSchedule* schedule){
+        funding_ = schedule;
+    }
+
+    void updatePortfolio(std::vector<Trade>& current_trades, Timestamp ts);
+
+    // Binary (de)serialization of the state needed to resume (balance, equity, counters),
+    // used by state checkpoints. The balance/equity and closed trade histories are not saved.
+    void saveState(BinaryWriter& out) const;
+    void loadState(BinaryReader& in);
 
 private:
     Timestamp start_ = 0;
@@ -25,4 +44,7 @@ private:
     std::vector<std::pair<double,double>> balance_equity_historic_;
     std::map<TradeID,Trade> trades_history_; // closed real trades (non-simulated)
     unsigned int nSimulated_ = 0; // number of trades signaled and not taken
+    double funding_paid_ = 0.0; // net funding paid (negative = received)
+    const FundingSchedule* funding_ = nullptr;
+    uint64_t fundingId_ = 0; // schedule the trades' fundingCoin_ were resolved against
 };
@@ -1,14 +1,17 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
+#include <functional>
 #include "data_types.h"  
-#include "portafolio.h"
+#include "portfolio.h"
 
-enum class Ranking{Volume, Return, None};
+enum class Ranking{Volume, Return, None, QuoteVolume};
+inline constexpr std::size_t RANKING_COUNT = 4;
 using RankedBars = std::vector<std::reference_wrapper<const std::pair<const Coin, BarData>>>;
 
 
-TradeID last_trade_id_ = 0;
+inline TradeID last_trade_id_ = 0;
 
 
 class Strategy {
@@ -21,14 +24,26 @@ public:
      *   - current_trades : Reference to currently open trades (can be modified)
      *   - bars           : Market data for all coins at this timestamp
      *   - ts             : Current timestamp
+     * Default : Emits no signals.
      **********************************************************************************/
     virtual void calculateSignals(
-        std::vector<Trade>& current_trades,
-        const CoinBarMap& bars,
-        Timestamp ts
-    );
+        [[maybe_unused]] std::vector<Trade>& current_trades,
+        [[maybe_unused]] const CoinBarMap& bars,
+        [[maybe_unused]] Timestamp ts
+    ) {}
 
-    inline RankedBars rank(const CoinBarMap& bars, Ranking ranking) {
+    /**********************************************************************************
+     * Purpose : Save / restore strategy-internal state (anything not stored in the
+     *           trades themselves) for state checkpoints.
+     * Default : Stateless strategy, nothing to save.
+     **********************************************************************************/
+    virtual void saveState([[maybe_unused]] BinaryWriter& out) const {}
+    virtual void loadState([[maybe_unused]] BinaryReader& in) {}
+
+    // Ranking this strategy selects its universe with (shared across strategies by MultiBacktester).
+    Ranking ranking() const noexcept { return ranking_; }
+
+    static RankedBars rank(const CoinBarMap& bars, Ranking ranking) {
         RankedBars ranked;
         ranked.reserve(bars.size());
 
@@ -43,18 +58,25 @@ public:
                 }
             );
         }
+        else if (ranking == Ranking::QuoteVolume) {
+            std::sort(ranked.begin(), ranked.end(),
+                [](const auto& a, const auto& b) {
+                    return quoteVolumeOf(a.get().second) > quoteVolumeOf(b.get().second);
+                }
+            );
+        }
 
         return ranked;
     }
 
 
 protected:
-    Strategy(Portafolio& portafolio, unsigned int maxPosOpen, Ranking ranking, double commissionEntryPctg, double commissionExitPctg): maxPosOpen_(maxPosOpen), ranking_(ranking),
-            commissionEntryPctg_(commissionEntryPctg), commissionExitPctg_(commissionExitPctg), portafolio_(portafolio)   {}
+    Strategy(Portfolio& portfolio, unsigned int maxPosOpen, Ranking ranking, double commissionEntryPctg, double commissionExitPctg): maxPosOpen_(maxPosOpen), ranking_(ranking),
+            commissionEntryPctg_(commissionEntryPctg), commissionExitPctg_(commissionExitPctg), portfolio_(portfolio)   {}
 
     unsigned int maxPosOpen_;
     Ranking ranking_;
     double commissionEntryPctg_;
     double commissionExitPctg_;
-    Portafolio& portafolio_
+    Portfolio& portfolio_;
 };
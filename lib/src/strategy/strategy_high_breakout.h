@@ -1,13 +1,17 @@
+#pragma once
+
 #include "strategy.h"
 #include <algorithm>
+#include "logger.h"
 #include "time_utils.h"
 
 
-class StrategyHighBreakout : public Strategy {
+// final: lets Backtester<StrategyHighBreakout> devirtualize and inline calculateSignals.
+class StrategyHighBreakout final : public Strategy {
 public:
-    StrategyHighBreakout(Portafolio& portafolio, double commissionEntryPctg, double commissionExitPctg): Strategy(portafolio, 10, Ranking::Volume, commissionEntryPctg,  commissionExitPctg) {} 
+    StrategyHighBreakout(Portfolio& portfolio, double commissionEntryPctg, double commissionExitPctg): Strategy(portfolio, 10, Ranking::QuoteVolume, commissionEntryPctg,  commissionExitPctg) {} 
 
-    inline unsigned int processSignal(std::vector<Trade>& current_trades, Coin& coin, const BarData& bar, Timestamp& ts){
+    inline void processSignal(std::vector<Trade>& current_trades, const Coin& coin, const BarData& bar, Timestamp ts){
         if(bar.close > bar.high_20d && bar.barNumber > 20){
             Trade newTrade;
             newTrade.trade_id_ = last_trade_id_ ++ ;
@@ -15,11 +19,11 @@ public:
             newTrade.commission_ += this->commissionEntryPctg_;
             newTrade.coin_ = coin;
             newTrade.direction_ = Direction::Long;
-            newTrade.currentPrice = bar.close;
+            newTrade.current_price_ = bar.close;
             newTrade.entry_ = bar.close;
-            newTrade.size_ = 0.05 * this->portafolio_.GetCurrentBalance() / bar.close;
+            newTrade.size_ = 0.05 * this->portfolio_.GetCurrentBalance() / bar.close;
             newTrade.sl_ = bar.close - 3*bar.atr_14d;
-            newTrade.slReference = bar.close;
+            newTrade.slReference_ = bar.close;
 
 
             current_trades.emplace_back(newTrade);
@@ -34,7 +38,11 @@ public:
         for (auto& trade : current_trades) {
 
             if (trade.exited_) {
-                LG_ERROR("Received a closed trade");
+                // Orders the execution model cancelled, or exits it deferred and filled,
+                // on this bar are expected here
+                if (trade.end_ != ts) {
+                    LG_ERROR("Received a closed trade");
+                }
                 continue;
             }
 
@@ -81,11 +89,14 @@ public:
     };
 
     inline void calculateSignals(std::vector<Trade>& current_trades, const CoinBarMap& bars, Timestamp ts) override {
-        unsigned int nOpenTrades = processOpenTrades();
+        calculateSignals(current_trades, bars, rank(bars, this->ranking_), ts);
+    }
 
-        if(nOpenTrades < this->maxPosOpen_){
+    // Same as above with the cross-sectional ranking already computed (shared by MultiBacktester).
+    inline void calculateSignals(std::vector<Trade>& current_trades, const CoinBarMap& bars, const RankedBars& rbars, Timestamp ts) {
+        unsigned int nOpenTrades = processOpenTrades(current_trades, bars, ts);
 
-            RankedBars Rbars = rank(bars, this->ranking_);
+        if(nOpenTrades < this->maxPosOpen_){
 
             unsigned int counter = 0;
             unsigned int universeVolume = 20;
@@ -98,7 +109,7 @@ public:
                 
                 const auto& [coin, bar] = wrapped.get();
 
-                if(hasOpenTrade(coin))
+                if(hasOpenTrade(current_trades, coin))
                     continue;
 
                 // ---- ENTRY LOGIC ----
@@ -0,0 +1,178 @@
+#include "binary_io.h"
+#include "logger.h"
+
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**************************************************************************************
+ * Purpose : Computes the 64-bit FNV-1a hash of a byte range.
+ * Args    : data - Bytes to hash.
+ * Return  : uint64_t - Hash value.
+ **************************************************************************************/
+uint64_t fnv1a64(std::string_view data) noexcept
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : data)
+    {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+
+/**************************************************************************************
+ * Purpose : Writes a file atomically: the content goes to "<path>.tmp", is fsync'ed and
+ *           then renamed over `path`. A crash at any point leaves either the previous
+ *           file or the new one, never a partial write.
+ * Args    : path    - Destination file.
+ *           content - Bytes to write.
+ * Return  : bool - true on success.
+ **************************************************************************************/
+bool writeFileAtomic(const boost::filesystem::path& path, std::string_view content)
+{
+    if (!path.parent_path().empty() && !boost::filesystem::exists(path.parent_path()))
+        boost::filesystem::create_directories(path.parent_path());
+
+    const std::string tmp = path.string() + ".tmp";
+
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        LG_ERROR("Cannot open {}: {}", tmp, std::strerror(errno));
+        return false;
+    }
+
+    const char* p = content.data();
+    std::size_t left = content.size();
+    while (left > 0)
+    {
+        ssize_t n = ::write(fd, p, left);
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            LG_ERROR("Write {} failed: {}", tmp, std::strerror(errno));
+            ::close(fd);
+            return false;
+        }
+        p    += n;
+        left -= static_cast<std::size_t>(n);
+    }
+
+    if (::fsync(fd) < 0)
+    {
+        LG_ERROR("fsync {} failed: {}", tmp, std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    ::close(fd);
+
+    if (::rename(tmp.c_str(), path.string().c_str()) < 0)
+    {
+        LG_ERROR("Rename {} → {} failed: {}", tmp, path.string(), std::strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+
+/**************************************************************************************
+ * Purpose : Reads a whole file into memory.
+ * Args    : path - File to read.
+ *           out  - Receives the content.
+ * Return  : bool - false if the file does not exist or cannot be read.
+ **************************************************************************************/
+bool readFile(const boost::filesystem::path& path, std::string& out)
+{
+    std::ifstream in(path.string(), std::ios::binary);
+    if (!in)
+        return false;
+
+    out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+
+MappedFile::~MappedFile()
+{
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : addr_(std::exchange(other.addr_, nullptr)),
+      size_(std::exchange(other.size_, 0))
+{}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        addr_ = std::exchange(other.addr_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+void MappedFile::release() noexcept
+{
+    if (addr_)
+        ::munmap(addr_, size_);
+    addr_ = nullptr;
+    size_ = 0;
+}
+
+
+/**************************************************************************************
+ * Purpose : Maps a whole file read-only. The kernel is told the mapping will be read
+ *           sequentially so it reads ahead aggressively.
+ * Args    : path - File to map.
+ * Return  : bool - false if the file cannot be opened or mapped.
+ **************************************************************************************/
+bool MappedFile::open(const boost::filesystem::path& path)
+{
+    release();
+
+    int fd = ::open(path.string().c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        LG_ERROR("Cannot open {}: {}", path.string(), std::strerror(errno));
+        return false;
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) < 0)
+    {
+        LG_ERROR("Cannot stat {}: {}", path.string(), std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    if (st.st_size == 0)
+    {
+        ::close(fd);
+        return true;
+    }
+
+    void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (p == MAP_FAILED)
+    {
+        LG_ERROR("mmap {} failed: {}", path.string(), std::strerror(errno));
+        return false;
+    }
+
+    ::madvise(p, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+
+    addr_ = p;
+    size_ = static_cast<std::size_t>(st.st_size);
+    return true;
+}
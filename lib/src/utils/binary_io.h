@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <boost/filesystem.hpp>
+
+/**************************************************************************************
+ * Purpose : Append-only binary buffer used to build checkpoints and other native
+ *           binary files. Values are written in host byte order: files are meant to be
+ *           read back on the same machine (restart state), not exchanged.
+ **************************************************************************************/
+class BinaryWriter {
+public:
+    // Appends the raw bytes of a trivially copyable value.
+    template<typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "write() requires a POD-like type");
+        buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // Appends a length-prefixed string.
+    void writeString(std::string_view s) {
+        write(static_cast<uint32_t>(s.size()));
+        buffer_.append(s.data(), s.size());
+    }
+
+    const std::string& data() const noexcept { return buffer_; }
+
+private:
+    std::string buffer_;
+};
+
+/**************************************************************************************
+ * Purpose : Bounds-checked reader over a buffer produced by BinaryWriter.
+ * Throws  : std::runtime_error on truncated input.
+ **************************************************************************************/
+class BinaryReader {
+public:
+    explicit BinaryReader(std::string_view data) : data_(data) {}
+
+    // Reads a trivially copyable value.
+    template<typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable_v<T>, "read() requires a POD-like type");
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, data_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    // Reads a length-prefixed string.
+    std::string readString() {
+        const uint32_t n = read<uint32_t>();
+        require(n);
+        std::string s(data_.substr(pos_, n));
+        pos_ += n;
+        return s;
+    }
+
+    bool atEnd() const noexcept { return pos_ == data_.size(); }
+
+private:
+    std::string_view data_;
+    std::size_t      pos_ = 0;
+
+    void require(std::size_t n) const {
+        if (data_.size() - pos_ < n)
+            throw std::runtime_error("binary data truncated");
+    }
+};
+
+/**************************************************************************************
+ * Purpose : Computes the 64-bit FNV-1a hash of a byte range (checksums, fingerprints).
+ * Args    : data - Bytes to hash.
+ * Return  : uint64_t - Hash value.
+ **************************************************************************************/
+uint64_t fnv1a64(std::string_view data) noexcept;
+
+/**************************************************************************************
+ * Purpose : Writes a file atomically: the content goes to "<path>.tmp", is fsync'ed and
+ *           then renamed over `path`, so readers see either the old or the new file.
+ * Args    : path    - Destination file.
+ *           content - Bytes to write.
+ * Return  : bool - true on success.
+ **************************************************************************************/
+bool writeFileAtomic(const boost::filesystem::path& path, std::string_view content);
+
+/**************************************************************************************
+ * Purpose : Reads a whole file into memory.
+ * Args    : path - File to read.
+ *           out  - Receives the content.
+ * Return  : bool - false if the file does not exist or cannot be read.
+ **************************************************************************************/
+bool readFile(const boost::filesystem::path& path, std::string& out);
+
+/**************************************************************************************
+ * Purpose : Read-only memory mapping of a whole file, for parsers that scan large
+ *           inputs in place without copying them. Empty files map to an empty view.
+ **************************************************************************************/
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**************************************************************************************
+     * Purpose : Maps `path` (replacing any previous mapping).
+     * Args    : path - File to map.
+     * Return  : bool - false if the file cannot be opened or mapped.
+     **************************************************************************************/
+    bool open(const boost::filesystem::path& path);
+
+    std::string_view data() const noexcept { return {static_cast<const char*>(addr_), size_}; }
+
+private:
+    void*       addr_ = nullptr;
+    std::size_t size_ = 0;
+
+    void release() noexcept;
+};
@@ -154,6 +154,23 @@ int toYYYYMMDD(std::chrono::year_month_day ymd)
 }
 
 
+/**************************************************************************************
+ * Purpose : Converts a compact date (YYYYMMDD), as stored in the database, back into a
+ *           chrono date.
+ *
+ * Args    : yyyymmdd - Date encoded as YYYYMMDD.
+ *
+ * Return  : std::chrono::year_month_day - Decoded date (not ok() if the input is not a
+ *           valid date).
+ **************************************************************************************/
+std::chrono::year_month_day fromYYYYMMDD(unsigned int yyyymmdd)
+{
+    return std::chrono::year_month_day{std::chrono::year{static_cast<int>(yyyymmdd / 10000)},
+                                       std::chrono::month{(yyyymmdd / 100) % 100},
+                                       std::chrono::day{yyyymmdd % 100}};
+}
+
+
 /**************************************************************************************
  * Purpose : Converts an integer date in the format YYYYMMDD into a Unix timestamp
  *           expressed in milliseconds since epoch (UTC). This is required for all
@@ -238,3 +255,15 @@ unsigned int nextDay(unsigned int yyyymmdd) {
         unsigned(nextYmd.day())
     );
 }
+
+
+int shiftDays(int yyyymmdd, int days) {
+    std::chrono::year_month_day ymd{
+        std::chrono::year{yyyymmdd / 10000},
+        std::chrono::month{static_cast<unsigned>((yyyymmdd / 100) % 100)},
+        std::chrono::day{static_cast<unsigned>(yyyymmdd % 100)}
+    };
+
+    return toYYYYMMDD(std::chrono::year_month_day{
+        std::chrono::sys_days{ymd} + std::chrono::days{days}});
+}
@@ -66,6 +66,13 @@ std::chrono::system_clock::time_point computeNextMidnightUTC();
  **************************************************************************************/
 int toYYYYMMDD(std::chrono::year_month_day ymd);
 
+/**************************************************************************************
+ * Purpose : Converts a compact date (YYYYMMDD) into a year_month_day.
+ * Args    : yyyymmdd - Date encoded as YYYYMMDD.
+ * Return  : std::chrono::year_month_day - Decoded date.
+ **************************************************************************************/
+std::chrono::year_month_day fromYYYYMMDD(unsigned int yyyymmdd);
+
 /**************************************************************************************
  * Purpose : Converts an integer date (YYYYMMDD) to a Unix timestamp in milliseconds.
  * Args    : yyyymmdd - The encoded date (YYYYMMDD).
@@ -87,3 +94,11 @@ unsigned int previousDay(unsigned int yyyymmdd);
  **************************************************************************************/
 unsigned int nextDay(unsigned int yyyymmdd);
 
+
+/**************************************************************************************
+ * Purpose : Shifts a compact date (YYYYMMDD) by a number of calendar days.
+ * Args    : yyyymmdd - Date encoded as YYYYMMDD.
+ *           days     - Days to add (negative to go back).
+ * Return  : int - Shifted date encoded as YYYYMMDD.
+ **************************************************************************************/
+int shiftDays(int yyyymmdd, int days);
@@ -0,0 +1,147 @@
+#include "backtest.h"
+#include "indicators.h"
+#include "logger.h"
+#include "signal_matrix.h"
+#include "time_utils.h"
+
+#include <chrono>
+#include <cmath>
+#include <fmt/core.h>
+
+using Clock = std::chrono::steady_clock;
+
+/***********************************************
+ * Size of the benchmark: days × symbols, and
+ * rule variants of the sweep.
+ ***********************************************/
+static constexpr int N_DAYS     = 900;
+static constexpr int N_SYMBOLS  = 150;
+static constexpr int N_VARIANTS = 1000;
+
+// Milliseconds elapsed since `start`.
+static double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Deterministic generator (xorshift): the same bars on every run.
+static uint64_t nextRandom(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Uniform in [-1, 1].
+static double nextUnit(uint64_t& state)
+{
+    return static_cast<double>(nextRandom(state) % 20001) / 10000.0 - 1.0;
+}
+
+/**************************************************************************************
+ * Purpose : Random walks with a per-symbol drift and volume level, so breakouts happen
+ *           and the top-N volume universe changes from day to day.
+ **************************************************************************************/
+static OHLCVData generateData(Timestamp first)
+{
+    OHLCVData data;
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < N_SYMBOLS; ++i)
+    {
+        auto& bars = data.data[fmt::format("S{:03}USDT", i)];
+        const double drift       = 0.002 * nextUnit(state);
+        const double volumeLevel = std::pow(10.0, 3.0 + 2.0 * (nextUnit(state) + 1.0) / 2.0);
+
+        double close = 10.0 + i;
+        for (int d = 0; d < N_DAYS; ++d)
+        {
+            const double open = close;
+            close = std::max(open * (1.0 + drift + 0.04 * nextUnit(state)), 0.01);
+            const double volume = volumeLevel * (1.0 + 0.5 * nextUnit(state));
+            bars[static_cast<unsigned int>(shiftDays(first, d))] =
+                OHLCV{open, std::max(open, close) * 1.01, std::min(open, close) * 0.99, close,
+                      volume, volume * close, 100.0, volume / 2, volume * close / 2};
+        }
+    }
+    return data;
+}
+
+/**************************************************************************************
+ * Purpose : Benchmark of the signal matrix, the figures quoted by the matrix backtest
+ *           mode (900 days × 150 symbols):
+ *              - Building the matrix from EnrichedData (once per data set)
+ *              - One Backtester<StrategyHighBreakout> run, and the matrix run of the
+ *                default BreakoutRule, which must give the same result
+ *              - A sweep of 1000 rule variants (entry threshold, minimum bars, stop
+ *                distance, max positions, universe size), per variant
+ **************************************************************************************/
+int main()
+{
+    Logger::Instance().Setup(false, true, "", "", false);
+
+    const Timestamp first = 20220101;
+    const Timestamp last  = shiftDays(first, N_DAYS - 1);
+    const EnrichedData data = enrichData(generateData(first));
+
+    // ------------------------------------------------------------
+    // Matrix build
+    // ------------------------------------------------------------
+    auto start = Clock::now();
+    const BarMatrix matrix = buildBarMatrix(data, first, last);
+    fmt::print("build matrix {} days x {} symbols: {:.2f} ms\n", matrix.nDays(), matrix.nSymbols(), elapsedMs(start));
+
+    // ------------------------------------------------------------
+    // Default rule: event-driven Backtester vs matrix
+    // ------------------------------------------------------------
+    start = Clock::now();
+    auto runner = makeBacktester("high_breakout", data, first, last, 0.0, 0.0);
+    if (!runner)
+        return 1;
+    runner->run();
+    const double backtesterMs = elapsedMs(start);
+
+    const BreakoutRule rule;
+    std::vector<uint8_t> mask;
+    start = Clock::now();
+    evaluateBreakoutEntries(matrix, rule, mask);
+    const MatrixBacktestResult result = resolvePositions(matrix, mask, rule);
+    const double matrixMs = elapsedMs(start);
+
+    const Portfolio& portfolio = runner->portfolio();
+    const bool same = result.finalBalance == portfolio.GetCurrentBalance() &&
+                      result.finalEquity  == portfolio.GetCurrentEquity() &&
+                      result.nSimulated   == portfolio.GetNSimulated();
+    fmt::print("default rule, Backtester: {:.2f} ms, matrix: {:.2f} ms ({})\n",
+               backtesterMs, matrixMs, same ? "same result" : "RESULTS DIFFER");
+    fmt::print("  final balance {:.2f}, equity {:.2f}, {} trades, {} simulated\n",
+               result.finalBalance, result.finalEquity, result.nTrades, result.nSimulated);
+
+    // ------------------------------------------------------------
+    // Sweep
+    // ------------------------------------------------------------
+    std::vector<BreakoutRule> rules;
+    for (int v = 0; v < N_VARIANTS; ++v)
+    {
+        BreakoutRule r;
+        r.breakoutPctg = 0.01 * (v % 10);
+        r.minBars      = 20 + 5 * ((v / 10) % 4);
+        r.atrStopMult  = 1.5 + 0.5 * ((v / 40) % 5);
+        r.maxPosOpen   = 5 + 5 * ((v / 200) % 5);
+        r.universe     = 20 + 10 * (v % 3);
+        rules.push_back(r);
+    }
+
+    start = Clock::now();
+    const std::vector<MatrixBacktestResult> results = sweepBreakoutRules(matrix, rules);
+    const double sweepMs = elapsedMs(start);
+
+    unsigned int trades = 0;
+    for (const auto& r : results)
+        trades += r.nTrades;
+    fmt::print("sweep of {} variants: {:.1f} ms, {:.3f} ms per variant ({} trades)\n",
+               rules.size(), sweepMs, sweepMs / static_cast<double>(rules.size()), trades);
+
+    // Timings never fail the benchmark; a result that differs from the Backtester does
+    return same ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <iostream>
+
+/***********************************************
+ * Failed CHECKs of the test executable; main()
+ * returns it, so meson counts any as a failure.
+ ***********************************************/
+inline int testFailures = 0;
+
+// Reports a failed expression with its location and keeps going.
+#define CHECK(expr)                                                                   \
+    do {                                                                              \
+        if (!(expr)) {                                                                \
+            ++testFailures;                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #expr ") failed\n"; \
+        }                                                                             \
+    } while (0)
+
+// Exit code of a test executable: 0 if every CHECK passed.
+inline int testResult()
+{
+    if (testFailures > 0)
+        std::cerr << testFailures << " check(s) failed\n";
+    return testFailures > 0 ? 1 : 0;
+}
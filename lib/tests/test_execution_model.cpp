@@ -0,0 +1,178 @@
+#include "execution_model.h"
+#include "logger.h"
+#include "test_check.h"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr Timestamp DAY1 = 20240101;
+static constexpr Timestamp DAY2 = 20240102;
+static constexpr Timestamp DAY3 = 20240103;
+
+static bool near(double a, double b)
+{
+    return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(b));
+}
+
+static BarData barOf(double open, double volume, double atr)
+{
+    BarData bar{};
+    bar.open = bar.high = bar.low = bar.close = open;
+    bar.volume  = volume;
+    bar.atr_14d = atr;
+    return bar;
+}
+
+// A trade signalled on the previous bar, due to fill on `start`.
+static Trade orderOf(TradeID id, const Coin& coin, Direction direction, double size, Timestamp start)
+{
+    Trade trade;
+    trade.trade_id_  = id;
+    trade.coin_      = coin;
+    trade.direction_ = direction;
+    trade.size_      = size;
+    trade.start_     = start;
+    trade.entry_     = 1.0;                 // Signal price, replaced by the fill
+    return trade;
+}
+
+/**************************************************************************************
+ * Purpose : Entries fill at the open plus slippage (fixed bps + ATR fraction), mirrored
+ *           for shorts, capped to the bar's volume share, and pay commission on the
+ *           filled notional. Orders with no bar or no volume are cancelled.
+ **************************************************************************************/
+static void testEntries()
+{
+    ExecutionConfig config;
+    config.fixedSlippageBps    = 10.0;
+    config.atrSlippageFraction = 0.1;
+    config.maxVolumePctg       = 0.1;
+    config.commissionEntryPctg = 0.001;
+    ExecutionModel model(config);
+
+    // Slippage = 10 bps + 0.1 × 2 / 100 = 0.3 %
+    const CoinBarMap bars = {{"AAAUSDT", barOf(100.0, 1000.0, 2.0)},
+                             {"BBBUSDT", barOf(100.0, 50.0, 2.0)},
+                             {"DRYUSDT", barOf(100.0, 0.0, 2.0)}};
+    std::vector<Trade> trades = {
+        orderOf(1, "AAAUSDT", Direction::Long,  10.0, DAY1),
+        orderOf(2, "AAAUSDT", Direction::Short, 10.0, DAY1),
+        orderOf(3, "BBBUSDT", Direction::Long,  20.0, DAY1),    // 40 % of the volume
+        orderOf(4, "NONUSDT", Direction::Long,  1.0,  DAY1),    // No bar
+        orderOf(5, "DRYUSDT", Direction::Long,  1.0,  DAY1),    // No volume
+        orderOf(6, "AAAUSDT", Direction::Long,  1.0,  DAY2),    // Due tomorrow
+    };
+    model.fillEntries(trades, bars, DAY1);
+
+    CHECK(near(model.slippage(bars.at("AAAUSDT"), 10.0), 0.003));
+    CHECK(!trades[0].isSimulated_ && near(trades[0].entry_, 100.3) && trades[0].size_ == 10.0);
+    CHECK(near(trades[0].commission_, 100.3 * 10.0 * 0.001));
+    CHECK(!trades[1].isSimulated_ && near(trades[1].entry_, 99.7));
+
+    CHECK(trades[2].size_ == 5.0 && near(trades[2].entry_, 100.3));
+    CHECK(near(trades[2].commission_, 100.3 * 5.0 * 0.001));
+
+    for (const Trade* cancelled : {&trades[3], &trades[4]})
+    {
+        CHECK(cancelled->exited_ && cancelled->isSimulated_);
+        CHECK(cancelled->size_ == 0.0 && cancelled->end_ == DAY1);
+    }
+
+    CHECK(trades[5].isSimulated_ && !trades[5].exited_ && trades[5].entry_ == 1.0);
+}
+
+/**************************************************************************************
+ * Purpose : Exits fill at the stop, or at the open when the bar gapped through it, minus
+ *           slippage (plus for shorts), and add exit commission to the entry's. An exit
+ *           on a bar without data for the coin keeps the trade open until the coin's
+ *           next bar, where it fills at the open before the strategy runs.
+ **************************************************************************************/
+static void testExits()
+{
+    ExecutionConfig config;
+    config.fixedSlippageBps    = 10.0;
+    config.commissionEntryPctg = 0.001;
+    config.commissionExitPctg  = 0.002;
+    ExecutionModel model(config);
+
+    std::vector<Trade> trades = {
+        orderOf(1, "AAAUSDT", Direction::Long,  1.0, DAY1),
+        orderOf(2, "BBBUSDT", Direction::Long,  1.0, DAY1),
+        orderOf(3, "CCCUSDT", Direction::Short, 1.0, DAY1),
+        orderOf(4, "GAPUSDT", Direction::Long,  1.0, DAY1),
+    };
+    const CoinBarMap day1 = {{"AAAUSDT", barOf(100.0, 1000.0, 0.0)}, {"BBBUSDT", barOf(100.0, 1000.0, 0.0)},
+                             {"CCCUSDT", barOf(100.0, 1000.0, 0.0)}, {"GAPUSDT", barOf(100.0, 1000.0, 0.0)}};
+    model.fillEntries(trades, day1, DAY1);
+    const double entryCommission = 100.1 * 0.001;
+
+    // The strategy stops everything out on day 2; GAPUSDT has no bar that day
+    const CoinBarMap day2 = {{"AAAUSDT", barOf(97.0, 1000.0, 0.0)}, {"BBBUSDT", barOf(90.0, 1000.0, 0.0)},
+                             {"CCCUSDT", barOf(103.0, 1000.0, 0.0)}};
+    for (auto& trade : trades)
+    {
+        trade.exit_   = trade.direction_ == Direction::Short ? 105.0 : 95.0;
+        trade.end_    = DAY3;
+        trade.exited_ = true;
+    }
+    model.fillExits(trades, day2);
+
+    CHECK(near(trades[0].exit_, 95.0 * 0.999));                    // At the stop
+    CHECK(near(trades[0].commission_, entryCommission + 95.0 * 0.999 * 0.002));
+    CHECK(near(trades[1].exit_, 90.0 * 0.999));                    // Gapped below it
+    CHECK(near(trades[2].exit_, 105.0 * 1.001));                   // Short: above the stop
+
+    CHECK(!trades[3].exited_ && trades[3].end_ == 0);              // Deferred
+    CHECK(trades[3].exit_ == 95.0 && near(trades[3].commission_, entryCommission));
+
+    trades.erase(trades.begin(), trades.begin() + 3);
+
+    // Day 3 still without a bar: nothing happens
+    model.fillEntries(trades, day2, DAY3);
+    model.fillExits(trades, day2);
+    CHECK(!trades[0].exited_);
+
+    const Timestamp day4 = 20240104;
+    model.fillEntries(trades, {{"GAPUSDT", barOf(80.0, 1000.0, 0.0)}}, day4);
+    CHECK(trades[0].exited_ && trades[0].end_ == day4);
+    CHECK(near(trades[0].exit_, 80.0 * 0.999));
+    CHECK(near(trades[0].commission_, entryCommission + 80.0 * 0.999 * 0.002));
+}
+
+/**************************************************************************************
+ * Purpose : A filled trade removed from the portfolio by another path than fillExits()
+ *           leaves no state behind: a later trade reusing its id is not taken for a
+ *           model fill and keeps the strategy's exit price.
+ **************************************************************************************/
+static void testRemovedTrades()
+{
+    ExecutionConfig config;
+    config.fixedSlippageBps = 10.0;
+    ExecutionModel model(config);
+
+    const CoinBarMap bars = {{"AAAUSDT", barOf(100.0, 1000.0, 0.0)}};
+    std::vector<Trade> trades = {orderOf(1, "AAAUSDT", Direction::Long, 1.0, DAY1)};
+    model.fillEntries(trades, bars, DAY1);
+    CHECK(!trades[0].isSimulated_);
+
+    trades.clear();
+    model.fillExits(trades, bars);
+
+    Trade reused = orderOf(1, "AAAUSDT", Direction::Long, 1.0, DAY1);
+    reused.exit_   = 50.0;
+    reused.exited_ = true;
+    trades.push_back(reused);
+    model.fillExits(trades, bars);
+    CHECK(trades[0].exit_ == 50.0);
+}
+
+int main()
+{
+    Logger::Instance().Setup(false, true, "", "", false);
+
+    testEntries();
+    testExits();
+    testRemovedTrades();
+
+    return testResult();
+}
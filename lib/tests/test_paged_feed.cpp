@@ -0,0 +1,269 @@
+#include "backtest.h"
+#include "bar_block_source.h"
+#include "indicators.h"
+#include "logger.h"
+#include "paged_bar_feed.h"
+#include "sharded_candle_store.h"
+#include "sqlite_connection.h"
+#include "test_check.h"
+
+#include <cmath>
+#include <boost/filesystem.hpp>
+#include <fmt/format.h>
+
+namespace fs = boost::filesystem;
+
+/***********************************************
+ * Size of the generated database.
+ ***********************************************/
+static constexpr int N_SYMBOLS = 40;
+
+static constexpr Timestamp RUN_START = 20220115;
+static constexpr Timestamp RUN_END   = 20231120;
+
+static fs::path workDir;
+
+// Deterministic generator (xorshift): the same database on every run.
+static uint64_t nextRandom(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/**************************************************************************************
+ * Purpose : 40 symbols of daily bars (days 1-28 of every month, 2021-2023) as random
+ *           walks. Listings and delistings are staggered, and S07USDT has no bar in
+ *           Q2 2022, so one of its time blocks is empty.
+ **************************************************************************************/
+static OHLCVData generateData()
+{
+    std::vector<unsigned> days;
+    for (unsigned year = 2021; year <= 2023; ++year)
+        for (unsigned month = 1; month <= 12; ++month)
+            for (unsigned day = 1; day <= 28; ++day)
+                days.push_back(year * 10000 + month * 100 + day);
+
+    OHLCVData data;
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < N_SYMBOLS; ++i)
+    {
+        auto& bars = data.data[fmt::format("S{:02}USDT", i)];
+        const std::size_t first = static_cast<std::size_t>(i) * 9;
+        const std::size_t last  = days.size() - static_cast<std::size_t>(i % 5) * 40;
+
+        double close = 10.0 + i;
+        for (std::size_t d = first; d < last; ++d)
+        {
+            const double move = static_cast<double>(nextRandom(state) % 2001) / 1000.0 - 1.0;
+            const double open = close;
+            close = std::max(open * (1.0 + 0.04 * move), 0.01);
+            if (i == 7 && days[d] >= 20220401 && days[d] <= 20220630)
+                continue;
+
+            const double volume = 1000.0 + static_cast<double>(nextRandom(state) % 5000);
+            bars[days[d]] = OHLCV{open, std::max(open, close) * 1.01, std::min(open, close) * 0.99, close,
+                                  volume, volume * close, 50.0, volume / 2, volume * close / 2};
+        }
+    }
+    return data;
+}
+
+static bool sameBar(const BarData& a, const BarData& b)
+{
+    return a.open == b.open && a.high == b.high && a.low == b.low && a.close == b.close &&
+           a.volume == b.volume && a.quoteVolume == b.quoteVolume &&
+           a.barNumber == b.barNumber && a.high_20d == b.high_20d && a.atr_14d == b.atr_14d;
+}
+
+/**************************************************************************************
+ * Purpose : Walks the feed over the run and compares every date with the in-memory
+ *           bars: same dates, same symbols, identical enriched bars.
+ * Return  : std::size_t - Dates returned by the feed.
+ **************************************************************************************/
+static std::size_t checkAgainst(const EnrichedData& reference, PagedBarFeed& feed)
+{
+    CHECK(feed.seek(RUN_START) > 0);
+
+    auto expected = reference.lower_bound(RUN_START);
+    std::size_t dates = 0, mismatches = 0;
+    Timestamp ts;
+    while (const CoinBarMap* bars = feed.next(RUN_END, ts))
+    {
+        ++dates;
+        if (expected == reference.end() || expected->first != ts || expected->second.size() != bars->size())
+        {
+            ++mismatches;
+            expected = reference.upper_bound(ts);
+            continue;
+        }
+
+        auto a = expected->second.begin();
+        for (auto b = bars->begin(); b != bars->end(); ++a, ++b)
+            mismatches += a->first != b->first || !sameBar(a->second, b->second);
+        ++expected;
+    }
+
+    CHECK(mismatches == 0);
+    CHECK(!feed.failed());
+    CHECK(expected == reference.upper_bound(RUN_END));
+    return dates;
+}
+
+// Final equity of the high_breakout strategy run over `bars` (EnrichedData or feed).
+template<typename Bars>
+static double equityOver(Bars& bars)
+{
+    auto runner = makeBacktester("high_breakout", bars, RUN_START, RUN_END, 0.1, 0.1);
+    CHECK(runner != nullptr);
+    if (!runner)
+        return 0.0;
+    runner->run();
+    return runner->portfolio().GetCurrentEquity();
+}
+
+/**************************************************************************************
+ * Purpose : In memory, paged from SQLite and paged from a snapshot give the same bars
+ *           and the same backtest, with the default budget and with one small enough
+ *           to evict constantly (with and without read-ahead).
+ **************************************************************************************/
+static void testEquivalence(const EnrichedData& reference, BarBlockSource& source, const char* name)
+{
+    const double expectedEquity = equityOver(reference);
+
+    PagedBarFeed roomy(source);
+    const std::size_t dates = checkAgainst(reference, roomy);
+    CHECK(dates > 500);
+    CHECK(roomy.cache().stats().evictions == 0);
+    CHECK(equityOver(roomy) == expectedEquity);
+
+    // Second run on the same feed: served from the cache
+    const BarCacheStats before = roomy.cache().stats();
+    CHECK(checkAgainst(reference, roomy) == dates);
+    CHECK(roomy.cache().stats().misses == before.misses);
+
+    for (int readAhead : {0, 2})
+    {
+        BarCacheConfig tight;
+        tight.maxBytes    = 16 << 10;      // A couple of blocks for 40 symbols
+        tight.blockMonths = 1;
+        tight.readAhead   = readAhead;
+
+        PagedBarFeed feed(source, tight);
+        CHECK(checkAgainst(reference, feed) == dates);
+        CHECK(equityOver(feed) == expectedEquity);
+
+        const BarCacheStats stats = feed.cache().stats();
+        CHECK(stats.evictions > 0);
+        CHECK(stats.failures == 0);
+        CHECK(readAhead == 0 || stats.prefetched > 0);
+        fmt::print("{} read-ahead {}: {} misses, {} prefetched, {} evictions\n",
+                   name, readAhead, stats.misses, stats.prefetched, stats.evictions);
+    }
+}
+
+/***********************************************
+ * Source that fails the loads of one symbol
+ * from a date on, while `failing` is set.
+ ***********************************************/
+class FailingSource final : public BarBlockSource {
+public:
+    FailingSource(BarBlockSource& inner, std::string symbol, int from)
+        : inner_(inner), symbol_(std::move(symbol)), from_(from) {}
+
+    bool failing = true;
+
+    std::vector<SymbolRange> ranges() override { return inner_.ranges(); }
+
+    bool load(const std::string& symbol, int from, int to, BarBlock& out) override {
+        if (failing && symbol == symbol_ && to >= from_)
+            return false;
+        return inner_.load(symbol, from, to, out);
+    }
+
+private:
+    BarBlockSource& inner_;
+    std::string     symbol_;
+    int             from_;
+};
+
+/**************************************************************************************
+ * Purpose : A block that cannot be loaded stops the feed (failed(), counted in the
+ *           stats) instead of dropping the symbol from the remaining dates; the failed
+ *           block is not cached, so a rerun retries it.
+ **************************************************************************************/
+static void testLoadFailure(const EnrichedData& reference, BarBlockSource& source)
+{
+    FailingSource failingSource(source, "S03USDT", 20230101);
+    PagedBarFeed feed(failingSource);
+
+    CHECK(feed.seek(RUN_START) > 0);
+    Timestamp ts, last = 0;
+    std::size_t mismatches = 0;
+    while (const CoinBarMap* bars = feed.next(RUN_END, ts))
+    {
+        last = ts;
+        mismatches += !reference.contains(ts) || reference.at(ts).size() != bars->size();
+    }
+    CHECK(feed.failed());
+    CHECK(mismatches == 0);
+    CHECK(last > RUN_START && last < 20230101);
+    CHECK(feed.cache().stats().failures > 0);
+    CHECK(feed.next(RUN_END, ts) == nullptr);
+
+    // A failure while replaying the warm-up fails seek()
+    PagedBarFeed late(failingSource);
+    CHECK(late.seek(20230301) == 0);
+    CHECK(late.failed());
+
+    failingSource.failing = false;
+    CHECK(checkAgainst(reference, feed) > 0);
+    CHECK(!feed.failed());
+}
+
+int main()
+{
+    Logger::Instance().Setup(false, true, "", "", false);
+
+    workDir = fs::temp_directory_path() / fs::unique_path("paged_feed_%%%%%%");
+    fs::create_directories(workDir);
+    const fs::path database = workDir / "market.db";
+    const fs::path snapshot = workDir / "market.bsn";
+
+    const OHLCVData data = generateData();
+    const EnrichedData reference = enrichData(data);
+
+    {
+        SqliteConnection db;
+        CHECK(db.open(database));
+        CHECK(db.exec("CREATE TABLE ohlcv_data ("
+                      "   pair TEXT NOT NULL, date INTEGER NOT NULL,"
+                      "   open REAL, high REAL, low REAL, close REAL, volume REAL,"
+                      "   quote_volume REAL, trades INTEGER, taker_buy_volume REAL, taker_buy_quote_volume REAL,"
+                      "   PRIMARY KEY(pair, date));"
+                      "CREATE INDEX idx_ohlcv_data_date_pair ON ohlcv_data(date, pair);"));
+        {
+            SqliteTransaction tx(db);
+            CHECK(writeCandles(db, "ohlcv_data", data));
+            CHECK(tx.commit());
+        }
+
+        MarketDataReader reader(db);
+        CHECK(writeBarSnapshot(snapshot, reader));
+    }
+
+    SqliteBarSource sqlite;
+    BarSnapshot     snap;
+    CHECK(sqlite.open(database));
+    CHECK(snap.open(snapshot));
+    CHECK(sqlite.ranges().size() == N_SYMBOLS);
+    CHECK(snap.ranges().size() == N_SYMBOLS);
+
+    testEquivalence(reference, sqlite, "sqlite");
+    testEquivalence(reference, snap, "snapshot");
+    testLoadFailure(reference, snap);
+
+    fs::remove_all(workDir);
+    return testResult();
+}
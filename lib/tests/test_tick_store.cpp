@@ -0,0 +1,223 @@
+#include "logger.h"
+#include "test_check.h"
+#include "tick_store.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+/***********************************************
+ * 2024-01-01 00:00 UTC and the bucket lengths
+ * the candle checks use (Unix ms).
+ ***********************************************/
+static constexpr long long DAY1_MS = 1704067200000LL;
+static constexpr long long HOUR_MS = 3600000LL;
+static constexpr long long DAY_MS  = 24 * HOUR_MS;
+
+static bool near(double a, double b)
+{
+    return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(b));
+}
+
+// Whether `block` decodes to exactly `trades` (prices and quantities bit for bit).
+static bool decodesTo(const std::string& block, const std::vector<AggTrade>& trades)
+{
+    TickBlockCursor cursor(block);
+    if (!cursor.valid() || cursor.size() != trades.size())
+        return false;
+
+    AggTrade t;
+    for (const auto& expected : trades)
+    {
+        if (!cursor.next(t))
+            return false;
+        if (t.id != expected.id || t.timeMs != expected.timeMs || t.price != expected.price ||
+            t.qty != expected.qty || t.buyerMaker != expected.buyerMaker)
+            return false;
+    }
+    return !cursor.next(t);
+}
+
+/**************************************************************************************
+ * Purpose : Blocks round trip: prices and quantities with different decimal counts in
+ *           one block (the block scale is the largest), prices and timestamps moving
+ *           backwards (negative zigzag deltas), id gaps, values too large for the
+ *           finest scale of their column, and an empty block.
+ **************************************************************************************/
+static void testRoundTrip()
+{
+    const std::vector<AggTrade> trades = {
+        {1000, DAY1_MS + 500,  27123.5,    0.001,   false},
+        {1001, DAY1_MS + 499,  27123.25,   12.0,    true},     // Time and price go back
+        {1002, DAY1_MS + 499,  0.00012345, 3.25,    false},    // 8 price decimals
+        {1010, DAY1_MS + 1200, 31000.0,    0.00001, true},     // Id gap, price jumps up
+        {1011, DAY1_MS + 900,  1.1,        150.5,   false},    // Large negative deltas
+        {1012, DAY1_MS + 900,  1.1,        7.0,     true},
+    };
+
+    const std::string block = encodeTickBlock(trades);
+    CHECK(block.compare(0, 4, std::string(TICK_BLOCK_MAGIC, 4)) == 0);
+    CHECK(static_cast<uint8_t>(block[4]) == 8);      // priceDecimals
+    CHECK(static_cast<uint8_t>(block[5]) == 5);      // qtyDecimals
+    CHECK(decodesTo(block, trades));
+
+    // Integral values only: no scale at all
+    const std::vector<AggTrade> integral = {{1, 5, 100.0, 2.0, false}, {2, 3, 90.0, 1.0, true}};
+    const std::string integralBlock = encodeTickBlock(integral);
+    CHECK(integralBlock[4] == 0 && integralBlock[5] == 0);
+    CHECK(decodesTo(integralBlock, integral));
+
+    // Large values next to float noise (15 decimals) in one column: at the finest
+    // scale 65000·1e15 overflows int64, so the column gets fewer decimals
+    const std::vector<AggTrade> mixed = {
+        {1, 5, 65000.0,     1.0 / 3.0, false},
+        {2, 6, 0.1 + 0.2,   1.0e5,     true},
+    };
+    const std::string mixedBlock = encodeTickBlock(mixed);
+    CHECK(static_cast<uint8_t>(mixedBlock[4]) == 11);     // 65000·1e11 < 9e15
+    CHECK(static_cast<uint8_t>(mixedBlock[5]) == 10);     // 1e5·1e10 < 9e15
+    TickBlockCursor mixedCursor(mixedBlock);
+    AggTrade m;
+    CHECK(mixedCursor.valid() && mixedCursor.next(m));
+    CHECK(m.price == 65000.0 && near(m.qty, 1.0 / 3.0));
+    CHECK(mixedCursor.next(m));
+    CHECK(near(m.price, 0.3) && m.qty == 1.0e5);
+
+    const std::string empty = encodeTickBlock({});
+    CHECK(empty.size() == TICK_BLOCK_HEADER + 1 + TICK_BLOCK_TRAILER);
+    CHECK(decodesTo(empty, {}));
+}
+
+/**************************************************************************************
+ * Purpose : A block whose bytes no longer match its checksum (body, header or trailer
+ *           changed), a wrong magic or a truncated block is refused; the store skips
+ *           such a block and keeps reading the other days.
+ **************************************************************************************/
+static void testCorruption(const fs::path& root)
+{
+    const std::vector<AggTrade> trades = {
+        {1, DAY1_MS, 10.5, 1.0, false}, {2, DAY1_MS + 10, 10.25, 2.0, true}, {3, DAY1_MS + 20, 10.75, 0.5, false}
+    };
+    const std::string block = encodeTickBlock(trades);
+    CHECK(TickBlockCursor(block).valid());
+
+    std::string body = block;
+    body[TICK_BLOCK_HEADER + 3] ^= 0x01;
+    CHECK(!TickBlockCursor(body).valid());
+
+    std::string header = block;
+    header[4] = static_cast<char>(header[4] + 1);       // Other price scale
+    CHECK(!TickBlockCursor(header).valid());
+
+    std::string trailer = block;
+    trailer.back() ^= 0x40;
+    CHECK(!TickBlockCursor(trailer).valid());
+
+    std::string magic = block;
+    magic[3] = '2';
+    CHECK(!TickBlockCursor(magic).valid());
+
+    CHECK(!TickBlockCursor(std::string_view(block).substr(0, block.size() - 1)).valid());
+    CHECK(!TickBlockCursor(std::string_view(block).substr(0, TICK_BLOCK_HEADER)).valid());
+
+    TickStore store(root);
+    CHECK(store.write("BADUSDT", 20240101, trades) == block.size());
+    CHECK(store.write("BADUSDT", 20240102, trades) > 0);
+
+    // Corrupt the first day on disk
+    {
+        std::string content;
+        CHECK(readFile(store.blockPath("BADUSDT", 20240101), content));
+        content[TICK_BLOCK_HEADER + 1] ^= 0x08;
+        CHECK(writeFileAtomic(store.blockPath("BADUSDT", 20240101), content));
+    }
+
+    std::size_t seen = 0;
+    CHECK(store.forEachTrade("BADUSDT", 20240101, 20240102, [&](const AggTrade&) { ++seen; }) == trades.size());
+    CHECK(seen == trades.size());
+}
+
+/**************************************************************************************
+ * Purpose : Candles rebuilt from the store: OHLC follow trade order, volumes are split
+ *           by taker side, buckets and days without trades are not emitted, the day
+ *           range bounds the read, and a daily candle spans the whole UTC day.
+ **************************************************************************************/
+static void testCandles(const fs::path& root)
+{
+    TickStore store(root);
+
+    // Day 1: hour 0 and hour 2 traded, hour 1 empty. Day 2: no block. Day 3: one hour.
+    const std::vector<AggTrade> day1 = {
+        {1, DAY1_MS + 1000,               100.0, 0.5,  false},   // Taker buy
+        {2, DAY1_MS + 2000,               101.5, 1.25, true},    // Taker sell
+        {3, DAY1_MS + 3000,               99.0,  2.0,  false},   // Taker buy
+        {4, DAY1_MS + 2 * HOUR_MS + 10,   98.0,  1.0,  true},
+        {5, DAY1_MS + 2 * HOUR_MS + 20,   98.5,  3.0,  true},
+    };
+    const std::vector<AggTrade> day3 = {
+        {9,  DAY1_MS + 2 * DAY_MS + 5 * HOUR_MS,       97.0, 4.0, false},
+        {10, DAY1_MS + 2 * DAY_MS + 5 * HOUR_MS + 500, 96.0, 1.0, false},
+    };
+    CHECK(store.write("TSTUSDT", 20240101, day1) > 0);
+    CHECK(store.write("TSTUSDT", 20240103, day3) > 0);
+    CHECK((store.days("TSTUSDT") == std::vector<unsigned int>{20240101, 20240103}));
+
+    const auto hourly = store.candles("TSTUSDT", 20240101, 20240103, std::chrono::hours(1));
+    CHECK(hourly.size() == 3);
+    if (hourly.size() == 3)
+    {
+        const OHLCV& h0 = hourly[0].bar;
+        CHECK(hourly[0].openTimeMs == DAY1_MS);
+        CHECK(h0.open == 100.0 && h0.high == 101.5 && h0.low == 99.0 && h0.close == 99.0);
+        CHECK(near(h0.volume, 3.75));
+        CHECK(near(h0.quoteVolume, 0.5 * 100.0 + 1.25 * 101.5 + 2.0 * 99.0));
+        CHECK(h0.trades == 3.0);
+        CHECK(near(h0.takerBuyVolume, 2.5));
+        CHECK(near(h0.takerBuyQuoteVolume, 0.5 * 100.0 + 2.0 * 99.0));
+
+        // Only taker sells: no taker buy volume
+        const OHLCV& h2 = hourly[1].bar;
+        CHECK(hourly[1].openTimeMs == DAY1_MS + 2 * HOUR_MS);
+        CHECK(h2.open == 98.0 && h2.high == 98.5 && h2.low == 98.0 && h2.close == 98.5);
+        CHECK(near(h2.volume, 4.0) && h2.trades == 2.0);
+        CHECK(h2.takerBuyVolume == 0.0 && h2.takerBuyQuoteVolume == 0.0);
+
+        // Only taker buys: all of the volume
+        const OHLCV& h5 = hourly[2].bar;
+        CHECK(hourly[2].openTimeMs == DAY1_MS + 2 * DAY_MS + 5 * HOUR_MS);
+        CHECK(near(h5.takerBuyVolume, h5.volume) && near(h5.takerBuyQuoteVolume, h5.quoteVolume));
+    }
+
+    const auto daily = store.candles("TSTUSDT", 20240101, 20240103, std::chrono::hours(24));
+    CHECK(daily.size() == 2);
+    if (daily.size() == 2)
+    {
+        CHECK(daily[0].openTimeMs == DAY1_MS && daily[1].openTimeMs == DAY1_MS + 2 * DAY_MS);
+        CHECK(daily[0].bar.open == 100.0 && daily[0].bar.close == 98.5);
+        CHECK(daily[0].bar.high == 101.5 && daily[0].bar.low == 98.0);
+        CHECK(daily[0].bar.trades == 5.0);
+        CHECK(near(daily[0].bar.volume, 7.75) && near(daily[0].bar.takerBuyVolume, 2.5));
+    }
+
+    CHECK(store.candles("TSTUSDT", 20240102, 20240102, std::chrono::hours(1)).empty());
+    CHECK(store.candles("TSTUSDT", 20240103, 20240131, std::chrono::hours(1)).size() == 1);
+    CHECK(store.candles("NONEUSDT", 20240101, 20240131, std::chrono::hours(1)).empty());
+}
+
+int main()
+{
+    Logger::Instance().Setup(false, true, "", "", false);
+
+    const fs::path root = fs::temp_directory_path() / fs::unique_path("tick_store_%%%%%%");
+    fs::create_directories(root);
+
+    testRoundTrip();
+    testCorruption(root);
+    testCandles(root);
+
+    fs::remove_all(root);
+    return testResult();
+}
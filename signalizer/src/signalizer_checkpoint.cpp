@@ -0,0 +1,198 @@
+#include "signalizer_engine.h"
+#include "binary_io.h"
+#include "logger.h"
+#include "time_utils.h"
+
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+/***********************************************
+ * Checkpoint file framing:
+ *   uint64 magic | uint32 format | uint64 fingerprint
+ *   uint64 payload size | uint64 payload FNV-1a
+ *   payload
+ ***********************************************/
+static constexpr uint64_t CHECKPOINT_MAGIC          = 0x54504B434F474C41ULL;   // "ALGOCKPT"
+static constexpr uint32_t CHECKPOINT_FORMAT_VERSION = 3;
+static constexpr std::size_t CHECKPOINT_HEADER_SIZE =
+    sizeof(uint64_t) + sizeof(uint32_t) + 3 * sizeof(uint64_t);
+
+/**************************************************************************************
+ * Purpose : Fingerprint of the configuration fields the saved state depends on. A
+ *           checkpoint written with other strategies or commissions is not restored.
+ * Args    : config - Active signalizer configuration.
+ * Return  : uint64_t - FNV-1a hash of strategies and commissions.
+ **************************************************************************************/
+static uint64_t configFingerprint(const SignalizerConfig& config)
+{
+    std::string key = fmt::format("{}|{}|{}",
+                                  fmt::join(config.GetStrategies(), ","),
+                                  config.GetCommissionEntryPctg(),
+                                  config.GetCommissionExitPctg());
+    return fnv1a64(key);
+}
+
+
+/**************************************************************************************
+ * Purpose : Writes the complete live state (watermarks, trade id counter, indicator
+ *           state per pair, and per strategy its portfolio, internal state and open
+ *           trades) to checkpoint_path. Written atomically, so a crash mid-write keeps
+ *           the previous checkpoint.
+ * Args    : None
+ * Return  : bool - true on success (or if checkpoints are disabled).
+ **************************************************************************************/
+bool SignalEngine::saveCheckpoint()
+{
+    const boost::filesystem::path& path = config_.GetCheckpointPath();
+    if (path.empty())
+        return true;
+
+    BinaryWriter payload;
+    payload.write(lastProcessedDate_);
+    payload.write(lastVersion_);
+    payload.write(last_trade_id_);
+
+    payload.write(static_cast<uint64_t>(indicators_.size()));
+    for (const auto& [pair, state] : indicators_)
+    {
+        payload.writeString(pair);
+        payload.write(state);
+    }
+
+    payload.write(static_cast<uint64_t>(strategies_.size()));
+    for (const auto& slot : strategies_)
+    {
+        payload.writeString(slot.name);
+        slot.portfolio->saveState(payload);
+
+        BinaryWriter strategyState;
+        slot.strategy->saveState(strategyState);
+        payload.writeString(strategyState.data());
+
+        payload.write(static_cast<uint64_t>(slot.current_trades.size()));
+        for (const auto& trade : slot.current_trades)
+            writeTrade(payload, trade);
+    }
+
+    BinaryWriter file;
+    file.write(CHECKPOINT_MAGIC);
+    file.write(CHECKPOINT_FORMAT_VERSION);
+    file.write(configFingerprint(config_));
+    file.write(static_cast<uint64_t>(payload.data().size()));
+    file.write(fnv1a64(payload.data()));
+
+    std::string content = file.data();
+    content += payload.data();
+
+    if (!writeFileAtomic(path, content))
+    {
+        LG_ERROR("Failed to write checkpoint {}", path.string());
+        return false;
+    }
+
+    LG_DEBUG("Checkpoint written at {} ({} bytes)", lastProcessedDate_, content.size());
+    return true;
+}
+
+
+/**************************************************************************************
+ * Purpose : Restores the live state from checkpoint_path so a restart resumes right
+ *           after the last processed bar, without replaying history. The checkpoint is
+ *           ignored (normal warm-up) if it is missing, corrupted, written by another
+ *           format or configuration, or newer than the market database.
+ * Args    : latestDate - Latest date stored in the market database (YYYYMMDD).
+ * Return  : bool - true if the state was restored.
+ **************************************************************************************/
+bool SignalEngine::restoreCheckpoint(int latestDate)
+{
+    const boost::filesystem::path& path = config_.GetCheckpointPath();
+    if (path.empty())
+        return false;
+
+    std::string content;
+    if (!readFile(path, content))
+    {
+        LG_INFO("No checkpoint at {}, warming up from history", path.string());
+        return false;
+    }
+
+    try {
+        BinaryReader header(std::string_view(content).substr(0, CHECKPOINT_HEADER_SIZE));
+        if (header.read<uint64_t>() != CHECKPOINT_MAGIC)
+            throw std::runtime_error("bad magic");
+        if (const uint32_t format = header.read<uint32_t>(); format != CHECKPOINT_FORMAT_VERSION)
+            throw std::runtime_error(fmt::format("unsupported format {}", format));
+        if (header.read<uint64_t>() != configFingerprint(config_))
+            throw std::runtime_error("written with another strategy configuration");
+
+        const uint64_t size     = header.read<uint64_t>();
+        const uint64_t checksum = header.read<uint64_t>();
+
+        const std::string_view body = std::string_view(content).substr(CHECKPOINT_HEADER_SIZE);
+        if (body.size() != size || fnv1a64(body) != checksum)
+            throw std::runtime_error("checksum mismatch");
+
+        BinaryReader in(body);
+
+        const int       date    = in.read<int>();
+        const long long version = in.read<long long>();
+        const TradeID   tradeId = in.read<TradeID>();
+
+        if (date > latestDate)
+            throw std::runtime_error(fmt::format("checkpoint date {} is after latest stored date {}",
+                                                 date, latestDate));
+
+        std::map<Coin, IndicatorState> indicators;
+        const uint64_t nIndicators = in.read<uint64_t>();
+        for (uint64_t i = 0; i < nIndicators; ++i)
+        {
+            Coin pair = in.readString();
+            indicators.emplace(std::move(pair), in.read<IndicatorState>());
+        }
+
+        const uint64_t nSlots = in.read<uint64_t>();
+        if (nSlots != strategies_.size())
+            throw std::runtime_error("strategy count mismatch");
+
+        for (auto& slot : strategies_)
+        {
+            if (in.readString() != slot.name)
+                throw std::runtime_error("strategy order mismatch");
+
+            slot.portfolio->loadState(in);
+
+            const std::string strategyState = in.readString();
+            BinaryReader strategyIn(strategyState);
+            slot.strategy->loadState(strategyIn);
+
+            slot.current_trades.clear();
+            const uint64_t nTrades = in.read<uint64_t>();
+            for (uint64_t i = 0; i < nTrades; ++i)
+                slot.current_trades.push_back(readTrade(in));
+        }
+
+        if (!in.atEnd())
+            throw std::runtime_error("trailing data");
+
+        indicators_        = std::move(indicators);
+        lastProcessedDate_ = date;
+        lastVersion_       = version;
+        last_trade_id_     = std::max(last_trade_id_, tradeId);
+    }
+    catch (const std::exception& e) {
+        LG_WARN("Checkpoint {} ignored: {}", path.string(), e.what());
+
+        // A partially restored slot must not leak into the normal warm-up
+        for (auto& slot : strategies_)
+        {
+            slot.current_trades.clear();
+            slot.portfolio = std::make_unique<Portfolio>(toYYYYMMDD(getCurrentUtcDate()));
+            slot.strategy  = makeStrategy(slot.name, *slot.portfolio, config_);
+        }
+        return false;
+    }
+
+    LG_INFO("Restored checkpoint at {} (data_version {}): {} pairs, {} strategies",
+            lastProcessedDate_, lastVersion_, indicators_.size(), strategies_.size());
+    return true;
+}
@@ -0,0 +1,102 @@
+#include "signalizer_configdata.h"
+#include <stdexcept>
+
+/**************************************************************************************
+ * Purpose : Extracts signalizer-specific configuration fields from the validated JSON
+ *           object. Ensures required fields exist and contain valid data, otherwise
+ *           throws an exception. Optional fields keep their defaults when absent.
+ * Args    : j - Validated JSON configuration object.
+ * Return  : void
+ **************************************************************************************/
+void SignalizerConfig::ParseConfig(const nlohmann::json& j)
+{
+    // Validate and extract database_path
+    if (!j.contains("database_path") || !j["database_path"].is_string()) {
+        throw std::runtime_error("'database_path' must be a valid file path string");
+    }
+    database_path_ = boost::filesystem::path(j["database_path"].get<std::string>());
+
+    // Validate and extract signals_path
+    if (!j.contains("signals_path") || !j["signals_path"].is_string()) {
+        throw std::runtime_error("'signals_path' must be a valid file path string");
+    }
+    signals_path_ = boost::filesystem::path(j["signals_path"].get<std::string>());
+
+    // Validate and extract strategies
+    if (!j.contains("strategies") || !j["strategies"].is_array()) {
+        throw std::runtime_error("'strategies' must be an array of strategy names");
+    }
+    strategies_ = j["strategies"].get<std::vector<std::string>>();
+    if (strategies_.empty()) {
+        throw std::runtime_error("'strategies' cannot be empty");
+    }
+
+    // Optional fields
+    checkpoint_path_.clear();
+    if (j.contains("checkpoint_path"))
+        checkpoint_path_ = boost::filesystem::path(j["checkpoint_path"].get<std::string>());
+
+    notify_socket_.clear();
+    if (j.contains("notify_socket"))
+        notify_socket_ = j["notify_socket"].get<std::string>();
+
+    market_bus_name_.clear();
+    if (j.contains("market_bus_name"))
+        market_bus_name_ = j["market_bus_name"].get<std::string>();
+
+    if (j.contains("lookback_days")) {
+        lookback_days_ = j["lookback_days"].get<int>();
+        if (lookback_days_ < 1) {
+            throw std::runtime_error("'lookback_days' must be >= 1");
+        }
+    }
+
+    if (j.contains("commission_entry_pctg"))
+        commission_entry_pctg_ = j["commission_entry_pctg"].get<double>();
+
+    if (j.contains("commission_exit_pctg"))
+        commission_exit_pctg_ = j["commission_exit_pctg"].get<double>();
+}
+
+
+/**************************************************************************************
+ * Purpose : Compares this configuration with another configuration object to check
+ *           whether they contain identical values. Used by ConfigHandler to determine
+ *           whether an update is necessary.
+ * Args    : other - Another SignalizerConfig instance to compare with.
+ * Return  : bool - true if both instances contain the same configuration values.
+ **************************************************************************************/
+bool SignalizerConfig::operator==(const SignalizerConfig& other) const noexcept
+{
+    return database_path_ == other.database_path_ &&
+           signals_path_ == other.signals_path_ &&
+           strategies_ == other.strategies_ &&
+           checkpoint_path_ == other.checkpoint_path_ &&
+           notify_socket_ == other.notify_socket_ &&
+           market_bus_name_ == other.market_bus_name_ &&
+           lookback_days_ == other.lookback_days_ &&
+           commission_entry_pctg_ == other.commission_entry_pctg_ &&
+           commission_exit_pctg_ == other.commission_exit_pctg_;
+}
+
+
+/**************************************************************************************
+ * Purpose : Serializes the configuration fields into a JSON object. Useful for logging,
+ *           debugging, or exporting the currently active configuration.
+ * Args    : None
+ * Return  : nlohmann::json - JSON object containing all configuration fields.
+ **************************************************************************************/
+nlohmann::json SignalizerConfig::ToJson() const
+{
+    return nlohmann::json{
+        {"database_path", database_path_.string()},
+        {"signals_path", signals_path_.string()},
+        {"strategies", strategies_},
+        {"checkpoint_path", checkpoint_path_.string()},
+        {"notify_socket", notify_socket_},
+        {"market_bus_name", market_bus_name_},
+        {"lookback_days", lookback_days_},
+        {"commission_entry_pctg", commission_entry_pctg_},
+        {"commission_exit_pctg", commission_exit_pctg_}
+    };
+}
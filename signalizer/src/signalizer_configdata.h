@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <nlohmann/json.hpp>
+
+#include "config_data.h"
+
+/**************************************************************************************
+ * Purpose : Represents the signalizer configuration used by the application. Loaded
+ *           and validated via ConfigData::LoadFromFile(), then parsed through
+ *           ParseConfig(). The class provides comparison, serialization, and accessors.
+ **************************************************************************************/
+class SignalizerConfig : public ConfigData {
+public:
+    SignalizerConfig() = default;
+
+    /**************************************************************************************
+     * Purpose : Parses the validated JSON configuration and extracts all required fields
+     *           for signal generation (database paths, strategies, commissions...).
+     * Args    : j - Validated JSON configuration object.
+     * Return  : void
+     **************************************************************************************/
+    void ParseConfig(const nlohmann::json& j) override;
+
+    /**************************************************************************************
+     * Purpose : Compares this configuration with another to determine whether all fields
+     *           are identical. Used to avoid unnecessary reloads when the config file
+     *           content has not truly changed.
+     * Args    : other - Configuration to compare with.
+     * Return  : bool - true if both configs contain the same values.
+     **************************************************************************************/
+    bool operator==(const SignalizerConfig& other) const noexcept;
+
+    /**************************************************************************************
+     * Purpose : Serializes the configuration back into JSON. Useful for logging the
+     *           active configuration or exporting it for diagnostics.
+     * Args    : None
+     * Return  : nlohmann::json - JSON representation of this configuration.
+     **************************************************************************************/
+    nlohmann::json ToJson() const;
+
+private:
+    // Filesystem path of the market database written by the database service.
+    boost::filesystem::path database_path_;
+
+    // Filesystem path of the SQLite file where emitted signals are stored.
+    boost::filesystem::path signals_path_;
+
+    // Names of the strategies to run (e.g., "high_breakout").
+    std::vector<std::string> strategies_;
+
+    // Binary checkpoint of the live state rewritten after each processed bar (optional).
+    boost::filesystem::path checkpoint_path_;
+
+    // Unix datagram socket where "day committed" notifications are received (optional).
+    std::string notify_socket_;
+
+    // POSIX shared memory name of the market data bus (optional, empty = SQLite only).
+    std::string market_bus_name_;
+
+    // Days of history loaded per symbol to warm up indicators at startup.
+    int lookback_days_ = 60;
+
+    // Commission percentages passed to every strategy.
+    double commission_entry_pctg_ = 0.0;
+    double commission_exit_pctg_  = 0.0;
+
+public:
+    // Returns the filesystem path of the market database.
+    const boost::filesystem::path GetDatabasePath() const noexcept { return database_path_; }
+
+    // Returns the filesystem path of the signals database.
+    const boost::filesystem::path GetSignalsPath() const noexcept { return signals_path_; }
+
+    // Returns the checkpoint file path (empty = checkpoints disabled).
+    const boost::filesystem::path& GetCheckpointPath() const noexcept { return checkpoint_path_; }
+
+    // Returns the configured strategy names.
+    const std::vector<std::string>& GetStrategies() const noexcept { return strategies_; }
+
+    // Returns the notification socket path (empty = poll only).
+    const std::string& GetNotifySocket() const noexcept { return notify_socket_; }
+
+    // Returns the market data bus shared memory name (empty = SQLite only).
+    const std::string& GetMarketBusName() const noexcept { return market_bus_name_; }
+
+    // Returns the warm-up window in days.
+    int GetLookbackDays() const noexcept { return lookback_days_; }
+
+    // Returns the entry commission percentage.
+    double GetCommissionEntryPctg() const noexcept { return commission_entry_pctg_; }
+
+    // Returns the exit commission percentage.
+    double GetCommissionExitPctg() const noexcept { return commission_exit_pctg_; }
+};
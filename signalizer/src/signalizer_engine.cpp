@@ -0,0 +1,716 @@
+#include "signalizer_engine.h"
+#include "logger.h"
+#include "time_utils.h"
+#include "strategy_high_breakout.h"
+
+#include <cmath>
+
+static const char* directionToString(Direction dir)
+{
+    switch (dir) {
+        case Direction::Long:  return "LONG";
+        case Direction::Short: return "SHORT";
+        default:               return "FLAT";
+    }
+}
+
+/**************************************************************************************
+ * Purpose : Creates a strategy instance from its configured name.
+ * Args    : name   - Strategy name (e.g., "high_breakout").
+ *           portfolio - Portfolio the strategy sizes its positions against.
+ *           config - Active signalizer configuration (commissions...).
+ * Return  : std::unique_ptr<Strategy> - nullptr if the name is unknown.
+ **************************************************************************************/
+std::unique_ptr<Strategy> makeStrategy(const std::string& name,
+                                       Portfolio& portfolio,
+                                       const SignalizerConfig& config)
+{
+    if (name == "high_breakout")
+        return std::make_unique<StrategyHighBreakout>(
+            portfolio, config.GetCommissionEntryPctg(), config.GetCommissionExitPctg());
+
+    return nullptr;
+}
+
+
+/**************************************************************************************
+ * Purpose : Constructs the SignalEngine and registers every configured strategy, each
+ *           with its own portfolio.
+ * Args    : config - Active signalizer configuration.
+ * Return  : None
+ **************************************************************************************/
+SignalEngine::SignalEngine(const SignalizerConfig& config)
+    : config_(config)
+{
+    for (const auto& name : config_.GetStrategies())
+    {
+        StrategySlot slot;
+        slot.name      = name;
+        slot.portfolio = std::make_unique<Portfolio>(toYYYYMMDD(getCurrentUtcDate()));
+        slot.strategy  = makeStrategy(name, *slot.portfolio, config_);
+
+        if (!slot.strategy) {
+            LG_ERROR("Unknown strategy '{}' — skipped", name);
+            continue;
+        }
+
+        LG_INFO("Registered strategy '{}'", name);
+        strategies_.push_back(std::move(slot));
+    }
+}
+
+SignalEngine::~SignalEngine()
+{
+    if (signalsDb_) sqlite3_close(signalsDb_);
+}
+
+
+/**************************************************************************************
+ * Purpose : Opens the market database read-only and the signals database read-write,
+ *           creating the signals table if needed.
+ * Args    : None
+ * Return  : bool - true if both handles are ready.
+ **************************************************************************************/
+bool SignalEngine::openDatabases()
+{
+    if (!db_.isOpen())
+    {
+        if (!db_.open(config_.GetDatabasePath(), SQLITE_OPEN_READONLY))
+        {
+            LG_ERROR("SQLite failed to open market DB {}: {}", config_.GetDatabasePath().string(), db_.errmsg());
+            return false;
+        }
+        // The database service may be writing at the same time
+        db_.setBusyTimeout(5000);
+    }
+
+    // Shards added by the database service since the last tick (a stat otherwise)
+    if (!shardView_.refresh(config_.GetDatabasePath()))
+        return false;
+
+    if (!signalsDb_)
+    {
+        const boost::filesystem::path& path = config_.GetSignalsPath();
+        if (!path.parent_path().empty() &&
+            !boost::filesystem::exists(path.parent_path()))
+        {
+            boost::filesystem::create_directories(path.parent_path());
+        }
+
+        if (sqlite3_open(path.string().c_str(), &signalsDb_) != SQLITE_OK)
+        {
+            LG_ERROR("SQLite failed to open signals DB: {}", sqlite3_errmsg(signalsDb_));
+            sqlite3_close(signalsDb_);
+            signalsDb_ = nullptr;
+            return false;
+        }
+
+        const char* sql =
+            "CREATE TABLE IF NOT EXISTS signals ("
+            "   strategy  TEXT NOT NULL,"
+            "   date      INTEGER NOT NULL,"
+            "   pair      TEXT NOT NULL,"
+            "   action    TEXT NOT NULL,"
+            "   direction TEXT,"
+            "   price     REAL,"
+            "   stop      REAL,"
+            "   size      REAL,"
+            "   emitted_at TEXT,"
+            "   PRIMARY KEY(strategy, date, pair, action)"
+            ");";
+
+        char* errMsg = nullptr;
+        if (sqlite3_exec(signalsDb_, sql, nullptr, nullptr, &errMsg) != SQLITE_OK)
+        {
+            LG_ERROR("Signals schema creation failed: {}", errMsg);
+            sqlite3_free(errMsg);
+            sqlite3_close(signalsDb_);
+            signalsDb_ = nullptr;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/**************************************************************************************
+ * Purpose : Checks PRAGMA data_version to detect commits done by the database service.
+ *           The pragma is answered from the connection state, so polling it every tick
+ *           costs microseconds.
+ * Args    : None
+ * Return  : bool - true if the database changed since the last call.
+ **************************************************************************************/
+bool SignalEngine::hasNewCommit()
+{
+    long long version = dataVersion_;
+    {
+        CachedStatement stmt = db_.cached("PRAGMA data_version;");
+        if (!stmt)
+        {
+            LG_ERROR("Prepare data_version failed: {}", db_.errmsg());
+            return false;
+        }
+
+        if (sqlite3_step(stmt) == SQLITE_ROW)
+            version = sqlite3_column_int64(stmt, 0);
+    }
+
+    if (version == dataVersion_)
+        return false;
+
+    dataVersion_ = version;
+    return true;
+}
+
+
+/**************************************************************************************
+ * Purpose : Returns the latest date stored in ohlcv_data. A sharded table is read pass
+ *           by pass from the most recent one, older passes only while nothing is found.
+ * Args    : None
+ * Return  : int - Latest YYYYMMDD, or 0 if the table is empty or on error.
+ **************************************************************************************/
+int SignalEngine::queryLatestDate()
+{
+    const auto passes = shardView_.passes({});
+    for (auto pass = passes.rbegin(); pass != passes.rend(); ++pass)
+    {
+        if (!shardView_.attach(db_, {}, pass->first, pass->second))
+            return 0;
+        if (const int latest = market_.latestDate())
+            return latest;
+    }
+    return 0;
+}
+
+
+/**************************************************************************************
+ * Purpose : Returns the latest data_version watermark written by the database service.
+ * Args    : None
+ * Return  : long long - Latest version, or 0 if none (or older DB without the table).
+ **************************************************************************************/
+long long SignalEngine::queryLatestVersion()
+{
+    CachedStatement stmt = db_.cached("SELECT MAX(version) FROM data_version;");
+    if (!stmt)
+    {
+        LG_DEBUG("data_version not available: {}", db_.errmsg());
+        return 0;
+    }
+
+    long long version = 0;
+    if (sqlite3_step(stmt) == SQLITE_ROW)
+        version = sqlite3_column_int64(stmt, 0);
+
+    return version;
+}
+
+
+/**************************************************************************************
+ * Purpose : Reads the data_changes rows committed after a watermark.
+ * Args    : version - Exclusive lower bound on data_version.
+ * Return  : std::vector<ChangedRange> - Changed pair/date ranges.
+ **************************************************************************************/
+std::vector<ChangedRange> SignalEngine::loadChangesSince(long long version)
+{
+    std::vector<ChangedRange> result;
+
+    CachedStatement stmt = db_.cached(
+        "SELECT pair, MIN(first_date), MAX(last_date) FROM data_changes "
+        "WHERE version > ? GROUP BY pair;");
+    if (!stmt)
+    {
+        LG_DEBUG("data_changes not available: {}", db_.errmsg());
+        return result;
+    }
+
+    sqlite3_bind_int64(stmt, 1, version);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        const char* pair_c = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        if (!pair_c) continue;
+
+        result.push_back({pair_c, sqlite3_column_int(stmt, 1), sqlite3_column_int(stmt, 2)});
+    }
+
+    return result;
+}
+
+
+/**************************************************************************************
+ * Purpose : Re-warms only the pairs whose already-processed history was rewritten by
+ *           commits after lastVersion_ (backfills, gap repairs). A regular daily commit
+ *           only touches dates after lastProcessedDate_ and invalidates nothing.
+ * Args    : None
+ * Return  : void
+ **************************************************************************************/
+void SignalEngine::invalidateChangedPairs()
+{
+    const long long latestVersion = queryLatestVersion();
+    if (latestVersion <= lastVersion_)
+        return;
+
+    for (const auto& change : loadChangesSince(lastVersion_))
+    {
+        if (change.firstDate > lastProcessedDate_ || !indicators_.contains(change.pair))
+            continue;
+
+        LG_INFO("[{}] History changed ({} → {}), re-warming indicators",
+                change.pair, change.firstDate, change.lastDate);
+
+        indicators_.erase(change.pair);
+        warmUpPair(change.pair, lastProcessedDate_);
+    }
+
+    lastVersion_ = latestVersion;
+}
+
+
+/**************************************************************************************
+ * Purpose : Loads all candles with fromDate < date <= toDate, grouped by date.
+ * Args    : fromDate - Exclusive lower bound (YYYYMMDD).
+ *           toDate   - Inclusive upper bound (YYYYMMDD).
+ *           pair     - Optional pair filter (empty = all pairs).
+ * Return  : date → (pair → OHLCV), dates in ascending order.
+ **************************************************************************************/
+std::map<int, std::map<Coin, OHLCV>> SignalEngine::loadBars(int fromDate, int toDate,
+                                                            const std::string& pair)
+{
+    std::map<int, std::map<Coin, OHLCV>> result;
+
+    BarQuery query;
+    if (!pair.empty())
+        query.symbols.push_back(pair);
+    query.order = BarOrder::ByDate;
+
+    // Exclusive lower bound on YYYYMMDD integers; sharded tables are read in passes
+    BarColumns batch;
+    for (const auto& [from, to] : shardView_.passes(query.symbols, fromDate + 1, toDate))
+    {
+        if (!shardView_.attach(db_, query.symbols, from, to))
+            break;
+
+        query.from = from;
+        query.to   = to;
+        BarCursor cursor = market_.scan(query);
+        while (cursor.fill(batch) > 0)
+        {
+            for (std::size_t row = 0; row < batch.size(); ++row)
+                result[batch.date[row]][batch.symbolOf(row)] = batch.bar(row);
+        }
+    }
+
+    return result;
+}
+
+
+/**************************************************************************************
+ * Purpose : Maps the market data bus if configured, and re-maps it when the mapping is
+ *           stale:
+ *              - the name resolves to another segment (the database service restarted
+ *                and re-created it, the old mapping never changes again)
+ *              - the mapped snapshot is older than `watermark`
+ *           The database service may start later, so a missing segment is retried on
+ *           later ticks; if re-opening fails, the current mapping is kept.
+ * Args    : watermark - data_version the caller needs (0 = any).
+ * Return  : bool - true if the bus is available.
+ **************************************************************************************/
+bool SignalEngine::attachBus(long long watermark)
+{
+    if (config_.GetMarketBusName().empty())
+        return false;
+
+    bool replaced = false;
+    if (bus_)
+    {
+        replaced = bus_->replaced();
+        if (!replaced && bus_->dataVersion() >= watermark)
+            return true;
+    }
+
+    try {
+        auto bus = std::make_unique<MarketBusReader>(config_.GetMarketBusName());
+        if (!bus_)
+            LG_INFO("Market data bus {} attached", config_.GetMarketBusName());
+        else if (replaced)
+            LG_INFO("Market data bus {} re-created by the writer, re-attached", config_.GetMarketBusName());
+        else
+            LG_DEBUG("Market data bus {} behind data_version {}, re-attached", config_.GetMarketBusName(), watermark);
+        bus_ = std::move(bus);
+    } catch (const std::exception& e) {
+        LG_DEBUG("Market data bus not available: {}", e.what());
+        return bus_ != nullptr;
+    }
+
+    return true;
+}
+
+
+/**************************************************************************************
+ * Purpose : Reads the bars with fromDate < date <= toDate straight from the shared
+ *           columns of the market data bus. The bus is only used if it already holds
+ *           the data_version applied by invalidateChangedPairs(), its window covers
+ *           the whole range and it holds every pair (not truncated to the writer's
+ *           capacity); otherwise the caller falls back to SQLite.
+ * Args    : fromDate - Exclusive lower bound (YYYYMMDD).
+ *           toDate   - Inclusive upper bound (YYYYMMDD).
+ *           out      - date → (pair → OHLCV), filled on success.
+ * Return  : bool - true if the bars were read from the bus.
+ **************************************************************************************/
+bool SignalEngine::loadBarsFromBus(int fromDate, int toDate,
+                                   std::map<int, std::map<Coin, OHLCV>>& out)
+{
+    if (!attachBus(lastVersion_))
+        return false;
+
+    const int firstNeeded = shiftDays(fromDate, 1);
+    bool usable = false;
+    bool truncated = false;
+
+    const bool consistent = bus_->read([&](const MarketBusView& view) {
+        out.clear();
+        truncated = view.truncated();
+        usable = !truncated &&
+                 view.dataVersion() >= lastVersion_ &&
+                 view.latestDate() >= toDate &&
+                 view.nBars() > 0 && view.date(0) <= firstNeeded;
+        if (!usable)
+            return;
+
+        for (uint32_t s = 0; s < view.nSymbols(); ++s)
+        {
+            const double* open   = view.column(BusField::Open, s);
+            const double* high   = view.column(BusField::High, s);
+            const double* low    = view.column(BusField::Low, s);
+            const double* close  = view.column(BusField::Close, s);
+            const double* volume = view.column(BusField::Volume, s);
+            const double* quoteVolume         = view.column(BusField::QuoteVolume, s);
+            const double* trades              = view.column(BusField::Trades, s);
+            const double* takerBuyVolume      = view.column(BusField::TakerBuyVolume, s);
+            const double* takerBuyQuoteVolume = view.column(BusField::TakerBuyQuoteVolume, s);
+
+            for (uint32_t b = 0; b < view.nBars(); ++b)
+            {
+                const int date = view.date(b);
+                if (date <= fromDate || date > toDate || std::isnan(close[b]))
+                    continue;
+
+                out[date][Coin(view.symbol(s))] = OHLCV{open[b], high[b], low[b], close[b], volume[b],
+                                                        quoteVolume[b], trades[b],
+                                                        takerBuyVolume[b], takerBuyQuoteVolume[b]};
+            }
+        }
+    });
+
+    if (consistent && truncated)
+        LG_WARN("Market data bus holds part of the universe only, reading SQLite");
+
+    if (!consistent || !usable)
+    {
+        out.clear();
+        return false;
+    }
+
+    LG_DEBUG("Loaded {} day(s) from the market data bus", out.size());
+    return true;
+}
+
+
+/**************************************************************************************
+ * Purpose : Adopts the indicator state published on the bus (computed by the database
+ *           service over a longer history) instead of replaying the lookback window
+ *           from SQLite. Only used when the bus matches the latest stored date and
+ *           data_version and holds every pair.
+ * Args    : latestDate - Last stored date (YYYYMMDD).
+ * Return  : bool - true if indicators were seeded from the bus.
+ **************************************************************************************/
+bool SignalEngine::warmUpFromBus(int latestDate)
+{
+    const long long latestVersion = queryLatestVersion();
+    if (!attachBus(latestVersion))
+        return false;
+    std::map<Coin, IndicatorState> states;
+    bool usable = false;
+    bool truncated = false;
+
+    const bool consistent = bus_->read([&](const MarketBusView& view) {
+        states.clear();
+        truncated = view.truncated();
+        usable = !truncated && view.latestDate() == latestDate && view.dataVersion() == latestVersion;
+        if (!usable)
+            return;
+
+        for (uint32_t s = 0; s < view.nSymbols(); ++s)
+            states.emplace(Coin(view.symbol(s)), view.indicatorState(s));
+    });
+
+    if (consistent && truncated)
+        LG_WARN("Market data bus holds part of the universe only, warming up from SQLite");
+
+    if (!consistent || !usable)
+        return false;
+
+    indicators_        = std::move(states);
+    lastProcessedDate_ = latestDate;
+    lastVersion_       = latestVersion;
+
+    LG_INFO("Warm-up from market data bus: {} pairs up to {}", indicators_.size(), latestDate);
+    return true;
+}
+
+
+/**************************************************************************************
+ * Purpose : Seeds indicator state with the lookback window ending at latestDate.
+ *           Strategies are not run during warm-up: signals are only emitted for days
+ *           committed while the service is running.
+ * Args    : latestDate - Last stored date (YYYYMMDD).
+ * Return  : void
+ **************************************************************************************/
+void SignalEngine::warmUp(int latestDate)
+{
+    const int fromDate = shiftDays(latestDate, -config_.GetLookbackDays());
+
+    auto window = loadBars(fromDate, latestDate);
+    for (const auto& [date, candles] : window)
+    {
+        for (const auto& [pair, candle] : candles)
+            indicators_[pair].update(candle);
+    }
+
+    lastProcessedDate_ = latestDate;
+    lastVersion_ = queryLatestVersion();
+
+    LG_INFO("Warm-up complete: {} pairs, {} days ({} → {})",
+            indicators_.size(), window.size(), fromDate, latestDate);
+}
+
+
+/**************************************************************************************
+ * Purpose : Seeds indicator state of a pair first seen after warm-up (e.g., a newly
+ *           tracked pair backfilled by the database service) up to toDate.
+ * Args    : pair   - Pair symbol.
+ *           toDate - Inclusive upper bound (YYYYMMDD).
+ * Return  : void
+ **************************************************************************************/
+void SignalEngine::warmUpPair(const Coin& pair, int toDate)
+{
+    const int fromDate = shiftDays(toDate, -config_.GetLookbackDays());
+
+    IndicatorState& state = indicators_[pair];
+    for (const auto& [date, candles] : loadBars(fromDate, toDate, pair))
+    {
+        auto it = candles.find(pair);
+        if (it != candles.end())
+            state.update(it->second);
+    }
+
+    LG_INFO("[{}] New pair warmed up ({} bars)", pair, state.barNumber());
+}
+
+
+/**************************************************************************************
+ * Purpose : Advances indicators by one bar and runs every strategy on it. Exits are
+ *           detected on trades flagged exited_ during this bar, entries on trades
+ *           appended by the strategy.
+ * Args    : date    - Bar date (YYYYMMDD).
+ *           candles - pair → OHLCV for that date.
+ * Return  : std::vector<Signal> - Signals emitted for this bar.
+ **************************************************************************************/
+std::vector<Signal> SignalEngine::processBar(Timestamp date, const std::map<Coin, OHLCV>& candles)
+{
+    std::vector<Signal> signals;
+
+    CoinBarMap bars;
+    for (const auto& [pair, candle] : candles)
+        bars.emplace(pair, indicators_[pair].update(candle));
+
+    for (auto& slot : strategies_)
+    {
+        const std::size_t before = slot.current_trades.size();
+
+        slot.strategy->calculateSignals(slot.current_trades, bars, date);
+
+        for (std::size_t i = 0; i < slot.current_trades.size(); ++i)
+        {
+            const Trade& t = slot.current_trades[i];
+            const bool isEntry = i >= before;
+
+            if (!isEntry && !t.exited_)
+                continue;
+
+            Signal s;
+            s.strategy  = slot.name;
+            s.date      = date;
+            s.coin      = t.coin_;
+            s.action    = isEntry ? "ENTRY" : "EXIT";
+            s.direction = t.direction_;
+            s.price     = isEntry ? t.entry_ : t.exit_;
+            s.stop      = t.sl_;
+            s.size      = t.size_;
+            signals.push_back(std::move(s));
+        }
+
+        // Closes exited trades and updates balance/equity
+        slot.portfolio->updatePortfolio(slot.current_trades, date);
+    }
+
+    return signals;
+}
+
+
+/**************************************************************************************
+ * Purpose : Stores the signals into the signals table in a single transaction. Uses
+ *           INSERT OR REPLACE so re-processing the same bar is idempotent.
+ * Args    : signals - Signals to persist.
+ * Return  : bool - true on success.
+ **************************************************************************************/
+bool SignalEngine::storeSignals(const std::vector<Signal>& signals)
+{
+    if (signals.empty())
+        return true;
+
+    const char* sql =
+        "INSERT OR REPLACE INTO signals "
+        "(strategy, date, pair, action, direction, price, stop, size, emitted_at) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, strftime('%Y-%m-%d %H:%M:%f', 'now'));";
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(signalsDb_, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        LG_ERROR("SQLite prepare failed: {}", sqlite3_errmsg(signalsDb_));
+        return false;
+    }
+
+    sqlite3_exec(signalsDb_, "BEGIN;", nullptr, nullptr, nullptr);
+
+    for (const auto& s : signals)
+    {
+        sqlite3_bind_text(stmt, 1, s.strategy.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, s.date);
+        sqlite3_bind_text(stmt, 3, s.coin.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 4, s.action.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 5, directionToString(s.direction), -1, SQLITE_STATIC);
+        sqlite3_bind_double(stmt, 6, s.price);
+        sqlite3_bind_double(stmt, 7, s.stop);
+        sqlite3_bind_double(stmt, 8, s.size);
+
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+        {
+            LG_ERROR("Insert signal failed: {}", sqlite3_errmsg(signalsDb_));
+            sqlite3_finalize(stmt);
+            sqlite3_exec(signalsDb_, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return false;
+        }
+
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+
+    sqlite3_finalize(stmt);
+
+    if (sqlite3_exec(signalsDb_, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        LG_ERROR("Commit signals failed: {}", sqlite3_errmsg(signalsDb_));
+        sqlite3_exec(signalsDb_, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    }
+
+    return true;
+}
+
+
+/**************************************************************************************
+ * Purpose : Main function invoked every tick by SignalizerScheduler:
+ *              - Opening the databases (retried until the market DB exists)
+ *              - Checking PRAGMA data_version for a new commit
+ *              - Restoring the last checkpoint on the first run, or else warming up
+ *                indicators (from the market data bus when available, otherwise SQLite)
+ *              - Re-warming only pairs whose history changed (data_changes)
+ *              - Loading only the bars newer than the last processed date, from the
+ *                market data bus when it covers them
+ *              - Loading the funding rates of those bars for the portfolios
+ *              - Running every strategy on each new bar, in date order
+ *              - Storing and logging the emitted signals, then checkpointing the state
+ *
+ * Args    : None
+ * Return  : bool - true if at least one new bar was processed.
+ **************************************************************************************/
+bool SignalEngine::processNewData()
+{
+    if (!openDatabases())
+        return false;
+
+    if (!hasNewCommit())
+        return false;
+
+    const int latestDate = queryLatestDate();
+    if (latestDate == 0)
+    {
+        LG_WARN("Market database has no OHLCV rows yet");
+        return false;
+    }
+
+    if (lastProcessedDate_ == 0 && !restoreCheckpoint(latestDate))
+    {
+        if (!warmUpFromBus(latestDate))
+            warmUp(latestDate);
+        saveCheckpoint();
+        return false;
+    }
+
+    // Only pairs whose processed history was rewritten are rebuilt
+    invalidateChangedPairs();
+
+    if (latestDate <= lastProcessedDate_)
+        return false;
+
+    LG_INFO("New data committed: {} → {}", lastProcessedDate_, latestDate);
+
+    // Shared memory first, SQLite if the bus is missing, stale or too short
+    std::map<int, std::map<Coin, OHLCV>> newBars;
+    if (!loadBarsFromBus(lastProcessedDate_, latestDate, newBars))
+        newBars = loadBars(lastProcessedDate_, latestDate);
+
+    // Pairs never seen before need their history before the new bar
+    for (const auto& [date, candles] : newBars)
+    {
+        for (const auto& [pair, _] : candles)
+        {
+            if (!indicators_.contains(pair))
+                warmUpPair(pair, lastProcessedDate_);
+        }
+    }
+
+    // Funding settled over the new bars (stored by the same commit as their candles)
+    if (!newBars.empty())
+        funding_ = FundingSchedule::load(db_, newBars.begin()->first, newBars.rbegin()->first);
+    for (auto& slot : strategies_)
+        slot.portfolio->setFundingSchedule(&funding_);
+
+    // Signals are stored and the state checkpointed bar by bar, so a restart resumes
+    // exactly after the last bar whose signals were persisted
+    std::size_t nSignals = 0;
+    for (const auto& [date, candles] : newBars)
+    {
+        const auto signals = processBar(date, candles);
+
+        for (const auto& s : signals)
+        {
+            LG_INFO("SIGNAL [{}] {} {} {} @ {:.6f} (sl {:.6f}, size {:.6f})",
+                    s.strategy, s.date, s.action, s.coin, s.price, s.stop, s.size);
+        }
+
+        if (!storeSignals(signals))
+            LG_ERROR("Failed to store {} signals", signals.size());
+
+        nSignals += signals.size();
+        lastProcessedDate_ = date;
+        saveCheckpoint();
+    }
+
+    LG_INFO("Processed {} new day(s), {} signal(s) emitted at {}",
+            newBars.size(), nSignals, currentUtcTimestamp());
+
+    return true;
+}
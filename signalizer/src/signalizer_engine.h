@@ -0,0 +1,236 @@
+#pragma once
+
+#include <boost/filesystem.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sqlite3.h>
+
+#include "data_types.h"
+#include "change_notification.h"
+#include "indicators.h"
+#include "market_data_bus.h"
+#include "market_data_reader.h"
+#include "shard_catalog.h"
+#include "sqlite_connection.h"
+#include "portfolio.h"
+#include "strategy.h"
+#include "signalizer_configdata.h"
+
+/***********************************************
+ * One signal emitted by a strategy for a bar.
+ ***********************************************/
+struct Signal {
+    std::string strategy;                  // Strategy name that emitted it
+    Timestamp   date      = 0;             // Bar date (YYYYMMDD) that produced it
+    Coin        coin;                      // Pair symbol
+    std::string action;                    // "ENTRY" or "EXIT"
+    Direction   direction = Direction::Flat;
+    double      price     = 0.0;           // Entry or exit price
+    double      stop      = 0.0;           // Current stop loss
+    double      size      = 0.0;           // Position size (base units)
+};
+
+/***********************************************
+ * A registered strategy running live, with its
+ * own portfolio and open trades.
+ ***********************************************/
+struct StrategySlot {
+    std::string                name;
+    std::unique_ptr<Portfolio> portfolio;  // Heap-allocated: strategy keeps a reference
+    std::unique_ptr<Strategy>  strategy;
+    std::vector<Trade>         current_trades;
+};
+
+/**************************************************************************************
+ * Purpose : Creates a strategy instance from its configured name.
+ * Args    : name   - Strategy name (e.g., "high_breakout").
+ *           portfolio - Portfolio the strategy sizes its positions against.
+ *           config - Active signalizer configuration (commissions...).
+ * Return  : std::unique_ptr<Strategy> - nullptr if the name is unknown.
+ **************************************************************************************/
+std::unique_ptr<Strategy> makeStrategy(const std::string& name,
+                                       Portfolio& portfolio,
+                                       const SignalizerConfig& config);
+
+/***********************************************
+ * Live signal engine performing:
+ *  - Detection of new commits in the market DB
+ *  - Incremental indicator updates per symbol
+ *  - Strategy evaluation for the new bar only
+ *  - Storage of emitted signals
+ ***********************************************/
+class SignalEngine {
+public:
+    /**************************************************************************************
+     * Purpose : Construct the engine and register the configured strategies.
+     * Args    : config - Active signalizer configuration.
+     **************************************************************************************/
+    explicit SignalEngine(const SignalizerConfig& config);
+    ~SignalEngine();
+
+    SignalEngine(const SignalEngine&) = delete;
+    SignalEngine& operator=(const SignalEngine&) = delete;
+
+    /**************************************************************************************
+     * Purpose : Main function invoked every tick by SignalizerScheduler. Cheaply checks
+     *           whether the market database has a new commit and, if new days are
+     *           present, advances indicators and runs every strategy on those bars.
+     * Args    : None
+     * Return  : bool - true if at least one new bar was processed.
+     **************************************************************************************/
+    bool processNewData();
+
+private:
+    // Active configuration
+    SignalizerConfig config_;
+
+    // Read-only connection on the market database, and typed queries over it
+    SqliteConnection db_;
+    MarketDataReader market_{db_};
+
+    // Shards of a sharded market database, attached to db_ per read
+    ShardedView shardView_;
+
+    // Read-write handle on the signals database
+    sqlite3* signalsDb_ = nullptr;
+
+    // Read-only mapping of the market data bus (null until the writer created it)
+    std::unique_ptr<MarketBusReader> bus_;
+
+    // Last seen PRAGMA data_version of db_ (changes when another connection commits)
+    long long dataVersion_ = -1;
+
+    // Last bar date (YYYYMMDD) fed to indicators and strategies
+    int lastProcessedDate_ = 0;
+
+    // Last data_version watermark whose changes were applied
+    long long lastVersion_ = 0;
+
+    // Indicator state per pair
+    std::map<Coin, IndicatorState> indicators_;
+
+    // Funding rates of the bars being processed, accrued by every strategy's portfolio
+    FundingSchedule funding_;
+
+    // Registered strategies
+    std::vector<StrategySlot> strategies_;
+
+    /**************************************************************************************
+     * Purpose : Opens the market database read-only and the signals database read-write,
+     *           creating the signals table if needed.
+     * Return  : bool - true if both handles are ready.
+     **************************************************************************************/
+    bool openDatabases();
+
+    /**************************************************************************************
+     * Purpose : Checks PRAGMA data_version to detect commits done by the database service.
+     * Return  : bool - true if the database changed since the last call.
+     **************************************************************************************/
+    bool hasNewCommit();
+
+    /**************************************************************************************
+     * Purpose : Returns the latest date stored in ohlcv_data (0 if empty or on error).
+     **************************************************************************************/
+    int queryLatestDate();
+
+    /**************************************************************************************
+     * Purpose : Returns the latest data_version watermark (0 if none or table missing).
+     **************************************************************************************/
+    long long queryLatestVersion();
+
+    /**************************************************************************************
+     * Purpose : Reads the data_changes rows committed after a watermark.
+     * Args    : version - Exclusive lower bound on data_version.
+     * Return  : std::vector<ChangedRange> - Changed pair/date ranges.
+     **************************************************************************************/
+    std::vector<ChangedRange> loadChangesSince(long long version);
+
+    /**************************************************************************************
+     * Purpose : Re-warms only the pairs whose already-processed history was rewritten
+     *           by commits after lastVersion_ (backfills, gap repairs).
+     **************************************************************************************/
+    void invalidateChangedPairs();
+
+    /**************************************************************************************
+     * Purpose : Loads all candles with fromDate < date <= toDate, grouped by date.
+     * Args    : fromDate - Exclusive lower bound (YYYYMMDD).
+     *           toDate   - Inclusive upper bound (YYYYMMDD).
+     *           pair     - Optional pair filter (empty = all pairs).
+     * Return  : date → (pair → OHLCV), dates in ascending order.
+     **************************************************************************************/
+    std::map<int, std::map<Coin, OHLCV>> loadBars(int fromDate, int toDate,
+                                                  const std::string& pair = "");
+
+    /**************************************************************************************
+     * Purpose : Maps the market data bus if configured, re-mapping it when the segment
+     *           was re-created or its snapshot is older than `watermark`.
+     * Args    : watermark - data_version the caller needs (0 = any).
+     * Return  : bool - true if the bus is available.
+     **************************************************************************************/
+    bool attachBus(long long watermark);
+
+    /**************************************************************************************
+     * Purpose : Reads the bars with fromDate < date <= toDate from the market data bus.
+     * Args    : fromDate - Exclusive lower bound (YYYYMMDD).
+     *           toDate   - Inclusive upper bound (YYYYMMDD).
+     *           out      - date → (pair → OHLCV), filled on success.
+     * Return  : bool - false if the bus is unavailable, stale, truncated or does not cover
+     *           the range.
+     **************************************************************************************/
+    bool loadBarsFromBus(int fromDate, int toDate, std::map<int, std::map<Coin, OHLCV>>& out);
+
+    /**************************************************************************************
+     * Purpose : Adopts the indicator state published on the bus instead of replaying the
+     *           lookback window from SQLite.
+     * Args    : latestDate - Last stored date (YYYYMMDD).
+     * Return  : bool - false if the bus is unavailable, truncated or not at latestDate.
+     **************************************************************************************/
+    bool warmUpFromBus(int latestDate);
+
+    /**************************************************************************************
+     * Purpose : Seeds indicator state with the lookback window ending at latestDate.
+     *           Strategies are not run during warm-up.
+     * Args    : latestDate - Last stored date (YYYYMMDD).
+     **************************************************************************************/
+    void warmUp(int latestDate);
+
+    /**************************************************************************************
+     * Purpose : Seeds indicator state of a pair first seen after warm-up (e.g., newly
+     *           tracked pair backfilled by the database service) up to toDate.
+     * Args    : pair   - Pair symbol.
+     *           toDate - Inclusive upper bound (YYYYMMDD).
+     **************************************************************************************/
+    void warmUpPair(const Coin& pair, int toDate);
+
+    /**************************************************************************************
+     * Purpose : Advances indicators by one bar and runs every strategy on it.
+     * Args    : date    - Bar date (YYYYMMDD).
+     *           candles - pair → OHLCV for that date.
+     * Return  : std::vector<Signal> - Signals emitted for this bar.
+     **************************************************************************************/
+    std::vector<Signal> processBar(Timestamp date, const std::map<Coin, OHLCV>& candles);
+
+    /**************************************************************************************
+     * Purpose : Writes the complete live state (indicators, portfolios, strategy state,
+     *           open trades, watermarks) to checkpoint_path, atomically.
+     * Return  : bool - true on success (or if checkpoints are disabled).
+     **************************************************************************************/
+    bool saveCheckpoint();
+
+    /**************************************************************************************
+     * Purpose : Restores the live state from checkpoint_path so a restart resumes after
+     *           the last processed bar instead of replaying history.
+     * Args    : latestDate - Latest date stored in the market database (YYYYMMDD).
+     * Return  : bool - true if a valid checkpoint was restored.
+     **************************************************************************************/
+    bool restoreCheckpoint(int latestDate);
+
+    /**************************************************************************************
+     * Purpose : Stores the signals into the signals table in a single transaction.
+     * Args    : signals - Signals to persist.
+     * Return  : bool - true on success.
+     **************************************************************************************/
+    bool storeSignals(const std::vector<Signal>& signals);
+};
@@ -1,5 +1,136 @@
+#include <iostream>
+#include <chrono>
+#include <csignal>
+#include <memory>
+#include <boost/program_options.hpp>
+
+#include "logger.h"
+#include "signalizer_scheduler.h"
+#include "config_handler.h"
+#include "signalizer_configdata.h"
+
+namespace po = boost::program_options;
+
+void signalHandler(int) {
+    Scheduler<SignalizerContext>::globalStop.store(true);
+}
 
 int main(int argc, char** argv) {
 
+    // ----------------------------------------------------
+    // Logger: minimal setup until arguments are parsed
+    // ----------------------------------------------------
+    bool debugMode = false;
+
+    Logger::Instance().Setup(
+        /*debugEnabled=*/false,
+        /*quiet=*/false,
+        /*fileAppender=*/"signalizer.log",
+        /*rollingAppender=*/"signalizer_roll.log",
+        /*includeHeader=*/true
+    );
+
+    std::signal(SIGINT,  signalHandler);
+    std::signal(SIGTERM, signalHandler);
+
+    // ----------------------------------------------------
+    // CLI arguments
+    // ----------------------------------------------------
+    std::string configPath;
+    std::string schemaPath;
+    int checkInterval = 30;
+
+    try {
+        po::options_description desc("Options");
+        desc.add_options()
+            ("help,h", "Show help")
+            ("debug,d", "Enable debug logging")
+            ("config,c", po::value<std::string>(&configPath)->required(), "Path to configuration file")
+            ("schema,s", po::value<std::string>(&schemaPath)->required(), "Path to JSON schema file")
+            ("check-interval,i", po::value<int>(&checkInterval)->default_value(30), "Seconds between configuration checks");
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << "\n";
+            return 0;
+        }
+
+        if (vm.count("debug"))
+            debugMode = true;
+
+        po::notify(vm);
+    }
+    catch (const std::exception& e) {
+        LG_ERROR(std::string("Argument error: ") + e.what());
+        return 1;
+    }
+
+    // ----------------------------------------------------
+    // Set log level based on CLI flag
+    // ----------------------------------------------------
+    Logger::Instance().Setup(
+        /*debugEnabled=*/debugMode,
+        /*quiet=*/false,
+        /*fileAppender=*/"signalizer.log",
+        /*rollingAppender=*/"signalizer_roll.log",
+        /*includeHeader=*/true
+    );
+
+    if (debugMode)
+        LG_DEBUG("Debug mode ENABLED.");
+    else
+        LG_INFO("Debug mode disabled.");
+
+    LG_INFO("Starting Signalizer service...");
+
+    // ----------------------------------------------------
+    // Create ConfigHandler
+    // ----------------------------------------------------
+    auto configHandler = std::make_unique<SignalizerConfigHandler>(
+        configPath,
+        schemaPath,
+        std::chrono::seconds(checkInterval)
+    );
+
+    // ----------------------------------------------------
+    // Load initial config into context
+    // ----------------------------------------------------
+    auto ctx = std::make_shared<SignalizerContext>();
+    if (auto initialCfg = configHandler->getCurrentConfig()) {
+        ctx->config = *initialCfg;
+    } else {
+        LG_ERROR("No initial config available from ConfigHandler.");
+        return 1;
+    }
+
+    // ----------------------------------------------------
+    // Create SignalizerScheduler
+    // ----------------------------------------------------
+    auto signalizerScheduler = std::make_unique<SignalizerScheduler>(
+        ctx,
+        *configHandler,
+        std::chrono::milliseconds(1000),   // tick every second
+        std::chrono::milliseconds(30000),  // timeout
+        std::chrono::seconds(2)            // initial delay
+    );
+
+    // Start config handler thread
+    configHandler->startAsync();
+
+    LG_INFO("Running... Press CTRL+C to stop.");
+
+    // ----------------------------------------------------
+    // Run scheduler (blocking)
+    // ----------------------------------------------------
+    signalizerScheduler->start();
+
+    // ----------------------------------------------------
+    // Graceful shutdown
+    // ----------------------------------------------------
+    configHandler->stop();
+    LG_INFO("Shutting down Signalizer application...");
+
     return 0;
 }
@@ -0,0 +1,97 @@
+#include "signalizer_scheduler.h"
+#include "logger.h"
+#include "time_utils.h"
+
+/**************************************************************************************
+ * Purpose : Constructs the SignalizerScheduler and initializes the underlying Scheduler
+ *           timer parameters, configuration handler reference, and signal engine.
+ * Args    : ctx            - Shared pointer holding the signalizer context.
+ *           configHandler  - Configuration handler for detecting and applying updates.
+ *           interval       - Time between scheduler ticks.
+ *           timeout        - Allowed execution time for processSecond().
+ *           secondsToStart - Optional delay before the first scheduler tick.
+ * Return  : None
+ **************************************************************************************/
+SignalizerScheduler::SignalizerScheduler(std::shared_ptr<SignalizerContext> ctx,
+                                         SignalizerConfigHandler& configHandler,
+                                         std::chrono::milliseconds interval,
+                                         std::chrono::milliseconds timeout,
+                                         std::chrono::seconds secondsToStart)
+    : Scheduler<SignalizerContext>(ctx, interval, timeout, secondsToStart),
+      configHandler_(configHandler),
+      signalEngine_(std::make_unique<SignalEngine>(this->ctx->config))
+{
+    resetChangeListener();
+}
+
+
+/**************************************************************************************
+ * Purpose : (Re)creates the notification listener from the active configuration. If the
+ *           socket cannot be bound the service keeps working by polling data_version.
+ * Args    : None
+ * Return  : void
+ **************************************************************************************/
+void SignalizerScheduler::resetChangeListener()
+{
+    changeListener_.reset();
+
+    const std::string& path = this->ctx->config.GetNotifySocket();
+    if (path.empty())
+        return;
+
+    try {
+        changeListener_ = std::make_unique<ChangeListener>(path);
+    }
+    catch (const std::exception& e) {
+        LG_ERROR("Notification listener disabled, polling only: {}", e.what());
+    }
+}
+
+
+/**************************************************************************************
+ * Purpose : Core periodic execution function. This runs once every scheduler tick.
+ *           Responsible for:
+ *             - Waiting (most of the tick) for a "day committed" notification so new
+ *               data is processed as soon as it is committed
+ *             - Processing any newly committed day (cheap no-op otherwise)
+ *             - Applying new signalizer configuration when available
+ * Args    : None
+ * Return  : void
+ **************************************************************************************/
+void SignalizerScheduler::processSecond() {
+
+    LG_DEBUG("Running processSecond ({})", currentUtcTimestamp());
+
+    auto& ctxRef = *this->ctx;
+
+    // ============================================================================
+    // WAIT FOR A COMMIT NOTIFICATION (RETURNS AS SOON AS ONE ARRIVES)
+    // ============================================================================
+    DayCommitted notification;
+    if (changeListener_ &&
+        changeListener_->wait(std::chrono::milliseconds(900), notification)) {
+        LG_INFO("DayCommitted notification: data_version {} for {} ({} pairs)",
+                notification.version, notification.date, notification.changes.size());
+    }
+
+    // ============================================================================
+    // PROCESS NEW BARS IF THE DATABASE SERVICE COMMITTED A NEW DAY
+    // ============================================================================
+    signalEngine_->processNewData();
+
+    // ============================================================================
+    // APPLY CONFIGURATION UPDATE IF ONE IS AVAILABLE
+    // ============================================================================
+    SignalizerConfig newConfig;
+    if (configHandler_.consumeNextConfig(newConfig)) {
+        LG_INFO("Applying new config...");
+        ctxRef.config = std::move(newConfig);
+
+        // Strategies/paths may have changed: rebuild state from a fresh warm-up
+        signalEngine_ = std::make_unique<SignalEngine>(ctxRef.config);
+        resetChangeListener();
+
+        LG_INFO("Config applied:\n{}",
+                     ctxRef.config.ToJson().dump(4));
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <memory>
+#include <chrono>
+#include "logger.h"
+#include "signalizer_configdata.h"
+#include "config_handler.h"
+#include "scheduler.h"
+#include "signalizer_engine.h"
+#include "change_notification.h"
+
+// --------------------------------------------------------------------------------------
+// Context used by the SignalizerScheduler. Holds the current signalizer configuration.
+// --------------------------------------------------------------------------------------
+struct SignalizerContext {
+    SignalizerConfig config;   // Current active signalizer configuration
+};
+
+using SignalizerConfigHandler = ConfigHandler<SignalizerConfig>;
+
+/**************************************************************************************
+ * Purpose : Scheduler responsible for live signal computation. Every tick it asks the
+ *           SignalEngine to check the market database for a newly committed day and,
+ *           if there is one, to run the registered strategies on that bar only.
+ *
+ * Inheritance:
+ *    - Inherits from Scheduler<SignalizerContext> to gain periodic scheduling capabilities.
+ **************************************************************************************/
+class SignalizerScheduler : public Scheduler<SignalizerContext> {
+public:
+
+    /**************************************************************************************
+     * Purpose : Constructs a signalizer scheduler responsible for running periodic work
+     *           and reacting to updated configuration values.
+     * Args    : ctx            - Shared pointer containing signalizer context.
+     *           configHandler  - Config handler that provides updated configurations.
+     *           interval       - Time between scheduler ticks.
+     *           timeout        - Max time allowed for each processSecond() execution.
+     *           secondsToStart - Optional initial delay before scheduling begins.
+     * Return  : None
+     **************************************************************************************/
+    SignalizerScheduler(std::shared_ptr<SignalizerContext> ctx,
+                        SignalizerConfigHandler& configHandler,
+                        std::chrono::milliseconds interval,
+                        std::chrono::milliseconds timeout,
+                        std::chrono::seconds secondsToStart = std::chrono::seconds(1));
+
+protected:
+
+    /**************************************************************************************
+     * Purpose : Main periodic task executed by the scheduler. Processes newly committed
+     *           market data and applies new configuration when available.
+     * Args    : None
+     * Return  : void
+     **************************************************************************************/
+    void processSecond() override;
+
+private:
+    // Reference to configuration handler used to detect and consume new configs.
+    SignalizerConfigHandler& configHandler_;
+
+    // Engine holding indicator/strategy state; rebuilt when the configuration changes.
+    std::unique_ptr<SignalEngine> signalEngine_;
+
+    // Receives "day committed" notifications (nullptr = rely on polling only).
+    std::unique_ptr<ChangeListener> changeListener_;
+
+    /**************************************************************************************
+     * Purpose : (Re)creates the notification listener from the active configuration.
+     * Args    : None
+     * Return  : void
+     **************************************************************************************/
+    void resetChangeListener();
+};